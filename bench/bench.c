@@ -0,0 +1,1490 @@
+/**
+ * File: bench.c
+ *
+ * Benchmarks for the renderer, built and run with `scons bench`.
+ *
+ * Microbenchmarks time the low level routines in a tight loop over varied inputs.
+ * Frame benchmarks render whole scenes (the <TriRing12_t> scene from main.c, and grids
+ * of rings for bigger triangle counts) at several resolutions, with and without antialiasing
+ * and lighting, and also time just the shading pass (<VisBuffer_shade>) on its own. The grids
+ * are rendered both as one big mesh and as instances of a single ring (see <Instance_t>).
+ * Animation benchmarks time keeping a scene's <Bvh_t> up to date as its mesh moves, either
+ * every vertex in a wave or just one ring spinning, with a <BvhRefit_t> and by building it
+ * again every frame. Loader benchmarks write a
+ * big grid mesh out to a file, in the current directory, and time loading it back.
+ *
+ * Every benchmark runs once to warm up, then <reps> timed times, and reports the median.
+ * Results go to stdout as CSV, one line per benchmark, with these columns:
+ *
+ *  name        -   Benchmark name, "micro/...", "frame/<scene>/<accel>/<WxH>",
+ *                  "anim/<scene>/<motion>/<update>", or "load/<format>/<mesh>".
+ *                  The accel is "bvh", "brute", "instanced", "raster" for primary
+ *                  visibility rasterized, or "shade" for the shading pass alone, with "+aa<N>" on the end for frames antialiased with N samples, and
+ *                  "+lit" for frames lit by a sun.
+ *  reps        -   Number of timed repetitions.
+ *  threads     -   Render or loader threads (always 1 for microbenchmarks).
+ *  ops         -   Operations per repetition: calls for micro, rays (pixels) for frames,
+ *                  frames for animations, bytes for loads.
+ *  median_ms, min_ms, max_ms   -   Time per repetition (i.e., frame time for frames).
+ *  ns_per_op   -   Median nanoseconds per operation (per ray, for frames).
+ *  ops_per_sec -   Operations per second at the median (rays per second, for frames).
+ *  ns_per_test -   For brute force frames, median nanoseconds per ray/triangle test.
+ *
+ * Progress goes to stderr, so stdout can be redirected straight to a file and diffed
+ * or plotted between builds.
+ *
+ * With --check DIR, it runs regression checks instead: a few reference scenes, chosen to
+ * go through the parts of the tracing most easily broken by a speedup (the edges the ring's
+ * triangles share, rays parallel to a triangle, brute force, instancing, antialiasing,
+ * shadows, rasterizing, cached camera rays, and refitting the hierarchy as the mesh moves), are
+ * rendered and compared pixel by pixel with golden images in DIR, and timed
+ * against a budget for each and against the times recorded in DIR. Adding --bless writes the
+ * golden images and times from this build instead, making DIR if it isn't there. The double
+ * build's golden images come with the source, in bench/golden, and come out the same on any
+ * machine; the times in its <BENCH_CHECK_BASELINE> only mean anything on the machine that
+ * recorded them, so they're left out of the repository. The results go to stdout as CSV:
+ *
+ *  name        -   Check name, "check/<scene>/<accel>/<WxH>", as for frame benchmarks, with
+ *                  "+wave" or "+spin" on the accel for a mesh moved as in the animation
+ *                  benchmarks first, and "+rays" for the camera rays cached in a <RayGen_t>,
+ *                  as main.c casts them. Those go without caching otherwise.
+ *  median_ms   -   Median frame time.
+ *  best_ms     -   Fastest frame time. Unlike the median, it hardly moves with whatever else
+ *                  the machine is doing, so it's what's held against the baseline.
+ *  budget_ms   -   Most the median can be.
+ *  baseline_ms -   Fastest time recorded by --bless, if it was recorded with as many threads.
+ *                  The fastest time going over it by more than the slack fails the check.
+ *  off_pixels  -   Pixels with a channel further from the golden image than the tolerance.
+ *  max_diff    -   Furthest any channel is from the golden image.
+ *  result      -   "ok", "blessed", or what failed. A moved mesh's frame also fails if it
+ *                  differs from the same frame with the hierarchy built from scratch.
+ *
+ * The program exits with 1 if any check fails.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <math.h>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
+
+#include "triangle.h"
+#include "triring.h"
+#include "triblock.h"
+#include "mesh.h"
+#include "meshload.h"
+#include "bvh.h"
+#include "instance.h"
+#include "scene.h"
+#include "light.h"
+#include "render.h"
+#include "raygen.h"
+#include "raster.h"
+#include "visbuffer.h"
+#include "tilepool.h"
+#include "image.h"
+#include "camera.h"
+#include "axes.h"
+#include "quat.h"
+#include "xform.h"
+#include "vect.h"
+#include "point.h"
+#include "util.h"
+#include "trig_helper.h"
+
+/**
+ * Constant: BENCH_INPUTS
+ * Number of distinct inputs the microbenchmarks cycle through (a power of 2).
+ */
+#define BENCH_INPUTS 1024
+
+/**
+ * Constant: BENCH_MICRO_OPS
+ * Calls per repetition of a microbenchmark.
+ */
+#define BENCH_MICRO_OPS (1 << 20)
+
+/**
+ * Constant: BENCH_RING_BLOCKS
+ * Number of <TriBlock_t> it takes to hold the 24 triangles of a ring.
+ */
+#define BENCH_RING_BLOCKS ((24 + TRIBLOCK_WIDTH - 1) / TRIBLOCK_WIDTH)
+
+/**
+ * Enum: BenchAccel_t
+ *
+ * BENCH_BVH - One mesh, traced with its <Bvh_t>.
+ * BENCH_BRUTE - One mesh, with every ray tested against every triangle.
+ * BENCH_INSTANCED - A copy of one ring for each ring, traced with an <InstanceBvh_t>.
+ * BENCH_RASTER - One mesh, rasterized for what each pixel sees (see <Raster_t>), and traced
+ *  with its <Bvh_t> for the rest.
+ */
+typedef enum {
+    BENCH_BVH,
+    BENCH_BRUTE,
+    BENCH_INSTANCED,
+    BENCH_RASTER
+} BenchAccel_t;
+
+typedef struct {
+    int reps;
+    unsigned int threads;
+    int quick;
+    const char *filter;
+
+    /**
+     * Fields: check_dir, bless, tolerance, max_off, slack
+     * For regression checks: where the golden images and times are, whether to write them
+     * rather than check against them, how far a channel can be from the golden image, the
+     * fraction of pixels that can be further than that, and the fraction the median can be
+     * over the recorded one.
+     */
+    const char *check_dir;
+    int bless;
+    int tolerance;
+    double max_off;
+    double slack;
+} BenchOpts_t;
+
+/**
+ * Struct: BenchScene_t
+ * A scene to render, with everything it points to.
+ */
+typedef struct {
+    const char *name;
+
+    /**
+     * Field: arena
+     * Holds the instances, and the scratch for building the meshes, so the scene takes its
+     * memory in a few big blocks and gives it all back at once.
+     */
+    Arena_t arena;
+
+    /**
+     * Fields: ring_pool, rings
+     * Each ring is its own object from the pool, which cuts them all from one slab, and
+     * <rings> points to them in order.
+     */
+    Pool_t ring_pool;
+    TriRing12_t **rings;
+    unsigned int ring_count;
+    unsigned int triangle_count;
+    Mesh_t mesh;
+    Bvh_t bvh;
+    Camera_t cam;
+
+    /**
+     * Fields: ring_mesh, ring_bvh, instances, top
+     * The same scene as instances of a single ring at the origin.
+     */
+    Mesh_t ring_mesh;
+    Bvh_t ring_bvh;
+    Instance_t *instances;
+    InstanceBvh_t top;
+
+    /**
+     * Field: raster
+     * The rasterizer for <BENCH_RASTER> frames, kept with the scene so, as in main.c, its memory
+     * is reused from frame to frame.
+     */
+    Raster_t raster;
+} BenchScene_t;
+
+//Results get written here so the compiler can't throw the work away.
+static volatile double bench_sink;
+
+static double Bench_random(void)
+{
+    return (rand() / (double)RAND_MAX) * 2.0 - 1.0;
+}
+
+static int Bench_compare(const void *pA, const void *pB)
+{
+    const double a = *(const double *)pA;
+    const double b = *(const double *)pB;
+    return (a > b) - (a < b);
+}
+
+static int Bench_selected(const BenchOpts_t *const pOpts, const char *const name)
+{
+    return pOpts->filter == NULL || strstr(name, pOpts->filter) != NULL;
+}
+
+/**
+ * Function: Bench_median
+ * Sorts the times, and returns their median.
+ */
+static double Bench_median(double *const times, const int reps)
+{
+    qsort(times, reps, sizeof(double), Bench_compare);
+    return (reps % 2) ? times[reps/2] : 0.5 * (times[reps/2 - 1] + times[reps/2]);
+}
+
+static void Bench_report(const char *const name, const int reps, const unsigned int threads, double *const times, const double ops, const double tests)
+{
+    const double median = Bench_median(times, reps);
+
+    printf("%s,%d,%u,%.0f,%.6f,%.6f,%.6f,%.3f,%.1f,", name, reps, threads, ops,
+        median * 1e3, times[0] * 1e3, times[reps-1] * 1e3,
+        (median / ops) * 1e9, ops / median);
+    if(tests > 0) {
+        printf("%.4f", (median / tests) * 1e9);
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+//// Microbenchmarks ////
+
+/**
+ * Struct: BenchInputs_t
+ * Random rays, points, vectors, and rotations for the microbenchmarks to chew on.
+ */
+typedef struct {
+    TriRing12_t ring;
+    Mesh_t mesh;
+    TriBlock_t blocks[BENCH_RING_BLOCKS];
+    Point_t origins[BENCH_INPUTS];
+    Vect_t rays[BENCH_INPUTS];
+    Point_t points[BENCH_INPUTS];
+    Vect_t vects[BENCH_INPUTS];
+    Quat_t quats[BENCH_INPUTS];
+} BenchInputs_t;
+
+static void BenchInputs_cfg(BenchInputs_t *const pThis)
+{
+    unsigned int i;
+    Point_t center, target;
+    Vect_t first, up, axis;
+    const Triangle_t *triangles[25];
+
+    Point_cfg(&center, 0, 0, 0);
+    Vect_cfg(&first, 0, 0, 2);
+    Vect_cfg(&up, 0, 1, 0);
+    TriRing12_cfg(&(pThis->ring), &center, &first, &up, rads(20));
+    for(i=0; i<24; i++) {
+        if(i % TRIBLOCK_WIDTH == 0) {
+            TriBlock_cfgEmpty(&(pThis->blocks[i / TRIBLOCK_WIDTH]));
+        }
+        TriBlock_setLane(&(pThis->blocks[i / TRIBLOCK_WIDTH]), i % TRIBLOCK_WIDTH, &(pThis->ring.triangles[i]), i);
+        triangles[i] = &(pThis->ring.triangles[i]);
+    }
+    triangles[24] = NULL;
+    Mesh_cfgTriangles(&(pThis->mesh), triangles);
+
+    //Rays from in front of the ring towards points scattered around it, so some hit and some miss.
+    for(i=0; i<BENCH_INPUTS; i++) {
+        Point_cfg(&(pThis->origins[i]), Bench_random(), Bench_random(), -5.0);
+        Point_cfg(&target, 2.5 * Bench_random(), 1.5 * Bench_random(), 2.0 * Bench_random());
+        Point_displacement(&(pThis->rays[i]), &(pThis->origins[i]), &target);
+
+        Point_cfg(&(pThis->points[i]), 2.0 * Bench_random(), Bench_random(), 2.0 * Bench_random());
+        Vect_cfg(&(pThis->vects[i]), Bench_random(), Bench_random(), Bench_random());
+
+        Vect_cfg(&axis, Bench_random(), Bench_random(), Bench_random() + 2.0);
+        Quat_rotation(&(pThis->quats[i]), &axis, PI * Bench_random());
+    }
+}
+
+static double BenchMicro_rayCast(const BenchInputs_t *const pIn)
+{
+    unsigned int i;
+    double sum = 0;
+    Color_t color;
+
+    for(i=0; i<BENCH_MICRO_OPS; i++) {
+        const unsigned int k = i & (BENCH_INPUTS - 1);
+        sum += Triangle_rayCast(&(pIn->ring.triangles[i % 24]), &color, INFINITY, &(pIn->origins[k]), &(pIn->rays[k]));
+    }
+    return sum;
+}
+
+static double BenchMicro_meshRayCast(const BenchInputs_t *const pIn)
+{
+    unsigned int i;
+    double sum = 0;
+    Color_t color;
+
+    for(i=0; i<BENCH_MICRO_OPS; i++) {
+        const unsigned int k = i & (BENCH_INPUTS - 1);
+        sum += Mesh_rayCast(&(pIn->mesh), i % 24, &color, INFINITY, &(pIn->origins[k]), &(pIn->rays[k]));
+    }
+    return sum;
+}
+
+static double BenchMicro_triBlock(const BenchInputs_t *const pIn)
+{
+    unsigned int i;
+    double sum = 0;
+    TriHit_t hit;
+
+    //Each call tests TRIBLOCK_WIDTH triangles, so do that many fewer calls for the same work.
+    for(i=0; i<BENCH_MICRO_OPS / TRIBLOCK_WIDTH; i++) {
+        const unsigned int k = i & (BENCH_INPUTS - 1);
+        hit.dist = INFINITY;
+        hit.id = TRIBLOCK_EMPTY;
+        TriBlock_intersect(&(pIn->blocks[i % BENCH_RING_BLOCKS]), &(pIn->origins[k]), &(pIn->rays[k]), &hit);
+        sum += hit.dist;
+    }
+    return sum;
+}
+
+static double BenchMicro_barycentric(const BenchInputs_t *const pIn)
+{
+    unsigned int i;
+    double sum = 0;
+    Point_t bary;
+
+    for(i=0; i<BENCH_MICRO_OPS; i++) {
+        Triangle_barycentricPosition(&(pIn->ring.triangles[i % 24]), &bary, &(pIn->points[i & (BENCH_INPUTS - 1)]));
+        sum += bary.x;
+    }
+    return sum;
+}
+
+static double BenchMicro_quatRotate(const BenchInputs_t *const pIn)
+{
+    unsigned int i;
+    double sum = 0;
+    Vect_t out;
+
+    for(i=0; i<BENCH_MICRO_OPS; i++) {
+        const unsigned int k = i & (BENCH_INPUTS - 1);
+        Quat_rotateVect(&(pIn->quats[k]), &out, &(pIn->vects[(k * 7) & (BENCH_INPUTS - 1)]));
+        sum += out.x;
+    }
+    return sum;
+}
+
+static double BenchMicro_xformPoints(const BenchInputs_t *const pIn)
+{
+    unsigned int i, k;
+    double sum = 0;
+    Xform_t xform;
+    Point_t out[BENCH_INPUTS];
+
+    //One matrix per batch of points, as for animating a mesh.
+    for(i=0; i<BENCH_MICRO_OPS / BENCH_INPUTS; i++) {
+        k = i & (BENCH_INPUTS - 1);
+        Xform_fromQuat(&xform, &(pIn->quats[k]), &(pIn->vects[k]));
+        Xform_points(&xform, out, pIn->points, BENCH_INPUTS);
+        sum += out[k].x;
+    }
+    return sum;
+}
+
+static double BenchMicro_crossDot(const BenchInputs_t *const pIn)
+{
+    unsigned int i;
+    double sum = 0;
+    Vect_t out;
+
+    for(i=0; i<BENCH_MICRO_OPS; i++) {
+        const unsigned int k = i & (BENCH_INPUTS - 1);
+        Vect_cross(&out, &(pIn->vects[k]), &(pIn->rays[k]));
+        sum += Vect_dot(&out, &(pIn->vects[(k + 1) & (BENCH_INPUTS - 1)]));
+    }
+    return sum;
+}
+
+static void Bench_micro(const BenchOpts_t *const pOpts, const char *const name, double (*func)(const BenchInputs_t *), const BenchInputs_t *const pIn)
+{
+    int r;
+    double start;
+    double *times;
+
+    if(!Bench_selected(pOpts, name)) {
+        return;
+    }
+    fprintf(stderr, "%s\n", name);
+    times = Util_allocOrDie(sizeof(double) * pOpts->reps, "Allocating benchmark timings.");
+
+    bench_sink = func(pIn);
+    for(r=0; r<pOpts->reps; r++) {
+        start = Util_now();
+        bench_sink = func(pIn);
+        times[r] = Util_now() - start;
+    }
+
+    Bench_report(name, pOpts->reps, 1, times, BENCH_MICRO_OPS, 0);
+    free(times);
+}
+
+//// Frame benchmarks ////
+
+/**
+ * Function: BenchScene_cfg
+ * Configures a scene of <side> by <side> rings on a grid, with a camera that takes them all in.
+ * A side of 1 is exactly the scene main.c shows.
+ */
+static BenchScene_t * BenchScene_cfg(BenchScene_t *const pThis, const char *const name, const unsigned int side)
+{
+    unsigned int i, j, t;
+    Point_t center;
+    Vect_t first, up;
+    Axes_t axes;
+    TriRing12_t ring;
+    const Triangle_t **triangles;
+
+    const double spacing = 5.0;
+
+    pThis->name = name;
+    pThis->ring_count = side * side;
+    pThis->triangle_count = 24 * pThis->ring_count;
+    Arena_cfg(&(pThis->arena), 0);
+    POOL_CFG(&(pThis->ring_pool), TriRing12_t, pThis->ring_count);
+    pThis->rings = Arena_alloc(&(pThis->arena), sizeof(TriRing12_t *) * pThis->ring_count, "Allocating benchmark rings.");
+    triangles = Arena_alloc(&(pThis->arena), sizeof(const Triangle_t *) * (pThis->triangle_count + 1), "Allocating benchmark triangles.");
+
+    Vect_cfg(&first, 0, 0, 2);
+    Vect_cfg(&up, 0, 1, 0);
+    for(j=0; j<side; j++) {
+        for(i=0; i<side; i++) {
+            Point_cfg(&center, spacing * (i - 0.5 * (side - 1)), spacing * (j - 0.5 * (side - 1)), 0);
+            pThis->rings[j * side + i] = POOL_NEW(&(pThis->ring_pool), TriRing12_t);
+            TriRing12_cfg(pThis->rings[j * side + i], &center, &first, &up, rads(20));
+        }
+    }
+    for(t=0; t<pThis->triangle_count; t++) {
+        triangles[t] = &(pThis->rings[t / 24]->triangles[t % 24]);
+    }
+    triangles[pThis->triangle_count] = NULL;
+
+    Mesh_cfgTriangles(&(pThis->mesh), triangles);
+    Bvh_cfg(&(pThis->bvh), &(pThis->mesh));
+
+    //The same again, as copies of one ring moved into place.
+    Point_cfg(&center, 0, 0, 0);
+    TriRing12_cfg(&ring, &center, &first, &up, rads(20));
+    for(t=0; t<24; t++) {
+        triangles[t] = &(ring.triangles[t]);
+    }
+    triangles[24] = NULL;
+    Mesh_cfgTriangles(&(pThis->ring_mesh), triangles);
+    Bvh_cfg(&(pThis->ring_bvh), &(pThis->ring_mesh));
+    pThis->instances = Arena_alloc(&(pThis->arena), sizeof(Instance_t) * pThis->ring_count, "Allocating benchmark instances.");
+    for(j=0; j<side; j++) {
+        for(i=0; i<side; i++) {
+            Axes_cfg(&axes);
+            Point_cfg(&(axes.origin), spacing * (i - 0.5 * (side - 1)), spacing * (j - 0.5 * (side - 1)), 0);
+            Instance_cfg(&(pThis->instances[j * side + i]), &(pThis->ring_bvh), &axes);
+        }
+    }
+    InstanceBvh_cfg(&(pThis->top), pThis->instances, pThis->ring_count);
+    Raster_cfg(&(pThis->raster));
+
+    Camera_cfg(&(pThis->cam), 1.0);
+    Camera_pitch(&(pThis->cam), rads(20));
+    Camera_march(&(pThis->cam), -5.0 * side);
+
+    return pThis;
+}
+
+static void BenchScene_destroy(BenchScene_t *const pThis)
+{
+    Raster_destroy(&(pThis->raster));
+    InstanceBvh_destroy(&(pThis->top));
+    Bvh_destroy(&(pThis->ring_bvh));
+    Mesh_destroy(&(pThis->ring_mesh));
+    Bvh_destroy(&(pThis->bvh));
+    Mesh_destroy(&(pThis->mesh));
+    Pool_destroy(&(pThis->ring_pool));
+    Arena_destroy(&(pThis->arena));
+}
+
+/**
+ * Function: Bench_variant
+ * Writes the accel part of a frame benchmark's name, e.g. "bvh+aa8+lit".
+ */
+static void Bench_variant(char *const opVariant, const size_t size, const BenchAccel_t accel, const unsigned int aa, const int lit)
+{
+    snprintf(opVariant, size, "%s", (accel == BENCH_BRUTE) ? "brute" : (accel == BENCH_INSTANCED) ? "instanced" : (accel == BENCH_RASTER) ? "raster" : "bvh");
+    if(aa > 0) {
+        snprintf(opVariant + strlen(opVariant), size - strlen(opVariant), "+aa%u", aa);
+    }
+    if(lit) {
+        snprintf(opVariant + strlen(opVariant), size - strlen(opVariant), "+lit");
+    }
+}
+
+/**
+ * Function: Bench_sun
+ * Configures the one sun lit frames have, so every hit casts one shadow ray.
+ */
+static const Light_t * Bench_sun(Light_t *const opSun)
+{
+    Vect_t sun_dir;
+
+    Vect_cfg(&sun_dir, 1, -2, 1);
+    return Light_cfgDirectional(opSun, &sun_dir, 0.8);
+}
+
+/**
+ * Function: BenchScene_scene
+ * Configures a <Scene_t> to render the benchmark scene with the given accel, through its
+ * camera, lit by <pSun> if it isn't NULL. The rays aren't cached, nothing is counted, and only
+ * <BENCH_RASTER> rasterizes.
+ */
+static Scene_t * BenchScene_scene(BenchScene_t *const pThis, Scene_t *const opScene, const BenchAccel_t accel, const unsigned int aa, const Light_t *const pSun, const unsigned int threads, const int width, const int height)
+{
+    opScene->mesh = &(pThis->mesh);
+    opScene->bvh = (accel == BENCH_BRUTE) ? NULL : &(pThis->bvh);
+    opScene->instances = (accel == BENCH_INSTANCED) ? &(pThis->top) : NULL;
+    opScene->cam = &(pThis->cam);
+    opScene->frame_height = 1.0;
+    opScene->frame_width = opScene->frame_height * width / height;
+    opScene->img_width = width;
+    opScene->img_height = height;
+    opScene->threads = threads;
+    opScene->aa_samples = aa;
+    opScene->lights = pSun;
+    opScene->light_count = (pSun != NULL) ? 1 : 0;
+    opScene->ambient = 0.2;
+    opScene->rays = NULL;
+    opScene->raster = (accel == BENCH_RASTER) ? &(pThis->raster) : NULL;
+    opScene->stats = NULL;
+    return opScene;
+}
+
+static void Bench_frame(const BenchOpts_t *const pOpts, BenchScene_t *const pScene, const BenchAccel_t accel, const unsigned int aa, const int lit, const int width, const int height)
+{
+    int r;
+    double start;
+    char name[128];
+    char variant[32];
+    Scene_t scene;
+    RayGen_t rays;
+    Image_t image;
+    Light_t sun;
+    double *times;
+
+    Bench_variant(variant, sizeof(variant), accel, aa, lit);
+    snprintf(name, sizeof(name), "frame/%s/%s/%dx%d", pScene->name, variant, width, height);
+    if(!Bench_selected(pOpts, name)) {
+        return;
+    }
+    fprintf(stderr, "%s\n", name);
+
+    BenchScene_scene(pScene, &scene, accel, aa, lit ? Bench_sun(&sun) : NULL, pOpts->threads, width, height);
+
+    //As in main.c, the rays are worked out in the warm up frame, and reused after that.
+    scene.rays = RayGen_cfg(&rays);
+
+    times = Util_allocOrDie(sizeof(double) * pOpts->reps, "Allocating benchmark timings.");
+    Image_cfg(&image, width, height);
+
+    Render_scene(&scene, image.pixels, image.rowstride);
+    for(r=0; r<pOpts->reps; r++) {
+        start = Util_now();
+        Render_scene(&scene, image.pixels, image.rowstride);
+        times[r] = Util_now() - start;
+    }
+
+    Bench_report(name, pOpts->reps, TilePool_threads(pOpts->threads), times, (double)width * height,
+        (accel == BENCH_BRUTE) ? (double)width * height * pScene->triangle_count : 0);
+
+    RayGen_destroy(&rays);
+    Image_destroy(&image);
+    free(times);
+}
+
+/**
+ * Function: Bench_shade
+ * Times only shading a frame from its visibility buffer, i.e. what redrawing it costs when
+ * just the colors change.
+ */
+static void Bench_shade(const BenchOpts_t *const pOpts, BenchScene_t *const pScene, const int width, const int height)
+{
+    int r;
+    double start;
+    char name[128];
+    Scene_t scene;
+    Image_t image;
+    VisBuffer_t buffer;
+    double *times;
+
+    snprintf(name, sizeof(name), "frame/%s/shade/%dx%d", pScene->name, width, height);
+    if(!Bench_selected(pOpts, name)) {
+        return;
+    }
+    fprintf(stderr, "%s\n", name);
+
+    BenchScene_scene(pScene, &scene, BENCH_BVH, 0, NULL, pOpts->threads, width, height);
+
+    times = Util_allocOrDie(sizeof(double) * pOpts->reps, "Allocating benchmark timings.");
+    Image_cfg(&image, width, height);
+    VisBuffer_cfg(&buffer, width, height);
+    Render_visibility(&scene, &buffer);
+
+    VisBuffer_shade(&buffer, scene.mesh, image.pixels, image.rowstride);
+    for(r=0; r<pOpts->reps; r++) {
+        start = Util_now();
+        VisBuffer_shade(&buffer, scene.mesh, image.pixels, image.rowstride);
+        times[r] = Util_now() - start;
+    }
+
+    Bench_report(name, pOpts->reps, 1, times, (double)width * height, 0);
+
+    VisBuffer_destroy(&buffer);
+    Image_destroy(&image);
+    free(times);
+}
+
+//// Animation benchmarks ////
+
+/**
+ * Constant: BENCH_ANIM_FRAMES
+ * Frames of animation per repetition of an animation benchmark.
+ */
+#define BENCH_ANIM_FRAMES 10
+
+/**
+ * Enum: BenchMotion_t
+ *
+ * BENCH_STILL - Nothing moves. Only the regression checks use it, for scenes that don't.
+ * BENCH_WAVE - Every vertex moves, in a wave across the grid.
+ * BENCH_SPIN - One ring turns about its axis, and nothing else moves.
+ */
+typedef enum {
+    BENCH_STILL,
+    BENCH_WAVE,
+    BENCH_SPIN
+} BenchMotion_t;
+
+/**
+ * Function: BenchAnim_move
+ * Moves the mesh's vertices from where they started, <orig>, to where they are in frame <f>,
+ * and lists the triangles that moved in <opMoved>. Returns how many there are.
+ */
+static unsigned int BenchAnim_move(Mesh_t *const pMesh, const Point_t *const orig, const BenchMotion_t motion, const unsigned int f, unsigned int *const opMoved)
+{
+    unsigned int t, v;
+    Point_t center;
+    Vect_t up, disp;
+    Quat_t spin;
+
+    if(motion == BENCH_WAVE) {
+        for(v=0; v<pMesh->vert_count; v++) {
+            pMesh->positions[v] = orig[v];
+            pMesh->positions[v].z += 0.5 * sin((0.4 * orig[v].x) + (0.3 * f));
+        }
+        Mesh_recompute(pMesh);
+        for(t=0; t<pMesh->tri_count; t++) {
+            opMoved[t] = t;
+        }
+        return pMesh->tri_count;
+    }
+
+    //The first ring is the first 24 triangles; it turns about its center, the average of its
+    // corners.
+    Point_cfg(&center, 0, 0, 0);
+    for(t=0; t<24; t++) {
+        for(v=0; v<3; v++) {
+            const Point_t *const pPt = &(orig[pMesh->indices[(3 * t) + v]]);
+            Point_cfg(&center, center.x + (pPt->x / 72), center.y + (pPt->y / 72), center.z + (pPt->z / 72));
+        }
+    }
+    Vect_cfg(&up, 0, 1, 0);
+    Quat_rotation(&spin, &up, 0.1 * f);
+    for(t=0; t<24; t++) {
+        for(v=0; v<3; v++) {
+            const uint32_t index = pMesh->indices[(3 * t) + v];
+            Point_displacement(&disp, &center, &(orig[index]));
+            Quat_rotateVect(&spin, &disp, &disp);
+            Point_cfg(&(pMesh->positions[index]), center.x + disp.x, center.y + disp.y, center.z + disp.z);
+        }
+    }
+    for(t=0; t<24; t++) {
+        Mesh_recomputeTri(pMesh, t);
+        opMoved[t] = t;
+    }
+    return 24;
+}
+
+/**
+ * Function: Bench_anim
+ * Times keeping the scene's hierarchy up to date as its mesh moves, with a <BvhRefit_t> if
+ * <refit>, otherwise by building it again from scratch every frame.
+ */
+static void Bench_anim(const BenchOpts_t *const pOpts, BenchScene_t *const pScene, const BenchMotion_t motion, const int refit)
+{
+    int r;
+    unsigned int t, f = 0, frame, moved_count, rebuilds = 0, rebuilt = 0;
+    double start;
+    char name[128];
+    double *times;
+    const Triangle_t **triangles;
+    unsigned int *moved;
+    Point_t *orig;
+    Mesh_t mesh;
+    Bvh_t bvh;
+    BvhRefit_t refitter;
+
+    snprintf(name, sizeof(name), "anim/%s/%s/%s", pScene->name, (motion == BENCH_WAVE) ? "wave" : "spin", refit ? "refit" : "rebuild");
+    if(!Bench_selected(pOpts, name)) {
+        return;
+    }
+    fprintf(stderr, "%s\n", name);
+
+    //A mesh of its own, so the other benchmarks' stays put.
+    triangles = Util_allocOrDie(sizeof(const Triangle_t *) * (pScene->triangle_count + 1), "Allocating benchmark triangles.");
+    for(t=0; t<pScene->triangle_count; t++) {
+        triangles[t] = &(pScene->rings[t / 24]->triangles[t % 24]);
+    }
+    triangles[pScene->triangle_count] = NULL;
+    Mesh_cfgTriangles(&mesh, triangles);
+    free(triangles);
+    orig = Util_cloneOrDie(mesh.positions, sizeof(Point_t) * mesh.vert_count, "Allocating benchmark vertices.");
+    moved = Util_allocOrDie(sizeof(unsigned int) * mesh.tri_count, "Allocating benchmark moved triangles.");
+    Bvh_cfg(&bvh, &mesh);
+    if(refit) {
+        BvhRefit_cfg(&refitter, &bvh);
+    }
+
+    times = Util_allocOrDie(sizeof(double) * pOpts->reps, "Allocating benchmark timings.");
+    for(r=-1; r<pOpts->reps; r++) {
+        start = Util_now();
+        for(frame=0; frame<BENCH_ANIM_FRAMES; frame++) {
+            moved_count = BenchAnim_move(&mesh, orig, motion, ++f, moved);
+            if(refit) {
+                if(moved_count == mesh.tri_count) {
+                    BvhRefit_all(&refitter);
+                }
+                else {
+                    BvhRefit_moved(&refitter, moved, moved_count);
+                }
+                rebuilds += refitter.rebuilds;
+                rebuilt += refitter.rebuilt;
+            }
+            else {
+                Bvh_destroy(&bvh);
+                Bvh_cfg(&bvh, &mesh);
+            }
+        }
+        if(r >= 0) {
+            times[r] = Util_now() - start;
+        }
+    }
+
+    Bench_report(name, pOpts->reps, 1, times, BENCH_ANIM_FRAMES, 0);
+    if(refit) {
+        fprintf(stderr, "Rebuilt %u subtrees, of %u triangles in all, over %u frames.\n", rebuilds, rebuilt, f);
+        BvhRefit_destroy(&refitter);
+    }
+
+    Bvh_destroy(&bvh);
+    Mesh_destroy(&mesh);
+    free(moved);
+    free(orig);
+    free(times);
+}
+
+//// Loader benchmarks ////
+
+/**
+ * Function: BenchLoad_write
+ * Writes a <side> by <side> grid of colored squares, two triangles each, as an OBJ file or a
+ * binary STL file. Returns the size of the file, or -1 if it can't be written.
+ */
+static long BenchLoad_write(const char *const path, const unsigned int side, const int stl)
+{
+    unsigned int i, j, k;
+    long size;
+    unsigned char rec[50];
+    float coords[3];
+    FILE *const file = fopen(path, "wb");
+
+    if(file == NULL) {
+        return -1;
+    }
+
+    if(stl) {
+        const unsigned int count = 2 * side * side;
+        memset(rec, 0, sizeof(rec));
+        fwrite(rec, 1, 80, file);
+        rec[0] = count & 0xFF;
+        rec[1] = (count >> 8) & 0xFF;
+        rec[2] = (count >> 16) & 0xFF;
+        rec[3] = (count >> 24) & 0xFF;
+        fwrite(rec, 1, 4, file);
+
+        //Assumes a little-endian machine, which is all we benchmark on.
+        memset(rec, 0, sizeof(rec));
+        for(j=0; j<side; j++) {
+            for(i=0; i<side; i++) {
+                for(k=0; k<6; k++) {
+                    //Corners (0,0), (1,0), (1,1) then (0,0), (1,1), (0,1) of the square.
+                    const unsigned int di = (k == 1 || k == 2 || k == 4);
+                    const unsigned int dj = (k == 2 || k == 4 || k == 5);
+                    coords[0] = (float)(i + di) / side;
+                    coords[1] = (float)(j + dj) / side;
+                    coords[2] = (float)(0.1 * sin((i + di) * 0.1));
+                    memcpy(rec + 12 + (12 * (k % 3)), coords, sizeof(coords));
+                    if(k % 3 == 2) {
+                        rec[48] = (unsigned char)i;
+                        rec[49] = 0x80 | (j & 0x7F);
+                        fwrite(rec, 1, sizeof(rec), file);
+                    }
+                }
+            }
+        }
+    }
+    else {
+        for(j=0; j<=side; j++) {
+            for(i=0; i<=side; i++) {
+                fprintf(file, "v %f %f %f %.3f %.3f 0.5\n", (double)i / side, (double)j / side, 0.1 * sin(i * 0.1), (double)i / side, (double)j / side);
+            }
+        }
+        for(j=0; j<side; j++) {
+            for(i=0; i<side; i++) {
+                const unsigned int a = (j * (side + 1)) + i + 1;
+                fprintf(file, "f %u %u %u %u\n", a, a + 1, a + side + 2, a + side + 1);
+            }
+        }
+    }
+
+    size = ftell(file);
+    if(fclose(file) != 0) {
+        return -1;
+    }
+    return size;
+}
+
+static void Bench_load(const BenchOpts_t *const pOpts, const unsigned int side, const int stl)
+{
+    int r;
+    double start;
+    long size;
+    char name[128];
+    double *times;
+    Mesh_t mesh;
+
+    const char *const path = stl ? "bench_load.stl" : "bench_load.obj";
+
+    snprintf(name, sizeof(name), "load/%s/grid%u", stl ? "stl" : "obj", side);
+    if(!Bench_selected(pOpts, name)) {
+        return;
+    }
+    fprintf(stderr, "%s\n", name);
+
+    size = BenchLoad_write(path, side, stl);
+    if(size < 0) {
+        fprintf(stderr, "Can't write %s, skipping.\n", path);
+        remove(path);
+        return;
+    }
+
+    times = Util_allocOrDie(sizeof(double) * pOpts->reps, "Allocating benchmark timings.");
+    for(r=-1; r<pOpts->reps; r++) {
+        start = Util_now();
+        if(!MeshLoad_file(&mesh, path, pOpts->threads)) {
+            break;
+        }
+        if(r >= 0) {
+            times[r] = Util_now() - start;
+        }
+        Mesh_destroy(&mesh);
+    }
+
+    if(r == pOpts->reps) {
+        Bench_report(name, pOpts->reps, TilePool_threads(pOpts->threads), times, (double)size, 0);
+    }
+    remove(path);
+    free(times);
+}
+
+//// Regression checks ////
+
+/**
+ * Constants: Regression checks
+ *
+ * BENCH_CHECK_TOLERANCE - Default for how far a channel can be from the golden image, so
+ *  rounding a color the other way doesn't count.
+ * BENCH_CHECK_MAX_OFF - Default for the fraction of pixels that can be further than that, so an
+ *  edge pixel or two going to the triangle on the other side doesn't either.
+ * BENCH_CHECK_SLACK - Default for the fraction the fastest time can be over the recorded one.
+ * BENCH_CHECK_NOISE_MS - Milliseconds it can be over that as well, so the jitter in
+ *  frames that only take a few doesn't count.
+ * BENCH_CHECK_BASELINE - File in the check directory the times are recorded in.
+ */
+#define BENCH_CHECK_TOLERANCE 1
+#define BENCH_CHECK_MAX_OFF 0.0005
+#define BENCH_CHECK_SLACK 0.5
+#define BENCH_CHECK_NOISE_MS 2.0
+#define BENCH_CHECK_BASELINE "baseline.csv"
+
+/**
+ * Struct: BenchCheck_t
+ * A reference scene for the regression checks: a <side> by <side> grid of rings, seen as the
+ * frame benchmarks see it, or straight down the rings' axis if <axial>, where rays go along
+ * the ring's faces rather than through them. If <motion> isn't <BENCH_STILL>, the mesh moves
+ * that way for <BENCH_ANIM_FRAMES> frames first, with its hierarchy refit after each. If <cached>,
+ * the camera rays come from a <RayGen_t>, and have to give the golden image of the same check
+ * without it. Its median frame time mustn't go over <budget_ms>.
+ */
+typedef struct {
+    const char *scene;
+    unsigned int side;
+    int axial;
+    BenchAccel_t accel;
+    unsigned int aa;
+    int lit;
+    BenchMotion_t motion;
+    int cached;
+    int width;
+    int height;
+    double budget_ms;
+} BenchCheck_t;
+
+static const BenchCheck_t bench_checks[] = {
+    {"ring12", 1, 0, BENCH_BVH, 0, 0, BENCH_STILL, 0, 320, 240, 250},
+    {"ring12", 1, 0, BENCH_BRUTE, 0, 0, BENCH_STILL, 0, 320, 240, 250},
+    {"ring12", 1, 0, BENCH_BVH, 8, 0, BENCH_STILL, 0, 320, 240, 500},
+    {"ring12", 1, 0, BENCH_BVH, 0, 1, BENCH_STILL, 0, 320, 240, 250},
+    {"ring12-axial", 1, 1, BENCH_BVH, 0, 0, BENCH_STILL, 0, 320, 240, 250},
+    {"ring12-axial", 1, 1, BENCH_BRUTE, 0, 1, BENCH_STILL, 0, 320, 240, 250},
+    {"grid4", 4, 0, BENCH_INSTANCED, 0, 1, BENCH_STILL, 0, 320, 240, 500},
+    {"grid16", 16, 0, BENCH_BVH, 8, 1, BENCH_STILL, 0, 640, 480, 2000},
+    {"ring12", 1, 0, BENCH_RASTER, 8, 1, BENCH_STILL, 0, 320, 240, 500},
+    {"ring12-axial", 1, 1, BENCH_RASTER, 0, 0, BENCH_STILL, 0, 320, 240, 250},
+    {"grid16", 16, 0, BENCH_RASTER, 8, 1, BENCH_STILL, 0, 640, 480, 2000},
+    {"grid4", 4, 0, BENCH_BVH, 0, 1, BENCH_WAVE, 0, 320, 240, 250},
+    {"grid4", 4, 0, BENCH_BVH, 0, 1, BENCH_SPIN, 0, 320, 240, 250},
+    {"ring12", 1, 0, BENCH_BVH, 0, 1, BENCH_STILL, 1, 320, 240, 250},
+    {"ring12-axial", 1, 1, BENCH_BVH, 0, 0, BENCH_STILL, 1, 320, 240, 250},
+};
+
+#define BENCH_CHECK_COUNT (sizeof(bench_checks) / sizeof(bench_checks[0]))
+
+/**
+ * Struct: BenchBaseline_t
+ * The fastest frame time recorded by --bless, and how many threads rendered it.
+ */
+typedef struct {
+    char name[128];
+    unsigned int threads;
+    double best_ms;
+} BenchBaseline_t;
+
+/**
+ * Function: BenchBaseline_load
+ * Reads the recorded times, as many as fit, into <opBaselines>. Returns how many there were,
+ * which is 0 if the file isn't there.
+ */
+static unsigned int BenchBaseline_load(BenchBaseline_t *const opBaselines, const unsigned int max, const char *const path)
+{
+    char line[256];
+    unsigned int count = 0;
+    FILE *const file = fopen(path, "r");
+
+    if(file == NULL) {
+        return 0;
+    }
+    while(count < max && fgets(line, sizeof(line), file) != NULL) {
+        BenchBaseline_t *const pBase = &(opBaselines[count]);
+        //Skips the header, and anything else that isn't a time.
+        if(sscanf(line, "%127[^,],%u,%lf", pBase->name, &(pBase->threads), &(pBase->best_ms)) == 3) {
+            count++;
+        }
+    }
+    fclose(file);
+    return count;
+}
+
+static bool BenchBaseline_save(const BenchBaseline_t *const baselines, const unsigned int count, const char *const path)
+{
+    unsigned int b;
+    FILE *const file = fopen(path, "w");
+
+    if(file == NULL) {
+        fprintf(stderr, "Can't open %s for writing: %s\n", path, strerror(errno));
+        return false;
+    }
+    fprintf(file, "name,threads,best_ms\n");
+    for(b=0; b<count; b++) {
+        fprintf(file, "%s,%u,%.6f\n", baselines[b].name, baselines[b].threads, baselines[b].best_ms);
+    }
+
+    const bool failed = (ferror(file) != 0);
+    if(fclose(file) != 0 || failed) {
+        fprintf(stderr, "Error writing %s.\n", path);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Function: BenchBaseline_find
+ * Finds the recorded time for a check, or returns NULL if there isn't one.
+ */
+static BenchBaseline_t * BenchBaseline_find(BenchBaseline_t *const baselines, const unsigned int count, const char *const name)
+{
+    unsigned int b;
+
+    for(b=0; b<count; b++) {
+        if(strcmp(baselines[b].name, name) == 0) {
+            return &(baselines[b]);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Function: Bench_compareImages
+ * Counts the pixels of <pImage> with a channel more than <tolerance> from <pGolden>, which
+ * must be the same size, and finds the furthest any channel is.
+ */
+static long Bench_compareImages(const Image_t *const pImage, const Image_t *const pGolden, const int tolerance, int *const opMaxDiff)
+{
+    int i, j, c;
+    long off = 0;
+
+    *opMaxDiff = 0;
+    for(j=0; j<pImage->height; j++) {
+        const uint8_t *const row = pImage->pixels + (j * pImage->rowstride);
+        const uint8_t *const golden = pGolden->pixels + (j * pGolden->rowstride);
+        for(i=0; i<pImage->width; i++) {
+            int pixel_diff = 0;
+            for(c=0; c<3; c++) {
+                const int diff = abs((int)(row[3*i + c]) - (int)(golden[3*i + c]));
+                if(diff > pixel_diff) {
+                    pixel_diff = diff;
+                }
+            }
+            if(pixel_diff > tolerance) {
+                off++;
+            }
+            if(pixel_diff > *opMaxDiff) {
+                *opMaxDiff = pixel_diff;
+            }
+        }
+    }
+    return off;
+}
+
+/**
+ * Function: Bench_fail
+ * Adds a reason a check failed to its result.
+ */
+static void Bench_fail(char *const result, const size_t size, const char *const reason)
+{
+    if(strcmp(result, "ok") == 0) {
+        result[0] = '\0';
+    }
+    snprintf(result + strlen(result), size - strlen(result), "%s%s", (result[0] == '\0') ? "" : "; ", reason);
+}
+
+/**
+ * Function: BenchCheck_move
+ * Moves the check scene's mesh for <BENCH_ANIM_FRAMES> frames, refitting its hierarchy after
+ * each as the animation benchmarks do, then builds <opRebuilt> from scratch over where it ends up.
+ */
+static Bvh_t * BenchCheck_move(BenchScene_t *const pScene, const BenchMotion_t motion, Bvh_t *const opRebuilt)
+{
+    unsigned int f, moved_count;
+    BvhRefit_t refitter;
+
+    Point_t *const orig = Util_cloneOrDie(pScene->mesh.positions, sizeof(Point_t) * pScene->mesh.vert_count, "Allocating check vertices.");
+    unsigned int *const moved = Util_allocOrDie(sizeof(unsigned int) * pScene->mesh.tri_count, "Allocating check moved triangles.");
+
+    BvhRefit_cfg(&refitter, &(pScene->bvh));
+    for(f=1; f<=BENCH_ANIM_FRAMES; f++) {
+        moved_count = BenchAnim_move(&(pScene->mesh), orig, motion, f, moved);
+        if(moved_count == pScene->mesh.tri_count) {
+            BvhRefit_all(&refitter);
+        }
+        else {
+            BvhRefit_moved(&refitter, moved, moved_count);
+        }
+    }
+    BvhRefit_destroy(&refitter);
+    free(moved);
+    free(orig);
+    return Bvh_cfg(opRebuilt, &(pScene->mesh));
+}
+
+/**
+ * Function: Bench_check
+ * Renders one reference scene, and checks it against its golden image and times, or records
+ * them with --bless. Returns false if it failed.
+ */
+static bool Bench_check(const BenchOpts_t *const pOpts, const BenchCheck_t *const pCheck, BenchBaseline_t *const baselines, unsigned int *const pBaselineCount)
+{
+    int r, max_diff = 0, rebuilt_diff = 0;
+    long off = 0;
+    double start, median_ms, best_ms;
+    char name[128];
+    char variant[32];
+    char path[4096];
+    char result[128];
+    size_t k;
+    BenchScene_t bench_scene;
+    Scene_t scene;
+    RayGen_t rays;
+    Light_t sun;
+    Image_t image, golden, rebuilt_image;
+    Bvh_t rebuilt;
+    BenchBaseline_t *pBase;
+    double *times;
+
+    const unsigned int threads = TilePool_threads(pOpts->threads);
+
+    Bench_variant(variant, sizeof(variant), pCheck->accel, pCheck->aa, pCheck->lit);
+    if(pCheck->motion != BENCH_STILL) {
+        snprintf(variant + strlen(variant), sizeof(variant) - strlen(variant), "+%s", (pCheck->motion == BENCH_WAVE) ? "wave" : "spin");
+    }
+    snprintf(name, sizeof(name), "check/%s/%s/%dx%d", pCheck->scene, variant, pCheck->width, pCheck->height);
+
+    //The golden image is named for the check, without the "check/", and with dashes for slashes.
+    // Cached rays have to give the same image as rays cast through the frame, so a check with
+    // them shares the golden image of the one without.
+    if(snprintf(path, sizeof(path), "%s/%s.ppm", pOpts->check_dir, name + strlen("check/")) >= (int)sizeof(path)) {
+        fprintf(stderr, "Golden image path in %s is too long.\n", pOpts->check_dir);
+        return false;
+    }
+    for(k=strlen(pOpts->check_dir) + 1; path[k] != '\0'; k++) {
+        if(path[k] == '/') {
+            path[k] = '-';
+        }
+    }
+    if(pCheck->cached) {
+        snprintf(name, sizeof(name), "check/%s/%s+rays/%dx%d", pCheck->scene, variant, pCheck->width, pCheck->height);
+    }
+    if(!Bench_selected(pOpts, name)) {
+        return true;
+    }
+    fprintf(stderr, "%s\n", name);
+
+    BenchScene_cfg(&bench_scene, pCheck->scene, pCheck->side);
+    if(pCheck->axial) {
+        Camera_cfg(&(bench_scene.cam), 1.0);
+        Camera_pitch(&(bench_scene.cam), rads(90));
+        Camera_march(&(bench_scene.cam), -5.0 * pCheck->side);
+    }
+    if(pCheck->motion != BENCH_STILL) {
+        BenchCheck_move(&bench_scene, pCheck->motion, &rebuilt);
+    }
+    BenchScene_scene(&bench_scene, &scene, pCheck->accel, pCheck->aa, pCheck->lit ? Bench_sun(&sun) : NULL, pOpts->threads, pCheck->width, pCheck->height);
+    if(pCheck->cached) {
+        //As in Bench_frame, the rays are worked out in the warm up frame, and reused after that.
+        scene.rays = RayGen_cfg(&rays);
+    }
+
+    times = Util_allocOrDie(sizeof(double) * pOpts->reps, "Allocating benchmark timings.");
+    Image_cfg(&image, pCheck->width, pCheck->height);
+    Render_scene(&scene, image.pixels, image.rowstride);
+    for(r=0; r<pOpts->reps; r++) {
+        start = Util_now();
+        Render_scene(&scene, image.pixels, image.rowstride);
+        times[r] = Util_now() - start;
+    }
+    median_ms = Bench_median(times, pOpts->reps) * 1e3;
+    //Bench_median sorted them, so the fastest is first.
+    best_ms = times[0] * 1e3;
+    pBase = BenchBaseline_find(baselines, *pBaselineCount, name);
+
+    snprintf(result, sizeof(result), "ok");
+    if(pOpts->bless) {
+        if(pBase == NULL && *pBaselineCount < BENCH_CHECK_COUNT) {
+            pBase = &(baselines[(*pBaselineCount)++]);
+            snprintf(pBase->name, sizeof(pBase->name), "%s", name);
+        }
+        if(pBase != NULL) {
+            pBase->threads = threads;
+            pBase->best_ms = best_ms;
+        }
+    }
+    //The golden image a check with cached rays shares is blessed by the check without them, and
+    // only checked against here.
+    if(pOpts->bless && !pCheck->cached) {
+        snprintf(result, sizeof(result), "%s", Image_writePpm(&image, path) ? "blessed" : "can't write golden image");
+    }
+    else if(!Image_readPpm(&golden, path)) {
+        Bench_fail(result, sizeof(result), "no golden image");
+    }
+    else {
+        if(golden.width != image.width || golden.height != image.height) {
+            Bench_fail(result, sizeof(result), "golden image is another size");
+        }
+        else {
+            off = Bench_compareImages(&image, &golden, pOpts->tolerance, &max_diff);
+            if(off > pOpts->max_off * image.width * image.height) {
+                Bench_fail(result, sizeof(result), "pixels differ");
+            }
+        }
+        Image_destroy(&golden);
+    }
+    if(pCheck->motion != BENCH_STILL) {
+        //A refit hierarchy has to find the same hits as one built over the moved mesh from scratch,
+        // blessing or not, so a golden image can't record a refitting bug.
+        scene.bvh = &rebuilt;
+        Image_cfg(&rebuilt_image, pCheck->width, pCheck->height);
+        Render_scene(&scene, rebuilt_image.pixels, rebuilt_image.rowstride);
+        if(Bench_compareImages(&image, &rebuilt_image, pOpts->tolerance, &rebuilt_diff) > pOpts->max_off * image.width * image.height) {
+            Bench_fail(result, sizeof(result), "differs from rebuilt hierarchy");
+        }
+        Image_destroy(&rebuilt_image);
+        Bvh_destroy(&rebuilt);
+    }
+    if(!pOpts->bless) {
+        if(median_ms > pCheck->budget_ms) {
+            Bench_fail(result, sizeof(result), "over budget");
+        }
+        if(pBase != NULL && pBase->threads == threads && best_ms > (pBase->best_ms * (1 + pOpts->slack)) + BENCH_CHECK_NOISE_MS) {
+            Bench_fail(result, sizeof(result), "slower than baseline");
+        }
+    }
+
+    printf("%s,%.3f,%.3f,%.0f,", name, median_ms, best_ms, pCheck->budget_ms);
+    if(pBase != NULL && pBase->threads == threads) {
+        printf("%.3f", pBase->best_ms);
+    }
+    printf(",%ld,%d,%s\n", off, max_diff, result);
+    fflush(stdout);
+
+    if(pCheck->cached) {
+        RayGen_destroy(&rays);
+    }
+    Image_destroy(&image);
+    free(times);
+    BenchScene_destroy(&bench_scene);
+    return strcmp(result, "ok") == 0 || strcmp(result, "blessed") == 0;
+}
+
+/**
+ * Function: Bench_makeDir
+ * Makes the check directory for --bless, and any directories it's in, unless they're already
+ * there. Returns false, having printed a message to stderr, if it can't.
+ */
+static bool Bench_makeDir(const char *const path)
+{
+    char dir[4096];
+    size_t k;
+    int made;
+
+    if(strlen(path) >= sizeof(dir)) {
+        fprintf(stderr, "Check directory %s is too long.\n", path);
+        return false;
+    }
+
+    //Make each directory on the way, then the last one. Only the last one failing counts, since
+    // ones on the way, like a drive, can fail to be made though they're there.
+    for(k=0; ; k++) {
+        if(k > 0 && (path[k] == '/' || path[k] == '\\' || path[k] == '\0')) {
+            memcpy(dir, path, k);
+            dir[k] = '\0';
+#ifdef _WIN32
+            made = _mkdir(dir);
+#else
+            made = mkdir(dir, 0777);
+#endif
+            if(made != 0 && errno != EEXIST && path[k] == '\0') {
+                fprintf(stderr, "Can't make %s: %s\n", dir, strerror(errno));
+                return false;
+            }
+        }
+        if(path[k] == '\0') {
+            return true;
+        }
+    }
+}
+
+/**
+ * Function: Bench_checkAll
+ * Runs every regression check, and then records the times if blessing. Returns how many failed.
+ */
+static unsigned int Bench_checkAll(const BenchOpts_t *const pOpts)
+{
+    unsigned int c, failed = 0;
+    unsigned int baseline_count;
+    char path[4096];
+    BenchBaseline_t baselines[BENCH_CHECK_COUNT];
+
+    if(snprintf(path, sizeof(path), "%s/%s", pOpts->check_dir, BENCH_CHECK_BASELINE) >= (int)sizeof(path)) {
+        fprintf(stderr, "Check directory %s is too long.\n", pOpts->check_dir);
+        return 1;
+    }
+    if(pOpts->bless && !Bench_makeDir(pOpts->check_dir)) {
+        return 1;
+    }
+    baseline_count = BenchBaseline_load(baselines, BENCH_CHECK_COUNT, path);
+
+    printf("name,median_ms,best_ms,budget_ms,baseline_ms,off_pixels,max_diff,result\n");
+    for(c=0; c<BENCH_CHECK_COUNT; c++) {
+        if(!Bench_check(pOpts, &(bench_checks[c]), baselines, &baseline_count)) {
+            failed++;
+        }
+    }
+
+    if(pOpts->bless && !BenchBaseline_save(baselines, baseline_count, path)) {
+        failed++;
+    }
+    if(failed > 0) {
+        fprintf(stderr, "Checks failed: %u.\n", failed);
+    }
+    return failed;
+}
+
+static void Bench_usage(FILE *const file, const char *const prog)
+{
+    fprintf(file,
+        "Usage: %s [options]\n"
+        "\n"
+        "  -r, --reps N          Timed repetitions of each benchmark (default 5).\n"
+        "  -t, --threads N       Render threads for frame benchmarks (default: one per CPU).\n"
+        "  -q, --quick           Skip the biggest scenes and resolutions.\n"
+        "  -f, --filter TEXT     Only run benchmarks whose name contains TEXT.\n"
+        "  -c, --check DIR       Run the regression checks against the golden images and\n"
+        "                        times in DIR, instead of the benchmarks.\n"
+        "  -b, --bless           With --check, write this build's images and times to DIR.\n"
+        "      --tolerance N     How far a channel can be from the golden image (default %d).\n"
+        "      --max-off F       Fraction of pixels that can be further (default %g).\n"
+        "      --slack F         Fraction a check's fastest time can be over the recorded\n"
+        "                        one (default %g).\n"
+        "  -h, --help            Show this message.\n",
+        prog, BENCH_CHECK_TOLERANCE, BENCH_CHECK_MAX_OFF, BENCH_CHECK_SLACK
+    );
+}
+
+int main(int argc, char **argv)
+{
+    int i;
+    unsigned int s, z;
+    BenchOpts_t opts;
+    BenchInputs_t *pInputs;
+    BenchScene_t scene;
+
+    static const struct {
+        const char *name;
+        unsigned int side;
+        int brute;
+        int big;
+    } scenes[] = {
+        {"ring12", 1, 1, 0},
+        {"grid4", 4, 1, 0},
+        {"grid16", 16, 0, 0},
+        {"grid64", 64, 0, 1},
+    };
+    static const struct {
+        int width;
+        int height;
+        int big;
+    } sizes[] = {
+        {200, 200, 0},
+        {640, 480, 0},
+        {1920, 1080, 1},
+    };
+
+    opts.reps = 5;
+    opts.threads = 0;
+    opts.quick = 0;
+    opts.filter = NULL;
+    opts.check_dir = NULL;
+    opts.bless = 0;
+    opts.tolerance = BENCH_CHECK_TOLERANCE;
+    opts.max_off = BENCH_CHECK_MAX_OFF;
+    opts.slack = BENCH_CHECK_SLACK;
+    for(i=1; i<argc; i++) {
+        if(strcmp(argv[i], "-q") == 0 || strcmp(argv[i], "--quick") == 0) {
+            opts.quick = 1;
+        }
+        else if((strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "--reps") == 0) && i+1 < argc) {
+            opts.reps = atoi(argv[++i]);
+        }
+        else if((strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--threads") == 0) && i+1 < argc) {
+            opts.threads = (unsigned int)atoi(argv[++i]);
+        }
+        else if((strcmp(argv[i], "-f") == 0 || strcmp(argv[i], "--filter") == 0) && i+1 < argc) {
+            opts.filter = argv[++i];
+        }
+        else if((strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--check") == 0) && i+1 < argc) {
+            opts.check_dir = argv[++i];
+        }
+        else if(strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "--bless") == 0) {
+            opts.bless = 1;
+        }
+        else if(strcmp(argv[i], "--tolerance") == 0 && i+1 < argc) {
+            opts.tolerance = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--max-off") == 0 && i+1 < argc) {
+            opts.max_off = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--slack") == 0 && i+1 < argc) {
+            opts.slack = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            Bench_usage(stdout, argv[0]);
+            return 0;
+        }
+        else {
+            Bench_usage(stderr, argv[0]);
+            return 1;
+        }
+    }
+    if(opts.reps < 1) {
+        opts.reps = 1;
+    }
+    if(opts.bless && opts.check_dir == NULL) {
+        Bench_usage(stderr, argv[0]);
+        return 1;
+    }
+    if(opts.check_dir != NULL) {
+        return (Bench_checkAll(&opts) > 0) ? 1 : 0;
+    }
+
+    //Same inputs every run, so runs are comparable.
+    srand(12345);
+
+    printf("name,reps,threads,ops,median_ms,min_ms,max_ms,ns_per_op,ops_per_sec,ns_per_test\n");
+
+    pInputs = Util_allocOrDie(sizeof(BenchInputs_t), "Allocating benchmark inputs.");
+    BenchInputs_cfg(pInputs);
+    Bench_micro(&opts, "micro/Triangle_rayCast", BenchMicro_rayCast, pInputs);
+    Bench_micro(&opts, "micro/Mesh_rayCast", BenchMicro_meshRayCast, pInputs);
+    Bench_micro(&opts, "micro/TriBlock_intersect", BenchMicro_triBlock, pInputs);
+    Bench_micro(&opts, "micro/Triangle_barycentricPosition", BenchMicro_barycentric, pInputs);
+    Bench_micro(&opts, "micro/Quat_rotateVect", BenchMicro_quatRotate, pInputs);
+    Bench_micro(&opts, "micro/Xform_points", BenchMicro_xformPoints, pInputs);
+    Bench_micro(&opts, "micro/Vect_cross+Vect_dot", BenchMicro_crossDot, pInputs);
+    Mesh_destroy(&(pInputs->mesh));
+    free(pInputs);
+
+    for(s=0; s<sizeof(scenes)/sizeof(scenes[0]); s++) {
+        if(opts.quick && scenes[s].big) {
+            continue;
+        }
+        BenchScene_cfg(&scene, scenes[s].name, scenes[s].side);
+        for(z=0; z<sizeof(sizes)/sizeof(sizes[0]); z++) {
+            if(opts.quick && sizes[z].big) {
+                continue;
+            }
+            Bench_frame(&opts, &scene, BENCH_BVH, 0, 0, sizes[z].width, sizes[z].height);
+            Bench_frame(&opts, &scene, BENCH_BVH, 8, 0, sizes[z].width, sizes[z].height);
+            Bench_frame(&opts, &scene, BENCH_BVH, 0, 1, sizes[z].width, sizes[z].height);
+            Bench_frame(&opts, &scene, BENCH_INSTANCED, 0, 0, sizes[z].width, sizes[z].height);
+            Bench_frame(&opts, &scene, BENCH_RASTER, 0, 0, sizes[z].width, sizes[z].height);
+            Bench_frame(&opts, &scene, BENCH_RASTER, 0, 1, sizes[z].width, sizes[z].height);
+            Bench_shade(&opts, &scene, sizes[z].width, sizes[z].height);
+            if(scenes[s].brute) {
+                Bench_frame(&opts, &scene, BENCH_BRUTE, 0, 0, sizes[z].width, sizes[z].height);
+            }
+        }
+        Bench_anim(&opts, &scene, BENCH_WAVE, 1);
+        Bench_anim(&opts, &scene, BENCH_WAVE, 0);
+        Bench_anim(&opts, &scene, BENCH_SPIN, 1);
+        Bench_anim(&opts, &scene, BENCH_SPIN, 0);
+        BenchScene_destroy(&scene);
+    }
+
+    Bench_load(&opts, opts.quick ? 256 : 1024, 0);
+    Bench_load(&opts, opts.quick ? 256 : 1024, 1);
+
+    return 0;
+}
+
@@ -0,0 +1,118 @@
+/**
+ * File: aabb.c
+ *
+ */
+#include "aabb.h"
+
+#include <math.h>
+#include <stdbool.h>
+
+#include "point.h"
+#include "vect.h"
+
+/**
+ * Constants: AABB_PAD_REL, AABB_PAD_ABS
+ * How much <Aabb_pad> grows a box by: relative to its coordinates, and absolutely. Floats
+ * round far more coarsely than doubles, so they need a lot more.
+ */
+#ifdef RT_FLOAT
+#define AABB_PAD_REL 1e-5f
+#define AABB_PAD_ABS 1e-8f
+#else
+#define AABB_PAD_REL 1e-9
+#define AABB_PAD_ABS 1e-12
+#endif
+
+Aabb_t * Aabb_cfgEmpty(Aabb_t *const pThis)
+{
+    Point_cfg(&(pThis->min), INFINITY, INFINITY, INFINITY);
+    Point_cfg(&(pThis->max), -INFINITY, -INFINITY, -INFINITY);
+    return pThis;
+}
+
+Aabb_t * Aabb_copy(Aabb_t *const pThis, const Aabb_t *const pRhs)
+{
+    Point_copy(&(pThis->min), &(pRhs->min));
+    Point_copy(&(pThis->max), &(pRhs->max));
+    return pThis;
+}
+
+Aabb_t * Aabb_addPoint(Aabb_t *const pThis, const Point_t *const pPt)
+{
+    Point_cfg(&(pThis->min), fmin(pThis->min.x, pPt->x), fmin(pThis->min.y, pPt->y), fmin(pThis->min.z, pPt->z));
+    Point_cfg(&(pThis->max), fmax(pThis->max.x, pPt->x), fmax(pThis->max.y, pPt->y), fmax(pThis->max.z, pPt->z));
+    return pThis;
+}
+
+Aabb_t * Aabb_union(Aabb_t *const opBox, const Aabb_t *const pA, const Aabb_t *const pB)
+{
+    Point_cfg(&(opBox->min), fmin(pA->min.x, pB->min.x), fmin(pA->min.y, pB->min.y), fmin(pA->min.z, pB->min.z));
+    Point_cfg(&(opBox->max), fmax(pA->max.x, pB->max.x), fmax(pA->max.y, pB->max.y), fmax(pA->max.z, pB->max.z));
+    return opBox;
+}
+
+Point_t * Aabb_center(const Aabb_t *const pThis, Point_t *const opCenter)
+{
+    return Point_cfg(opCenter,
+        0.5 * (pThis->min.x + pThis->max.x),
+        0.5 * (pThis->min.y + pThis->max.y),
+        0.5 * (pThis->min.z + pThis->max.z)
+    );
+}
+
+double Aabb_surfaceArea(const Aabb_t *const pThis)
+{
+    const double dx = pThis->max.x - pThis->min.x;
+    const double dy = pThis->max.y - pThis->min.y;
+    const double dz = pThis->max.z - pThis->min.z;
+
+    if(dx < 0 || dy < 0 || dz < 0) {
+        return 0;
+    }
+    return 2.0 * ((dx*dy) + (dy*dz) + (dz*dx));
+}
+
+Aabb_t * Aabb_pad(Aabb_t *const pThis)
+{
+    Vect_t pad;
+
+    //Relative to the size of the box and its distance from the origin, so it survives rounding
+    // at any scale, plus a tiny absolute amount for boxes that are flat and sit at the origin.
+    Vect_cfg(&pad,
+        AABB_PAD_REL * (Real_fabs(pThis->min.x) + Real_fabs(pThis->max.x)) + AABB_PAD_ABS,
+        AABB_PAD_REL * (Real_fabs(pThis->min.y) + Real_fabs(pThis->max.y)) + AABB_PAD_ABS,
+        AABB_PAD_REL * (Real_fabs(pThis->min.z) + Real_fabs(pThis->max.z)) + AABB_PAD_ABS
+    );
+    Point_translateBack(&(pThis->min), &(pThis->min), &pad);
+    Point_translate(&(pThis->max), &(pThis->max), &pad);
+    return pThis;
+}
+
+bool Aabb_rayClip(const Aabb_t *const pThis, const Point_t *const pt, const Vect_t *const pInvVect, const Real_t closest_dist, Real_t *const opNear)
+{
+    Real_t near = 0;
+    Real_t far = closest_dist;
+    Real_t t1, t2, tmp;
+
+    //One slab per axis. When the ray is parallel to an axis, the reciprocal is infinite and
+    // the products are either infinite (ray is outside the slab) or NaN (ray sits exactly on a
+    // face). The comparisons below are written so a NaN never narrows the interval.
+#define AABB_SLAB(AXIS) \
+    t1 = (pThis->min.AXIS - pt->AXIS) * pInvVect->AXIS; \
+    t2 = (pThis->max.AXIS - pt->AXIS) * pInvVect->AXIS; \
+    if(t1 > t2) { tmp = t1; t1 = t2; t2 = tmp; } \
+    if(t1 > near) { near = t1; } \
+    if(t2 < far) { far = t2; }
+
+    AABB_SLAB(x)
+    AABB_SLAB(y)
+    AABB_SLAB(z)
+#undef AABB_SLAB
+
+    if(near > far) {
+        return false;
+    }
+    *opNear = near;
+    return true;
+}
+
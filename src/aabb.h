@@ -0,0 +1,83 @@
+/**
+ * File: aabb.h
+ *
+ * Axis-aligned bounding boxes, used by the acceleration structures to cull
+ * groups of triangles that a ray can't possibly hit.
+ */
+#ifndef AABB_H
+#define AABB_H
+
+#include <stdbool.h>
+
+#include "point.h"
+#include "vect.h"
+
+/**
+ * Struct: Aabb_t
+ * An axis-aligned box described by its minimum and maximum corners.
+ * A box whose <min> is greater than its <max> on any axis is empty.
+ */
+typedef struct {
+    Point_t min;
+    Point_t max;
+} Aabb_t;
+
+/**
+ * Function: Aabb_cfgEmpty
+ * Configures the box to be empty, so that adding any point to it gives
+ * a box containing just that point.
+ */
+Aabb_t * Aabb_cfgEmpty(Aabb_t *pThis);
+
+Aabb_t * Aabb_copy(Aabb_t *pThis, const Aabb_t *pRhs);
+
+/**
+ * Function: Aabb_addPoint
+ * Grows the box just enough to contain the given point.
+ */
+Aabb_t * Aabb_addPoint(Aabb_t *pThis, const Point_t *pPt);
+
+/**
+ * Function: Aabb_union
+ * Configures <opBox> as the smallest box containing both of the given boxes.
+ * Any of the pointers may point to the same object.
+ */
+Aabb_t * Aabb_union(Aabb_t *opBox, const Aabb_t *pA, const Aabb_t *pB);
+
+/**
+ * Function: Aabb_center
+ * Gets the point at the center of the box.
+ */
+Point_t * Aabb_center(const Aabb_t *pThis, Point_t *opCenter);
+
+/**
+ * Function: Aabb_surfaceArea
+ * Returns the total area of the six faces of the box, or 0 for an empty box.
+ */
+double Aabb_surfaceArea(const Aabb_t *pThis);
+
+/**
+ * Function: Aabb_pad
+ * Grows the box on every side by a small amount relative to its size. Used to
+ * make sure points computed with rounding error on a flat triangle still fall
+ * inside its box.
+ */
+Aabb_t * Aabb_pad(Aabb_t *pThis);
+
+/**
+ * Function: Aabb_rayClip
+ *
+ * Clips a ray against the box with the slab method.
+ *
+ * The ray is the parametric line pt + t*vect, and is given here by its start point and the
+ * component-wise reciprocal of its direction vector (which the caller computes once per ray).
+ * Distances are measured in the same units of t as <Triangle_rayCast>.
+ *
+ * Returns true if some part of the ray with t in [0, <closest_dist>] is inside the box,
+ * in which case the entry distance is stored in <opNear>.
+ */
+bool Aabb_rayClip(const Aabb_t *pThis, const Point_t *pt, const Vect_t *pInvVect, Real_t closest_dist, Real_t *opNear);
+
+#endif
+//end inclusion filter
+
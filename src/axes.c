@@ -41,7 +41,18 @@ Axes_t * Axes_clone(const Axes_t *const pRhs)
     return Util_cloneOrDie(pRhs, sizeof(Axes_t), "Cloning a Axes_t object.");
 }
 
-Axes_t * Axes_scale(Axes_t *const pThis, const double scale)
+Axes_t * Axes_inArena(Arena_t *const pArena)
+{
+    Axes_t *const pThis = Arena_alloc(pArena, sizeof(Axes_t), "Allocating a Axes_t object in an arena.");
+    return Axes_cfg(pThis);
+}
+
+Axes_t * Axes_cloneInArena(Arena_t *const pArena, const Axes_t *const pRhs)
+{
+    return Arena_clone(pArena, pRhs, sizeof(Axes_t), "Cloning a Axes_t object into an arena.");
+}
+
+Axes_t * Axes_scale(Axes_t *const pThis, const Real_t scale)
 {
     Vect_scale(&(pThis->x), &(pThis->x), scale);
     Vect_scale(&(pThis->y), &(pThis->y), scale);
@@ -50,7 +61,7 @@ Axes_t * Axes_scale(Axes_t *const pThis, const double scale)
 }
 
 
-Axes_t * Axes_yaw(Axes_t *const pThis, const double rads)
+Axes_t * Axes_yaw(Axes_t *const pThis, const Real_t rads)
 {
     Quat_t rot;
     Quat_rotation(&rot, &(pThis->y), rads);
@@ -59,7 +70,7 @@ Axes_t * Axes_yaw(Axes_t *const pThis, const double rads)
     return pThis;
 }
 
-Axes_t * Axes_pitch(Axes_t *const pThis, const double rads)
+Axes_t * Axes_pitch(Axes_t *const pThis, const Real_t rads)
 {
     Quat_t rot;
     Quat_rotation(&rot, &(pThis->x), rads);
@@ -68,7 +79,7 @@ Axes_t * Axes_pitch(Axes_t *const pThis, const double rads)
     return pThis;
 }
 
-Axes_t * Axes_roll(Axes_t *const pThis, const double rads)
+Axes_t * Axes_roll(Axes_t *const pThis, const Real_t rads)
 {
     Quat_t rot;
     Quat_rotation(&rot, &(pThis->z), rads);
@@ -77,7 +88,7 @@ Axes_t * Axes_roll(Axes_t *const pThis, const double rads)
     return pThis;
 }
 
-Axes_t * Axes_march(Axes_t *const pThis, const double dist)
+Axes_t * Axes_march(Axes_t *const pThis, const Real_t dist)
 {
     Vect_t disp;
     Vect_scale(&disp, &(pThis->z), dist);
@@ -85,7 +96,7 @@ Axes_t * Axes_march(Axes_t *const pThis, const double dist)
     return pThis;
 }
 
-Axes_t * Axes_strafe(Axes_t *const pThis, const double dist)
+Axes_t * Axes_strafe(Axes_t *const pThis, const Real_t dist)
 {
     Vect_t disp;
     Vect_scale(&disp, &(pThis->x), dist);
@@ -93,7 +104,7 @@ Axes_t * Axes_strafe(Axes_t *const pThis, const double dist)
     return pThis;
 }
 
-Axes_t * Axes_climb(Axes_t *const pThis, const double dist)
+Axes_t * Axes_climb(Axes_t *const pThis, const Real_t dist)
 {
     Vect_t disp;
     Vect_scale(&disp, &(pThis->y), dist);
@@ -12,6 +12,7 @@
 #include "vect.h"
 #include "point.h"
 #include "quat.h"
+#include "util.h"
 
 typedef struct {
     Vect_t x;
@@ -28,45 +29,49 @@ Axes_t * Axes_copy(Axes_t *pThis, const Axes_t *const pRhs);
 
 Axes_t * Axes_clone(const Axes_t *const pRhs);
 
+Axes_t * Axes_inArena(Arena_t *pArena);
+
+Axes_t * Axes_cloneInArena(Arena_t *pArena, const Axes_t *pRhs);
+
 //TODO: Add Axes_rotate, to rotate around arbitrary axes. Probably a local vector?
 
 /**
  * Function: Axes_yaw
  * Rotates the axes around it's Y-axis.
  */
-Axes_t * Axes_yaw(Axes_t *const pThis, const double rads);
+Axes_t * Axes_yaw(Axes_t *const pThis, const Real_t rads);
 
 /**
  * Function: Axes_pitch
  * Rotates the axes around it's X-axis.
  */
-Axes_t * Axes_pitch(Axes_t *const pThis, const double rads);
+Axes_t * Axes_pitch(Axes_t *const pThis, const Real_t rads);
 
 /**
  * Function: Axes_roll
  * Rotates the axes around it's Z-axis.
  */
-Axes_t * Axes_roll(Axes_t *const pThis, const double rads);
+Axes_t * Axes_roll(Axes_t *const pThis, const Real_t rads);
 
-Axes_t * Axes_scale(Axes_t *const pThis, const double scale);
+Axes_t * Axes_scale(Axes_t *const pThis, const Real_t scale);
 
 /**
  * Function: Axes_march
  * Translates the axes along it's Z-axis.
  */
-Axes_t * Axes_march(Axes_t *const pThis, const double dist);
+Axes_t * Axes_march(Axes_t *const pThis, const Real_t dist);
 
 /**
  * Function: Axes_strafe
  * Translates the axes along it's X-axis.
  */
-Axes_t * Axes_strafe(Axes_t *const pThis, const double dist);
+Axes_t * Axes_strafe(Axes_t *const pThis, const Real_t dist);
 
 /**
  * Function: Axes_climb
  * Translates the axes along it's Y-axis.
  */
-Axes_t * Axes_climb(Axes_t *const pThis, const double dist);
+Axes_t * Axes_climb(Axes_t *const pThis, const Real_t dist);
 
 
 /**
@@ -0,0 +1,999 @@
+/**
+ * File: bvh.c
+ *
+ */
+#include "bvh.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aabb.h"
+#include "mesh.h"
+#include "triblock.h"
+#include "raypacket.h"
+#include "raystats.h"
+#include "util.h"
+
+/**
+ * Constant: BVH_BINS
+ * Number of buckets centroids are sorted into along each axis when looking for the
+ * cheapest split.
+ */
+#define BVH_BINS 16
+
+/**
+ * Constant: BVH_MAX_LEAF
+ * Nodes with more triangles than this are always split, whatever the SAH says.
+ */
+#define BVH_MAX_LEAF 8
+
+/**
+ * Constant: BVH_TRAVERSAL_COST
+ * Cost of visiting a node, relative to testing one block of triangles.
+ */
+#define BVH_TRAVERSAL_COST 1.0
+
+/**
+ * Struct: BvhBuild_t
+ * Scratch state used while building the tree.
+ */
+typedef struct {
+    BvhNode_t *nodes;
+    unsigned int node_count;
+
+    //Bounds and centroid of each item, by index.
+    const Aabb_t *bounds;
+    Point_t *centroids;
+
+    //Item indices, partitioned in place as the tree is built.
+    unsigned int *order;
+
+    //How many items a leaf tests for the price of one; see Bvh_buildNodes.
+    unsigned int group;
+} BvhBuild_t;
+
+typedef struct {
+    Aabb_t bounds;
+    unsigned int count;
+} BvhBin_t;
+
+static double Bvh_axis(const Point_t *const pPt, const int axis)
+{
+    switch(axis) {
+        case 0: return pPt->x;
+        case 1: return pPt->y;
+        default: return pPt->z;
+    }
+}
+
+/**
+ * Function: Bvh_blocksFor
+ * How many blocks it takes to hold the given number of triangles. Testing a block costs
+ * the same however many lanes are in use, so this is what the SAH counts.
+ */
+static unsigned int Bvh_blocksFor(const unsigned int count)
+{
+    return (count + TRIBLOCK_WIDTH - 1) / TRIBLOCK_WIDTH;
+}
+
+/**
+ * Function: Bvh_costOf
+ * What the SAH counts for testing the given number of items in a leaf.
+ */
+static unsigned int Bvh_costOf(const BvhBuild_t *const pBuild, const unsigned int count)
+{
+    return (count + pBuild->group - 1) / pBuild->group;
+}
+
+static int Bvh_binOf(const double c, const double lo, const double scale)
+{
+    const int bin = (int)((c - lo) * scale);
+    if(bin < 0) {
+        return 0;
+    }
+    if(bin >= BVH_BINS) {
+        return BVH_BINS - 1;
+    }
+    return bin;
+}
+
+static void Bvh_buildNode(BvhBuild_t *const pBuild, const unsigned int node, const unsigned int begin, const unsigned int end, const unsigned int depth)
+{
+    unsigned int i, b, mid;
+    int axis;
+    Aabb_t cbox;
+    BvhBin_t bins[BVH_BINS];
+    Aabb_t left_box, right_box;
+    double left_area[BVH_BINS];
+    unsigned int left_count[BVH_BINS];
+    unsigned int right_count;
+    double cost;
+    double best_cost;
+    int best_axis = -1;
+    int best_split = 0;
+
+    BvhNode_t *const pNode = &(pBuild->nodes[node]);
+    const unsigned int count = end - begin;
+
+    //Bound the items, and separately their centroids (which is what we split on).
+    Aabb_cfgEmpty(&(pNode->bounds));
+    Aabb_cfgEmpty(&cbox);
+    for(i=begin; i<end; i++) {
+        Aabb_union(&(pNode->bounds), &(pNode->bounds), &(pBuild->bounds[pBuild->order[i]]));
+        Aabb_addPoint(&cbox, &(pBuild->centroids[pBuild->order[i]]));
+    }
+
+    pNode->start = begin;
+    pNode->count = count;
+    pNode->block = 0;
+    if(count <= 1 || depth >= BVH_MAX_DEPTH) {
+        return;
+    }
+
+    //Making this a leaf costs one test per block; that's what a split has to beat.
+    const double parent_area = Aabb_surfaceArea(&(pNode->bounds));
+    best_cost = (double)Bvh_costOf(pBuild, count);
+
+    for(axis=0; axis<3; axis++) {
+        const double lo = Bvh_axis(&(cbox.min), axis);
+        const double hi = Bvh_axis(&(cbox.max), axis);
+        if(!(hi > lo)) {
+            continue;
+        }
+        const double scale = BVH_BINS / (hi - lo);
+
+        for(b=0; b<BVH_BINS; b++) {
+            Aabb_cfgEmpty(&(bins[b].bounds));
+            bins[b].count = 0;
+        }
+        for(i=begin; i<end; i++) {
+            b = Bvh_binOf(Bvh_axis(&(pBuild->centroids[pBuild->order[i]]), axis), lo, scale);
+            Aabb_union(&(bins[b].bounds), &(bins[b].bounds), &(pBuild->bounds[pBuild->order[i]]));
+            bins[b].count++;
+        }
+
+        //Sweep from the left to get the area and count on the left of each split plane...
+        Aabb_cfgEmpty(&left_box);
+        for(b=0; b<BVH_BINS-1; b++) {
+            Aabb_union(&left_box, &left_box, &(bins[b].bounds));
+            left_area[b] = Aabb_surfaceArea(&left_box);
+            left_count[b] = (b > 0 ? left_count[b-1] : 0) + bins[b].count;
+        }
+
+        //...then from the right, costing each split on the way.
+        Aabb_cfgEmpty(&right_box);
+        right_count = 0;
+        for(b=BVH_BINS-1; b>0; b--) {
+            Aabb_union(&right_box, &right_box, &(bins[b].bounds));
+            right_count += bins[b].count;
+            if(right_count == 0 || left_count[b-1] == 0) {
+                continue;
+            }
+            cost = BVH_TRAVERSAL_COST + ((left_area[b-1]*Bvh_costOf(pBuild, left_count[b-1])) + (Aabb_surfaceArea(&right_box)*Bvh_costOf(pBuild, right_count))) / parent_area;
+            if(cost < best_cost) {
+                best_cost = cost;
+                best_axis = axis;
+                best_split = b-1;
+            }
+        }
+    }
+
+    if(best_axis < 0) {
+        if(count <= BVH_MAX_LEAF) {
+            //Cheaper as a leaf.
+            return;
+        }
+
+        //Either the centroids are all in the same place or no split paid off, but this is
+        // too many to leave in one leaf, so just cut the list in half.
+        mid = begin + (count / 2);
+    }
+    else {
+        //Partition the items so everything in bins up to the split comes first.
+        const double lo = Bvh_axis(&(cbox.min), best_axis);
+        const double scale = BVH_BINS / (Bvh_axis(&(cbox.max), best_axis) - lo);
+        unsigned int tmp;
+        unsigned int j = end;
+
+        i = begin;
+        while(i < j) {
+            if(Bvh_binOf(Bvh_axis(&(pBuild->centroids[pBuild->order[i]]), best_axis), lo, scale) <= best_split) {
+                i++;
+            }
+            else {
+                j--;
+                tmp = pBuild->order[i];
+                pBuild->order[i] = pBuild->order[j];
+                pBuild->order[j] = tmp;
+            }
+        }
+        mid = i;
+    }
+
+    //First child directly follows this node, second child comes after the whole first subtree.
+    pNode->count = 0;
+    Bvh_buildNode(pBuild, pBuild->node_count++, begin, mid, depth+1);
+    pNode->start = pBuild->node_count++;
+    Bvh_buildNode(pBuild, pNode->start, mid, end, depth+1);
+}
+
+/**
+ * Function: Bvh_buildFrom
+ * Like <Bvh_buildNodes>, for a tree whose root will be <depth> levels down another tree, so
+ * the whole thing keeps to <BVH_MAX_DEPTH>.
+ */
+static unsigned int Bvh_buildFrom(BvhNode_t *const opNodes, unsigned int *const opOrder, const Aabb_t *const bounds, const unsigned int count, const unsigned int group, const unsigned int depth)
+{
+    unsigned int i;
+    BvhBuild_t build;
+
+    if(count == 0) {
+        return 0;
+    }
+
+    build.nodes = opNodes;
+    build.node_count = 0;
+    build.bounds = bounds;
+    build.centroids = Util_allocOrDie(sizeof(Point_t) * count, "Allocating BVH build centroids.");
+    build.order = opOrder;
+    build.group = group;
+
+    for(i=0; i<count; i++) {
+        Aabb_center(&(bounds[i]), &(build.centroids[i]));
+        build.order[i] = i;
+    }
+
+    Bvh_buildNode(&build, build.node_count++, 0, count, depth);
+
+    free(build.centroids);
+    return build.node_count;
+}
+
+unsigned int Bvh_buildNodes(BvhNode_t *const opNodes, unsigned int *const opOrder, const Aabb_t *const bounds, const unsigned int count, const unsigned int group)
+{
+    return Bvh_buildFrom(opNodes, opOrder, bounds, count, group, 0);
+}
+
+/**
+ * Function: Bvh_triBounds
+ * Bounds one triangle of the mesh, padded as for the build.
+ */
+static Aabb_t * Bvh_triBounds(const Mesh_t *const pMesh, const unsigned int tri, Aabb_t *const opBox)
+{
+    unsigned int v;
+
+    Aabb_cfgEmpty(opBox);
+    for(v=0; v<3; v++) {
+        Aabb_addPoint(opBox, Mesh_vertex(pMesh, tri, v));
+    }
+    return Aabb_pad(opBox);
+}
+
+/**
+ * Function: Bvh_packLeaf
+ * Packs a leaf's triangles, as they are now in the mesh, into its blocks.
+ */
+static void Bvh_packLeaf(Bvh_t *const pThis, const BvhNode_t *const pNode)
+{
+    unsigned int v;
+
+    for(v=0; v<pNode->count; v++) {
+        TriBlock_t *const pBlock = &(pThis->blocks[pNode->block + (v / TRIBLOCK_WIDTH)]);
+        if(v % TRIBLOCK_WIDTH == 0) {
+            TriBlock_cfgEmpty(pBlock);
+        }
+        const unsigned int index = pThis->order[pNode->start + v];
+        const MeshTri_t *const pTri = &(pThis->mesh->tris[index]);
+        TriBlock_setLaneEdges(pBlock, v % TRIBLOCK_WIDTH, Mesh_vertex(pThis->mesh, index, 0), &(pTri->edge1), &(pTri->edge2), index);
+    }
+}
+
+Bvh_t * Bvh_cfg(Bvh_t *const pThis, const Mesh_t *const pMesh)
+{
+    unsigned int i;
+    const unsigned int count = pMesh->tri_count;
+    Aabb_t *bounds;
+
+    pThis->mesh = pMesh;
+    pThis->prim_count = count;
+    pThis->node_count = 0;
+    pThis->block_count = 0;
+    pThis->nodes = Util_allocOrDie(sizeof(BvhNode_t) * (count > 0 ? (2*count - 1) : 1), "Allocating BVH nodes.");
+    pThis->order = Util_allocOrDie(sizeof(unsigned int) * (count > 0 ? count : 1), "Allocating BVH triangle order.");
+
+    //Every leaf wastes less than one block, and there are at most as many leaves as triangles.
+    pThis->blocks = Util_allocOrDie(sizeof(TriBlock_t) * (count > 0 ? (2*count) : 1), "Allocating BVH triangle blocks.");
+
+    if(count == 0) {
+        return pThis;
+    }
+
+    bounds = Util_allocOrDie(sizeof(Aabb_t) * count, "Allocating BVH build bounds.");
+    for(i=0; i<count; i++) {
+        Bvh_triBounds(pMesh, i, &(bounds[i]));
+    }
+
+    pThis->node_count = Bvh_buildNodes(pThis->nodes, pThis->order, bounds, count, TRIBLOCK_WIDTH);
+
+    //Pack each leaf's triangles into blocks.
+    for(i=0; i<pThis->node_count; i++) {
+        BvhNode_t *const pNode = &(pThis->nodes[i]);
+        if(pNode->count == 0) {
+            continue;
+        }
+        pNode->block = pThis->block_count;
+        Bvh_packLeaf(pThis, pNode);
+        pThis->block_count += Bvh_blocksFor(pNode->count);
+    }
+
+    free(bounds);
+
+    return pThis;
+}
+
+Bvh_t * Bvh(const Mesh_t *const pMesh)
+{
+    Bvh_t *pThis = Util_allocOrDie(sizeof(Bvh_t), "Allocating new Bvh_t object.");
+    if(pThis != NULL) {
+        Bvh_cfg(pThis, pMesh);
+    }
+    return pThis;
+}
+
+void Bvh_destroy(Bvh_t *const pThis)
+{
+    free(pThis->nodes);
+    free(pThis->order);
+    free(pThis->blocks);
+    pThis->nodes = NULL;
+    pThis->mesh = NULL;
+    pThis->order = NULL;
+    pThis->blocks = NULL;
+    pThis->node_count = 0;
+    pThis->prim_count = 0;
+    pThis->block_count = 0;
+}
+
+double Bvh_rayHit(const Bvh_t *const pThis, TriHit_t *const opHit, const double closest_dist, const Point_t *const pt, const Vect_t *const vect)
+{
+    unsigned int stack[BVH_MAX_DEPTH + 2];
+    Real_t stack_near[BVH_MAX_DEPTH + 2];
+    unsigned int top = 0;
+    unsigned int b, blocks;
+    Real_t near, near_a, near_b;
+    bool hit_a, hit_b;
+    Vect_t inv;
+    TriHit_t hit;
+
+    opHit->id = TRIBLOCK_EMPTY;
+    opHit->instance = 0;
+    if(pThis->node_count == 0) {
+        return closest_dist;
+    }
+
+    //The blocks accept hits at exactly the current distance (so earlier triangles can win ties
+    // against later ones), but a triangle exactly at the caller's distance must not count. So
+    // start from the largest Real_t that is less than it.
+    hit.dist = (Real_t)closest_dist;
+    if(hit.dist >= closest_dist) {
+        hit.dist = Real_nextafter(hit.dist, -INFINITY);
+    }
+    hit.id = TRIBLOCK_EMPTY;
+    hit.instance = 0;
+
+    //Reciprocal of the direction, shared by every box test.
+    Vect_cfg(&inv, 1 / vect->x, 1 / vect->y, 1 / vect->z);
+
+    if(!Aabb_rayClip(&(pThis->nodes[0].bounds), pt, &inv, hit.dist, &near)) {
+        return closest_dist;
+    }
+    stack[top] = 0;
+    stack_near[top] = near;
+    top++;
+
+    while(top > 0) {
+        top--;
+
+        //Something closer may have been found since this node was pushed.
+        if(stack_near[top] > hit.dist) {
+            continue;
+        }
+        const BvhNode_t *const pNode = &(pThis->nodes[stack[top]]);
+        RAYSTATS_ADD(RAYSTATS_NODES, 1);
+
+        if(pNode->count > 0) {
+            blocks = Bvh_blocksFor(pNode->count);
+            for(b=pNode->block; b<pNode->block + blocks; b++) {
+                TriBlock_intersect(&(pThis->blocks[b]), pt, vect, &hit);
+            }
+            continue;
+        }
+
+        //Interior node: visit the nearer child first by pushing it last.
+        const unsigned int a = stack[top] + 1;
+        const unsigned int c = pNode->start;
+        hit_a = Aabb_rayClip(&(pThis->nodes[a].bounds), pt, &inv, hit.dist, &near_a);
+        hit_b = Aabb_rayClip(&(pThis->nodes[c].bounds), pt, &inv, hit.dist, &near_b);
+
+        if(hit_a && hit_b) {
+            if(near_a <= near_b) {
+                stack[top] = c; stack_near[top] = near_b; top++;
+                stack[top] = a; stack_near[top] = near_a; top++;
+            }
+            else {
+                stack[top] = a; stack_near[top] = near_a; top++;
+                stack[top] = c; stack_near[top] = near_b; top++;
+            }
+        }
+        else if(hit_a) {
+            stack[top] = a; stack_near[top] = near_a; top++;
+        }
+        else if(hit_b) {
+            stack[top] = c; stack_near[top] = near_b; top++;
+        }
+    }
+
+    if(hit.id == TRIBLOCK_EMPTY) {
+        return closest_dist;
+    }
+    *opHit = hit;
+    return hit.dist;
+}
+
+double Bvh_rayCast(const Bvh_t *const pThis, Color_t *const opColor, const double closest_dist, const Point_t *const pt, const Vect_t *const vect)
+{
+    TriHit_t hit;
+
+    const double dist = Bvh_rayHit(pThis, &hit, closest_dist, pt, vect);
+    if(hit.id == TRIBLOCK_EMPTY) {
+        return closest_dist;
+    }
+
+    //Only now that we know which triangle is closest do we bother with its color.
+    Mesh_getBaryColor(pThis->mesh, hit.id, opColor, &(hit.bary));
+    return dist;
+}
+
+/**
+ * Function: Bvh_packetCullsBlock
+ * Whether every triangle in the block is outside the packet's frustum.
+ */
+static bool Bvh_packetCullsBlock(const Bvh_t *const pThis, const RayPacket_t *const pPacket, const TriBlock_t *const pBlock)
+{
+    unsigned int lane;
+
+    for(lane=0; lane<TRIBLOCK_WIDTH; lane++) {
+        const unsigned int id = pBlock->id[lane];
+        if(id == TRIBLOCK_EMPTY) {
+            continue;
+        }
+        if(!RayPacket_cullsTriangle(pPacket, Mesh_vertex(pThis->mesh, id, 0), Mesh_vertex(pThis->mesh, id, 1), Mesh_vertex(pThis->mesh, id, 2))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Function: Bvh_packetDepth
+ * How far along the middle of the packet's frustum the center of a node's box is, for
+ * visiting nodes roughly front to back.
+ */
+static double Bvh_packetDepth(const RayPacket_t *const pPacket, const BvhNode_t *const pNode)
+{
+    Point_t center;
+    Vect_t disp;
+
+    Aabb_center(&(pNode->bounds), &center);
+    Point_displacement(&disp, &(pPacket->eye), &center);
+    return Vect_dot(&disp, &(pPacket->center));
+}
+
+void Bvh_packetHit(const Bvh_t *const pThis, RayPacket_t *const pPacket)
+{
+    unsigned int stack[BVH_MAX_DEPTH + 2];
+    unsigned int stack_first[BVH_MAX_DEPTH + 2];
+    unsigned int top = 0;
+    unsigned int active[RAYPACKET_MAX];
+    unsigned int active_count;
+    unsigned int first, r, i, b, blocks;
+    Real_t near;
+
+    if(pThis->node_count == 0 || pPacket->count == 0) {
+        return;
+    }
+
+    //Each entry is a node along with the first ray that might still hit anything under it.
+    // Rays before that one missed the box of the node or of one of its ancestors.
+    stack[top] = 0;
+    stack_first[top] = 0;
+    top++;
+
+    while(top > 0) {
+        top--;
+        const BvhNode_t *const pNode = &(pThis->nodes[stack[top]]);
+        const unsigned int node = stack[top];
+
+        if(RayPacket_cullsBox(pPacket, &(pNode->bounds))) {
+            continue;
+        }
+
+        //Rays get closer hits as the walk goes on, so the box test uses each one's current best.
+        for(first=stack_first[top]; first<pPacket->count; first++) {
+            if(Aabb_rayClip(&(pNode->bounds), &(pPacket->origins[first]), &(pPacket->invs[first]), pPacket->hits[first].dist, &near)) {
+                break;
+            }
+        }
+        if(first == pPacket->count) {
+            continue;
+        }
+
+        if(pNode->count > 0) {
+            //Only the rays that actually hit the leaf's box are tested against its triangles.
+            active_count = 0;
+            active[active_count++] = first;
+            for(r=first+1; r<pPacket->count; r++) {
+                if(Aabb_rayClip(&(pNode->bounds), &(pPacket->origins[r]), &(pPacket->invs[r]), pPacket->hits[r].dist, &near)) {
+                    active[active_count++] = r;
+                }
+            }
+
+#ifdef RT_STATS
+            for(i=0; i<active_count; i++) {
+                RAYSTATS_ADD_TO(&(pPacket->stats[active[i]]), RAYSTATS_NODES, 1);
+            }
+#endif
+
+            blocks = Bvh_blocksFor(pNode->count);
+            for(b=pNode->block; b<pNode->block + blocks; b++) {
+                if(Bvh_packetCullsBlock(pThis, pPacket, &(pThis->blocks[b]))) {
+                    continue;
+                }
+                for(i=0; i<active_count; i++) {
+                    r = active[i];
+                    RAYSTATS_TARGET(&(pPacket->stats[r]));
+                    TriBlock_intersect(&(pThis->blocks[b]), &(pPacket->origins[r]), &(pPacket->dirs[r]), &(pPacket->hits[r]));
+                }
+            }
+            continue;
+        }
+
+        //Every ray from the first that hit the box is carried down into the children.
+#ifdef RT_STATS
+        for(r=first; r<pPacket->count; r++) {
+            RAYSTATS_ADD_TO(&(pPacket->stats[r]), RAYSTATS_NODES, 1);
+        }
+#endif
+
+        //Interior node: visit the nearer child first by pushing it last. The order only affects
+        // how soon rays find their closest hits, never which hits they find.
+        const unsigned int a = node + 1;
+        const unsigned int c = pNode->start;
+        if(Bvh_packetDepth(pPacket, &(pThis->nodes[a])) <= Bvh_packetDepth(pPacket, &(pThis->nodes[c]))) {
+            stack[top] = c; stack_first[top] = first; top++;
+            stack[top] = a; stack_first[top] = first; top++;
+        }
+        else {
+            stack[top] = a; stack_first[top] = first; top++;
+            stack[top] = c; stack_first[top] = first; top++;
+        }
+    }
+    RAYSTATS_TARGET(NULL);
+}
+
+bool Bvh_occluded(const Bvh_t *const pThis, const Point_t *const pt, const Vect_t *const vect, const double max_dist)
+{
+    unsigned int stack[BVH_MAX_DEPTH + 2];
+    unsigned int top = 0;
+    unsigned int b, blocks;
+    Real_t near;
+    Vect_t inv;
+    TriHit_t hit;
+
+    if(pThis->node_count == 0) {
+        return false;
+    }
+
+    //Anything strictly closer than max_dist counts, as in Bvh_rayHit.
+    hit.dist = (Real_t)max_dist;
+    if(hit.dist >= max_dist) {
+        hit.dist = Real_nextafter(hit.dist, -INFINITY);
+    }
+    hit.id = TRIBLOCK_EMPTY;
+
+    Vect_cfg(&inv, 1 / vect->x, 1 / vect->y, 1 / vect->z);
+
+    stack[top++] = 0;
+    while(top > 0) {
+        const unsigned int node = stack[--top];
+        const BvhNode_t *const pNode = &(pThis->nodes[node]);
+
+        //The distance never shrinks here, so boxes are only clipped when they're popped.
+        if(!Aabb_rayClip(&(pNode->bounds), pt, &inv, hit.dist, &near)) {
+            continue;
+        }
+        RAYSTATS_ADD(RAYSTATS_NODES, 1);
+
+        if(pNode->count > 0) {
+            blocks = Bvh_blocksFor(pNode->count);
+            for(b=pNode->block; b<pNode->block + blocks; b++) {
+                if(TriBlock_intersect(&(pThis->blocks[b]), pt, vect, &hit)) {
+                    return true;
+                }
+            }
+            continue;
+        }
+
+        stack[top++] = pNode->start;
+        stack[top++] = node + 1;
+    }
+    return false;
+}
+
+//// Refitting ////
+
+/**
+ * Function: BvhRefit_nodeCost
+ * The SAH cost of a node's subtree, from its box and its children's costs.
+ */
+static double BvhRefit_nodeCost(const BvhRefit_t *const pThis, const unsigned int node)
+{
+    const BvhNode_t *const pNode = &(pThis->bvh->nodes[node]);
+    const double area = Aabb_surfaceArea(&(pNode->bounds));
+
+    if(pNode->count > 0) {
+        return area * Bvh_blocksFor(pNode->count);
+    }
+    return (area * BVH_TRAVERSAL_COST) + pThis->costs[node + 1] + pThis->costs[pNode->start];
+}
+
+/**
+ * Function: BvhRefit_ratio
+ * How many times its cost when it was built the cost of a node's subtree is now.
+ */
+static double BvhRefit_ratio(const BvhRefit_t *const pThis, const unsigned int node)
+{
+    const double area = Aabb_surfaceArea(&(pThis->bvh->nodes[node].bounds));
+
+    if(!(area > 0) || !(pThis->built_costs[node] > 0)) {
+        return 1.0;
+    }
+    return (pThis->costs[node] / area) / pThis->built_costs[node];
+}
+
+/**
+ * Function: BvhRefit_link
+ * Works out the parents, leaves, and costs for the subtree under a node that's just been
+ * built, and takes its costs as what it cost when built.
+ */
+static void BvhRefit_link(BvhRefit_t *const pThis, const unsigned int node)
+{
+    unsigned int v;
+    const BvhNode_t *const pNode = &(pThis->bvh->nodes[node]);
+
+    if(pNode->count > 0) {
+        for(v=0; v<pNode->count; v++) {
+            pThis->leaves[pThis->bvh->order[pNode->start + v]] = node;
+        }
+    }
+    else {
+        pThis->parents[node + 1] = node;
+        pThis->parents[pNode->start] = node;
+        BvhRefit_link(pThis, node + 1);
+        BvhRefit_link(pThis, pNode->start);
+    }
+
+    const double area = Aabb_surfaceArea(&(pNode->bounds));
+    pThis->costs[node] = BvhRefit_nodeCost(pThis, node);
+    pThis->built_costs[node] = (area > 0) ? pThis->costs[node] / area : 0;
+    pThis->touched[node] = 0;
+}
+
+/**
+ * Function: BvhRefit_fitLeaf
+ * Packs a leaf's triangles again, and fits its box to them.
+ */
+static void BvhRefit_fitLeaf(BvhRefit_t *const pThis, const unsigned int node)
+{
+    unsigned int v;
+    Aabb_t box;
+    BvhNode_t *const pNode = &(pThis->bvh->nodes[node]);
+
+    Aabb_cfgEmpty(&(pNode->bounds));
+    for(v=0; v<pNode->count; v++) {
+        Bvh_triBounds(pThis->bvh->mesh, pThis->bvh->order[pNode->start + v], &box);
+        Aabb_union(&(pNode->bounds), &(pNode->bounds), &box);
+    }
+    Bvh_packLeaf(pThis->bvh, pNode);
+    pThis->costs[node] = BvhRefit_nodeCost(pThis, node);
+}
+
+/**
+ * Function: BvhRefit_fitNode
+ * Fits an interior node's box to its children's.
+ */
+static void BvhRefit_fitNode(BvhRefit_t *const pThis, const unsigned int node)
+{
+    BvhNode_t *const pNode = &(pThis->bvh->nodes[node]);
+
+    Aabb_union(&(pNode->bounds), &(pThis->bvh->nodes[node + 1].bounds), &(pThis->bvh->nodes[pNode->start].bounds));
+    pThis->costs[node] = BvhRefit_nodeCost(pThis, node);
+}
+
+/**
+ * Function: BvhRefit_fitUp
+ * Fits every ancestor of a node, from its parent up to the root.
+ */
+static void BvhRefit_fitUp(BvhRefit_t *const pThis, unsigned int node)
+{
+    while(node != 0) {
+        node = pThis->parents[node];
+        BvhRefit_fitNode(pThis, node);
+        pThis->touched[node] = pThis->update;
+    }
+}
+
+/**
+ * Function: BvhRefit_fitAll
+ * Fits every node of a subtree, children before parents.
+ */
+static void BvhRefit_fitAll(BvhRefit_t *const pThis, const unsigned int node)
+{
+    const BvhNode_t *const pNode = &(pThis->bvh->nodes[node]);
+
+    pThis->touched[node] = pThis->update;
+    if(pNode->count > 0) {
+        BvhRefit_fitLeaf(pThis, node);
+        return;
+    }
+    BvhRefit_fitAll(pThis, node + 1);
+    BvhRefit_fitAll(pThis, pNode->start);
+    BvhRefit_fitNode(pThis, node);
+}
+
+/**
+ * Function: BvhRefit_place
+ *
+ * Copies node <k> of a subtree just built by <Bvh_buildFrom>, with everything under it, into
+ * the hierarchy at <dst>, as the refitter lays it out (see <BvhRefit_cfg>). <lo> is the
+ * position in the subtree's order of its first triangle, and <begin> where the subtree's
+ * triangles start in <Bvh_t.order>.
+ */
+static void BvhRefit_place(BvhRefit_t *const pThis, const BvhNode_t *const built, const unsigned int k, const unsigned int dst, const unsigned int lo, const unsigned int begin)
+{
+    unsigned int mid;
+    BvhNode_t *const pNode = &(pThis->bvh->nodes[dst]);
+
+    *pNode = built[k];
+    if(pNode->count > 0) {
+        pNode->start += begin;
+        pNode->block = 2 * pNode->start;
+        Bvh_packLeaf(pThis->bvh, pNode);
+        return;
+    }
+
+    //The second child's triangles start at its leftmost leaf's, and it goes after all the
+    // room the first child's triangles get.
+    mid = built[k].start;
+    while(built[mid].count == 0) {
+        mid++;
+    }
+    mid = built[mid].start;
+    pNode->start = dst + (2 * (mid - lo));
+    BvhRefit_place(pThis, built, k + 1, dst + 1, lo, begin);
+    BvhRefit_place(pThis, built, built[k].start, pNode->start, mid, begin);
+}
+
+/**
+ * Function: BvhRefit_count
+ * Adds up the nodes and blocks in the subtree under a node.
+ */
+static void BvhRefit_count(const BvhRefit_t *const pThis, const unsigned int node, unsigned int *const pNodes, unsigned int *const pBlocks)
+{
+    const BvhNode_t *const pNode = &(pThis->bvh->nodes[node]);
+
+    (*pNodes)++;
+    if(pNode->count > 0) {
+        *pBlocks += Bvh_blocksFor(pNode->count);
+        return;
+    }
+    BvhRefit_count(pThis, node + 1, pNodes, pBlocks);
+    BvhRefit_count(pThis, pNode->start, pNodes, pBlocks);
+}
+
+/**
+ * Function: BvhRefit_rebuild
+ * Builds the subtree under a node again, over the same triangles, in the same room.
+ */
+static void BvhRefit_rebuild(BvhRefit_t *const pThis, const unsigned int node)
+{
+    Bvh_t *const pBvh = pThis->bvh;
+    unsigned int first = node, last = node, n, depth = 0, k;
+    unsigned int old_nodes = 0, old_blocks = 0, new_nodes = 0, new_blocks = 0;
+    BvhNode_t *built;
+    Aabb_t *bounds;
+    unsigned int *order, *items;
+
+    //The subtree's triangles start at its leftmost leaf, and end with its rightmost.
+    while(pBvh->nodes[first].count == 0) {
+        first++;
+    }
+    while(pBvh->nodes[last].count == 0) {
+        last = pBvh->nodes[last].start;
+    }
+    const unsigned int begin = pBvh->nodes[first].start;
+    const unsigned int count = pBvh->nodes[last].start + pBvh->nodes[last].count - begin;
+
+    for(n=node; n!=0; n=pThis->parents[n]) {
+        depth++;
+    }
+
+    bounds = Util_allocOrDie(sizeof(Aabb_t) * count, "Allocating BVH rebuild bounds.");
+    built = Util_allocOrDie(sizeof(BvhNode_t) * ((2 * count) - 1), "Allocating BVH rebuild nodes.");
+    order = Util_allocOrDie(sizeof(unsigned int) * count, "Allocating BVH rebuild order.");
+    items = Util_cloneOrDie(pBvh->order + begin, sizeof(unsigned int) * count, "Allocating BVH rebuild triangles.");
+    for(k=0; k<count; k++) {
+        Bvh_triBounds(pBvh->mesh, items[k], &(bounds[k]));
+    }
+    Bvh_buildFrom(built, order, bounds, count, TRIBLOCK_WIDTH, depth);
+
+    for(k=0; k<count; k++) {
+        pBvh->order[begin + k] = items[order[k]];
+    }
+    //The new subtree can have a different number of leaves, so keep the counts in use right.
+    BvhRefit_count(pThis, node, &old_nodes, &old_blocks);
+    BvhRefit_place(pThis, built, 0, node, 0, begin);
+    BvhRefit_count(pThis, node, &new_nodes, &new_blocks);
+    pBvh->node_count = pBvh->node_count - old_nodes + new_nodes;
+    pBvh->block_count = pBvh->block_count - old_blocks + new_blocks;
+    BvhRefit_link(pThis, node);
+    BvhRefit_fitUp(pThis, node);
+    pThis->rebuilds++;
+    pThis->rebuilt += count;
+
+    free(items);
+    free(order);
+    free(built);
+    free(bounds);
+}
+
+/**
+ * Function: BvhRefit_find
+ *
+ * Looks through the nodes under <node> that this update fitted for the highest one that's got
+ * too costly. From there, it goes down into whichever child has got too costly while the
+ * other hasn't, so as to rebuild as little as it can.
+ *
+ * Returns false if there's nothing to rebuild.
+ */
+static bool BvhRefit_find(const BvhRefit_t *const pThis, unsigned int node, unsigned int *const opNode)
+{
+    const BvhNode_t *const nodes = pThis->bvh->nodes;
+
+    if(pThis->touched[node] != pThis->update) {
+        return false;
+    }
+    if(BvhRefit_ratio(pThis, node) > BVH_REFIT_DEGRADE) {
+        while(nodes[node].count == 0) {
+            const bool worse_a = BvhRefit_ratio(pThis, node + 1) > BVH_REFIT_DEGRADE;
+            const bool worse_b = BvhRefit_ratio(pThis, nodes[node].start) > BVH_REFIT_DEGRADE;
+            if(worse_a == worse_b) {
+                break;
+            }
+            node = worse_a ? node + 1 : nodes[node].start;
+        }
+        *opNode = node;
+        return true;
+    }
+    if(nodes[node].count > 0) {
+        return false;
+    }
+    return BvhRefit_find(pThis, node + 1, opNode) || BvhRefit_find(pThis, nodes[node].start, opNode);
+}
+
+/**
+ * Function: BvhRefit_check
+ * Rebuilds whatever's got too costly, each subtree found by <BvhRefit_find> in turn. A rebuilt
+ * subtree is as good as new, and isn't looked through again, so this ends at the latest once
+ * the root has been rebuilt.
+ */
+static void BvhRefit_check(BvhRefit_t *const pThis)
+{
+    unsigned int node;
+
+    while(BvhRefit_find(pThis, 0, &node)) {
+        BvhRefit_rebuild(pThis, node);
+    }
+}
+
+/**
+ * Function: BvhRefit_begin
+ * Starts an update.
+ */
+static void BvhRefit_begin(BvhRefit_t *const pThis)
+{
+    pThis->rebuilds = 0;
+    pThis->rebuilt = 0;
+
+    //After four billion updates, start again, rather than mistake old marks for new.
+    pThis->update++;
+    if(pThis->update == 0) {
+        memset(pThis->touched, 0, sizeof(unsigned int) * pThis->node_capacity);
+        pThis->update = 1;
+    }
+}
+
+BvhRefit_t * BvhRefit_cfg(BvhRefit_t *const pThis, Bvh_t *const pBvh)
+{
+    const unsigned int capacity = (pBvh->prim_count > 0) ? (2 * pBvh->prim_count) - 1 : 1;
+
+    pThis->bvh = pBvh;
+    pThis->node_capacity = capacity;
+    pThis->block_capacity = (pBvh->prim_count > 0) ? 2 * pBvh->prim_count : 1;
+    pThis->parents = Util_allocOrDie(sizeof(unsigned int) * capacity, "Allocating BVH refit parents.");
+    pThis->leaves = Util_allocOrDie(sizeof(unsigned int) * (pBvh->prim_count > 0 ? pBvh->prim_count : 1), "Allocating BVH refit leaves.");
+    pThis->costs = Util_allocOrDie(sizeof(double) * capacity, "Allocating BVH refit costs.");
+    pThis->built_costs = Util_allocOrDie(sizeof(double) * capacity, "Allocating BVH refit costs.");
+    pThis->touched = Util_allocOrDie(sizeof(unsigned int) * capacity, "Allocating BVH refit marks.");
+    memset(pThis->touched, 0, sizeof(unsigned int) * capacity);
+    pThis->update = 0;
+
+    //Lay the tree out again with room for rebuilding any subtree in place.
+    if(pBvh->node_count > 0) {
+        pThis->parents[0] = 0;
+        BvhRefit_rebuild(pThis, 0);
+    }
+    pThis->rebuilds = 0;
+    pThis->rebuilt = 0;
+    return pThis;
+}
+
+void BvhRefit_destroy(BvhRefit_t *const pThis)
+{
+    free(pThis->parents);
+    free(pThis->leaves);
+    free(pThis->costs);
+    free(pThis->built_costs);
+    free(pThis->touched);
+    pThis->parents = NULL;
+    pThis->leaves = NULL;
+    pThis->costs = NULL;
+    pThis->built_costs = NULL;
+    pThis->touched = NULL;
+    pThis->bvh = NULL;
+    pThis->node_capacity = 0;
+    pThis->block_capacity = 0;
+}
+
+void BvhRefit_moved(BvhRefit_t *const pThis, const unsigned int *const tris, const unsigned int count)
+{
+    unsigned int i;
+
+    BvhRefit_begin(pThis);
+    if(pThis->bvh->node_count == 0) {
+        return;
+    }
+
+    for(i=0; i<count; i++) {
+        const unsigned int leaf = pThis->leaves[tris[i]];
+        if(pThis->touched[leaf] == pThis->update) {
+            continue;
+        }
+        pThis->touched[leaf] = pThis->update;
+        BvhRefit_fitLeaf(pThis, leaf);
+        BvhRefit_fitUp(pThis, leaf);
+    }
+    BvhRefit_check(pThis);
+}
+
+void BvhRefit_all(BvhRefit_t *const pThis)
+{
+    BvhRefit_begin(pThis);
+    if(pThis->bvh->node_count == 0) {
+        return;
+    }
+
+    BvhRefit_fitAll(pThis, 0);
+    BvhRefit_check(pThis);
+}
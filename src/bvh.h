@@ -0,0 +1,307 @@
+/**
+ * File: bvh.h
+ *
+ * A bounding volume hierarchy over the triangles of a <Mesh_t>, so that casting a ray
+ * only tests the triangles in boxes the ray actually passes through, instead of
+ * every triangle in the scene.
+ */
+#ifndef BVH_H
+#define BVH_H
+
+#include "aabb.h"
+#include "mesh.h"
+#include "triblock.h"
+#include "raypacket.h"
+#include "color.h"
+#include "point.h"
+#include "vect.h"
+
+/**
+ * Constant: BVH_MAX_DEPTH
+ * The builder never makes a tree deeper than this, which bounds the size of the
+ * traversal stack.
+ */
+#define BVH_MAX_DEPTH 48
+
+/**
+ * Struct: BvhNode_t
+ * A single node in the hierarchy. Nodes are stored depth first, so the first child of an
+ * interior node always immediately follows it in the node array.
+ */
+typedef struct {
+    /**
+     * Field: bounds
+     * Box containing every triangle under this node.
+     */
+    Aabb_t bounds;
+
+    /**
+     * Field: start
+     * For a leaf, the index of its first triangle in <Bvh_t.order>. For an interior
+     * node, the index of its second child.
+     */
+    unsigned int start;
+
+    /**
+     * Field: count
+     * The number of triangles in a leaf, or 0 for an interior node.
+     */
+    unsigned int count;
+
+    /**
+     * Field: block
+     * For a leaf, the index of its first block in <Bvh_t.blocks>. The leaf's triangles are
+     * packed into that block and as many after it as they need.
+     */
+    unsigned int block;
+} BvhNode_t;
+
+/**
+ * Struct: Bvh_t
+ * The hierarchy itself. The mesh is not copied, only a pointer to it, so it needs
+ * to outlive the hierarchy.
+ */
+typedef struct {
+    BvhNode_t *nodes;
+    unsigned int node_count;
+
+    /**
+     * Field: mesh
+     * The mesh the hierarchy was built over.
+     */
+    const Mesh_t *mesh;
+    unsigned int prim_count;
+
+    /**
+     * Field: order
+     * Triangle indices in <mesh>, reordered so each leaf's triangles are contiguous.
+     */
+    unsigned int *order;
+
+    /**
+     * Field: blocks
+     * Each leaf's triangles packed for SIMD testing. The id of each lane is the
+     * triangle's index in <mesh>.
+     */
+    TriBlock_t *blocks;
+    unsigned int block_count;
+} Bvh_t;
+
+/**
+ * Function: Bvh_cfg
+ * Builds the hierarchy over every triangle in a mesh, splitting nodes according to the
+ * surface area heuristic (SAH).
+ *
+ * Aborts the program if there is not enough memory.
+ */
+Bvh_t * Bvh_cfg(Bvh_t *pThis, const Mesh_t *pMesh);
+
+/**
+ * Function: Bvh_buildNodes
+ *
+ * Builds just the nodes of a hierarchy, with the same SAH splits as <Bvh_cfg>, over any
+ * <count> items given by their boxes. This is how <Bvh_cfg> builds over triangles, and how
+ * <InstanceBvh_cfg> builds over instances.
+ *
+ * Testing up to <group> items in a leaf is costed the same as testing one, as when triangles
+ * are tested a <TriBlock_t> at a time; use 1 where each item is tested on its own.
+ *
+ * <opNodes> needs room for 2*<count> - 1 nodes, and <opOrder> for <count> indices. Each
+ * leaf's <BvhNode_t.start> and <BvhNode_t.count> are the range of <opOrder> holding its
+ * items' indices. <BvhNode_t.block> is left 0.
+ *
+ * Returns the number of nodes built.
+ */
+unsigned int Bvh_buildNodes(BvhNode_t *opNodes, unsigned int *opOrder, const Aabb_t *bounds, unsigned int count, unsigned int group);
+
+/**
+ * Function: Bvh
+ * Dynamically allocates a new <Bvh_t> object and builds it with <Bvh_cfg>.
+ *
+ * Aborts the program if there is not enough memory.
+ */
+Bvh_t * Bvh(const Mesh_t *pMesh);
+
+/**
+ * Function: Bvh_destroy
+ * Frees the memory allocated by <Bvh_cfg>. The object itself is not freed.
+ */
+void Bvh_destroy(Bvh_t *pThis);
+
+/**
+ * Function: Bvh_rayCast
+ *
+ * Casts a single ray into every triangle in the hierarchy. This has exactly the same
+ * contract as <Triangle_rayCast>, and when two triangles are hit at the same distance
+ * the one earlier in the mesh wins, just as with a linear scan of the mesh.
+ *
+ * Nodes are visited front to back, and any node whose box starts beyond the closest
+ * hit found so far is skipped. Triangles in a leaf are tested a block at a time with
+ * <TriBlock_intersect>, and the color is only worked out for the final closest hit.
+ *
+ * The blocks do exactly the same arithmetic as <Mesh_rayCast>, so the result is exactly
+ * what a linear scan of the mesh would give.
+ */
+double Bvh_rayCast(const Bvh_t *pThis, Color_t *opColor, double closest_dist, const Point_t *pt, const Vect_t *vect);
+
+/**
+ * Function: Bvh_rayHit
+ *
+ * Finds the same closest hit as <Bvh_rayCast>, but instead of working out its color, fills in
+ * <opHit> with the triangle's index in the mesh, the distance, and the barycentric coordinates,
+ * which is all that's needed to color it later. If nothing is hit closer than <closest_dist>,
+ * the id is <TRIBLOCK_EMPTY>.
+ *
+ * Returns the distance to the hit, or <closest_dist> if there isn't one.
+ */
+double Bvh_rayHit(const Bvh_t *pThis, TriHit_t *opHit, double closest_dist, const Point_t *pt, const Vect_t *vect);
+
+/**
+ * Function: Bvh_packetHit
+ *
+ * Finds the closest hit for every ray in the packet, updating <RayPacket_t.hits>, with exactly
+ * the same results as calling <Bvh_rayHit> on each ray with a <closest_dist> of <INFINITY>.
+ *
+ * The packet walks the tree as a whole. A node is skipped for all of its rays at once if it's
+ * outside the packet's frustum, or if none of the rays still to be considered there hits its
+ * box. Otherwise only the rays from the first one that hits the box onward go further down,
+ * and in a leaf, each block of triangles is checked against the frustum before any of the
+ * rays are tested against it.
+ */
+void Bvh_packetHit(const Bvh_t *pThis, RayPacket_t *pPacket);
+
+/**
+ * Function: Bvh_occluded
+ *
+ * Whether the ray hits any triangle at all closer than <max_dist>, for shadow rays and the
+ * like that only need to know whether something is in the way, not what.
+ *
+ * Unlike <Bvh_rayHit>, this stops at the first hit it finds, and doesn't bother visiting
+ * nodes front to back.
+ */
+bool Bvh_occluded(const Bvh_t *pThis, const Point_t *pt, const Vect_t *vect, double max_dist);
+
+/**
+ * Constant: BVH_REFIT_DEGRADE
+ * How many times its SAH cost when it was built a subtree's cost can grow to, as its
+ * triangles move, before <BvhRefit_t> rebuilds it.
+ */
+#define BVH_REFIT_DEGRADE 1.5
+
+/**
+ * Struct: BvhRefit_t
+ *
+ * Keeps a <Bvh_t> up to date as its mesh's vertices move, for animated geometry, without
+ * building it again from scratch every frame.
+ *
+ * Each moved triangle's leaf is packed again, and the boxes above it are grown or shrunk to
+ * fit, which costs a walk to the root for each leaf touched, not a whole new build. The
+ * tree keeps its shape, so as triangles move further from where it was built, its boxes get
+ * bigger and overlap more, and rays visit more of them. To catch that, the SAH cost of every
+ * subtree is kept up to date as well, relative to its box's area, and once a subtree's cost
+ * has grown past <BVH_REFIT_DEGRADE> times what it was when it was built, just that subtree is
+ * built again.
+ * A mesh moved rigidly never needs rebuilding: its boxes keep their size.
+ *
+ * Whatever shape the tree is in, rays find exactly the same hits as in a <Bvh_cfg> built from
+ * scratch over the moved mesh; only how long they take changes.
+ *
+ * Instances of the mesh (see <Instance_t>) don't know their bounds have changed, so they need
+ * configuring again after it moves.
+ */
+typedef struct {
+    /**
+     * Field: bvh
+     * The hierarchy kept up to date. It's not copied, so it needs to outlive this.
+     */
+    Bvh_t *bvh;
+
+    /**
+     * Fields: node_capacity, block_capacity
+     * How many nodes and blocks the hierarchy has room for, all of which the refitter's layout
+     * can use. <Bvh_t.node_count> and <Bvh_t.block_count> stay how many are in use.
+     */
+    unsigned int node_capacity;
+    unsigned int block_capacity;
+
+    /**
+     * Fields: parents, leaves
+     * The parent of each node (the root's is itself), and the leaf each triangle of the mesh
+     * is in. A node's first child is the one right after it, as in the <Bvh_t>.
+     */
+    unsigned int *parents;
+    unsigned int *leaves;
+
+    /**
+     * Fields: costs, built_costs
+     * The SAH cost of each node's subtree, as the sum over its nodes of their boxes' areas
+     * times what visiting them costs, and what that was, divided by the node's area, when the
+     * subtree was last built.
+     */
+    double *costs;
+    double *built_costs;
+
+    /**
+     * Field: touched
+     * For each node, the last update that fitted it, so leaves aren't packed twice, and only
+     * what's been fitted is checked for having got too costly.
+     */
+    unsigned int *touched;
+    unsigned int update;
+
+    /**
+     * Fields: rebuilds, rebuilt
+     * For the last update: how many subtrees were built again, and how many triangles they
+     * held in all.
+     */
+    unsigned int rebuilds;
+    unsigned int rebuilt;
+} BvhRefit_t;
+
+/**
+ * Function: BvhRefit_cfg
+ *
+ * Configures a refitter for the hierarchy <pBvh>, which has just been built with <Bvh_cfg>.
+ *
+ * The hierarchy is built again, laid out with room for rebuilding any subtree in place: a
+ * subtree over <count> triangles gets 2*<count> - 1 nodes, the most it could ever need, and
+ * each leaf's blocks start at twice where its triangles start in <Bvh_t.order>. That's the
+ * same memory <Bvh_cfg> allocates, with the nodes and blocks spread out through it, so the
+ * ones in use are no longer all at the front.
+ *
+ * Aborts the program if there is not enough memory.
+ */
+BvhRefit_t * BvhRefit_cfg(BvhRefit_t *pThis, Bvh_t *pBvh);
+
+/**
+ * Function: BvhRefit_destroy
+ * Frees the memory allocated by <BvhRefit_cfg>. The object itself is not freed, nor is the
+ * hierarchy.
+ */
+void BvhRefit_destroy(BvhRefit_t *pThis);
+
+/**
+ * Function: BvhRefit_moved
+ *
+ * Updates the hierarchy for the <count> triangles in <tris> (indices in the mesh) having
+ * moved, rebuilding any subtree that's got too costly. The moved triangles' <MeshTri_t> need
+ * recomputing first, with <Mesh_recomputeTri>. Every triangle that uses a moved vertex has
+ * moved, and they can be listed more than once.
+ *
+ * Aborts the program if there is not enough memory for a rebuild.
+ */
+void BvhRefit_moved(BvhRefit_t *pThis, const unsigned int *tris, unsigned int count);
+
+/**
+ * Function: BvhRefit_all
+ * Updates the hierarchy for every triangle of the mesh having moved, as after
+ * <Mesh_recompute>, as <BvhRefit_moved> does, but a node at a time rather than a leaf at a
+ * time.
+ *
+ * Aborts the program if there is not enough memory for a rebuild.
+ */
+void BvhRefit_all(BvhRefit_t *pThis);
+
+#endif
+//end inclusion filter
+
@@ -6,7 +6,7 @@
 
 #include "axes.h"
 
-Camera_t * Camera_cfg(Camera_t *const pThis, double frame_dist)
+Camera_t * Camera_cfg(Camera_t *const pThis, Real_t frame_dist)
 {
     Axes_cfg(&(pThis->axes));
     pThis->frame_dist = frame_dist;
@@ -40,43 +40,43 @@ Vect_t * Camera_getUp(const Camera_t *const pThis, Vect_t *opUp)
     return opUp;
 }
 
-Camera_t * Camera_scale(Camera_t *const pThis, const double scale)
+Camera_t * Camera_scale(Camera_t *const pThis, const Real_t scale)
 {
     Axes_scale(&(pThis->axes), scale);
     return pThis;
 }
 
-Camera_t * Camera_yaw(Camera_t *const pThis, const double rads)
+Camera_t * Camera_yaw(Camera_t *const pThis, const Real_t rads)
 {
     Axes_yaw(&(pThis->axes), rads);
     return pThis;
 }
 
-Camera_t * Camera_pitch(Camera_t *const pThis, const double rads)
+Camera_t * Camera_pitch(Camera_t *const pThis, const Real_t rads)
 {
     Axes_pitch(&(pThis->axes), rads);
     return pThis;
 }
 
-Camera_t * Camera_roll(Camera_t *const pThis, const double rads)
+Camera_t * Camera_roll(Camera_t *const pThis, const Real_t rads)
 {
     Axes_roll(&(pThis->axes), rads);
     return pThis;
 }
 
-Camera_t * Camera_march(Camera_t *const pThis, const double dist)
+Camera_t * Camera_march(Camera_t *const pThis, const Real_t dist)
 {
     Axes_march(&(pThis->axes), dist);
     return pThis;
 }
 
-Camera_t * Camera_strafe(Camera_t *const pThis, const double dist)
+Camera_t * Camera_strafe(Camera_t *const pThis, const Real_t dist)
 {
     Axes_strafe(&(pThis->axes), dist);
     return pThis;
 }
 
-Camera_t * Camera_climb(Camera_t *const pThis, const double dist)
+Camera_t * Camera_climb(Camera_t *const pThis, const Real_t dist)
 {
     Axes_climb(&(pThis->axes), dist);
     return pThis;
@@ -25,11 +25,11 @@ typedef struct {
      * The distance from the eye to the frame, measured in the local
      * coordinate system.
      */
-    double frame_dist;
+    Real_t frame_dist;
 
 } Camera_t;
 
-Camera_t * Camera_cfg(Camera_t *const pThis, double frame_dist);
+Camera_t * Camera_cfg(Camera_t *const pThis, Real_t frame_dist);
 
 Camera_t * Camera_copy(Camera_t *const pThis, const Camera_t *const pRhs);
 
@@ -39,19 +39,19 @@ Vect_t * Camera_getPov(const Camera_t *const pThis, Vect_t *opPov);
 
 Vect_t * Camera_getUp(const Camera_t *const pThis, Vect_t *opUp);
 
-Camera_t * Camera_scale(Camera_t *const pThis, const double scale);
+Camera_t * Camera_scale(Camera_t *const pThis, const Real_t scale);
 
-Camera_t * Camera_yaw(Camera_t *const pThis, const double rads);
+Camera_t * Camera_yaw(Camera_t *const pThis, const Real_t rads);
 
-Camera_t * Camera_pitch(Camera_t *const pThis, const double rads);
+Camera_t * Camera_pitch(Camera_t *const pThis, const Real_t rads);
 
-Camera_t * Camera_roll(Camera_t *const pThis, const double rads);
+Camera_t * Camera_roll(Camera_t *const pThis, const Real_t rads);
 
-Camera_t * Camera_march(Camera_t *const pThis, const double dist);
+Camera_t * Camera_march(Camera_t *const pThis, const Real_t dist);
 
-Camera_t * Camera_strafe(Camera_t *const pThis, const double dist);
+Camera_t * Camera_strafe(Camera_t *const pThis, const Real_t dist);
 
-Camera_t * Camera_climb(Camera_t *const pThis, const double dist);
+Camera_t * Camera_climb(Camera_t *const pThis, const Real_t dist);
 
 #endif
 //end inclusion filter
@@ -0,0 +1,143 @@
+/**
+ * File: campath.c
+ *
+ */
+#include "campath.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "camera.h"
+#include "axes.h"
+#include "quat.h"
+#include "point.h"
+#include "vect.h"
+#include "trig_helper.h"
+#include "util.h"
+
+CamPath_t * CamPath_cfg(CamPath_t *const pThis)
+{
+    pThis->key_count = 0;
+    pThis->key_capacity = 4;
+    pThis->keys = Util_allocOrDie(sizeof(CamKey_t) * pThis->key_capacity, "Allocating camera path keys.");
+    return pThis;
+}
+
+void CamPath_destroy(CamPath_t *const pThis)
+{
+    free(pThis->keys);
+    pThis->keys = NULL;
+    pThis->key_count = 0;
+    pThis->key_capacity = 0;
+}
+
+bool CamPath_addKey(CamPath_t *const pThis, const double time, const Point_t *const pEye, const double yaw, const double pitch, const double roll)
+{
+    Quat_t q_yaw, q_pitch, q_roll, q_turn;
+    Vect_t axis;
+    CamKey_t *pKey;
+
+    if(pThis->key_count > 0 && !(time > pThis->keys[pThis->key_count - 1].time)) {
+        fprintf(stderr, "Camera path key at time %g is not after the one before it.\n", time);
+        return false;
+    }
+    if(pThis->key_count == pThis->key_capacity) {
+        pThis->key_capacity *= 2;
+        pThis->keys = Util_reallocOrDie(pThis->keys, sizeof(CamKey_t) * pThis->key_capacity, "Growing camera path keys.");
+    }
+    pKey = &(pThis->keys[pThis->key_count++]);
+    pKey->time = time;
+    Point_copy(&(pKey->eye), pEye);
+
+    //Turning around each axis as it is after the turns before it is the same as turning
+    // around the starting axes in the opposite order, which is the order the quats multiply.
+    Quat_rotation(&q_yaw, Vect_cfg(&axis, 0, 1, 0), yaw);
+    Quat_rotation(&q_pitch, Vect_cfg(&axis, 1, 0, 0), pitch);
+    Quat_rotation(&q_roll, Vect_cfg(&axis, 0, 0, 1), roll);
+    Quat_product(&q_turn, &q_yaw, &q_pitch);
+    Quat_product(&(pKey->orient), &q_turn, &q_roll);
+    return true;
+}
+
+bool CamPath_load(CamPath_t *const pThis, const char *const path)
+{
+    char line[1024];
+    char extra;
+    double time, x, y, z, yaw, pitch, roll;
+    unsigned int line_no = 0;
+    Point_t eye;
+    FILE *const file = fopen(path, "r");
+
+    if(file == NULL) {
+        fprintf(stderr, "Can't open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    CamPath_cfg(pThis);
+    while(fgets(line, sizeof(line), file) != NULL) {
+        const char *p = line;
+
+        line_no++;
+        while(*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if(*p == '\0' || *p == '\n' || *p == '\r' || *p == '#') {
+            continue;
+        }
+        if(sscanf(p, "%lf %lf %lf %lf %lf %lf %lf %c", &time, &x, &y, &z, &yaw, &pitch, &roll, &extra) != 7) {
+            fprintf(stderr, "%s:%u: expected TIME X Y Z YAW PITCH ROLL.\n", path, line_no);
+            break;
+        }
+        if(pThis->key_count > 0 && !(time > pThis->keys[pThis->key_count - 1].time)) {
+            fprintf(stderr, "%s:%u: keys must be in order of time.\n", path, line_no);
+            break;
+        }
+        Point_cfg(&eye, x, y, z);
+        CamPath_addKey(pThis, time, &eye, rads(yaw), rads(pitch), rads(roll));
+    }
+
+    if(!feof(file) || ferror(file)) {
+        fclose(file);
+        CamPath_destroy(pThis);
+        return false;
+    }
+    fclose(file);
+
+    if(pThis->key_count == 0) {
+        fprintf(stderr, "%s: no keys in the camera path.\n", path);
+        CamPath_destroy(pThis);
+        return false;
+    }
+    return true;
+}
+
+Camera_t * CamPath_camera(const CamPath_t *const pThis, Camera_t *const opCam, const double time)
+{
+    const CamKey_t *pA, *pB;
+    Quat_t orient;
+    Vect_t axis;
+    double t;
+    unsigned int k;
+
+    //Find the keys either side, holding the ends.
+    k = 0;
+    while(k + 1 < pThis->key_count && pThis->keys[k + 1].time <= time) {
+        k++;
+    }
+    pA = &(pThis->keys[k]);
+    pB = (k + 1 < pThis->key_count) ? &(pThis->keys[k + 1]) : pA;
+    t = (pB != pA && time > pA->time) ? (time - pA->time) / (pB->time - pA->time) : 0;
+
+    Quat_slerp(&orient, &(pA->orient), &(pB->orient), (Real_t)t);
+    Quat_rotateVect(&orient, &(opCam->axes.x), Vect_cfg(&axis, 1, 0, 0));
+    Quat_rotateVect(&orient, &(opCam->axes.y), Vect_cfg(&axis, 0, 1, 0));
+    Quat_rotateVect(&orient, &(opCam->axes.z), Vect_cfg(&axis, 0, 0, 1));
+    Point_cfg(&(opCam->axes.origin),
+        pA->eye.x + t * (pB->eye.x - pA->eye.x),
+        pA->eye.y + t * (pB->eye.y - pA->eye.y),
+        pA->eye.z + t * (pB->eye.z - pA->eye.z));
+    return opCam;
+}
+
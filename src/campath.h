@@ -0,0 +1,97 @@
+/**
+ * File: campath.h
+ *
+ * A keyframed camera path, for rendering animations: the camera's eye and orientation at a
+ * few points in time, and everything in between interpolated from them.
+ */
+#ifndef CAMPATH_H
+#define CAMPATH_H
+
+#include <stdbool.h>
+
+#include "camera.h"
+#include "quat.h"
+#include "point.h"
+
+/**
+ * Struct: CamKey_t
+ * Where the camera is, and which way it's facing, at one point in time.
+ */
+typedef struct {
+    double time;
+    Point_t eye;
+
+    /**
+     * Field: orient
+     * Unit quat rotating the camera's starting axes (looking along the Z axis, with Y up) to
+     * its axes at this key.
+     */
+    Quat_t orient;
+} CamKey_t;
+
+/**
+ * Struct: CamPath_t
+ * Keys in order of increasing time.
+ */
+typedef struct {
+    CamKey_t *keys;
+    unsigned int key_count;
+    unsigned int key_capacity;
+} CamPath_t;
+
+/**
+ * Function: CamPath_cfg
+ * Configures an empty path.
+ *
+ * Aborts the program if there is not enough memory.
+ */
+CamPath_t * CamPath_cfg(CamPath_t *pThis);
+
+/**
+ * Function: CamPath_destroy
+ * Frees the keys allocated for the path. The object itself is not freed.
+ */
+void CamPath_destroy(CamPath_t *pThis);
+
+/**
+ * Function: CamPath_addKey
+ *
+ * Adds a key at the given time, which must be later than the last key's. The camera's
+ * orientation is given as for the --yaw, --pitch, and --roll options: turned by <yaw>, then
+ * <pitch>, then <roll> radians, each around the axis as it is by then.
+ *
+ * Returns false, having printed a message to stderr, if the time is out of order.
+ */
+bool CamPath_addKey(CamPath_t *pThis, double time, const Point_t *pEye, double yaw, double pitch, double roll);
+
+/**
+ * Function: CamPath_load
+ *
+ * Configures the path from a text file with one key per line:
+ *
+ * > TIME X Y Z YAW PITCH ROLL
+ *
+ * giving the time of the key (in any units, as long as they go up from one line to the next),
+ * where the camera's eye is, and the camera's orientation as for <CamPath_addKey>, in degrees.
+ * Blank lines, and lines starting with #, are skipped.
+ *
+ * Returns false, having printed a message to stderr, if the file can't be read or isn't valid,
+ * in which case the path is not configured.
+ */
+bool CamPath_load(CamPath_t *pThis, const char *path);
+
+/**
+ * Function: CamPath_camera
+ *
+ * Places the camera where the path has it at <time>: the eye interpolated in a straight line
+ * between the keys either side, and the orientation with <Quat_slerp> between them. Times
+ * before the first key or after the last are held at that key. The camera's frame distance
+ * is left alone.
+ *
+ * The path must have at least one key.
+ */
+Camera_t * CamPath_camera(const CamPath_t *pThis, Camera_t *opCam, double time);
+
+#endif
+//end inclusion filter
+
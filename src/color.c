@@ -35,3 +35,14 @@ Color_t * Color_clone(const Color_t *pRhs)
     return Util_cloneOrDie(pRhs, sizeof(Color_t), "Cloning a Color_t object.");
 }
 
+Color_t * Color_inArena(Arena_t *const pArena, const uint8_t r, const uint8_t g, const uint8_t b)
+{
+    Color_t *const pThis = Arena_alloc(pArena, sizeof(Color_t), "Allocating a Color_t object in an arena.");
+    return Color_cfg(pThis, r, g, b);
+}
+
+Color_t * Color_cloneInArena(Arena_t *const pArena, const Color_t *const pRhs)
+{
+    return Arena_clone(pArena, pRhs, sizeof(Color_t), "Cloning a Color_t object into an arena.");
+}
+
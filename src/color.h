@@ -6,6 +6,7 @@
 #define COLOR_H
 
 #include <stdint.h>
+#include "util.h"
 
 /**
  * Struct: Color_t
@@ -44,6 +45,19 @@ Color_t * Color(const uint8_t r, const uint8_t g, const uint8_t b);
  */
 Color_t * Color_clone(const Color_t *pRhs);
 
+/**
+ * Function: Color_inArena
+ * Like <Color>, but allocates the object from the arena, so it's freed along with everything
+ * else in it.
+ */
+Color_t * Color_inArena(Arena_t *pArena, const uint8_t r, const uint8_t g, const uint8_t b);
+
+/**
+ * Function: Color_cloneInArena
+ * Like <Color_clone>, but allocates the copy from the arena.
+ */
+Color_t * Color_cloneInArena(Arena_t *pArena, const Color_t *pRhs);
+
 #endif
 //end inclusion filter
 
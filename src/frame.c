@@ -0,0 +1,18 @@
+/**
+ * File: frame.c
+ *
+ */
+#include "frame.h"
+
+#include "point.h"
+#include "vect.h"
+
+Point_t * Frame_point(const Frame_t *const pThis, Point_t *const opPt, const double col, const double row)
+{
+    return Point_cfg(opPt,
+        pThis->top_left.x + (col * pThis->step_right.x) + (row * pThis->step_down.x),
+        pThis->top_left.y + (col * pThis->step_right.y) + (row * pThis->step_down.y),
+        pThis->top_left.z + (col * pThis->step_right.z) + (row * pThis->step_down.z)
+    );
+}
+
@@ -0,0 +1,35 @@
+/**
+ * File: frame.h
+ *
+ * The grid of points in front of the camera that rays are cast through. See <Frame_cfg> in
+ * scene.h for setting one up for a scene.
+ */
+#ifndef FRAME_H
+#define FRAME_H
+
+#include "point.h"
+#include "vect.h"
+
+/**
+ * Struct: Frame_t
+ * The grid of points in front of the camera that rays are cast through, one per pixel.
+ */
+typedef struct {
+    Point_t top_left;
+    Vect_t step_down;
+    Vect_t step_right;
+} Frame_t;
+
+/**
+ * Function: Frame_point
+ * Gets the point on the frame for the given column and row (which may be fractional,
+ * to get points inside a pixel).
+ *
+ * The point is computed directly from <top_left>, so every pixel gets exactly the same
+ * point no matter what order, or on which thread, pixels are visited.
+ */
+Point_t * Frame_point(const Frame_t *pThis, Point_t *opPt, double col, double row);
+
+#endif
+//end inclusion filter
+
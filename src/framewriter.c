@@ -0,0 +1,199 @@
+/**
+ * File: framewriter.c
+ *
+ */
+#include "framewriter.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include "image.h"
+#include "util.h"
+
+/**
+ * Function: FrameWriter_isPattern
+ * Whether the path has exactly one conversion in it, and it's a %d with an optional 0 flag
+ * and width, so it's safe to hand to snprintf with the frame number.
+ */
+static bool FrameWriter_isPattern(const char *const path)
+{
+    const char *p = path;
+    unsigned int conversions = 0;
+
+    while((p = strchr(p, '%')) != NULL) {
+        p++;
+        while(*p >= '0' && *p <= '9') {
+            p++;
+        }
+        if(*p != 'd') {
+            return false;
+        }
+        conversions++;
+    }
+    return conversions == 1;
+}
+
+/**
+ * Function: FrameWriter_write
+ * Writes one frame, on the writer's thread.
+ */
+static bool FrameWriter_write(FrameWriter_t *const pThis, const Image_t *const pImage)
+{
+    char name[4096];
+
+    if(pThis->stream != NULL) {
+        if(!Image_writeY4mFrame(pImage, pThis->stream)) {
+            fprintf(stderr, "Error writing frame %u to %s.\n", pThis->written, pThis->path);
+            return false;
+        }
+        return true;
+    }
+
+    if(snprintf(name, sizeof(name), pThis->path, pThis->written) >= (int)sizeof(name)) {
+        fprintf(stderr, "File name for frame %u is too long.\n", pThis->written);
+        return false;
+    }
+    return Image_writePpm(pImage, name);
+}
+
+/**
+ * Function: FrameWriter_run
+ * The writer's thread: writes queued frames in order until it's closed and the queue is empty.
+ */
+static void * FrameWriter_run(void *const pArg)
+{
+    FrameWriter_t *const pThis = (FrameWriter_t *)pArg;
+
+    pthread_mutex_lock(&(pThis->lock));
+    for(;;) {
+        while(pThis->queued == 0 && !(pThis->closing)) {
+            pthread_cond_wait(&(pThis->cond), &(pThis->lock));
+        }
+        if(pThis->queued == 0) {
+            break;
+        }
+        const Image_t *const pImage = &(pThis->images[pThis->head]);
+        const bool skip = pThis->failed;
+
+        //The buffer stays counted as queued while it's written, so it isn't rendered over.
+        pthread_mutex_unlock(&(pThis->lock));
+        const bool ok = skip || FrameWriter_write(pThis, pImage);
+        pthread_mutex_lock(&(pThis->lock));
+
+        if(!ok) {
+            pThis->failed = true;
+        }
+        pThis->written++;
+        pThis->head = (pThis->head + 1) % FRAMEWRITER_BUFFERS;
+        pThis->queued--;
+        pthread_cond_broadcast(&(pThis->cond));
+    }
+    pthread_mutex_unlock(&(pThis->lock));
+    return NULL;
+}
+
+bool FrameWriter_open(FrameWriter_t *const pThis, const char *const path, const int width, const int height, const unsigned int fps)
+{
+    const size_t length = strlen(path);
+    unsigned int b;
+
+    pThis->path = path;
+    pThis->stream = NULL;
+    if(length >= 4 && strcmp(path + length - 4, ".y4m") == 0) {
+        if(strchr(path, '%') != NULL) {
+            fprintf(stderr, "A Y4M stream is a single file, so %s shouldn't have a frame number in it.\n", path);
+            return false;
+        }
+        pThis->stream = fopen(path, "wb");
+        if(pThis->stream == NULL) {
+            fprintf(stderr, "Can't open %s for writing: %s\n", path, strerror(errno));
+            return false;
+        }
+        if(!Image_writeY4mHeader(pThis->stream, width, height, fps)) {
+            fprintf(stderr, "Error writing %s.\n", path);
+            fclose(pThis->stream);
+            return false;
+        }
+    }
+    else if(!FrameWriter_isPattern(path)) {
+        fprintf(stderr, "%s needs to end in .y4m, or have one %%d (like frame%%04d.ppm) for the frame number.\n", path);
+        return false;
+    }
+
+    for(b=0; b<FRAMEWRITER_BUFFERS; b++) {
+        Image_cfg(&(pThis->images[b]), width, height);
+    }
+    pThis->head = 0;
+    pThis->queued = 0;
+    pThis->written = 0;
+    pThis->waited = 0;
+    pThis->closing = false;
+    pThis->failed = false;
+
+    pthread_mutex_init(&(pThis->lock), NULL);
+    pthread_cond_init(&(pThis->cond), NULL);
+    if(pthread_create(&(pThis->thread), NULL, FrameWriter_run, pThis) != 0) {
+        fputs("Failed to start frame writer thread.\n", stderr);
+        abort();
+    }
+    return true;
+}
+
+Image_t * FrameWriter_next(FrameWriter_t *const pThis)
+{
+    Image_t *pImage;
+
+    pthread_mutex_lock(&(pThis->lock));
+    if(pThis->queued == FRAMEWRITER_BUFFERS) {
+        const double start = Util_now();
+        while(pThis->queued == FRAMEWRITER_BUFFERS) {
+            pthread_cond_wait(&(pThis->cond), &(pThis->lock));
+        }
+        pThis->waited += Util_now() - start;
+    }
+    pImage = &(pThis->images[(pThis->head + pThis->queued) % FRAMEWRITER_BUFFERS]);
+    pthread_mutex_unlock(&(pThis->lock));
+    return pImage;
+}
+
+bool FrameWriter_submit(FrameWriter_t *const pThis)
+{
+    bool ok;
+
+    pthread_mutex_lock(&(pThis->lock));
+    pThis->queued++;
+    ok = !(pThis->failed);
+    pthread_cond_broadcast(&(pThis->cond));
+    pthread_mutex_unlock(&(pThis->lock));
+    return ok;
+}
+
+bool FrameWriter_close(FrameWriter_t *const pThis)
+{
+    unsigned int b;
+    bool ok;
+
+    pthread_mutex_lock(&(pThis->lock));
+    pThis->closing = true;
+    pthread_cond_broadcast(&(pThis->cond));
+    pthread_mutex_unlock(&(pThis->lock));
+    pthread_join(pThis->thread, NULL);
+
+    ok = !(pThis->failed);
+    if(pThis->stream != NULL && fclose(pThis->stream) != 0 && ok) {
+        fprintf(stderr, "Error writing %s.\n", pThis->path);
+        ok = false;
+    }
+    pThis->stream = NULL;
+
+    pthread_mutex_destroy(&(pThis->lock));
+    pthread_cond_destroy(&(pThis->cond));
+    for(b=0; b<FRAMEWRITER_BUFFERS; b++) {
+        Image_destroy(&(pThis->images[b]));
+    }
+    return ok;
+}
+
@@ -0,0 +1,111 @@
+/**
+ * File: framewriter.h
+ *
+ * Writes the frames of an animation on a thread of its own, so encoding and writing one frame
+ * overlaps with rendering the next, and the renderer never waits on the disk unless the disk
+ * has fallen a whole <FRAMEWRITER_BUFFERS> frames behind.
+ *
+ * The frames go either to a numbered image sequence of PPM files, or to a single Y4M stream.
+ */
+#ifndef FRAMEWRITER_H
+#define FRAMEWRITER_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "image.h"
+
+/**
+ * Constant: FRAMEWRITER_BUFFERS
+ * Frames that can be in flight at once: one being written, and the rest rendered and queued
+ * behind it or being rendered.
+ */
+#define FRAMEWRITER_BUFFERS 3
+
+/**
+ * Struct: FrameWriter_t
+ */
+typedef struct {
+    /**
+     * Field: path
+     * A Y4M file, or a pattern for the image sequence's file names with a single %d (which
+     * may have a width and leading zeroes, like %04d) for the frame number, from 0.
+     */
+    const char *path;
+
+    /**
+     * Field: stream
+     * The open Y4M file, or NULL for an image sequence.
+     */
+    FILE *stream;
+
+    /**
+     * Fields: images, head, queued
+     * A ring of frame buffers. The <queued> frames from <head> on have been rendered and are
+     * waiting to be (or being) written; the one after them is the one being rendered.
+     */
+    Image_t images[FRAMEWRITER_BUFFERS];
+    unsigned int head;
+    unsigned int queued;
+
+    /**
+     * Field: written
+     * Frames written so far, which numbers the next one.
+     */
+    unsigned int written;
+
+    /**
+     * Field: waited
+     * Total seconds the renderer has spent waiting for a free buffer.
+     */
+    double waited;
+
+    bool closing;
+    bool failed;
+
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} FrameWriter_t;
+
+/**
+ * Function: FrameWriter_open
+ *
+ * Starts writing frames of the given size to <path>: a Y4M stream, at <fps> frames per
+ * second, if it ends in ".y4m", otherwise a sequence of PPM files named by the pattern in it
+ * (see <FrameWriter_t.path>). The path is not copied.
+ *
+ * Returns false, having printed a message to stderr, if the path isn't valid or the stream
+ * can't be opened, in which case nothing is started.
+ */
+bool FrameWriter_open(FrameWriter_t *pThis, const char *path, int width, int height, unsigned int fps);
+
+/**
+ * Function: FrameWriter_next
+ * Gets the buffer to render the next frame into. This only blocks if every buffer is still
+ * waiting to be written.
+ */
+Image_t * FrameWriter_next(FrameWriter_t *pThis);
+
+/**
+ * Function: FrameWriter_submit
+ * Queues the frame rendered into the buffer from <FrameWriter_next> to be written, and returns
+ * straight away.
+ *
+ * Returns false if writing an earlier frame has failed, in which case there's no point
+ * rendering any more: this and any later frames are dropped.
+ */
+bool FrameWriter_submit(FrameWriter_t *pThis);
+
+/**
+ * Function: FrameWriter_close
+ * Waits for every queued frame to be written, stops the thread, and frees the buffers.
+ *
+ * Returns false, having printed a message to stderr, if any frame couldn't be written.
+ */
+bool FrameWriter_close(FrameWriter_t *pThis);
+
+#endif
+//end inclusion filter
+
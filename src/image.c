@@ -0,0 +1,195 @@
+/**
+ * File: image.c
+ *
+ */
+#include "image.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "util.h"
+
+Image_t * Image_cfg(Image_t *const pThis, const int width, const int height)
+{
+    pThis->width = width;
+    pThis->height = height;
+    pThis->rowstride = width * 3;
+    pThis->pixels = Util_allocOrDie((size_t)(pThis->rowstride) * height + 1, "Allocating image pixels.");
+    memset(pThis->pixels, 0, (size_t)(pThis->rowstride) * height);
+    return pThis;
+}
+
+void Image_destroy(Image_t *const pThis)
+{
+    free(pThis->pixels);
+    pThis->pixels = NULL;
+}
+
+bool Image_writePpm(const Image_t *const pThis, const char *const path)
+{
+    int j;
+    FILE *const file = fopen(path, "wb");
+
+    if(file == NULL) {
+        fprintf(stderr, "Can't open %s for writing: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", pThis->width, pThis->height);
+    for(j=0; j<pThis->height; j++) {
+        fwrite(pThis->pixels + (j * pThis->rowstride), 3, pThis->width, file);
+    }
+
+    const bool failed = (ferror(file) != 0);
+    if(fclose(file) != 0 || failed) {
+        fprintf(stderr, "Error writing %s.\n", path);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Function: Image_readPpmNumber
+ * Reads one number from a PPM header, skipping whitespace and comments before it. Returns -1
+ * if there isn't one.
+ */
+static int Image_readPpmNumber(FILE *const file)
+{
+    int c, value = 0, digits = 0;
+
+    c = fgetc(file);
+    while(c == '#' || c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+        if(c == '#') {
+            while(c != '\n' && c != EOF) {
+                c = fgetc(file);
+            }
+        }
+        c = fgetc(file);
+    }
+    while(c >= '0' && c <= '9' && value < 1000000) {
+        value = (value * 10) + (c - '0');
+        digits++;
+        c = fgetc(file);
+    }
+    //The one whitespace character after the number is part of it, so the maximum value's is
+    // all that separates the header from the pixels.
+    if(digits == 0 || (c != ' ' && c != '\t' && c != '\r' && c != '\n')) {
+        return -1;
+    }
+    return value;
+}
+
+bool Image_readPpm(Image_t *const pThis, const char *const path)
+{
+    int j, width, height, maxval;
+    FILE *const file = fopen(path, "rb");
+
+    if(file == NULL) {
+        fprintf(stderr, "Can't open %s for reading: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    if(fgetc(file) != 'P' || fgetc(file) != '6') {
+        fprintf(stderr, "%s isn't a binary PPM.\n", path);
+        fclose(file);
+        return false;
+    }
+    width = Image_readPpmNumber(file);
+    height = Image_readPpmNumber(file);
+    maxval = Image_readPpmNumber(file);
+    if(width <= 0 || height <= 0 || maxval != 255) {
+        fprintf(stderr, "%s doesn't have a PPM header this can read.\n", path);
+        fclose(file);
+        return false;
+    }
+
+    Image_cfg(pThis, width, height);
+    for(j=0; j<height; j++) {
+        if(fread(pThis->pixels + (j * pThis->rowstride), 3, width, file) != (size_t)width) {
+            fprintf(stderr, "%s ends before all its pixels.\n", path);
+            Image_destroy(pThis);
+            fclose(file);
+            return false;
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+bool Image_writeY4mHeader(FILE *const file, const int width, const int height, const unsigned int fps)
+{
+    return fprintf(file, "YUV4MPEG2 W%d H%d F%u:1 Ip A1:1 C420jpeg\n", width, height, fps) > 0;
+}
+
+/**
+ * Function: Image_byte
+ * Rounds a converted value to the nearest byte, saturating at 0 and 255.
+ */
+static uint8_t Image_byte(const double value)
+{
+    if(!(value > 0)) {
+        return 0;
+    }
+    if(value >= 255) {
+        return 255;
+    }
+    return (uint8_t)(value + 0.5);
+}
+
+bool Image_writeY4mFrame(const Image_t *const pThis, FILE *const file)
+{
+    const int chroma_width = (pThis->width + 1) / 2;
+    const int chroma_height = (pThis->height + 1) / 2;
+    uint8_t *const row = Util_allocOrDie((size_t)(pThis->width) + 1, "Allocating Y4M row.");
+    int i, j, di, dj, plane;
+
+    fputs("FRAME\n", file);
+
+    //Luma, a row at a time.
+    for(j=0; j<pThis->height; j++) {
+        const uint8_t *const pix = pThis->pixels + (j * pThis->rowstride);
+        for(i=0; i<pThis->width; i++) {
+            row[i] = Image_byte((0.299 * pix[3*i]) + (0.587 * pix[3*i + 1]) + (0.114 * pix[3*i + 2]));
+        }
+        fwrite(row, 1, (size_t)(pThis->width), file);
+    }
+
+    //Then Cb, then Cr, each from the average color of a 2x2 block (or what's left of one at
+    // an odd edge).
+    for(plane=0; plane<2; plane++) {
+        for(j=0; j<chroma_height; j++) {
+            for(i=0; i<chroma_width; i++) {
+                double r = 0, g = 0, b = 0;
+                int n = 0;
+                for(dj=0; dj<2; dj++) {
+                    for(di=0; di<2; di++) {
+                        const int x = (2 * i) + di;
+                        const int y = (2 * j) + dj;
+                        if(x < pThis->width && y < pThis->height) {
+                            const uint8_t *const pix = pThis->pixels + (y * pThis->rowstride) + (x * 3);
+                            r += pix[0];
+                            g += pix[1];
+                            b += pix[2];
+                            n++;
+                        }
+                    }
+                }
+                r /= n;
+                g /= n;
+                b /= n;
+                if(plane == 0) {
+                    row[i] = Image_byte(128 - (0.168736 * r) - (0.331264 * g) + (0.5 * b));
+                }
+                else {
+                    row[i] = Image_byte(128 + (0.5 * r) - (0.418688 * g) - (0.081312 * b));
+                }
+            }
+            fwrite(row, 1, (size_t)chroma_width, file);
+        }
+    }
+
+    free(row);
+    return ferror(file) == 0;
+}
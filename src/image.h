@@ -0,0 +1,77 @@
+/**
+ * File: image.h
+ *
+ * A plain in-memory 24-bit RGB image, for rendering without GTK.
+ */
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Struct: Image_t
+ * Rows of RGB triplets, top row first, with each row starting <rowstride> bytes after
+ * the one before it. This is the same layout <Render_scene> draws into.
+ */
+typedef struct {
+    int width;
+    int height;
+    int rowstride;
+    uint8_t *pixels;
+} Image_t;
+
+/**
+ * Function: Image_cfg
+ * Configures the image and allocates its pixels, all black.
+ *
+ * Aborts the program if there is not enough memory.
+ */
+Image_t * Image_cfg(Image_t *pThis, int width, int height);
+
+/**
+ * Function: Image_destroy
+ * Frees the pixels allocated by <Image_cfg>. The object itself is not freed.
+ */
+void Image_destroy(Image_t *pThis);
+
+/**
+ * Function: Image_writePpm
+ * Writes the image to the given file as a binary PPM (P6).
+ *
+ * Returns false, having printed a message to stderr, if the file can't be written.
+ */
+bool Image_writePpm(const Image_t *pThis, const char *path);
+
+/**
+ * Function: Image_readPpm
+ * Configures the image from a binary PPM (P6) with 8 bits per channel, as written by
+ * <Image_writePpm>.
+ *
+ * Returns false, having printed a message to stderr, if the file can't be read or isn't
+ * such a PPM, in which case the image is left unconfigured.
+ */
+bool Image_readPpm(Image_t *pThis, const char *path);
+
+/**
+ * Function: Image_writeY4mHeader
+ * Starts a YUV4MPEG2 (Y4M) stream of frames of the given size, at <fps> frames per second,
+ * in 4:2:0 with full range (JPEG) levels, which video tools read directly.
+ *
+ * Returns false if the header can't be written.
+ */
+bool Image_writeY4mHeader(FILE *file, int width, int height, unsigned int fps);
+
+/**
+ * Function: Image_writeY4mFrame
+ * Converts the image to Y'CbCr (BT.601, full range), averaging the chroma over each 2x2 block
+ * of pixels, and writes it as the next frame of a stream started with <Image_writeY4mHeader>.
+ *
+ * Returns false if the frame can't be written.
+ */
+bool Image_writeY4mFrame(const Image_t *pThis, FILE *file);
+
+#endif
+//end inclusion filter
+
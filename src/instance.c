@@ -0,0 +1,229 @@
+/**
+ * File: instance.c
+ *
+ */
+#include "instance.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "aabb.h"
+#include "axes.h"
+#include "bvh.h"
+#include "triblock.h"
+#include "point.h"
+#include "vect.h"
+#include "raystats.h"
+#include "util.h"
+
+Instance_t * Instance_cfg(Instance_t *const pThis, const Bvh_t *const pBvh, const Axes_t *const pAxes)
+{
+    Vect_t yz, zx, xy;
+    Point_t corner, global;
+    Real_t det;
+    unsigned int c;
+
+    pThis->bvh = pBvh;
+    Axes_copy(&(pThis->axes), pAxes);
+
+    //Inverse by cofactors: each row is the cross product of the other two axes, so it's at
+    // right angles to both of them, scaled to give 1 against its own.
+    Vect_cross(&yz, &(pAxes->y), &(pAxes->z));
+    Vect_cross(&zx, &(pAxes->z), &(pAxes->x));
+    Vect_cross(&xy, &(pAxes->x), &(pAxes->y));
+    det = Vect_dot(&(pAxes->x), &yz);
+    Vect_scale(&(pThis->inv_x), &yz, 1 / det);
+    Vect_scale(&(pThis->inv_y), &zx, 1 / det);
+    Vect_scale(&(pThis->inv_z), &xy, 1 / det);
+
+    //Bound the eight corners of the mesh's own box, wherever they end up.
+    Aabb_cfgEmpty(&(pThis->bounds));
+    if(pBvh->node_count > 0) {
+        const Aabb_t *const pBox = &(pBvh->nodes[0].bounds);
+        for(c=0; c<8; c++) {
+            Point_cfg(&corner,
+                (c & 1) ? pBox->max.x : pBox->min.x,
+                (c & 2) ? pBox->max.y : pBox->min.y,
+                (c & 4) ? pBox->max.z : pBox->min.z);
+            Aabb_addPoint(&(pThis->bounds), Axes_point(pAxes, &global, &corner));
+        }
+        Aabb_pad(&(pThis->bounds));
+    }
+
+    return pThis;
+}
+
+void Instance_toLocal(const Instance_t *const pThis, Point_t *const opPt, Vect_t *const opVect, const Point_t *const pt, const Vect_t *const vect)
+{
+    Vect_t rel;
+
+    Point_displacement(&rel, &(pThis->axes.origin), pt);
+    Point_cfg(opPt, Vect_dot(&(pThis->inv_x), &rel), Vect_dot(&(pThis->inv_y), &rel), Vect_dot(&(pThis->inv_z), &rel));
+    Vect_cfg(opVect, Vect_dot(&(pThis->inv_x), vect), Vect_dot(&(pThis->inv_y), vect), Vect_dot(&(pThis->inv_z), vect));
+}
+
+Vect_t * Instance_normal(const Instance_t *const pThis, Vect_t *const opNormal, const Vect_t *const pLocal)
+{
+    Vect_t sum, component;
+
+    //The inverse's rows are the inverse transpose's columns.
+    Vect_scale(&sum, &(pThis->inv_x), pLocal->x);
+    Vect_add(&sum, &sum, Vect_scale(&component, &(pThis->inv_y), pLocal->y));
+    Vect_add(&sum, &sum, Vect_scale(&component, &(pThis->inv_z), pLocal->z));
+    return Vect_normalize(opNormal, &sum);
+}
+
+InstanceBvh_t * InstanceBvh_cfg(InstanceBvh_t *const pThis, const Instance_t *const instances, const unsigned int count)
+{
+    Aabb_t *bounds;
+    unsigned int i;
+
+    pThis->instances = instances;
+    pThis->instance_count = count;
+    pThis->nodes = Util_allocOrDie(sizeof(BvhNode_t) * (count > 0 ? (2*count - 1) : 1), "Allocating instance BVH nodes.");
+    pThis->order = Util_allocOrDie(sizeof(unsigned int) * (count > 0 ? count : 1), "Allocating instance BVH order.");
+
+    bounds = Util_allocOrDie(sizeof(Aabb_t) * (count > 0 ? count : 1), "Allocating instance BVH build bounds.");
+    for(i=0; i<count; i++) {
+        Aabb_copy(&(bounds[i]), &(instances[i].bounds));
+    }
+
+    //Each instance is a whole hierarchy of its own to trace, so they're costed one at a time.
+    pThis->node_count = Bvh_buildNodes(pThis->nodes, pThis->order, bounds, count, 1);
+
+    free(bounds);
+    return pThis;
+}
+
+void InstanceBvh_destroy(InstanceBvh_t *const pThis)
+{
+    free(pThis->nodes);
+    free(pThis->order);
+    pThis->nodes = NULL;
+    pThis->order = NULL;
+    pThis->instances = NULL;
+    pThis->instance_count = 0;
+    pThis->node_count = 0;
+}
+
+double InstanceBvh_rayHit(const InstanceBvh_t *const pThis, TriHit_t *const opHit, const double closest_dist, const Point_t *const pt, const Vect_t *const vect)
+{
+    unsigned int stack[BVH_MAX_DEPTH + 2];
+    Real_t stack_near[BVH_MAX_DEPTH + 2];
+    unsigned int top = 0;
+    unsigned int k;
+    Real_t near, near_a, near_b;
+    bool hit_a, hit_b;
+    double best = closest_dist;
+    Point_t local_pt;
+    Vect_t local_vect, inv;
+    TriHit_t hit;
+
+    opHit->id = TRIBLOCK_EMPTY;
+    opHit->instance = 0;
+    if(pThis->node_count == 0) {
+        return closest_dist;
+    }
+
+    Vect_cfg(&inv, 1 / vect->x, 1 / vect->y, 1 / vect->z);
+    if(!Aabb_rayClip(&(pThis->nodes[0].bounds), pt, &inv, (Real_t)best, &near)) {
+        return closest_dist;
+    }
+    stack[top] = 0;
+    stack_near[top] = near;
+    top++;
+
+    while(top > 0) {
+        top--;
+
+        //Something closer may have been found since this node was pushed.
+        if(stack_near[top] > best) {
+            continue;
+        }
+        const BvhNode_t *const pNode = &(pThis->nodes[stack[top]]);
+        RAYSTATS_ADD(RAYSTATS_NODES, 1);
+
+        if(pNode->count > 0) {
+            for(k=pNode->start; k<pNode->start + pNode->count; k++) {
+                const unsigned int index = pThis->order[k];
+                const Instance_t *const pInst = &(pThis->instances[index]);
+
+                Instance_toLocal(pInst, &local_pt, &local_vect, pt, vect);
+                best = Bvh_rayHit(pInst->bvh, &hit, best, &local_pt, &local_vect);
+                if(hit.id != TRIBLOCK_EMPTY) {
+                    *opHit = hit;
+                    opHit->instance = index;
+                }
+            }
+            continue;
+        }
+
+        //Interior node: visit the nearer child first by pushing it last.
+        const unsigned int a = stack[top] + 1;
+        const unsigned int c = pNode->start;
+        hit_a = Aabb_rayClip(&(pThis->nodes[a].bounds), pt, &inv, (Real_t)best, &near_a);
+        hit_b = Aabb_rayClip(&(pThis->nodes[c].bounds), pt, &inv, (Real_t)best, &near_b);
+
+        if(hit_a && hit_b) {
+            if(near_a <= near_b) {
+                stack[top] = c; stack_near[top] = near_b; top++;
+                stack[top] = a; stack_near[top] = near_a; top++;
+            }
+            else {
+                stack[top] = a; stack_near[top] = near_a; top++;
+                stack[top] = c; stack_near[top] = near_b; top++;
+            }
+        }
+        else if(hit_a) {
+            stack[top] = a; stack_near[top] = near_a; top++;
+        }
+        else if(hit_b) {
+            stack[top] = c; stack_near[top] = near_b; top++;
+        }
+    }
+
+    return best;
+}
+
+bool InstanceBvh_occluded(const InstanceBvh_t *const pThis, const Point_t *const pt, const Vect_t *const vect, const double max_dist)
+{
+    unsigned int stack[BVH_MAX_DEPTH + 2];
+    unsigned int top = 0;
+    unsigned int k;
+    Real_t near;
+    Point_t local_pt;
+    Vect_t local_vect, inv;
+
+    if(pThis->node_count == 0) {
+        return false;
+    }
+
+    Vect_cfg(&inv, 1 / vect->x, 1 / vect->y, 1 / vect->z);
+
+    stack[top++] = 0;
+    while(top > 0) {
+        const unsigned int node = stack[--top];
+        const BvhNode_t *const pNode = &(pThis->nodes[node]);
+
+        if(!Aabb_rayClip(&(pNode->bounds), pt, &inv, (Real_t)max_dist, &near)) {
+            continue;
+        }
+        RAYSTATS_ADD(RAYSTATS_NODES, 1);
+
+        if(pNode->count > 0) {
+            for(k=pNode->start; k<pNode->start + pNode->count; k++) {
+                const Instance_t *const pInst = &(pThis->instances[pThis->order[k]]);
+                Instance_toLocal(pInst, &local_pt, &local_vect, pt, vect);
+                if(Bvh_occluded(pInst->bvh, &local_pt, &local_vect, max_dist)) {
+                    return true;
+                }
+            }
+            continue;
+        }
+
+        stack[top++] = pNode->start;
+        stack[top++] = node + 1;
+    }
+    return false;
+}
+
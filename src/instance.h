@@ -0,0 +1,141 @@
+/**
+ * File: instance.h
+ *
+ * Instanced geometry: many copies of a mesh placed around a scene, each by its own <Axes_t>,
+ * all sharing the one mesh and its <Bvh_t>. Memory goes with the unique meshes, not with the
+ * number of copies.
+ *
+ * Rays are traced through a two level hierarchy: an <InstanceBvh_t> over the instances'
+ * bounding boxes, and each instance's own <Bvh_t>, which the ray is transformed into the
+ * instance's local space to trace.
+ */
+#ifndef INSTANCE_H
+#define INSTANCE_H
+
+#include <stdbool.h>
+
+#include "aabb.h"
+#include "axes.h"
+#include "bvh.h"
+#include "triblock.h"
+#include "point.h"
+#include "vect.h"
+
+/**
+ * Struct: Instance_t
+ */
+typedef struct {
+    /**
+     * Field: bvh
+     * The hierarchy (and through it, the mesh) this is a copy of. It's shared, not copied, so
+     * it needs to outlive the instance.
+     */
+    const Bvh_t *bvh;
+
+    /**
+     * Field: axes
+     * Where the copy goes: a point in the mesh's own coordinates is at <Axes_point> of it in
+     * the scene. The axes may be scaled and needn't be at right angles, but mustn't be flat.
+     */
+    Axes_t axes;
+
+    /**
+     * Fields: inv_x, inv_y, inv_z
+     * Rows of the inverse of the matrix whose columns are the <axes>, for taking rays into the
+     * mesh's coordinates.
+     */
+    Vect_t inv_x;
+    Vect_t inv_y;
+    Vect_t inv_z;
+
+    /**
+     * Field: bounds
+     * Box containing the whole copy, in scene coordinates.
+     */
+    Aabb_t bounds;
+} Instance_t;
+
+/**
+ * Function: Instance_cfg
+ * Configures a copy of the mesh under <pBvh>, placed by <pAxes>.
+ */
+Instance_t * Instance_cfg(Instance_t *pThis, const Bvh_t *pBvh, const Axes_t *pAxes);
+
+/**
+ * Function: Instance_toLocal
+ *
+ * Takes the ray from <pt> along <vect>, in scene coordinates, into the mesh's coordinates.
+ * The ray's direction isn't normalized afterwards, so distances along it, in units of its
+ * direction vector, are the same in both: a hit at a distance of 2.5 along the local ray is
+ * 2.5 along the scene ray too. Hits in different instances can be compared directly.
+ */
+void Instance_toLocal(const Instance_t *pThis, Point_t *opPt, Vect_t *opVect, const Point_t *pt, const Vect_t *vect);
+
+/**
+ * Function: Instance_normal
+ * Takes a surface normal from the mesh's coordinates to the scene's, as a unit vector. Normals
+ * transform by the inverse transpose of the axes, so they stay at right angles to the surface
+ * even if the axes are scaled unevenly.
+ */
+Vect_t * Instance_normal(const Instance_t *pThis, Vect_t *opNormal, const Vect_t *pLocal);
+
+/**
+ * Struct: InstanceBvh_t
+ * The top level of the hierarchy: a <Bvh_t> style tree with instances in its leaves rather
+ * than triangles. The instances are not copied, only a pointer to them, so they need to outlive
+ * it.
+ */
+typedef struct {
+    const Instance_t *instances;
+    unsigned int instance_count;
+
+    /**
+     * Fields: nodes, node_count
+     * The tree, as for <Bvh_t.nodes>.
+     */
+    BvhNode_t *nodes;
+    unsigned int node_count;
+
+    /**
+     * Field: order
+     * Instance indices, reordered so each leaf's instances are contiguous.
+     */
+    unsigned int *order;
+} InstanceBvh_t;
+
+/**
+ * Function: InstanceBvh_cfg
+ * Builds the top level hierarchy over the given instances, with <Bvh_buildNodes>.
+ *
+ * Aborts the program if there is not enough memory.
+ */
+InstanceBvh_t * InstanceBvh_cfg(InstanceBvh_t *pThis, const Instance_t *instances, unsigned int count);
+
+/**
+ * Function: InstanceBvh_destroy
+ * Frees the memory allocated by <InstanceBvh_cfg>. The object itself is not freed.
+ */
+void InstanceBvh_destroy(InstanceBvh_t *pThis);
+
+/**
+ * Function: InstanceBvh_rayHit
+ *
+ * Finds the closest hit on any instance, as <Bvh_rayHit> does for a single mesh, filling in
+ * <TriHit_t.instance> with which one it was (the id is the triangle's index in that instance's
+ * mesh). Instances are visited front to back, and each one's <Bvh_rayHit> only looks for hits
+ * closer than the closest so far.
+ *
+ * Returns the distance to the hit, or <closest_dist> if there isn't one.
+ */
+double InstanceBvh_rayHit(const InstanceBvh_t *pThis, TriHit_t *opHit, double closest_dist, const Point_t *pt, const Vect_t *vect);
+
+/**
+ * Function: InstanceBvh_occluded
+ * Whether the ray hits any instance closer than <max_dist>, as <Bvh_occluded> does for a
+ * single mesh.
+ */
+bool InstanceBvh_occluded(const InstanceBvh_t *pThis, const Point_t *pt, const Vect_t *vect, double max_dist);
+
+#endif
+//end inclusion filter
+
@@ -0,0 +1,39 @@
+/**
+ * File: light.c
+ *
+ */
+#include "light.h"
+
+#include <math.h>
+
+#include "point.h"
+#include "vect.h"
+
+Light_t * Light_cfgPoint(Light_t *const pThis, const Point_t *const pPosition, const Real_t intensity)
+{
+    pThis->type = LIGHT_POINT;
+    Point_copy(&(pThis->position), pPosition);
+    Vect_cfg(&(pThis->direction), 0, 0, 0);
+    pThis->intensity = intensity;
+    return pThis;
+}
+
+Light_t * Light_cfgDirectional(Light_t *const pThis, const Vect_t *const pDirection, const Real_t intensity)
+{
+    pThis->type = LIGHT_DIRECTIONAL;
+    Point_cfg(&(pThis->position), 0, 0, 0);
+    Vect_normalize(&(pThis->direction), pDirection);
+    pThis->intensity = intensity;
+    return pThis;
+}
+
+double Light_toward(const Light_t *const pThis, const Point_t *const pPt, Vect_t *const opToward)
+{
+    if(pThis->type == LIGHT_POINT) {
+        Point_displacement(opToward, pPt, &(pThis->position));
+        return 1.0;
+    }
+    Vect_negate(opToward, &(pThis->direction));
+    return INFINITY;
+}
+
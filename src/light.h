@@ -0,0 +1,78 @@
+/**
+ * File: light.h
+ *
+ * Lights for shading a scene: point lights, which shine in every direction from a point, and
+ * directional lights, which shine the same way everywhere, like the sun.
+ */
+#ifndef LIGHT_H
+#define LIGHT_H
+
+#include "types.h"
+#include "point.h"
+#include "vect.h"
+
+/**
+ * Enum: LightType_t
+ *
+ * LIGHT_POINT - Shines from <Light_t.position> in every direction.
+ * LIGHT_DIRECTIONAL - Shines along <Light_t.direction> from infinitely far away.
+ */
+typedef enum {
+    LIGHT_POINT,
+    LIGHT_DIRECTIONAL
+} LightType_t;
+
+/**
+ * Struct: Light_t
+ */
+typedef struct {
+    LightType_t type;
+
+    /**
+     * Field: position
+     * Where a point light is.
+     */
+    Point_t position;
+
+    /**
+     * Field: direction
+     * Unit vector in the direction a directional light's rays travel.
+     */
+    Vect_t direction;
+
+    /**
+     * Field: intensity
+     * How bright the light is, where 1 lights a surface facing it squarely to its full color.
+     * Point lights don't fall off with distance.
+     */
+    Real_t intensity;
+} Light_t;
+
+/**
+ * Function: Light_cfgPoint
+ * Configures a point light at the given position.
+ */
+Light_t * Light_cfgPoint(Light_t *pThis, const Point_t *pPosition, Real_t intensity);
+
+/**
+ * Function: Light_cfgDirectional
+ * Configures a directional light shining along the given vector, which needn't be unit length.
+ */
+Light_t * Light_cfgDirectional(Light_t *pThis, const Vect_t *pDirection, Real_t intensity);
+
+/**
+ * Function: Light_toward
+ *
+ * Gets the vector from <pPt> toward the light in <opToward>, for casting a shadow ray. For a
+ * point light, this reaches all the way to the light, so anything hit closer than a distance
+ * of 1 along it is in the way. For a directional light it's a unit vector, and anything hit at
+ * all is in the way.
+ *
+ * Returns the distance along <opToward> to the light: 1 for a point light, or <INFINITY> for
+ * a directional light.
+ */
+double Light_toward(const Light_t *pThis, const Point_t *pPt, Vect_t *opToward);
+
+#endif
+//end inclusion filter
+
@@ -5,12 +5,29 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <inttypes.h>
 
 #include <gtk/gtk.h>
 #include <gdk/gdk.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
+#include <gdk/gdkkeysyms.h>
 
 #include "triangle.h"
+#include "triring.h"
+#include "mesh.h"
+#include "meshload.h"
+#include "bvh.h"
+#include "instance.h"
+#include "scene.h"
+#include "render.h"
+#include "raygen.h"
+#include "raster.h"
+#include "raystats.h"
+#include "image.h"
+#include "options.h"
+#include "campath.h"
+#include "framewriter.h"
+#include "tilefarm.h"
 #include "point.h"
 #include "vect.h"
 #include "vertex.h"
@@ -19,226 +36,238 @@
 #include "axes.h"
 #include "camera.h"
 #include "trig_helper.h"
+#include "util.h"
 
-typedef struct {
-    const Triangle_t *const * triangles;
-    const Camera_t *cam;
-    double frame_width;
-    double frame_height;
-    int img_width;
-    int img_height;
-} Scene_t;
+/**
+ *
+ * Coordinates:
+ *
+ * Note that this is a right-handed coordinate system, which may be counterintuitive in some cases.
+ * X is left and right, Y is up and down, Z is in and out (of the screen), but positive X
+ * is **to the left**, positive Y is up, and positive Z is into the screen.
+ */
+
+/**
+ * Constants: Navigation steps
+ *
+ * VIEW_TURN_STEP - Degrees the camera turns for each press of a turning key.
+ * VIEW_MOVE_STEP - Distance the camera moves for each press of a moving key.
+ * VIEW_FAST - How many times further either goes with shift held down.
+ * VIEW_DRAG_STEP - Degrees the camera turns for each pixel the mouse is dragged.
+ */
+#define VIEW_TURN_STEP 5.0
+#define VIEW_MOVE_STEP 0.25
+#define VIEW_FAST 5.0
+#define VIEW_DRAG_STEP 0.25
+
+/**
+ * Constant: VIEW_BATCH_ROWS
+ * Rows of the image each call of <render_pass> renders: one row of tiles, so the main loop
+ * gets to handle events many times during each pass, not just between them.
+ */
+#define VIEW_BATCH_ROWS RENDER_TILE_SIZE
 
+/**
+ * Struct: Viewer_t
+ * The state of the interactive window: the scene being explored, and how far along the
+ * progressive render of the current view is.
+ */
 typedef struct {
-    Triangle_t triangles[2*12];
-} TriRing12_t;
+    const Scene_t *scene;
+
+    /**
+     * Field: cam
+     * The scene's camera, which the viewer moves around.
+     */
+    Camera_t *cam;
+
+    GtkWidget *window;
+    GdkPixbuf *pixbuf;
+
+    /**
+     * Field: block
+     * The block size of the next pass of <Render_scenePass>, or 0 when the view is finished.
+     */
+    int block;
+
+    /**
+     * Field: row
+     * The first row of the next batch of the current pass.
+     */
+    int row;
+
+    /**
+     * Field: idle_id
+     * The idle source rendering the passes, or 0 when there isn't one.
+     */
+    guint idle_id;
+
+    /**
+     * Fields: drag_x, drag_y
+     * Where the mouse was last seen while dragging with the first button.
+     */
+    gdouble drag_x, drag_y;
+} Viewer_t;
 
-void TriRing12_cfg(TriRing12_t *const pThis, const Point_t * pCenter, const Vect_t *pFirst, const Vect_t *pUp, const double height_angle)
+static gboolean draw(GtkWidget *widget, GdkEventExpose *event, gpointer data)
 {
-    unsigned int i;
-    Quat_t rot;
-    Vect_t tptr, bptr;
-    Vect_t hinge;
-    Point_t pt;
-    Color_t col;
-    Vertex_t verts[24];
-
-    Color_t colors[3];
-    Color_cfg(&colors[0], 255, 0, 0);
-    Color_cfg(&colors[1], 0, 255, 0);
-    Color_cfg(&colors[2], 0, 0, 255);
-
-    //Pointer to the first vertex in the top row.
-    Vect_copy(&tptr, pFirst);
-
-    //Axis to rotate the top pointer around to get the bottom pointer.
-    Vect_cross(&hinge, pFirst, pUp);
-
-    //Quat to rotate around the hinge.
-    Quat_rotation(&rot, &hinge, height_angle);
-
-    //Pointer to the first vertex in the bottom row.
-    Quat_rotateVect(&rot, &bptr, &tptr);
-    Quat_rotation(&rot, pUp, TWO_PI/24.0);
-    Quat_rotateVect(&rot, &bptr, &bptr);
-    
-    //Quat to rotate around the up axis.
-    Quat_rotation(&rot, pUp, TWO_PI/12.0);
-
-    for(i=0; i<12; i++)
-    {
-        //fill in the top row of vertices
-        Point_translate(&pt, pCenter, &tptr);
-        Color_copy(&col, &(colors[i%3]));
-        Vertex_cfg(&(verts[2*i]), &pt, &col);
-
-        //And the bottom row.
-        Point_translate(&pt, pCenter, &bptr);
-        Color_copy(&col, &(colors[(i+1)%3]));
-        Vertex_cfg(&(verts[2*i+1]), &pt, &col);
-
-        //Rotate around to the next triangle.
-        Quat_rotateVect(&rot, &tptr, &tptr);
-        Quat_rotateVect(&rot, &bptr, &bptr);
+    const Viewer_t *const pViewer = (const Viewer_t*)(data);
+    const GdkPixbuf *const pixbuf = pViewer->pixbuf;
+    const int width = gdk_pixbuf_get_width(pixbuf);
+    const int height = gdk_pixbuf_get_height(pixbuf);
+
+    //Draw the pixbuf to the window.
+    gdk_draw_pixbuf(widget->window, NULL, pixbuf, 0, 0, 0, 0, width, height, GDK_RGB_DITHER_NONE, 0, 0);
+
+    return TRUE;
+}
+
+/**
+ * Function: render_pass
+ * Idle handler which renders the next batch of <VIEW_BATCH_ROWS> rows of the current pass of
+ * the view into the pixbuf and shows it. Each pass is a quarter of the cost of the one after
+ * it, so the first shows up almost at once, and the main loop gets to handle events between
+ * batches, so a camera move starts over from the coarsest pass without waiting for the rest of
+ * a pass it's made pointless. The last pass renders the scene as <Render_scene> does,
+ * antialiasing or rasterizing it if asked to.
+ */
+static gboolean render_pass(gpointer data)
+{
+    Viewer_t *const pViewer = (Viewer_t*)(data);
+    const Scene_t *const scene = pViewer->scene;
+    const int block = pViewer->block;
+    const int rowstride = gdk_pixbuf_get_rowstride(pViewer->pixbuf);
+    Tile_t batch;
+
+    batch.x0 = 0;
+    batch.x1 = scene->img_width;
+    batch.y0 = pViewer->row;
+    batch.y1 = (batch.y0 + VIEW_BATCH_ROWS < scene->img_height) ? batch.y0 + VIEW_BATCH_ROWS : scene->img_height;
+    uint8_t *const pixels = gdk_pixbuf_get_pixels(pViewer->pixbuf) + (batch.y0 * rowstride);
+
+    //A plain full resolution pass is all Render_scene would do, and it reuses the rays cast
+    // so far. Antialiasing and rasterizing need the whole thing, which Render_region does for
+    // just the batch.
+    if(block > 1 || (scene->aa_samples == 0 && !Render_rasterizes(scene))) {
+        Render_regionPass(scene, pixels, rowstride, block, block < RENDER_COARSE_BLOCK, &batch);
     }
+    else {
+        Render_region(scene, pixels, rowstride, &batch);
+    }
+    gtk_widget_queue_draw_area(pViewer->window, batch.x0, batch.y0, batch.x1 - batch.x0, batch.y1 - batch.y0);
 
-    for(i=0; i<12; i++)
-    {
-        //And the triangle.
-        Triangle_cfg(&(pThis->triangles[2*i]), &(verts[2*i]), &(verts[2*((i+1)%12)]), &(verts[2*i+1]));
-        Triangle_cfg(&(pThis->triangles[2*i+1]), &(verts[2*i+1]), &(verts[2*((i+1)%12)]), &(verts[2*((i+1)%12)+1]));
+    pViewer->row = batch.y1;
+    if(pViewer->row < scene->img_height) {
+        return TRUE;
+    }
+    pViewer->row = 0;
+    if(block == 1) {
+        //Full resolution, nothing left to do until the camera moves.
+        pViewer->block = 0;
+        pViewer->idle_id = 0;
+        return FALSE;
     }
+    pViewer->block = block / 2;
+    return TRUE;
 }
 
-typedef struct {
-    Point_t top_left;
-    Vect_t step_down;
-    Vect_t step_right;
-} Frame_t;
-
-static void Frame_cfg(Frame_t *pThis, const Scene_t *const scene)
+/**
+ * Function: rerender
+ * Starts the progressive render over from the coarsest pass, after the camera has moved.
+ */
+static void rerender(Viewer_t *const pViewer)
 {
-    Point_t eye;
-    Vect_t pov;
-    Vect_t up;
-    Vect_t right;
-
-    //Get the eye, pov, and up vector from the camera.
-    Camera_getEye(scene->cam, &eye);
-    Camera_getPov(scene->cam, &pov);
-    Camera_getUp(scene->cam, &up);
-
-    //Create the vector pointing right as the cross product of up and pov.
-    Vect_cross(&right, &pov, &up);
-    
-    //Now make sure up is really up, i.e., perpendicular to both pov and right
-    // (because right is a cross product of pov, we know right is perpendicular to pov.
-    // The cross product of right and pov will be perp to both, so all three will be
-    // mutually perpendicular.
-    Vect_cross(&up, &right, &pov);
-
-    //Make up be half the height of the frame, and right be half the width.
-    Vect_setMag(&up, (scene->frame_height)*0.5);
-    Vect_setMag(&right, (scene->frame_width)*0.5);
-
-    //Get a point in the top-left corner of the frame by starting at the eye,
-    // translating to the center of the frame with pov, then translating to the top-center
-    // of the frame with up, and then translating back to the top-left corner with right.
-    Point_translate(&(pThis->top_left), &eye, &pov);
-    Point_translate(&(pThis->top_left), &(pThis->top_left), &up);
-    Point_translateBack(&(pThis->top_left), &(pThis->top_left), &right);
-
-    //Now get scaled vectors that represent a single step along the grid of the frame,
-    // in each direction.
-    Vect_scale(&(pThis->step_down), &up, -1.0 / (((double)(scene->img_height)) * 0.5));
-    Vect_scale(&(pThis->step_right), &right, 1.0 / (((double)(scene->img_width)) * 0.5));
+    pViewer->block = RENDER_COARSE_BLOCK;
+    pViewer->row = 0;
+    if(pViewer->idle_id == 0) {
+        pViewer->idle_id = g_idle_add(render_pass, pViewer);
+    }
 }
 
-static void render_scene(GdkPixbuf *const pixbuf, const Scene_t *const scene)
+/**
+ * Function: key_press
+ *
+ * Moves the camera with the keyboard:
+ *
+ * Left, Right - Turn (yaw).
+ * Up, Down - Look up and down (pitch).
+ * q, e - Roll.
+ * w, s - March forward and back.
+ * a, d - Strafe left and right.
+ * r, f, Page Up, Page Down - Climb up and down.
+ * Escape - Quit.
+ *
+ * Holding shift makes every step <VIEW_FAST> times bigger.
+ */
+static gboolean key_press(GtkWidget *widget, GdkEventKey *event, gpointer data)
 {
-    unsigned int i, j;
-    Frame_t frame;
-    double min_dist;
-    Color_t render_color;
-    const Triangle_t *const *pTriangle;
-    guchar *scanline;
-    guchar *pix;
-    Point_t eye;
-
-    //The point we cast rays through.
-    Point_t pt;
-
-    //The ray we cast through it.
-    Vect_t ray;
-
-    //The point at the beginning of the row.
-    Point_t row_start;
-
-    const int width = scene->img_width;
-    const int height = scene->img_height;
-    const int rowstride = gdk_pixbuf_get_rowstride(pixbuf);
-    guchar *const pixels = gdk_pixbuf_get_pixels(pixbuf);
-
-    // Set Up the Frame
-    Frame_cfg(&frame, scene);
-
-
-    //// Render the Triangles ////
-
-    //Get the camera eye
-    Camera_getEye(scene->cam, &eye);
-    
-    //First row starts with the top-left corner.
-    Point_copy(&row_start, &(frame.top_left));
-    
-    //Conveniently, so does the raster data.
-    scanline = pixels;
-
-    //Iterate over each row, starting at the top and going down.
-    for(j=0; j<height; j++) {
-
-        //Our point will walk along the row, starting with the first point in the row.
-        Point_copy(&pt, &row_start);
-
-        //Same with the scan line.
-        pix = scanline;
-        
-        //Iterate over the pixels in the row, moving left to right.
-        for(i=0; i<width; i++) {
-
-            //Get the vector from the eye to the current point.
-            Point_displacement(&ray, &eye, &pt);
-
-            //Find which triangle it intersect withs closest.
-            min_dist = INFINITY;
-            Color_cfg(&render_color, 0, 0, 0);
-            pTriangle = scene->triangles;
-            for(pTriangle = scene->triangles; *(pTriangle) != NULL; pTriangle++)
-            {
-                min_dist = Triangle_rayCast(*pTriangle, &render_color, min_dist, &pt, &ray);
-            }
+    Viewer_t *const pViewer = (Viewer_t*)(data);
+    Camera_t *const cam = pViewer->cam;
+    const double scale = (event->state & GDK_SHIFT_MASK) ? VIEW_FAST : 1.0;
+    const double turn = rads(VIEW_TURN_STEP * scale);
+    const double move = VIEW_MOVE_STEP * scale;
+
+    //Remember positive X is to the left, and positive pitch looks down.
+    switch(event->keyval) {
+        case GDK_Left: Camera_yaw(cam, turn); break;
+        case GDK_Right: Camera_yaw(cam, -turn); break;
+        case GDK_Up: Camera_pitch(cam, -turn); break;
+        case GDK_Down: Camera_pitch(cam, turn); break;
+        case GDK_q: Camera_roll(cam, turn); break;
+        case GDK_e: Camera_roll(cam, -turn); break;
+        case GDK_w: Camera_march(cam, move); break;
+        case GDK_s: Camera_march(cam, -move); break;
+        case GDK_a: Camera_strafe(cam, move); break;
+        case GDK_d: Camera_strafe(cam, -move); break;
+        case GDK_r: case GDK_Page_Up: Camera_climb(cam, move); break;
+        case GDK_f: case GDK_Page_Down: Camera_climb(cam, -move); break;
+        case GDK_Escape: gtk_main_quit(); return TRUE;
+        default: return FALSE;
+    }
 
-            //Set the pixel in the GdkPixbuf.
-            pix[0] = render_color.r;
-            pix[1] = render_color.g;
-            pix[2] = render_color.b;
+    rerender(pViewer);
+    return TRUE;
+}
 
-            //Step to the next pixel.
-            Point_translate(&pt, &pt, &(frame.step_right));
-            pix += 3;
-        }
+static gboolean button_press(GtkWidget *widget, GdkEventButton *event, gpointer data)
+{
+    Viewer_t *const pViewer = (Viewer_t*)(data);
 
-        //Step to the next row.
-        Point_translate(&row_start, &row_start, &(frame.step_down));
-        scanline += rowstride;
+    if(event->button != 1) {
+        return FALSE;
     }
-
+    pViewer->drag_x = event->x;
+    pViewer->drag_y = event->y;
+    return TRUE;
 }
 
-
 /**
- *
- * Coordinates:
- *
- * Note that this is a right-handed coordinate system, which may be counterintuitive in some cases.
- * X is left and right, Y is up and down, Z is in and out (of the screen), but positive X
- * is **to the left**, positive Y is up, and positive Z is into the screen.
+ * Function: motion_notify
+ * Turns the camera to follow the mouse while it's dragged with the first button.
  */
-static gboolean draw(GtkWidget *widget, GdkEventExpose *event, gpointer data)
+static gboolean motion_notify(GtkWidget *widget, GdkEventMotion *event, gpointer data)
 {
-    const GdkPixbuf *const pixbuf = (const GdkPixbuf*)(data);
-    const int width = gdk_pixbuf_get_width(pixbuf);
-    const int height = gdk_pixbuf_get_height(pixbuf);
+    Viewer_t *const pViewer = (Viewer_t*)(data);
+    const gdouble dx = event->x - pViewer->drag_x;
+    const gdouble dy = event->y - pViewer->drag_y;
 
-    //Draw the pixbuf to the window.
-    gdk_draw_pixbuf(widget->window, NULL, pixbuf, 0, 0, 0, 0, width, height, GDK_RGB_DITHER_NONE, 0, 0);
+    if(!(event->state & GDK_BUTTON1_MASK)) {
+        return FALSE;
+    }
+    pViewer->drag_x = event->x;
+    pViewer->drag_y = event->y;
 
+    //Turn the way the mouse moves: right to look right, down to look down.
+    Camera_yaw(pViewer->cam, -rads(dx * VIEW_DRAG_STEP));
+    Camera_pitch(pViewer->cam, rads(dy * VIEW_DRAG_STEP));
+    rerender(pViewer);
     return TRUE;
 }
 
-void show_scene(const Scene_t *const scene)
+void show_scene(Viewer_t *const pViewer)
 {
     GtkWidget *window;
+    const Scene_t *const scene = pViewer->scene;
     const int width = scene->img_width;
     const int height = scene->img_height;
 
@@ -247,25 +276,182 @@ void show_scene(const Scene_t *const scene)
     g_assert(gdk_pixbuf_get_n_channels(pixbuf) == 3);
     g_assert(gdk_pixbuf_get_width(pixbuf) == width);
     g_assert(gdk_pixbuf_get_height(pixbuf) == height);
-
-    //Draw on it.
-    render_scene(pixbuf, scene);
+    pViewer->pixbuf = pixbuf;
 
     //Create the GTK window.
     window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
     gtk_window_set_default_size(GTK_WINDOW(window), scene->img_width, scene->img_height);
     gtk_window_set_title (GTK_WINDOW (window), "Ray Trace");
+    pViewer->window = window;
 
     //Connect it to the expose event, to actually do the drawing.
-    g_signal_connect(G_OBJECT(window), "expose_event", G_CALLBACK(draw), pixbuf);
+    g_signal_connect(G_OBJECT(window), "expose_event", G_CALLBACK(draw), pViewer);
+
+    //Navigation.
+    gtk_widget_add_events(window, GDK_KEY_PRESS_MASK | GDK_BUTTON_PRESS_MASK | GDK_POINTER_MOTION_MASK);
+    g_signal_connect(G_OBJECT(window), "key_press_event", G_CALLBACK(key_press), pViewer);
+    g_signal_connect(G_OBJECT(window), "button_press_event", G_CALLBACK(button_press), pViewer);
+    g_signal_connect(G_OBJECT(window), "motion_notify_event", G_CALLBACK(motion_notify), pViewer);
 
     //Connect to destroy signal so we can quit when the window closes.
     g_signal_connect(G_OBJECT(window), "destroy", G_CALLBACK(gtk_main_quit), NULL);
 
+    //Draw on it. The first pass is done before the window shows, so it never shows up empty.
+    pViewer->block = RENDER_COARSE_BLOCK;
+    pViewer->row = 0;
+    while(pViewer->block == RENDER_COARSE_BLOCK) {
+        render_pass(pViewer);
+    }
+    pViewer->idle_id = g_idle_add(render_pass, pViewer);
+
     //Show the window
     gtk_widget_show(window);
 }
 
+/**
+ * Function: make_copies
+ * Sets up a <copies> by <copies> grid of instances of the mesh under <pBvh>, side by side
+ * across the X and Y axes, each turned a bit more than the last around its Y axis.
+ */
+static const InstanceBvh_t * make_copies(InstanceBvh_t *const opTop, const Bvh_t *const pBvh, const unsigned int copies)
+{
+    Instance_t *const instances = Util_allocOrDie(sizeof(Instance_t) * copies * copies, "Allocating mesh copies.");
+    double spacing = 1.0;
+    unsigned int i, j;
+    Axes_t axes;
+
+    if(pBvh->node_count > 0) {
+        const Aabb_t *const pBox = &(pBvh->nodes[0].bounds);
+        const double dx = pBox->max.x - pBox->min.x;
+        const double dy = pBox->max.y - pBox->min.y;
+        const double dz = pBox->max.z - pBox->min.z;
+        spacing = 1.25 * fmax(dx, fmax(dy, dz));
+    }
+
+    for(j=0; j<copies; j++) {
+        for(i=0; i<copies; i++) {
+            Axes_cfg(&axes);
+            Axes_yaw(&axes, rads(15.0 * (j * copies + i)));
+            Point_cfg(&(axes.origin), spacing * (i - 0.5 * (copies - 1)), spacing * (j - 0.5 * (copies - 1)), 0);
+            Instance_cfg(&(instances[j * copies + i]), pBvh, &axes);
+        }
+    }
+    fprintf(stderr, "Placed %u copies of the mesh.\n", copies * copies);
+
+    //Lives as long as the program, like the rest of the scene.
+    return InstanceBvh_cfg(opTop, instances, copies * copies);
+}
+
+/**
+ * Function: render_image
+ * Renders the scene with the workers in <pFarm>, or in this process if that's NULL.
+ */
+static void render_image(const Scene_t *const scene, TileFarm_t *const pFarm, uint8_t *const pixels, const int rowstride)
+{
+    if(pFarm == NULL) {
+        Render_scene(scene, pixels, rowstride);
+        return;
+    }
+
+    TileFarm_render(pFarm, scene, pixels, rowstride);
+    if(pFarm->reissued > 0 || pFarm->requeued > 0 || pFarm->local > 0) {
+        fprintf(stderr, "Tiles handed out again: %u slow, %u from lost workers; %u rendered here.\n",
+            pFarm->reissued, pFarm->requeued, pFarm->local);
+    }
+}
+
+/**
+ * Function: report_stats
+ * Prints the totals of the scene's <Scene_t.stats>, if it has any, and writes their heatmaps
+ * to <prefix>. Returns false if they couldn't be written.
+ */
+static bool report_stats(const Scene_t *const scene, const char *const prefix, const char *const title)
+{
+    RayStatsTotals_t totals;
+
+    if(scene->stats == NULL) {
+        return true;
+    }
+    RayStatsTotals_print(RayStatsMap_totals(scene->stats, &totals), stderr, title);
+    return RayStatsMap_writeHeatmaps(scene->stats, prefix);
+}
+
+/**
+ * Function: write_scene
+ * Renders the scene into a plain image buffer (with the workers in <pFarm>, if it's not NULL)
+ * and writes it to a file, without touching GTK, along with heatmaps of what it cost to
+ * <stats_prefix> if the scene has <Scene_t.stats>. Returns the program's exit status.
+ */
+static int write_scene(const Scene_t *const scene, TileFarm_t *const pFarm, const char *const path, const char *const stats_prefix)
+{
+    Image_t image;
+    bool ok;
+
+    Image_cfg(&image, scene->img_width, scene->img_height);
+    render_image(scene, pFarm, image.pixels, image.rowstride);
+    ok = Image_writePpm(&image, path);
+    Image_destroy(&image);
+    ok = report_stats(scene, stats_prefix, "Render cost:") && ok;
+
+    return ok ? 0 : 1;
+}
+
+/**
+ * Function: write_animation
+ *
+ * Renders <frames> frames with the camera moving along the path, spread evenly over the time
+ * from its first key to its last, and writes them with a <FrameWriter_t>, so each frame is
+ * written while the next is rendered. <pCam> is the scene's camera, which is moved for each
+ * frame. The frames are rendered with the workers in <pFarm>, if it's not NULL. If the scene
+ * has <Scene_t.stats>, what each frame cost is printed, and the heatmaps written to
+ * <stats_prefix> are of all of them together. Returns the program's exit status.
+ */
+static int write_animation(const Scene_t *const scene, TileFarm_t *const pFarm, Camera_t *const pCam, const CamPath_t *const pPath, const unsigned int frames, const unsigned int fps, const char *const path, const char *const stats_prefix)
+{
+    const double first = pPath->keys[0].time;
+    const double last = pPath->keys[pPath->key_count - 1].time;
+    FrameWriter_t writer;
+    Image_t *pImage;
+    RayStatsTotals_t before, after;
+    unsigned int k, c;
+    bool ok = true;
+    double start;
+
+    if(!FrameWriter_open(&writer, path, scene->img_width, scene->img_height, fps)) {
+        return 1;
+    }
+
+    start = Util_now();
+    for(k=0; k<frames && ok; k++) {
+        const double time = (frames > 1) ? first + ((last - first) * k / (frames - 1)) : first;
+        CamPath_camera(pPath, pCam, time);
+
+        pImage = FrameWriter_next(&writer);
+        if(scene->stats != NULL) {
+            RayStatsMap_totals(scene->stats, &before);
+        }
+        render_image(scene, pFarm, pImage->pixels, pImage->rowstride);
+        ok = FrameWriter_submit(&writer);
+
+        //The counts carry on from frame to frame, so the frame's own are what it added.
+        if(scene->stats != NULL) {
+            RayStatsMap_totals(scene->stats, &after);
+            fprintf(stderr, "Frame %u:", k);
+            for(c=0; c<RAYSTATS_COUNT; c++) {
+                fprintf(stderr, " %s %" PRIu64, RayStats_names[c], after.totals[c] - before.totals[c]);
+            }
+            fputc('\n', stderr);
+        }
+    }
+    const double rendered = Util_now() - start;
+
+    ok = FrameWriter_close(&writer) && ok;
+    fprintf(stderr, "Rendered %u frames in %.3f s (%.1f fps), %.3f s of it waiting on the writer; all written after %.3f s.\n",
+        k, rendered, k / rendered, writer.waited, Util_now() - start);
+    ok = report_stats(scene, stats_prefix, "Render cost of all the frames:") && ok;
+    return ok ? 0 : 1;
+}
+
 int main(int argc, char **argv)
 {
     unsigned int i;
@@ -276,14 +462,26 @@ int main(int argc, char **argv)
     //const Triangle_t *const triangles[] = {&xytri, &yztri, &zxtri, NULL};
     const Triangle_t *triangles[25];
     Camera_t cam;
+    Mesh_t mesh;
+    Bvh_t bvh;
+    InstanceBvh_t top;
+    RayGen_t rays;
+    Raster_t raster;
     Scene_t scene;
     TriRing12_t ring;
     Point_t ring_center;
     Vect_t ring_up, ring_first;
-
-    /* Initialize the GTK+ and all of its supporting libraries. */
-    gtk_init (&argc, &argv);
-    gdk_init (&argc, &argv);
+    Options_t opts;
+    Viewer_t viewer;
+    TileFarm_t farm;
+    TileFarm_t *pFarm = NULL;
+    RayStatsMap_t stats;
+    int status;
+
+    Options_cfg(&opts);
+    if(!Options_parse(&opts, argc, argv)) {
+        return 1;
+    }
 
     //Set up the ring.
     Point_cfg(&ring_center, 0, 0, 0);
@@ -317,20 +515,103 @@ int main(int argc, char **argv)
 
 
     Camera_cfg(&cam, 1.0);
-    //Camera_yaw(&cam, rads(30));
-    Camera_pitch(&cam, rads(20));
-    //Camera_roll(&cam, rads(30));
-    Camera_march(&cam, -5.0);
-    
-    scene.triangles = triangles;
+    Camera_yaw(&cam, rads(opts.yaw));
+    Camera_pitch(&cam, rads(opts.pitch));
+    Camera_roll(&cam, rads(opts.roll));
+    Camera_march(&cam, opts.march);
+    if(opts.has_eye) {
+        Point_copy(&(cam.axes.origin), &(opts.eye));
+    }
+
+    //Either load the mesh, or share the vertices the ring's triangles have in common.
+    if(opts.mesh != NULL) {
+        const double start = Util_now();
+        if(!MeshLoad_file(&mesh, opts.mesh, opts.threads)) {
+            return 1;
+        }
+        fprintf(stderr, "Loaded %s: %u vertices, %u triangles in %.3f s.\n", opts.mesh, mesh.vert_count, mesh.tri_count, Util_now() - start);
+    }
+    else {
+        Mesh_cfgTriangles(&mesh, triangles);
+    }
+
+    //Build the hierarchy once, it's reused for every ray.
+    Bvh_cfg(&bvh, &mesh);
+
+    scene.mesh = &mesh;
+    scene.bvh = &bvh;
+    scene.instances = NULL;
+    if(opts.copies > 1) {
+        scene.instances = make_copies(&top, &bvh, opts.copies);
+    }
     scene.cam = &cam;
-    scene.frame_width = 1.0;
     scene.frame_height = 1.0;
-    scene.img_height = 200;
-    scene.img_width = 200;
+    scene.frame_width = scene.frame_height * opts.width / opts.height;
+    scene.img_height = opts.height;
+    scene.img_width = opts.width;
+    scene.threads = opts.threads;
+    scene.aa_samples = opts.aa_samples;
+    scene.lights = opts.lights;
+    scene.light_count = opts.light_count;
+    scene.ambient = opts.ambient;
+
+    //The viewer's passes and the animation's frames all share the primary rays, only turning
+    // them when the camera turns.
+    RayGen_cfg(&rays);
+    scene.rays = &rays;
+    scene.raster = NULL;
+    if(opts.raster) {
+        scene.raster = Raster_cfg(&raster);
+    }
+    scene.stats = NULL;
+    if(opts.stats != NULL) {
+        scene.stats = RayStatsMap_cfg(&stats, opts.width, opts.height);
+    }
+
+    //A worker just renders the coordinator's tiles, with its view.
+    if(opts.worker != NULL) {
+        const int fd = TileFarm_connect(&scene, opts.worker);
+        if(fd < 0) {
+            return 1;
+        }
+        return TileFarm_serve(&scene, &cam, fd) ? 0 : 1;
+    }
+
+    //Start the workers once the scene is all set up, so the forked ones get all of it.
+    if(opts.procs > 0 || opts.remotes > 0) {
+        pFarm = TileFarm_cfg(&farm);
+        if((opts.procs > 0 && !TileFarm_fork(&farm, &scene, opts.procs))
+            || (opts.remotes > 0 && !TileFarm_listen(&farm, &scene, opts.listen_port, opts.remotes))) {
+            TileFarm_destroy(&farm);
+            return 1;
+        }
+    }
 
+    //Batch mode: no display needed, so don't even initialize GTK.
+    if(opts.output != NULL) {
+        if(opts.cam_path != NULL) {
+            CamPath_t cam_path;
+            status = 1;
+            if(CamPath_load(&cam_path, opts.cam_path)) {
+                status = write_animation(&scene, pFarm, &cam, &cam_path, opts.frames, opts.fps, opts.output, opts.stats);
+            }
+        }
+        else {
+            status = write_scene(&scene, pFarm, opts.output, opts.stats);
+        }
+        if(pFarm != NULL) {
+            TileFarm_destroy(pFarm);
+        }
+        return status;
+    }
+
+    /* Initialize the GTK+ and all of its supporting libraries. */
+    gtk_init (&argc, &argv);
+    gdk_init (&argc, &argv);
 
-    show_scene(&scene);
+    viewer.scene = &scene;
+    viewer.cam = &cam;
+    show_scene(&viewer);
 
     /* Hand control over to the main loop. */
     gtk_main();
@@ -0,0 +1,105 @@
+/**
+ * File: mapfile.c
+ *
+ */
+#include "mapfile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "util.h"
+
+/**
+ * Function: MapFile_read
+ * The fallback where there's no mmap (or it fails): just read the whole file into a buffer.
+ */
+static bool MapFile_read(MapFile_t *const pThis, const char *const path)
+{
+    char *buffer;
+    long size;
+    FILE *const file = fopen(path, "rb");
+
+    if(file == NULL) {
+        fprintf(stderr, "Can't open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    if(fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) < 0 || fseek(file, 0, SEEK_SET) != 0) {
+        fprintf(stderr, "Can't get the size of %s.\n", path);
+        fclose(file);
+        return false;
+    }
+
+    buffer = Util_allocOrDie(size > 0 ? (size_t)size : 1, "Allocating file contents.");
+    if(fread(buffer, 1, (size_t)size, file) != (size_t)size) {
+        fprintf(stderr, "Error reading %s.\n", path);
+        free(buffer);
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+
+    pThis->data = buffer;
+    pThis->size = (size_t)size;
+    pThis->mapped = false;
+    return true;
+}
+
+bool MapFile_open(MapFile_t *const pThis, const char *const path)
+{
+#ifndef _WIN32
+    struct stat st;
+    void *data;
+    const int fd = open(path, O_RDONLY);
+
+    if(fd < 0) {
+        fprintf(stderr, "Can't open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        //Nothing to map (or not a plain file), so let stdio deal with it.
+        close(fd);
+        return MapFile_read(pThis, path);
+    }
+
+    data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED) {
+        return MapFile_read(pThis, path);
+    }
+
+    //Every page is going to be read (by several threads at once), so ask for them all up front.
+    madvise(data, (size_t)st.st_size, MADV_WILLNEED);
+
+    pThis->data = data;
+    pThis->size = (size_t)st.st_size;
+    pThis->mapped = true;
+    return true;
+#else
+    return MapFile_read(pThis, path);
+#endif
+}
+
+void MapFile_close(MapFile_t *const pThis)
+{
+#ifndef _WIN32
+    if(pThis->mapped) {
+        munmap((void *)pThis->data, pThis->size);
+    }
+    else
+#endif
+    {
+        free((void *)pThis->data);
+    }
+    pThis->data = NULL;
+    pThis->size = 0;
+    pThis->mapped = false;
+}
@@ -0,0 +1,47 @@
+/**
+ * File: mapfile.h
+ *
+ * Read-only access to the whole contents of a file, memory mapped where the platform
+ * supports it so nothing is copied.
+ */
+#ifndef MAPFILE_H
+#define MAPFILE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * Struct: MapFile_t
+ */
+typedef struct {
+    /**
+     * Fields: data, size
+     * The contents of the file. This is not NUL-terminated.
+     */
+    const char *data;
+    size_t size;
+
+    /**
+     * Field: mapped
+     * Whether <data> is a mapping (to unmap) or a buffer (to free).
+     */
+    bool mapped;
+} MapFile_t;
+
+/**
+ * Function: MapFile_open
+ * Maps the given file into memory.
+ *
+ * Returns false, having printed a message to stderr, if the file can't be read.
+ */
+bool MapFile_open(MapFile_t *pThis, const char *path);
+
+/**
+ * Function: MapFile_close
+ * Releases the contents mapped by <MapFile_open>. The object itself is not freed.
+ */
+void MapFile_close(MapFile_t *pThis);
+
+#endif
+//end inclusion filter
+
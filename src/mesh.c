@@ -0,0 +1,213 @@
+/**
+ * File: mesh.c
+ *
+ */
+#include "mesh.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "triangle.h"
+#include "point.h"
+#include "vect.h"
+#include "color.h"
+#include "util.h"
+
+Mesh_t * Mesh_cfg(Mesh_t *const pThis, const unsigned int vert_capacity, const unsigned int tri_capacity)
+{
+    pThis->vert_count = 0;
+    pThis->vert_capacity = (vert_capacity > 0 ? vert_capacity : 1);
+    pThis->positions = Util_allocOrDie(sizeof(Point_t) * pThis->vert_capacity, "Allocating mesh positions.");
+    pThis->colors = Util_allocOrDie(sizeof(Color_t) * pThis->vert_capacity, "Allocating mesh colors.");
+
+    pThis->tri_count = 0;
+    pThis->tri_capacity = (tri_capacity > 0 ? tri_capacity : 1);
+    pThis->indices = Util_allocOrDie(sizeof(uint32_t) * 3 * pThis->tri_capacity, "Allocating mesh indices.");
+    pThis->tris = Util_allocOrDie(sizeof(MeshTri_t) * pThis->tri_capacity, "Allocating mesh triangle data.");
+
+    return pThis;
+}
+
+void Mesh_destroy(Mesh_t *const pThis)
+{
+    free(pThis->positions);
+    free(pThis->colors);
+    free(pThis->indices);
+    free(pThis->tris);
+    pThis->positions = NULL;
+    pThis->colors = NULL;
+    pThis->indices = NULL;
+    pThis->tris = NULL;
+    pThis->vert_count = 0;
+    pThis->vert_capacity = 0;
+    pThis->tri_count = 0;
+    pThis->tri_capacity = 0;
+}
+
+uint32_t Mesh_addVertex(Mesh_t *const pThis, const Point_t *const pLoc, const Color_t *const pColor)
+{
+    if(pThis->vert_count == pThis->vert_capacity) {
+        pThis->vert_capacity *= 2;
+        pThis->positions = Util_reallocOrDie(pThis->positions, sizeof(Point_t) * pThis->vert_capacity, "Growing mesh positions.");
+        pThis->colors = Util_reallocOrDie(pThis->colors, sizeof(Color_t) * pThis->vert_capacity, "Growing mesh colors.");
+    }
+    Point_copy(&(pThis->positions[pThis->vert_count]), pLoc);
+    Color_copy(&(pThis->colors[pThis->vert_count]), pColor);
+    return pThis->vert_count++;
+}
+
+uint32_t Mesh_addTriangle(Mesh_t *const pThis, const uint32_t a, const uint32_t b, const uint32_t c)
+{
+    if(pThis->tri_count == pThis->tri_capacity) {
+        pThis->tri_capacity *= 2;
+        pThis->indices = Util_reallocOrDie(pThis->indices, sizeof(uint32_t) * 3 * pThis->tri_capacity, "Growing mesh indices.");
+        pThis->tris = Util_reallocOrDie(pThis->tris, sizeof(MeshTri_t) * pThis->tri_capacity, "Growing mesh triangle data.");
+    }
+    uint32_t *const idx = &(pThis->indices[3 * pThis->tri_count]);
+    idx[0] = a;
+    idx[1] = b;
+    idx[2] = c;
+    Mesh_recomputeTri(pThis, pThis->tri_count);
+    return pThis->tri_count++;
+}
+
+void Mesh_recomputeTri(Mesh_t *const pThis, const unsigned int tri)
+{
+    MeshTri_t *const pTri = &(pThis->tris[tri]);
+    const Point_t *const a = Mesh_vertex(pThis, tri, 0);
+    const Point_t *const b = Mesh_vertex(pThis, tri, 1);
+    const Point_t *const c = Mesh_vertex(pThis, tri, 2);
+    Vect_t xp;
+
+    //Same as Triangle_recompute, so a mesh built from triangles gives exactly the same results.
+    Point_displacement(&(pTri->edge1), a, b);
+    Point_displacement(&(pTri->edge2), a, c);
+    Vect_cross(&xp, &(pTri->edge1), &(pTri->edge2));
+    Vect_normalize(&(pTri->normal), &xp);
+    pTri->area = 0.5 * Vect_dot(&xp, &(pTri->normal));
+}
+
+Mesh_t * Mesh_recompute(Mesh_t *const pThis)
+{
+    unsigned int i;
+    for(i=0; i<pThis->tri_count; i++) {
+        Mesh_recomputeTri(pThis, i);
+    }
+    return pThis;
+}
+
+const Point_t * Mesh_vertex(const Mesh_t *const pThis, const unsigned int tri, const unsigned int corner)
+{
+    return &(pThis->positions[pThis->indices[(3 * tri) + corner]]);
+}
+
+/**
+ * Function: Mesh_hashVertex
+ * Hashes the exact bits of a vertex, for sharing identical vertices in <Mesh_cfgTriangles>.
+ */
+static uint64_t Mesh_hashVertex(const Vertex_t *const pVert)
+{
+    Real_t coords[3];
+    unsigned char bytes[sizeof(coords) + 3];
+    uint64_t hash = 14695981039346656037ULL;
+    size_t i;
+
+    //Hash the fields rather than the struct, which may have padding in it. Zeroes of either
+    // sign are the same location, so fold them together.
+    coords[0] = (pVert->loc.x == 0 ? 0.0 : pVert->loc.x);
+    coords[1] = (pVert->loc.y == 0 ? 0.0 : pVert->loc.y);
+    coords[2] = (pVert->loc.z == 0 ? 0.0 : pVert->loc.z);
+    memcpy(bytes, coords, sizeof(coords));
+    bytes[sizeof(coords)] = pVert->color.r;
+    bytes[sizeof(coords) + 1] = pVert->color.g;
+    bytes[sizeof(coords) + 2] = pVert->color.b;
+
+    //FNV-1a.
+    for(i=0; i<sizeof(bytes); i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+Mesh_t * Mesh_cfgTriangles(Mesh_t *const pThis, const Triangle_t *const *const triangles)
+{
+    unsigned int count = 0;
+    unsigned int i, v;
+    unsigned int slots = 1;
+    uint32_t *table;
+    uint32_t idx[3];
+
+    while(triangles[count] != NULL) {
+        count++;
+    }
+
+    //Open addressing table of vertex indices, at most half full.
+    while(slots < 6 * count) {
+        slots *= 2;
+    }
+    table = Util_allocOrDie(sizeof(uint32_t) * slots, "Allocating mesh vertex table.");
+    for(i=0; i<slots; i++) {
+        table[i] = UINT32_MAX;
+    }
+
+    Mesh_cfg(pThis, count, count);
+    for(i=0; i<count; i++) {
+        for(v=0; v<3; v++) {
+            const Vertex_t *const pVert = &(triangles[i]->vert[v]);
+            uint64_t slot = Mesh_hashVertex(pVert) & (slots - 1);
+
+            while(table[slot] != UINT32_MAX) {
+                const uint32_t j = table[slot];
+                if(pThis->positions[j].x == pVert->loc.x && pThis->positions[j].y == pVert->loc.y && pThis->positions[j].z == pVert->loc.z
+                    && pThis->colors[j].r == pVert->color.r && pThis->colors[j].g == pVert->color.g && pThis->colors[j].b == pVert->color.b)
+                {
+                    break;
+                }
+                slot = (slot + 1) & (slots - 1);
+            }
+            if(table[slot] == UINT32_MAX) {
+                table[slot] = Mesh_addVertex(pThis, &(pVert->loc), &(pVert->color));
+            }
+            idx[v] = table[slot];
+        }
+        Mesh_addTriangle(pThis, idx[0], idx[1], idx[2]);
+    }
+
+    free(table);
+    return pThis;
+}
+
+double Mesh_intersect(const Mesh_t *const pThis, const unsigned int tri, Point_t *const opBary, const double closest_dist, const Point_t *const pt, const Vect_t *const vect)
+{
+    const MeshTri_t *const pTri = &(pThis->tris[tri]);
+    return Triangle_intersectEdges(Mesh_vertex(pThis, tri, 0), &(pTri->edge1), &(pTri->edge2), opBary, closest_dist, pt, vect);
+}
+
+Color_t * Mesh_getBaryColor(const Mesh_t *const pThis, const unsigned int tri, Color_t *const opColor, const Point_t *const pBary)
+{
+    const uint32_t *const idx = &(pThis->indices[3 * tri]);
+    const Color_t *const c0 = &(pThis->colors[idx[0]]);
+    const Color_t *const c1 = &(pThis->colors[idx[1]]);
+    const Color_t *const c2 = &(pThis->colors[idx[2]]);
+
+    const Real_t r = (pBary->x*(c0->r)) + (pBary->y*(c1->r)) + (pBary->z*(c2->r));
+    const Real_t g = (pBary->x*(c0->g)) + (pBary->y*(c1->g)) + (pBary->z*(c2->g));
+    const Real_t b = (pBary->x*(c0->b)) + (pBary->y*(c1->b)) + (pBary->z*(c2->b));
+
+    return Color_cfg(opColor, r, g, b);
+}
+
+double Mesh_rayCast(const Mesh_t *const pThis, const unsigned int tri, Color_t *const opColor, const double closest_dist, const Point_t *const pt, const Vect_t *const vect)
+{
+    Point_t bary;
+
+    const double dist = Mesh_intersect(pThis, tri, &bary, closest_dist, pt, vect);
+    if(dist == closest_dist) {
+        return closest_dist;
+    }
+
+    Mesh_getBaryColor(pThis, tri, opColor, &bary);
+    return dist;
+}
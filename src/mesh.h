@@ -0,0 +1,145 @@
+/**
+ * File: mesh.h
+ *
+ * An indexed triangle mesh: one shared pool of vertices, with each triangle stored as
+ * three indices into it. A closed mesh shares each vertex among several triangles, so
+ * this stores far less than a <Triangle_t> per triangle, which copies all three vertices.
+ */
+#ifndef MESH_H
+#define MESH_H
+
+#include <stdint.h>
+
+#include "triangle.h"
+#include "point.h"
+#include "vect.h"
+#include "color.h"
+
+/**
+ * Struct: MeshTri_t
+ * Data precomputed for each triangle of a mesh, as <Triangle_cfg> does for a <Triangle_t>.
+ */
+typedef struct {
+    /**
+     * Fields: edge1, edge2
+     * The vectors from the first vertex to the second, and from the first to the third.
+     */
+    Vect_t edge1;
+    Vect_t edge2;
+
+    /**
+     * Field: normal
+     * Unit normal, the cross product of <edge1> and <edge2>, normalized.
+     */
+    Vect_t normal;
+
+    /**
+     * Field: area
+     * The signed area of the triangle.
+     */
+    Real_t area;
+} MeshTri_t;
+
+/**
+ * Struct: Mesh_t
+ */
+typedef struct {
+    /**
+     * Fields: positions, colors
+     * The vertex pool, <vert_count> of each.
+     */
+    Point_t *positions;
+    Color_t *colors;
+    unsigned int vert_count;
+    unsigned int vert_capacity;
+
+    /**
+     * Field: indices
+     * Three vertex indices per triangle, <tri_count> triangles.
+     */
+    uint32_t *indices;
+
+    /**
+     * Field: tris
+     * Precomputed data for each triangle, kept apart from the indices.
+     */
+    MeshTri_t *tris;
+    unsigned int tri_count;
+    unsigned int tri_capacity;
+} Mesh_t;
+
+/**
+ * Function: Mesh_cfg
+ * Configures an empty mesh with room for the given number of vertices and triangles.
+ * It grows as needed, the capacities are just a hint.
+ *
+ * Aborts the program if there is not enough memory.
+ */
+Mesh_t * Mesh_cfg(Mesh_t *pThis, unsigned int vert_capacity, unsigned int tri_capacity);
+
+/**
+ * Function: Mesh_cfgTriangles
+ * Configures a mesh holding the same triangles, in the same order, as a NULL-terminated
+ * list of <Triangle_t>. Vertices with exactly the same location and color are shared.
+ *
+ * Aborts the program if there is not enough memory.
+ */
+Mesh_t * Mesh_cfgTriangles(Mesh_t *pThis, const Triangle_t *const *triangles);
+
+/**
+ * Function: Mesh_destroy
+ * Frees the memory allocated for the mesh. The object itself is not freed.
+ */
+void Mesh_destroy(Mesh_t *pThis);
+
+/**
+ * Function: Mesh_addVertex
+ * Adds a vertex to the pool and returns its index.
+ */
+uint32_t Mesh_addVertex(Mesh_t *pThis, const Point_t *pLoc, const Color_t *pColor);
+
+/**
+ * Function: Mesh_addTriangle
+ * Adds a triangle made of the three given vertices, computes its <MeshTri_t>, and returns its index.
+ */
+uint32_t Mesh_addTriangle(Mesh_t *pThis, uint32_t a, uint32_t b, uint32_t c);
+
+/**
+ * Function: Mesh_recomputeTri
+ * Recomputes the <MeshTri_t> of one triangle from its vertices.
+ */
+void Mesh_recomputeTri(Mesh_t *pThis, unsigned int tri);
+
+/**
+ * Function: Mesh_recompute
+ * Recomputes the <MeshTri_t> of every triangle. Call this after moving vertices in place.
+ */
+Mesh_t * Mesh_recompute(Mesh_t *pThis);
+
+/**
+ * Function: Mesh_vertex
+ * Gets the location of one corner (0, 1, or 2) of a triangle.
+ */
+const Point_t * Mesh_vertex(const Mesh_t *pThis, unsigned int tri, unsigned int corner);
+
+/**
+ * Function: Mesh_intersect
+ * Like <Triangle_intersect>, for one triangle of the mesh. The arithmetic is exactly the same.
+ */
+double Mesh_intersect(const Mesh_t *pThis, unsigned int tri, Point_t *opBary, double closest_dist, const Point_t *pt, const Vect_t *vect);
+
+/**
+ * Function: Mesh_getBaryColor
+ * Like <Triangle_getBaryColor>, for one triangle of the mesh.
+ */
+Color_t * Mesh_getBaryColor(const Mesh_t *pThis, unsigned int tri, Color_t *opColor, const Point_t *pBary);
+
+/**
+ * Function: Mesh_rayCast
+ * Like <Triangle_rayCast>, for one triangle of the mesh.
+ */
+double Mesh_rayCast(const Mesh_t *pThis, unsigned int tri, Color_t *opColor, double closest_dist, const Point_t *pt, const Vect_t *vect);
+
+#endif
+//end inclusion filter
+
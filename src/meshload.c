@@ -0,0 +1,634 @@
+/**
+ * File: meshload.c
+ *
+ */
+#include "meshload.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <ctype.h>
+
+#include "mesh.h"
+#include "mapfile.h"
+#include "tilepool.h"
+#include "point.h"
+#include "color.h"
+#include "util.h"
+
+/**
+ * Constant: MESHLOAD_OBJ_CHUNK
+ * Roughly how many bytes of an OBJ file each chunk gets. Chunks are cut at line ends.
+ */
+#define MESHLOAD_OBJ_CHUNK (1 << 20)
+
+/**
+ * Constant: MESHLOAD_STL_CHUNK
+ * How many triangles of an STL file each chunk gets.
+ */
+#define MESHLOAD_STL_CHUNK 16384
+
+//// Parsing helpers ////
+
+//Powers of ten that are exactly representable as doubles.
+static const double MeshLoad_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static bool MeshLoad_isSpace(const char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static bool MeshLoad_isDigit(const char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static const char * MeshLoad_skipSpace(const char *p, const char *const end)
+{
+    while(p < end && MeshLoad_isSpace(*p)) {
+        p++;
+    }
+    return p;
+}
+
+static const char * MeshLoad_skipToken(const char *p, const char *const end)
+{
+    while(p < end && !MeshLoad_isSpace(*p)) {
+        p++;
+    }
+    return p;
+}
+
+/**
+ * Function: MeshLoad_lineEnd
+ * Finds the newline at the end of the line starting at <p>, or <end> if there isn't one.
+ */
+static const char * MeshLoad_lineEnd(const char *const p, const char *const end)
+{
+    const char *const eol = memchr(p, '\n', end - p);
+    return (eol != NULL) ? eol : end;
+}
+
+/**
+ * Function: MeshLoad_nextToken
+ * Skips to the next token on the line, and returns whether there is one. A comment
+ * ends the line.
+ */
+static bool MeshLoad_nextToken(const char **const pp, const char *const eol)
+{
+    *pp = MeshLoad_skipSpace(*pp, eol);
+    return (*pp < eol && **pp != '#');
+}
+
+/**
+ * Function: MeshLoad_parseDouble
+ *
+ * Parses the next token on the line as a number, and moves <pp> past it.
+ *
+ * Numbers with up to 19 significant digits and a small enough exponent (which is nearly
+ * all of them) are converted directly, and exactly: the digits as an integer and the power
+ * of ten are both exact doubles, so one multiply or divide rounds correctly. Anything else
+ * is handed to strtod.
+ */
+static bool MeshLoad_parseDouble(const char **const pp, const char *const eol, double *const opValue)
+{
+    const char *p;
+    const char *start;
+    const char *tok_end;
+    bool negative = false;
+    bool any = false;
+    bool exact = true;
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exp10 = 0;
+    int e, e_sign;
+    char buffer[64];
+    char *strtod_end;
+
+    if(!MeshLoad_nextToken(pp, eol)) {
+        return false;
+    }
+    start = p = *pp;
+    tok_end = MeshLoad_skipToken(start, eol);
+
+    if(*p == '-' || *p == '+') {
+        negative = (*p == '-');
+        p++;
+    }
+    while(p < tok_end && MeshLoad_isDigit(*p)) {
+        any = true;
+        if(digits < 19) {
+            mantissa = (mantissa * 10) + (*p - '0');
+            digits += (mantissa != 0);
+        }
+        else {
+            exact = exact && (*p == '0');
+            exp10++;
+        }
+        p++;
+    }
+    if(p < tok_end && *p == '.') {
+        p++;
+        while(p < tok_end && MeshLoad_isDigit(*p)) {
+            any = true;
+            if(digits < 19) {
+                mantissa = (mantissa * 10) + (*p - '0');
+                digits += (mantissa != 0);
+                exp10--;
+            }
+            else {
+                exact = exact && (*p == '0');
+            }
+            p++;
+        }
+    }
+    if(any && p < tok_end && (*p == 'e' || *p == 'E')) {
+        p++;
+        e = 0;
+        e_sign = 1;
+        if(p < tok_end && (*p == '-' || *p == '+')) {
+            e_sign = (*p == '-') ? -1 : 1;
+            p++;
+        }
+        if(!(p < tok_end && MeshLoad_isDigit(*p))) {
+            any = false;
+        }
+        while(p < tok_end && MeshLoad_isDigit(*p)) {
+            if(e < 10000) {
+                e = (e * 10) + (*p - '0');
+            }
+            p++;
+        }
+        exp10 += e_sign * e;
+    }
+
+    if(any && p == tok_end && exact && mantissa <= ((uint64_t)1 << 53) && exp10 >= -22 && exp10 <= 22) {
+        const double value = (exp10 < 0) ? (double)mantissa / MeshLoad_pow10[-exp10] : (double)mantissa * MeshLoad_pow10[exp10];
+        *opValue = negative ? -value : value;
+        *pp = tok_end;
+        return true;
+    }
+
+    //The slow way. strtod needs a terminated string, which the file isn't.
+    if((size_t)(tok_end - start) >= sizeof(buffer)) {
+        return false;
+    }
+    memcpy(buffer, start, tok_end - start);
+    buffer[tok_end - start] = '\0';
+    *opValue = strtod(buffer, &strtod_end);
+    if(strtod_end == buffer || *strtod_end != '\0') {
+        return false;
+    }
+    *pp = tok_end;
+    return true;
+}
+
+/**
+ * Function: MeshLoad_parseIndex
+ * Parses the vertex index at the start of the next token on the line (ignoring any
+ * texture or normal indices after it), and moves <pp> past the whole token.
+ */
+static bool MeshLoad_parseIndex(const char **const pp, const char *const eol, long *const opIndex)
+{
+    const char *p;
+    bool negative = false;
+    long value = 0;
+
+    if(!MeshLoad_nextToken(pp, eol)) {
+        return false;
+    }
+    p = *pp;
+    if(*p == '-' || *p == '+') {
+        negative = (*p == '-');
+        p++;
+    }
+    if(!(p < eol && MeshLoad_isDigit(*p))) {
+        return false;
+    }
+    while(p < eol && MeshLoad_isDigit(*p)) {
+        if(value < 0x7FFFFFFFL) {
+            value = (value * 10) + (*p - '0');
+        }
+        p++;
+    }
+    if(p < eol && !MeshLoad_isSpace(*p) && *p != '/') {
+        return false;
+    }
+
+    *opIndex = negative ? -value : value;
+    *pp = MeshLoad_skipToken(p, eol);
+    return true;
+}
+
+//// OBJ ////
+
+/**
+ * Struct: ObjChunk_t
+ * One chunk of an OBJ file, always a whole number of lines.
+ */
+typedef struct {
+    const char *begin;
+    const char *end;
+
+    //Counted by the first pass.
+    unsigned int verts;
+    unsigned int tris;
+    unsigned int lines;
+
+    //Totals of all the chunks before this one, so it knows where its output goes.
+    unsigned int vert_base;
+    unsigned int tri_base;
+    unsigned int line_base;
+
+    //Set by the second pass if the chunk isn't valid.
+    const char *error;
+    unsigned int error_line;
+} ObjChunk_t;
+
+typedef struct {
+    ObjChunk_t *chunks;
+    Mesh_t *mesh;
+} ObjLoad_t;
+
+/**
+ * Function: MeshLoad_objKeyword
+ * Works out what the line starting at <pp> is, and moves <pp> past the keyword: 'v' for a
+ * vertex, 'f' for a face, or 0 for anything we skip.
+ */
+static char MeshLoad_objKeyword(const char **const pp, const char *const eol)
+{
+    const char *const p = MeshLoad_skipSpace(*pp, eol);
+    if(p + 1 < eol && (*p == 'v' || *p == 'f') && MeshLoad_isSpace(p[1])) {
+        *pp = p + 1;
+        return *p;
+    }
+    return 0;
+}
+
+static void MeshLoad_objCount(void *const pCtx, const Tile_t *const pTile, const unsigned int worker)
+{
+    const ObjLoad_t *const pLoad = (const ObjLoad_t *)pCtx;
+    int c;
+    unsigned int n;
+
+    for(c=pTile->x0; c<pTile->x1; c++) {
+        ObjChunk_t *const pChunk = &(pLoad->chunks[c]);
+        const char *p = pChunk->begin;
+
+        while(p < pChunk->end) {
+            const char *const eol = MeshLoad_lineEnd(p, pChunk->end);
+            switch(MeshLoad_objKeyword(&p, eol)) {
+                case 'v':
+                    pChunk->verts++;
+                    break;
+
+                case 'f':
+                    for(n=0; MeshLoad_nextToken(&p, eol); n++) {
+                        p = MeshLoad_skipToken(p, eol);
+                    }
+                    if(n >= 3) {
+                        pChunk->tris += n - 2;
+                    }
+                    break;
+            }
+            pChunk->lines++;
+            p = (eol < pChunk->end) ? eol + 1 : pChunk->end;
+        }
+    }
+}
+
+static uint8_t MeshLoad_colorByte(const double value)
+{
+    if(!(value > 0)) {
+        return 0;
+    }
+    if(value >= 1.0) {
+        return 255;
+    }
+    return (uint8_t)((value * 255.0) + 0.5);
+}
+
+/**
+ * Function: MeshLoad_objChunk
+ * Parses one chunk into the mesh arrays. Returns an error message, or NULL.
+ */
+static const char * MeshLoad_objChunk(Mesh_t *const pMesh, ObjChunk_t *const pChunk)
+{
+    const char *p = pChunk->begin;
+    unsigned int vert = pChunk->vert_base;
+    unsigned int tri = pChunk->tri_base;
+    unsigned int n;
+    uint32_t first = 0, prev = 0, cur;
+    double xyz[3], rgb[3];
+    long index;
+
+    pChunk->error_line = pChunk->line_base;
+    while(p < pChunk->end) {
+        const char *const eol = MeshLoad_lineEnd(p, pChunk->end);
+        pChunk->error_line++;
+
+        switch(MeshLoad_objKeyword(&p, eol)) {
+            case 'v':
+                if(!(MeshLoad_parseDouble(&p, eol, &xyz[0]) && MeshLoad_parseDouble(&p, eol, &xyz[1]) && MeshLoad_parseDouble(&p, eol, &xyz[2]))) {
+                    return "bad vertex";
+                }
+                Point_cfg(&(pMesh->positions[vert]), xyz[0], xyz[1], xyz[2]);
+
+                //A color is exactly three more numbers (a fourth number on its own is a weight).
+                for(n=0; n<3 && MeshLoad_parseDouble(&p, eol, &rgb[n]); n++) {
+                }
+                if(n == 3 && !MeshLoad_nextToken(&p, eol)) {
+                    Color_cfg(&(pMesh->colors[vert]), MeshLoad_colorByte(rgb[0]), MeshLoad_colorByte(rgb[1]), MeshLoad_colorByte(rgb[2]));
+                }
+                else {
+                    Color_cfg(&(pMesh->colors[vert]), 255, 255, 255);
+                }
+                vert++;
+                break;
+
+            case 'f':
+                for(n=0; MeshLoad_nextToken(&p, eol); n++) {
+                    if(!MeshLoad_parseIndex(&p, eol, &index)) {
+                        return "bad face";
+                    }
+
+                    //Indices count from 1, or back from the last vertex so far if negative.
+                    if(index > 0 && (unsigned long)index <= pMesh->vert_count) {
+                        cur = (uint32_t)(index - 1);
+                    }
+                    else if(index < 0 && (unsigned long)(-index) <= vert) {
+                        cur = (uint32_t)(vert + index);
+                    }
+                    else {
+                        return "face refers to a vertex that doesn't exist";
+                    }
+
+                    if(n == 0) {
+                        first = cur;
+                    }
+                    else if(n >= 2) {
+                        uint32_t *const idx = &(pMesh->indices[3 * tri]);
+                        idx[0] = first;
+                        idx[1] = prev;
+                        idx[2] = cur;
+                        tri++;
+                    }
+                    prev = cur;
+                }
+                if(n < 3) {
+                    return "face with fewer than three vertices";
+                }
+                break;
+        }
+        p = (eol < pChunk->end) ? eol + 1 : pChunk->end;
+    }
+    return NULL;
+}
+
+static void MeshLoad_objParse(void *const pCtx, const Tile_t *const pTile, const unsigned int worker)
+{
+    const ObjLoad_t *const pLoad = (const ObjLoad_t *)pCtx;
+    int c;
+
+    for(c=pTile->x0; c<pTile->x1; c++) {
+        pLoad->chunks[c].error = MeshLoad_objChunk(pLoad->mesh, &(pLoad->chunks[c]));
+    }
+}
+
+static void MeshLoad_objRecompute(void *const pCtx, const Tile_t *const pTile, const unsigned int worker)
+{
+    const ObjLoad_t *const pLoad = (const ObjLoad_t *)pCtx;
+    int c;
+    unsigned int t;
+
+    for(c=pTile->x0; c<pTile->x1; c++) {
+        const ObjChunk_t *const pChunk = &(pLoad->chunks[c]);
+        for(t=pChunk->tri_base; t<pChunk->tri_base + pChunk->tris; t++) {
+            Mesh_recomputeTri(pLoad->mesh, t);
+        }
+    }
+}
+
+bool MeshLoad_obj(Mesh_t *const opMesh, const char *const path, const unsigned int threads)
+{
+    MapFile_t file;
+    ObjLoad_t load;
+    unsigned int c, chunk_count;
+    uint64_t verts = 0, tris = 0, lines = 0;
+    const char *begin, *end, *cut;
+
+    if(!MapFile_open(&file, path)) {
+        return false;
+    }
+    end = file.data + file.size;
+
+    //Cut the file into chunks, each ending just after a newline.
+    chunk_count = (unsigned int)((file.size + MESHLOAD_OBJ_CHUNK - 1) / MESHLOAD_OBJ_CHUNK);
+    if(chunk_count == 0) {
+        chunk_count = 1;
+    }
+    load.chunks = Util_allocOrDie(sizeof(ObjChunk_t) * chunk_count, "Allocating OBJ chunks.");
+    load.mesh = opMesh;
+    memset(load.chunks, 0, sizeof(ObjChunk_t) * chunk_count);
+    begin = file.data;
+    for(c=0; c<chunk_count; c++) {
+        load.chunks[c].begin = begin;
+        cut = file.data + ((size_t)(c + 1) * MESHLOAD_OBJ_CHUNK);
+        if(c + 1 == chunk_count || cut >= end) {
+            cut = end;
+        }
+        else {
+            if(cut < begin) {
+                cut = begin;
+            }
+            cut = MeshLoad_lineEnd(cut, end);
+            cut = (cut < end) ? cut + 1 : end;
+        }
+        load.chunks[c].end = cut;
+        begin = cut;
+    }
+
+    //First pass: count what's in each chunk, so we know where each chunk's output goes.
+    TilePool_run(chunk_count, 1, 1, threads, MeshLoad_objCount, &load);
+    for(c=0; c<chunk_count; c++) {
+        load.chunks[c].vert_base = (unsigned int)verts;
+        load.chunks[c].tri_base = (unsigned int)tris;
+        load.chunks[c].line_base = (unsigned int)lines;
+        verts += load.chunks[c].verts;
+        tris += load.chunks[c].tris;
+        lines += load.chunks[c].lines;
+    }
+    if(verts >= UINT32_MAX || tris >= UINT32_MAX / 3) {
+        fprintf(stderr, "%s: too many vertices or faces.\n", path);
+        free(load.chunks);
+        MapFile_close(&file);
+        return false;
+    }
+
+    //Second pass: parse straight into the mesh.
+    Mesh_cfg(opMesh, (unsigned int)verts, (unsigned int)tris);
+    opMesh->vert_count = (unsigned int)verts;
+    opMesh->tri_count = (unsigned int)tris;
+    TilePool_run(chunk_count, 1, 1, threads, MeshLoad_objParse, &load);
+    for(c=0; c<chunk_count; c++) {
+        if(load.chunks[c].error != NULL) {
+            fprintf(stderr, "%s:%u: %s.\n", path, load.chunks[c].error_line, load.chunks[c].error);
+            Mesh_destroy(opMesh);
+            free(load.chunks);
+            MapFile_close(&file);
+            return false;
+        }
+    }
+
+    //Faces can use vertices from any chunk, so the triangle data has to wait until they're all in.
+    TilePool_run(chunk_count, 1, 1, threads, MeshLoad_objRecompute, &load);
+
+    free(load.chunks);
+    MapFile_close(&file);
+    return true;
+}
+
+//// STL ////
+
+typedef struct {
+    const unsigned char *records;
+    unsigned int count;
+    Mesh_t *mesh;
+} StlLoad_t;
+
+static double MeshLoad_stlFloat(const unsigned char *const p)
+{
+    //Always little-endian, whatever this machine is.
+    const uint32_t bits = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static void MeshLoad_stlParse(void *const pCtx, const Tile_t *const pTile, const unsigned int worker)
+{
+    const StlLoad_t *const pLoad = (const StlLoad_t *)pCtx;
+    Mesh_t *const pMesh = pLoad->mesh;
+    int c;
+    unsigned int t, k, last;
+    Color_t color;
+
+    for(c=pTile->x0; c<pTile->x1; c++) {
+        last = (unsigned int)c * MESHLOAD_STL_CHUNK + MESHLOAD_STL_CHUNK;
+        if(last > pLoad->count) {
+            last = pLoad->count;
+        }
+        for(t=(unsigned int)c * MESHLOAD_STL_CHUNK; t<last; t++) {
+            //A normal (which we work out ourselves), three vertices, and two attribute bytes.
+            const unsigned char *const rec = pLoad->records + (50 * (size_t)t);
+            const unsigned int attr = rec[48] | (rec[49] << 8);
+
+            if(attr & 0x8000) {
+                const unsigned int r = (attr >> 10) & 31;
+                const unsigned int g = (attr >> 5) & 31;
+                const unsigned int b = attr & 31;
+                Color_cfg(&color, (r << 3) | (r >> 2), (g << 3) | (g >> 2), (b << 3) | (b >> 2));
+            }
+            else {
+                Color_cfg(&color, 255, 255, 255);
+            }
+
+            for(k=0; k<3; k++) {
+                const unsigned char *const v = rec + 12 + (12 * k);
+                Point_cfg(&(pMesh->positions[3*t + k]), MeshLoad_stlFloat(v), MeshLoad_stlFloat(v + 4), MeshLoad_stlFloat(v + 8));
+                Color_copy(&(pMesh->colors[3*t + k]), &color);
+                pMesh->indices[3*t + k] = 3*t + k;
+            }
+            Mesh_recomputeTri(pMesh, t);
+        }
+    }
+}
+
+/**
+ * Function: MeshLoad_stlAscii
+ * Whether a file that isn't a whole binary STL file starts like an ASCII one, which gets its
+ * own message. (A binary file's header can start with "solid" too, so this is only asked once
+ * the file has turned out not to be binary.)
+ */
+static bool MeshLoad_stlAscii(const MapFile_t *const pFile)
+{
+    return (pFile->size >= 5 && strncmp(pFile->data, "solid", 5) == 0);
+}
+
+bool MeshLoad_stl(Mesh_t *const opMesh, const char *const path, const unsigned int threads)
+{
+    MapFile_t file;
+    StlLoad_t load;
+    const unsigned char *data;
+
+    if(!MapFile_open(&file, path)) {
+        return false;
+    }
+    data = (const unsigned char *)file.data;
+
+    if(file.size < 84) {
+        if(MeshLoad_stlAscii(&file)) {
+            fprintf(stderr, "%s: looks like an ASCII STL file, only binary STL is supported.\n", path);
+        }
+        else {
+            fprintf(stderr, "%s: too short to be a binary STL file.\n", path);
+        }
+        MapFile_close(&file);
+        return false;
+    }
+    load.count = (uint32_t)data[80] | ((uint32_t)data[81] << 8) | ((uint32_t)data[82] << 16) | ((uint32_t)data[83] << 24);
+    if(file.size < 84 + (50 * (uint64_t)load.count)) {
+        if(MeshLoad_stlAscii(&file)) {
+            fprintf(stderr, "%s: looks like an ASCII STL file, only binary STL is supported.\n", path);
+        }
+        else {
+            fprintf(stderr, "%s: truncated, expected %u triangles.\n", path, load.count);
+        }
+        MapFile_close(&file);
+        return false;
+    }
+    if(load.count >= UINT32_MAX / 3) {
+        fprintf(stderr, "%s: too many triangles.\n", path);
+        MapFile_close(&file);
+        return false;
+    }
+
+    //Every record is the same size, so every chunk knows where it goes without counting.
+    Mesh_cfg(opMesh, 3 * load.count, load.count);
+    opMesh->vert_count = 3 * load.count;
+    opMesh->tri_count = load.count;
+    load.records = data + 84;
+    load.mesh = opMesh;
+    TilePool_run((int)((load.count + MESHLOAD_STL_CHUNK - 1) / MESHLOAD_STL_CHUNK), 1, 1, threads, MeshLoad_stlParse, &load);
+
+    MapFile_close(&file);
+    return true;
+}
+
+bool MeshLoad_file(Mesh_t *const opMesh, const char *const path, const unsigned int threads)
+{
+    char ext[4];
+    unsigned int i;
+    const char *const dot = strrchr(path, '.');
+
+    if(dot != NULL && strlen(dot + 1) == 3) {
+        for(i=0; i<3; i++) {
+            ext[i] = (char)tolower((unsigned char)dot[1 + i]);
+        }
+        ext[3] = '\0';
+        if(strcmp(ext, "obj") == 0) {
+            return MeshLoad_obj(opMesh, path, threads);
+        }
+        if(strcmp(ext, "stl") == 0) {
+            return MeshLoad_stl(opMesh, path, threads);
+        }
+    }
+
+    fprintf(stderr, "%s: don't know how to load this, expected a .obj or .stl file.\n", path);
+    return false;
+}
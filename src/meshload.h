@@ -0,0 +1,53 @@
+/**
+ * File: meshload.h
+ *
+ * Loads a <Mesh_t> from a Wavefront OBJ or binary STL file.
+ *
+ * The file is memory mapped and cut into chunks which are parsed in parallel over a
+ * <TilePool_run> pool, straight into the mesh's arrays: the chunks are counted first, so
+ * every chunk knows where its vertices and triangles go before any of them are parsed,
+ * and nothing is allocated per triangle.
+ */
+#ifndef MESHLOAD_H
+#define MESHLOAD_H
+
+#include <stdbool.h>
+
+#include "mesh.h"
+
+/**
+ * Function: MeshLoad_obj
+ *
+ * Loads a Wavefront OBJ file. Only vertex positions ("v" lines) and faces ("f" lines) are
+ * used. A vertex may have a color after its position, as three numbers from 0 to 1, otherwise
+ * it's white. Faces with more than three vertices are split into a fan of triangles, and any
+ * texture coordinate or normal indices on a face are ignored. Everything else is skipped.
+ *
+ * <threads> is as for <Scene_t.threads>, 0 for one per CPU.
+ *
+ * Returns false, having printed a message to stderr, if the file can't be read or isn't valid,
+ * in which case <opMesh> is not configured.
+ */
+bool MeshLoad_obj(Mesh_t *opMesh, const char *path, unsigned int threads);
+
+/**
+ * Function: MeshLoad_stl
+ *
+ * Loads a binary STL file. STL files don't share vertices between triangles, so neither does
+ * the mesh. A triangle's color comes from its attribute bytes if they hold one, as written by
+ * VisCAM and SolidView (the top bit set, and five bits each of red, green, and blue from the
+ * top), otherwise it's white. ASCII STL files are not supported.
+ *
+ * Otherwise the same as <MeshLoad_obj>.
+ */
+bool MeshLoad_stl(Mesh_t *opMesh, const char *path, unsigned int threads);
+
+/**
+ * Function: MeshLoad_file
+ * Loads a mesh with <MeshLoad_obj> or <MeshLoad_stl>, depending on the file's extension.
+ */
+bool MeshLoad_file(Mesh_t *opMesh, const char *path, unsigned int threads);
+
+#endif
+//end inclusion filter
+
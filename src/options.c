@@ -0,0 +1,314 @@
+/**
+ * File: options.c
+ *
+ */
+#include "options.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "point.h"
+#include "vect.h"
+#include "light.h"
+#include "raypacket.h"
+
+Options_t * Options_cfg(Options_t *const pThis)
+{
+    pThis->output = NULL;
+    pThis->mesh = NULL;
+    pThis->width = 200;
+    pThis->height = 200;
+    pThis->yaw = 0;
+    pThis->pitch = 20;
+    pThis->roll = 0;
+    pThis->march = -5.0;
+    pThis->has_eye = false;
+    Point_cfg(&(pThis->eye), 0, 0, 0);
+    pThis->threads = 0;
+    pThis->aa_samples = 0;
+    pThis->raster = false;
+    pThis->copies = 1;
+    pThis->cam_path = NULL;
+    pThis->frames = 60;
+    pThis->fps = 30;
+    pThis->light_count = 0;
+    pThis->ambient = 0.2;
+    pThis->procs = 0;
+    pThis->listen_port = 0;
+    pThis->remotes = 0;
+    pThis->worker = NULL;
+    pThis->stats = NULL;
+    return pThis;
+}
+
+void Options_usage(FILE *const file, const char *const prog)
+{
+    fprintf(file,
+        "Usage: %s [options]\n"
+        "\n"
+        "With no --output, the scene is shown in a window.\n"
+        "\n"
+        "  -o, --output FILE     Render to FILE (binary PPM) and exit, without a display.\n"
+        "  -m, --mesh FILE       Render the mesh in FILE (.obj or binary .stl) instead of the ring.\n"
+        "  -s, --size WxH        Image size in pixels (default 200x200).\n"
+        "      --yaw DEG         Turn the camera around its up axis.\n"
+        "      --pitch DEG       Tilt the camera around its right axis (default 20).\n"
+        "      --roll DEG        Roll the camera around its view axis.\n"
+        "      --march DIST      Move the camera along its view axis (default -5).\n"
+        "      --eye X,Y,Z       Then put the camera's eye at this point.\n"
+        "  -t, --threads N       Render threads (default: one per CPU).\n"
+        "  -a, --aa N            Antialias edges with N more samples per edge pixel (up to %d).\n"
+        "      --raster          Rasterize what each pixel sees, in the window and the output,\n"
+        "                        instead of tracing a ray for every pixel. Shading, shadows,\n"
+        "                        and scenes with --copies are still traced.\n"
+        "      --path FILE       Render an animation along the camera path in FILE. The output\n"
+        "                        is then a .y4m video, or numbered PPMs like frame%%04d.ppm.\n"
+        "      --frames N        Frames in the animation (default 60).\n"
+        "      --fps N           Frame rate written in a .y4m video's header (default 30).\n"
+        "      --copies N        Render an N by N grid of copies of the mesh, as instances.\n"
+        "      --light X,Y,Z[,I] Add a point light at this point, with intensity I (default 1).\n"
+        "      --sun X,Y,Z[,I]   Add a directional light shining along this vector.\n"
+        "      --ambient A       Light everywhere gets, from 0 to 1, if there are lights (default 0.2).\n"
+        "      --procs N         Split the output's tiles between N worker processes.\n"
+        "      --listen PORT     With --remotes, wait for workers to connect on TCP PORT.\n"
+        "      --remotes N       How many workers to wait for on the --listen port.\n"
+        "      --worker HOST:PORT  Render tiles for the coordinator at HOST:PORT, which must\n"
+        "                        have the same mesh, copies, and lights.\n"
+        "      --stats PREFIX    Count what each pixel costs and write heatmaps to PREFIX-*.ppm\n"
+        "                        (builds with RT_STATS only, e.g. `scons stats=1`).\n"
+        "  -h, --help            Show this message.\n",
+        prog, RAYPACKET_MAX
+    );
+}
+
+static bool Options_number(const char *const text, double *const opValue)
+{
+    char *end;
+    *opValue = strtod(text, &end);
+    return (end != text && *end == '\0');
+}
+
+/**
+ * Function: Options_light
+ * Parses the value of a --light or --sun option into the next light.
+ */
+static bool Options_light(Options_t *const pThis, const char *const prog, const char *const opt, const char *const val)
+{
+    double x, y, z, intensity = 1.0;
+    char extra;
+    const int count = sscanf(val, "%lf,%lf,%lf,%lf%c", &x, &y, &z, &intensity, &extra);
+    Point_t position;
+    Vect_t direction;
+
+    if(count != 3 && count != 4) {
+        fprintf(stderr, "%s: bad light for %s: %s (expected X,Y,Z or X,Y,Z,INTENSITY)\n", prog, opt, val);
+        return false;
+    }
+    if(pThis->light_count == OPTIONS_MAX_LIGHTS) {
+        fprintf(stderr, "%s: too many lights (at most %d)\n", prog, OPTIONS_MAX_LIGHTS);
+        return false;
+    }
+
+    if(strcmp(opt, "--light") == 0) {
+        Point_cfg(&position, x, y, z);
+        Light_cfgPoint(&(pThis->lights[pThis->light_count]), &position, intensity);
+    }
+    else {
+        if(x == 0 && y == 0 && z == 0) {
+            fprintf(stderr, "%s: a directional light needs a direction: %s\n", prog, val);
+            return false;
+        }
+        Vect_cfg(&direction, x, y, z);
+        Light_cfgDirectional(&(pThis->lights[pThis->light_count]), &direction, intensity);
+    }
+    pThis->light_count++;
+    return true;
+}
+
+bool Options_parse(Options_t *const pThis, const int argc, char **const argv)
+{
+    int i;
+    double x, y, z;
+    unsigned int n;
+    char extra;
+
+    for(i=1; i<argc; i++) {
+        const char *const opt = argv[i];
+
+        if(strcmp(opt, "-h") == 0 || strcmp(opt, "--help") == 0) {
+            Options_usage(stdout, argv[0]);
+            exit(0);
+        }
+
+        if(strcmp(opt, "--raster") == 0) {
+            pThis->raster = true;
+            continue;
+        }
+
+        //Every other option takes a value.
+        if(i+1 >= argc) {
+            fprintf(stderr, "%s: unknown option or missing value: %s\n", argv[0], opt);
+            Options_usage(stderr, argv[0]);
+            return false;
+        }
+        const char *const val = argv[++i];
+
+        if(strcmp(opt, "-o") == 0 || strcmp(opt, "--output") == 0) {
+            pThis->output = val;
+        }
+        else if(strcmp(opt, "-m") == 0 || strcmp(opt, "--mesh") == 0) {
+            pThis->mesh = val;
+        }
+        else if(strcmp(opt, "-s") == 0 || strcmp(opt, "--size") == 0) {
+            if(sscanf(val, "%dx%d%c", &(pThis->width), &(pThis->height), &extra) != 2 || pThis->width <= 0 || pThis->height <= 0) {
+                fprintf(stderr, "%s: bad size: %s (expected WIDTHxHEIGHT)\n", argv[0], val);
+                return false;
+            }
+        }
+        else if(strcmp(opt, "--yaw") == 0 || strcmp(opt, "--pitch") == 0 || strcmp(opt, "--roll") == 0 || strcmp(opt, "--march") == 0) {
+            if(!Options_number(val, &x)) {
+                fprintf(stderr, "%s: bad number for %s: %s\n", argv[0], opt, val);
+                return false;
+            }
+            if(strcmp(opt, "--yaw") == 0) {
+                pThis->yaw = x;
+            }
+            else if(strcmp(opt, "--pitch") == 0) {
+                pThis->pitch = x;
+            }
+            else if(strcmp(opt, "--roll") == 0) {
+                pThis->roll = x;
+            }
+            else {
+                pThis->march = x;
+            }
+        }
+        else if(strcmp(opt, "--eye") == 0) {
+            if(sscanf(val, "%lf,%lf,%lf%c", &x, &y, &z, &extra) != 3) {
+                fprintf(stderr, "%s: bad point: %s (expected X,Y,Z)\n", argv[0], val);
+                return false;
+            }
+            pThis->has_eye = true;
+            Point_cfg(&(pThis->eye), x, y, z);
+        }
+        else if(strcmp(opt, "-t") == 0 || strcmp(opt, "--threads") == 0) {
+            if(sscanf(val, "%u%c", &n, &extra) != 1) {
+                fprintf(stderr, "%s: bad thread count: %s\n", argv[0], val);
+                return false;
+            }
+            pThis->threads = n;
+        }
+        else if(strcmp(opt, "-a") == 0 || strcmp(opt, "--aa") == 0) {
+            if(sscanf(val, "%u%c", &n, &extra) != 1 || n > RAYPACKET_MAX) {
+                fprintf(stderr, "%s: bad antialiasing sample count: %s (expected 0 to %d)\n", argv[0], val, RAYPACKET_MAX);
+                return false;
+            }
+            pThis->aa_samples = n;
+        }
+        else if(strcmp(opt, "--path") == 0) {
+            pThis->cam_path = val;
+        }
+        else if(strcmp(opt, "--frames") == 0 || strcmp(opt, "--fps") == 0) {
+            if(sscanf(val, "%u%c", &n, &extra) != 1 || n == 0) {
+                fprintf(stderr, "%s: bad number for %s: %s\n", argv[0], opt, val);
+                return false;
+            }
+            if(strcmp(opt, "--frames") == 0) {
+                pThis->frames = n;
+            }
+            else {
+                pThis->fps = n;
+            }
+        }
+        else if(strcmp(opt, "--copies") == 0) {
+            if(sscanf(val, "%u%c", &n, &extra) != 1 || n == 0) {
+                fprintf(stderr, "%s: bad number of copies: %s\n", argv[0], val);
+                return false;
+            }
+            pThis->copies = n;
+        }
+        else if(strcmp(opt, "--light") == 0 || strcmp(opt, "--sun") == 0) {
+            if(!Options_light(pThis, argv[0], opt, val)) {
+                return false;
+            }
+        }
+        else if(strcmp(opt, "--ambient") == 0) {
+            if(!Options_number(val, &x) || x < 0 || x > 1) {
+                fprintf(stderr, "%s: bad ambient light: %s (expected 0 to 1)\n", argv[0], val);
+                return false;
+            }
+            pThis->ambient = x;
+        }
+        else if(strcmp(opt, "--procs") == 0 || strcmp(opt, "--remotes") == 0) {
+#ifdef _WIN32
+            fprintf(stderr, "%s: %s needs worker processes, which aren't available on Windows\n", argv[0], opt);
+            return false;
+#endif
+            if(sscanf(val, "%u%c", &n, &extra) != 1) {
+                fprintf(stderr, "%s: bad number for %s: %s\n", argv[0], opt, val);
+                return false;
+            }
+            if(strcmp(opt, "--procs") == 0) {
+                pThis->procs = n;
+            }
+            else {
+                pThis->remotes = n;
+            }
+        }
+        else if(strcmp(opt, "--listen") == 0) {
+#ifdef _WIN32
+            fprintf(stderr, "%s: --listen needs worker processes, which aren't available on Windows\n", argv[0]);
+            return false;
+#endif
+            if(sscanf(val, "%u%c", &n, &extra) != 1 || n == 0 || n > 65535) {
+                fprintf(stderr, "%s: bad port: %s\n", argv[0], val);
+                return false;
+            }
+            pThis->listen_port = (unsigned short)n;
+        }
+        else if(strcmp(opt, "--worker") == 0) {
+#ifdef _WIN32
+            fprintf(stderr, "%s: --worker needs POSIX sockets, which aren't available on Windows\n", argv[0]);
+            return false;
+#endif
+            pThis->worker = val;
+        }
+        else if(strcmp(opt, "--stats") == 0) {
+#ifndef RT_STATS
+            fprintf(stderr, "%s: --stats needs a build with RT_STATS defined (e.g., scons stats=1)\n", argv[0]);
+            return false;
+#endif
+            pThis->stats = val;
+        }
+        else {
+            fprintf(stderr, "%s: unknown option: %s\n", argv[0], opt);
+            Options_usage(stderr, argv[0]);
+            return false;
+        }
+    }
+
+    if(pThis->cam_path != NULL && pThis->output == NULL) {
+        fprintf(stderr, "%s: --path needs an --output to write the frames to\n", argv[0]);
+        return false;
+    }
+    if((pThis->remotes > 0) != (pThis->listen_port > 0)) {
+        fprintf(stderr, "%s: --listen and --remotes go together\n", argv[0]);
+        return false;
+    }
+    if((pThis->procs > 0 || pThis->remotes > 0) && pThis->output == NULL) {
+        fprintf(stderr, "%s: worker processes only render to an --output\n", argv[0]);
+        return false;
+    }
+    if(pThis->stats != NULL && (pThis->output == NULL || pThis->procs > 0 || pThis->remotes > 0)) {
+        fprintf(stderr, "%s: --stats counts an --output rendered in this process\n", argv[0]);
+        return false;
+    }
+    if(pThis->worker != NULL && (pThis->output != NULL || pThis->procs > 0 || pThis->remotes > 0)) {
+        fprintf(stderr, "%s: a --worker renders for its coordinator, not an --output of its own\n", argv[0]);
+        return false;
+    }
+    return true;
+}
+
@@ -0,0 +1,159 @@
+/**
+ * File: options.h
+ *
+ * Command line options for the main program.
+ */
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "point.h"
+#include "light.h"
+
+/**
+ * Constant: OPTIONS_MAX_LIGHTS
+ * Most lights that can be given on the command line.
+ */
+#define OPTIONS_MAX_LIGHTS 4
+
+/**
+ * Struct: Options_t
+ */
+typedef struct {
+    /**
+     * Field: output
+     * File to write the rendered image to. If this is NULL, the image is shown in a GTK
+     * window instead. Otherwise GTK is never initialized at all, so this works with no display.
+     */
+    const char *output;
+
+    /**
+     * Field: mesh
+     * OBJ or STL file to render instead of the built in scene, or NULL.
+     */
+    const char *mesh;
+
+    int width;
+    int height;
+
+    /**
+     * Fields: yaw, pitch, roll, march
+     * The camera pose, applied in this order to a camera that starts at the origin looking
+     * along the Z axis. Angles are in degrees.
+     */
+    double yaw;
+    double pitch;
+    double roll;
+    double march;
+
+    /**
+     * Fields: has_eye, eye
+     * If <has_eye> is set, the camera is then moved so its eye is at <eye>.
+     */
+    bool has_eye;
+    Point_t eye;
+
+    /**
+     * Field: threads
+     * Render threads, 0 for one per CPU.
+     */
+    unsigned int threads;
+
+    /**
+     * Field: aa_samples
+     * Extra samples for each pixel along an edge, 0 for no antialiasing. See <Scene_t.aa_samples>.
+     */
+    unsigned int aa_samples;
+
+    /**
+     * Field: raster
+     * Whether to rasterize the primary visibility of images written to <output>. See
+     * <Scene_t.raster>.
+     */
+    bool raster;
+
+    /**
+     * Field: copies
+     * Render a <copies> by <copies> grid of instances of the mesh, instead of just the one
+     * mesh. See <Instance_t>.
+     */
+    unsigned int copies;
+
+    /**
+     * Fields: cam_path, frames, fps
+     * If <cam_path> is set, render an animation of <frames> frames along the camera path in that
+     * file (see <CamPath_load>) to <output>, instead of a single image, and with the camera
+     * options ignored. <fps> is only used for the header of a Y4M stream. See <FrameWriter_t>.
+     */
+    const char *cam_path;
+    unsigned int frames;
+    unsigned int fps;
+
+    /**
+     * Fields: lights, light_count
+     * Point and directional lights, in the order given. With none, the scene is unlit, as
+     * described for <Scene_t.lights>.
+     */
+    Light_t lights[OPTIONS_MAX_LIGHTS];
+    unsigned int light_count;
+
+    /**
+     * Field: ambient
+     * See <Scene_t.ambient>.
+     */
+    double ambient;
+
+    /**
+     * Field: procs
+     * Worker processes to fork and render with, or 0 to render in this one. See <TileFarm_t>.
+     */
+    unsigned int procs;
+
+    /**
+     * Fields: listen_port, remotes
+     * If <remotes> is set, wait for that many workers to connect on TCP <listen_port> and
+     * render with them too.
+     */
+    unsigned short listen_port;
+    unsigned int remotes;
+
+    /**
+     * Field: worker
+     * HOST:PORT of a coordinator to connect to and render tiles for, instead of rendering an
+     * image of its own, or NULL. See <TileFarm_serve>.
+     */
+    const char *worker;
+
+    /**
+     * Field: stats
+     * Prefix for the heatmaps of what each pixel cost to render (see <RayStatsMap_writeHeatmaps>),
+     * or NULL. Only builds with RT_STATS can count.
+     */
+    const char *stats;
+} Options_t;
+
+/**
+ * Function: Options_cfg
+ * Configures the options with their defaults.
+ */
+Options_t * Options_cfg(Options_t *pThis);
+
+/**
+ * Function: Options_parse
+ * Parses the command line into the options (which should already have their defaults).
+ *
+ * Returns false, having printed a message to stderr, if the command line isn't valid.
+ */
+bool Options_parse(Options_t *pThis, int argc, char **argv);
+
+/**
+ * Function: Options_usage
+ * Prints a summary of the options.
+ */
+void Options_usage(FILE *file, const char *prog);
+
+#endif
+//end inclusion filter
+
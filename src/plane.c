@@ -22,6 +22,17 @@ Plane_t * Plane_clone(const Plane_t *const pRhs)
     return Util_cloneOrDie(pRhs, sizeof(Plane_t), "Cloning a Plane_t object.");
 }
 
+Plane_t * Plane_inArena(Arena_t *const pArena, const double a, const double b, const double c, const double d)
+{
+    Plane_t *const pThis = Arena_alloc(pArena, sizeof(Plane_t), "Allocating a Plane_t object in an arena.");
+    return Plane_cfg(pThis, a, b, c, d);
+}
+
+Plane_t * Plane_cloneInArena(Arena_t *const pArena, const Plane_t *const pRhs)
+{
+    return Arena_clone(pArena, pRhs, sizeof(Plane_t), "Cloning a Plane_t object into an arena.");
+}
+
 Plane_t * Plane_cfg(Plane_t *const pThis, double a, double b, double c, double d)
 {
     pThis->params[0] = a;
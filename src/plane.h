@@ -7,6 +7,7 @@
 
 #include "point.h"
 #include "vect.h"
+#include "util.h"
 
 /**
  *
@@ -37,6 +38,19 @@ Plane_t * Plane(double a, double b, double c, double d);
  */
 Plane_t * Plane_clone(const Plane_t *pRhs);
 
+/**
+ * Function: Plane_inArena
+ * Like <Plane>, but allocates the object from the arena, so it's freed along with everything
+ * else in it.
+ */
+Plane_t * Plane_inArena(Arena_t *pArena, double a, double b, double c, double d);
+
+/**
+ * Function: Plane_cloneInArena
+ * Like <Plane_clone>, but allocates the copy from the arena.
+ */
+Plane_t * Plane_cloneInArena(Arena_t *pArena, const Plane_t *pRhs);
+
 /**
  * Function: Plane_cfg
  * Configures the Plane object with the given parameters, where the plane is 
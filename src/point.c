@@ -11,7 +11,7 @@
 #include "util.h"
 #include "vect.h"
 
-Point_t * Point_cfg(Point_t *const pThis, const double x, const double y, const double z)
+Point_t * Point_cfg(Point_t *const pThis, const Real_t x, const Real_t y, const Real_t z)
 {
     pThis->x = x;
     pThis->y = y;
@@ -24,7 +24,7 @@ Point_t * Point_copy(Point_t * pThis,  const Point_t *pRhs)
     return Point_cfg(pThis, pRhs->x, pRhs->y, pRhs->z);
 }
 
-Point_t * Point(const double x, const double y, const double z)
+Point_t * Point(const Real_t x, const Real_t y, const Real_t z)
 {
     Point_t *const pThis = Util_allocOrDie(sizeof(Point_t), "Allocating a Point_t object.");
     if(pThis != NULL) {
@@ -43,6 +43,17 @@ Point_t * Point_clone(const Point_t *const pRhs)
     return Util_cloneOrDie(pRhs, sizeof(Point_t), "Cloning a Point_t object.");
 }
 
+Point_t * Point_inArena(Arena_t *const pArena, const Real_t x, const Real_t y, const Real_t z)
+{
+    Point_t *const pThis = Arena_alloc(pArena, sizeof(Point_t), "Allocating a Point_t object in an arena.");
+    return Point_cfg(pThis, x, y, z);
+}
+
+Point_t * Point_cloneInArena(Arena_t *const pArena, const Point_t *const pRhs)
+{
+    return Arena_clone(pArena, pRhs, sizeof(Point_t), "Cloning a Point_t object into an arena.");
+}
+
 Point_t * Point_translate(Point_t *opPoint, const Point_t *pPt, const Vect_t *pTrans)
 {
     return Point_cfg(opPoint, pPt->x+pTrans->x, pPt->y+pTrans->y, pPt->z+pTrans->z);
@@ -58,9 +69,9 @@ Vect_t * Point_displacement(Vect_t *const opDisp, const Point_t *const pA, const
     return Vect_cfg(opDisp, pB->x - pA->x, pB->y - pA->y, pB->z - pA->z);
 }
 
-double Point_distance(const Point_t *const pThis, const Point_t *const pOther)
+Real_t Point_distance(const Point_t *const pThis, const Point_t *const pOther)
 {
-    double dx, dy, dz;
+    Real_t dx, dy, dz;
     const Point_t this = *pThis;
     const Point_t other = *pOther;
 
@@ -68,7 +79,7 @@ double Point_distance(const Point_t *const pThis, const Point_t *const pOther)
     dy = this.y - other.y;
     dz = this.z - other.z;
 
-    return sqrt(dx*dx + dy*dy + dz*dz);
+    return Real_sqrt(dx*dx + dy*dy + dz*dz);
 }
 
 
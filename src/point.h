@@ -6,12 +6,13 @@
 #define POINT_H
 
 #include "types.h"
+#include "util.h"
 
 /**
  * Function: Point_cfg
  * Configures the given <Point_t> object and returns a pointer to the same object for convenience.
  */
-Point_t * Point_cfg(Point_t * pThis,  double x,  double y,  double z);
+Point_t * Point_cfg(Point_t * pThis,  Real_t x,  Real_t y,  Real_t z);
 
 /**
  * Function: Point_copy
@@ -26,7 +27,7 @@ Point_t * Point_copy(Point_t * pThis,  const Point_t *pRhs);
  *
  * Aborts the program if there is not enough memory.
  */
-Point_t * Point(double x, double y, double z);
+Point_t * Point(Real_t x, Real_t y, Real_t z);
 
 /**
  * Function: Point_clone
@@ -37,6 +38,19 @@ Point_t * Point(double x, double y, double z);
  */
 Point_t * Point_clone(const Point_t* pRhs);
 
+/**
+ * Function: Point_inArena
+ * Like <Point>, but allocates the object from the arena, so it's freed along with everything
+ * else in it.
+ */
+Point_t * Point_inArena(Arena_t *pArena, Real_t x, Real_t y, Real_t z);
+
+/**
+ * Function: Point_cloneInArena
+ * Like <Point_clone>, but allocates the copy from the arena.
+ */
+Point_t * Point_cloneInArena(Arena_t *pArena, const Point_t *pRhs);
+
 /**
  * Function: Point_zero
  * Dynamically allocates a <Point_t> with coordinate values all set to 0.
@@ -49,7 +63,7 @@ Point_t * Point_zero(void);
  *
  * Returns the distance between two points.
  */
-double Point_distance(const Point_t *pThis, const Point_t *pOther);
+Real_t Point_distance(const Point_t *pThis, const Point_t *pOther);
 
 /**
  * Function: Point_translate
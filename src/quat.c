@@ -11,8 +11,9 @@
 #include "vect.h"
 #include "vertex.h"
 #include "triangle.h"
+#include "xform.h"
 
-Quat_t * Quat_cfg(Quat_t *pThis, double w, double x, double y, double z)
+Quat_t * Quat_cfg(Quat_t *pThis, Real_t w, Real_t x, Real_t y, Real_t z)
 {
     pThis->w = w;
     pThis->x = x;
@@ -26,7 +27,7 @@ Quat_t * Quat_copy(Quat_t *pThis, const Quat_t *pRhs)
     return Quat_cfg(pThis, pRhs->w, pRhs->x, pRhs->y, pRhs->z);
 }
 
-Quat_t * Quat(double w, double x, double y, double z)
+Quat_t * Quat(Real_t w, Real_t x, Real_t y, Real_t z)
 {
     Quat_t *const pThis = Util_allocOrDie(sizeof(Quat_t), "Allocating a Quat_t object.");
     if(pThis != NULL) {
@@ -40,19 +41,30 @@ Quat_t * Quat_clone(const Quat_t *pRhs)
     return Util_cloneOrDie(pRhs, sizeof(Quat_t), "Cloning a Quat_t object.");
 }
 
+Quat_t * Quat_inArena(Arena_t *const pArena, const Real_t w, const Real_t x, const Real_t y, const Real_t z)
+{
+    Quat_t *const pThis = Arena_alloc(pArena, sizeof(Quat_t), "Allocating a Quat_t object in an arena.");
+    return Quat_cfg(pThis, w, x, y, z);
+}
+
+Quat_t * Quat_cloneInArena(Arena_t *const pArena, const Quat_t *const pRhs)
+{
+    return Arena_clone(pArena, pRhs, sizeof(Quat_t), "Cloning a Quat_t object into an arena.");
+}
+
 Quat_t * Quat_zero(void)
 {
     return Quat(0, 0, 0, 0);
 }
 
 
-Quat_t * Quat_rotation(Quat_t *pThis, const Vect_t *pAxis, double rads)
+Quat_t * Quat_rotation(Quat_t *pThis, const Vect_t *pAxis, Real_t rads)
 {
     //For rotation by A rads around unit-vector axis (x,y,z), we use the quat
     // (cos(A/2), x*sin(A/2), y*sin(A/2), z*sin(A/2)).
 
-    double lat;
-    double length;
+    Real_t lat;
+    Real_t length;
     Vect_t imag;
     
     //Get the "latitude"-ish, just half the angle.
@@ -62,22 +74,22 @@ Quat_t * Quat_rotation(Quat_t *pThis, const Vect_t *pAxis, double rads)
     length = Vect_magnitude(pAxis);
 
     //And scale the vector appropriately.
-    Vect_scale(&imag, pAxis, sin(lat)/length);
+    Vect_scale(&imag, pAxis, Real_sin(lat)/length);
 
-    return Quat_cfg(pThis, cos(lat), imag.x, imag.y, imag.z);
+    return Quat_cfg(pThis, Real_cos(lat), imag.x, imag.y, imag.z);
 }
 
 Quat_t * Quat_product(Quat_t *opThis, const Quat_t *pA, const Quat_t *pB)
 {
-    const double a1 = pA->w;
-    const double b1 = pA->x;
-    const double c1 = pA->y;
-    const double d1 = pA->z;
+    const Real_t a1 = pA->w;
+    const Real_t b1 = pA->x;
+    const Real_t c1 = pA->y;
+    const Real_t d1 = pA->z;
 
-    const double a2 = pB->w;
-    const double b2 = pB->x;
-    const double c2 = pB->y;
-    const double d2 = pB->z;
+    const Real_t a2 = pB->w;
+    const Real_t b2 = pB->x;
+    const Real_t c2 = pB->y;
+    const Real_t d2 = pB->z;
 
     return Quat_cfg(
         opThis,
@@ -93,7 +105,42 @@ Quat_t * Quat_conjugate(Quat_t *opThis, const Quat_t *pRhs)
     return Quat_cfg(opThis, pRhs->w, -(pRhs->x), -(pRhs->y), -(pRhs->z));
 }
 
-static void Quat_rotateTuple(const Quat_t *pThis, double coords[3])
+Quat_t * Quat_slerp(Quat_t *opThis, const Quat_t *pA, const Quat_t *pB, Real_t t)
+{
+    Real_t wa, wb, length;
+    Real_t dot = (pA->w * pB->w) + (pA->x * pB->x) + (pA->y * pB->y) + (pA->z * pB->z);
+    Real_t sign = 1;
+
+    //Q and -Q are the same rotation; pick the one that's less than half a turn away.
+    if(dot < 0) {
+        dot = -dot;
+        sign = -1;
+    }
+
+    if(dot > 1 - 1e-4) {
+        wa = 1 - t;
+        wb = t;
+    }
+    else {
+        const Real_t angle = Real_acos(dot);
+        const Real_t sin_angle = Real_sin(angle);
+        wa = Real_sin((1 - t) * angle) / sin_angle;
+        wb = Real_sin(t * angle) / sin_angle;
+    }
+    wb *= sign;
+
+    Quat_cfg(opThis,
+        (wa * pA->w) + (wb * pB->w),
+        (wa * pA->x) + (wb * pB->x),
+        (wa * pA->y) + (wb * pB->y),
+        (wa * pA->z) + (wb * pB->z));
+
+    //Exact for the slerp up to rounding, but needed for the linear fallback.
+    length = Real_sqrt((opThis->w * opThis->w) + (opThis->x * opThis->x) + (opThis->y * opThis->y) + (opThis->z * opThis->z));
+    return Quat_cfg(opThis, opThis->w / length, opThis->x / length, opThis->y / length, opThis->z / length);
+}
+
+static void Quat_rotateTuple(const Quat_t *pThis, Real_t coords[3])
 {
     Quat_t pt, conj, prod, result;
 
@@ -113,21 +160,21 @@ static void Quat_rotateTuple(const Quat_t *pThis, double coords[3])
 
 Point_t * Quat_rotatePoint(const Quat_t *pThis, Point_t *opRotated, const Point_t *pPoint)
 {
-    double coords[3] = {pPoint->x, pPoint->y, pPoint->z};
+    Real_t coords[3] = {pPoint->x, pPoint->y, pPoint->z};
     Quat_rotateTuple(pThis, coords);
     return Point_cfg(opRotated, coords[0], coords[1], coords[2]);
 }
 
 Vect_t * Quat_rotateVect(const Quat_t *pThis, Vect_t *opRotated, const Vect_t *pVect)
 {
-    double coords[3] = {pVect->x, pVect->y, pVect->z};
+    Real_t coords[3] = {pVect->x, pVect->y, pVect->z};
     Quat_rotateTuple(pThis, coords);
     return Vect_cfg(opRotated, coords[0], coords[1], coords[2]);
 }
 
 Vertex_t * Quat_rotateVertexInPlace(const Quat_t *pThis, Vertex_t *pVertex)
 {
-    double coords[3] = {pVertex->loc.x, pVertex->loc.y, pVertex->loc.z};
+    Real_t coords[3] = {pVertex->loc.x, pVertex->loc.y, pVertex->loc.z};
     Quat_rotateTuple(pThis, coords);
     Point_cfg(&(pVertex->loc), coords[0], coords[1], coords[2]);
     return pVertex;
@@ -135,9 +182,11 @@ Vertex_t * Quat_rotateVertexInPlace(const Quat_t *pThis, Vertex_t *pVertex)
 
 Triangle_t * Quat_rotateTriangleInPlace(const Quat_t *pThis, Triangle_t *pTriangle)
 {
-    Quat_rotateVertexInPlace(pThis, &(pTriangle->vert[0]));
-    Quat_rotateVertexInPlace(pThis, &(pTriangle->vert[1]));
-    Quat_rotateVertexInPlace(pThis, &(pTriangle->vert[2]));
+    Xform_t rot;
+
+    //One matrix for all three vertices is cheaper than three pairs of quat products.
+    Xform_fromQuat(&rot, pThis, NULL);
+    Xform_triangles(&rot, pTriangle, 1);
     return pTriangle;
 }
 
@@ -41,22 +41,27 @@
 #include "point.h"
 #include "vertex.h"
 #include "triangle.h"
+#include "util.h"
 
 typedef struct {
-    double w;
-    double x;
-    double y;
-    double z;
+    Real_t w;
+    Real_t x;
+    Real_t y;
+    Real_t z;
 } Quat_t;
 
-Quat_t * Quat_cfg(Quat_t *pThis, double w, double x, double y, double z);
+Quat_t * Quat_cfg(Quat_t *pThis, Real_t w, Real_t x, Real_t y, Real_t z);
 
 Quat_t * Quat_copy(Quat_t *pThis, const Quat_t *pRhs);
 
-Quat_t * Quat(double w, double x, double y, double z);
+Quat_t * Quat(Real_t w, Real_t x, Real_t y, Real_t z);
 
 Quat_t * Quat_clone(const Quat_t *pRhs);
 
+Quat_t * Quat_inArena(Arena_t *pArena, Real_t w, Real_t x, Real_t y, Real_t z);
+
+Quat_t * Quat_cloneInArena(Arena_t *pArena, const Quat_t *pRhs);
+
 Quat_t * Quat_zero(void);
 
 /**
@@ -69,9 +74,9 @@ Quat_t * Quat_zero(void);
  * Arguments:
  *  pThis   -   <Quat_t>* : The output structure to hold the quaternion that represents the rotation.
  *  pAxis   -   const <Vect_t>* : The vector representing the axis of rotation.
- *  rads    -   double : The angle of rotation, in radians.
+ *  rads    -   Real_t : The angle of rotation, in radians.
  */
-Quat_t * Quat_rotation(Quat_t *pThis, const Vect_t *pAxis, double rads);
+Quat_t * Quat_rotation(Quat_t *pThis, const Vect_t *pAxis, Real_t rads);
 
 /**
  * Function: Quat_product
@@ -89,6 +94,18 @@ Quat_t * Quat_product(Quat_t *opThis, const Quat_t *pA, const Quat_t *pB);
  */
 Quat_t * Quat_conjugate(Quat_t *opThis, const Quat_t *pRhs);
 
+/**
+ * Function: Quat_slerp
+ *
+ * Spherical linear interpolation between two unit quats: the rotation <t> of the way from
+ * <pA> to <pB>, turning at a constant rate around a single axis. <t> of 0 gives <pA>, and 1
+ * gives <pB> (or its negation, which is the same rotation).
+ *
+ * Always takes the shorter way round. Where the two are so close that the angle between them
+ * can't be worked out accurately, this falls back to a normalized linear interpolation.
+ */
+Quat_t * Quat_slerp(Quat_t *opThis, const Quat_t *pA, const Quat_t *pB, Real_t t);
+
 /**
  * Function: Quat_rotatePoint
  *
@@ -109,6 +126,15 @@ Vect_t * Quat_rotateVect(const Quat_t *pThis, Vect_t *opRotated, const Vect_t *p
 
 Vertex_t * Quat_rotateVertexInPlace(const Quat_t *pThis, Vertex_t *pVertex);
 
+/**
+ * Function: Quat_rotateTriangleInPlace
+ * Rotates the vertices of a triangle and recomputes it. To rotate many triangles (or a whole
+ * <Mesh_t>) by the same quat, make an <Xform_t> of it once with <Xform_fromQuat> and use the
+ * batch functions there instead.
+ *
+ * The quat must be a unit quat, as for <Xform_fromQuat>: the matrix is built assuming it, so a
+ * non-unit quat gives unspecified results rather than a rotation scaled by its squared length.
+ */
 Triangle_t * Quat_rotateTriangleInPlace(const Quat_t *pThis, Triangle_t *pTriangle);
 
 #endif
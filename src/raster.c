@@ -0,0 +1,425 @@
+/**
+ * File: raster.c
+ *
+ */
+#include "raster.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mesh.h"
+#include "frame.h"
+#include "triblock.h"
+#include "tilepool.h"
+#include "point.h"
+#include "util.h"
+
+/**
+ * Constant: RASTER_PROJECT_BATCH
+ * How many triangles each of the projecting threads takes at a time.
+ */
+#define RASTER_PROJECT_BATCH 1024
+
+/**
+ * Struct: RasterJob_t
+ * Everything the projecting threads need.
+ */
+typedef struct {
+    Raster_t *raster;
+    const Mesh_t *mesh;
+    double eye[3];
+
+    /**
+     * Field: inv
+     * Rows of the inverse of the matrix whose columns are the vector from the eye to the frame's
+     * top left corner, and the frame's steps right and down. It takes a point's offset from the
+     * eye to (w, w*col, w*row), where (col, row) is where it is on the frame and w is how far it
+     * is from the eye, in lengths of the ray to the frame.
+     */
+    double inv[3][3];
+} RasterJob_t;
+
+Raster_t * Raster_cfg(Raster_t *const pThis)
+{
+    pThis->tris = NULL;
+    pThis->tri_count = 0;
+    pThis->tri_capacity = 0;
+    pThis->width = 0;
+    pThis->height = 0;
+    pThis->bins_x = 0;
+    pThis->bins_y = 0;
+    pThis->bin_starts = NULL;
+    pThis->bin_capacity = 0;
+    pThis->binned = NULL;
+    pThis->binned_count = 0;
+    pThis->binned_capacity = 0;
+    return pThis;
+}
+
+void Raster_destroy(Raster_t *const pThis)
+{
+    free(pThis->tris);
+    free(pThis->bin_starts);
+    free(pThis->binned);
+    Raster_cfg(pThis);
+}
+
+/**
+ * Function: Raster_pixel
+ * Clamps a pixel coordinate to [0, <limit>], with NaN going to 0.
+ */
+static int Raster_pixel(const double x, const int limit)
+{
+    if(!(x >= 0)) {
+        return 0;
+    }
+    if(!(x < limit)) {
+        return limit;
+    }
+    return (int)x;
+}
+
+/**
+ * Function: Raster_setup
+ * Sets up a projected triangle from its corners, each given as (col, row, 1 / w).
+ */
+static void Raster_setup(const Raster_t *const pThis, RasterTri_t *const opTri, const double *const *const corners, const uint32_t id)
+{
+    const double *const v0 = corners[0];
+    const double *const v1 = corners[1];
+    const double *const v2 = corners[2];
+    const double area = ((v1[0] - v0[0]) * (v2[1] - v0[1])) - ((v2[0] - v0[0]) * (v1[1] - v0[1]));
+    const double sign = (area < 0) ? -1.0 : 1.0;
+    double lo[2], hi[2], len, dx, dy;
+    int k, c;
+
+    //Edge k runs between the two corners other than k, and is positive on corner k's side, or
+    // all zero if those two corners are in the same place.
+    for(k=0; k<3; k++) {
+        const double *const a = corners[(k + 1) % 3];
+        const double *const b = corners[(k + 2) % 3];
+        double *const e = opTri->edges[k];
+        e[0] = a[1] - b[1];
+        e[1] = b[0] - a[0];
+        e[2] = (a[0] * b[1]) - (b[0] * a[1]);
+        len = sqrt((e[0] * e[0]) + (e[1] * e[1]));
+        for(c=0; c<3; c++) {
+            e[c] = (len > 0) ? e[c] * sign / len : 0;
+        }
+    }
+
+    //The reciprocal depth is linear over the triangle. One seen edge on has no plane to speak
+    // of, so it gets its closest.
+    opTri->depth_min = fmin(fmin(v0[2], v1[2]), v2[2]);
+    opTri->depth_max = fmax(fmax(v0[2], v1[2]), v2[2]);
+    dx = 0;
+    dy = 0;
+    if(area != 0) {
+        dx = (((v1[2] - v0[2]) * (v2[1] - v0[1])) - ((v2[2] - v0[2]) * (v1[1] - v0[1]))) / area;
+        dy = (((v1[0] - v0[0]) * (v2[2] - v0[2])) - ((v2[0] - v0[0]) * (v1[2] - v0[2]))) / area;
+    }
+    opTri->depth[0] = dx;
+    opTri->depth[1] = dy;
+    opTri->depth[2] = (area != 0) ? v0[2] - (dx * v0[0]) - (dy * v0[1]) : opTri->depth_max;
+
+    //Every pixel whose point could be within the margin of the triangle.
+    for(c=0; c<2; c++) {
+        lo[c] = fmin(fmin(v0[c], v1[c]), v2[c]);
+        hi[c] = fmax(fmax(v0[c], v1[c]), v2[c]);
+    }
+    opTri->x0 = Raster_pixel(ceil(lo[0] - RASTER_EDGE_MARGIN), pThis->width);
+    opTri->x1 = Raster_pixel(floor(hi[0] + RASTER_EDGE_MARGIN) + 1, pThis->width);
+    opTri->y0 = Raster_pixel(ceil(lo[1] - RASTER_EDGE_MARGIN), pThis->height);
+    opTri->y1 = Raster_pixel(floor(hi[1] + RASTER_EDGE_MARGIN) + 1, pThis->height);
+    opTri->id = (opTri->x0 < opTri->x1 && opTri->y0 < opTri->y1) ? id : TRIBLOCK_EMPTY;
+}
+
+/**
+ * Function: Raster_projectTri
+ * Projects triangle <t> of the mesh into its two slots.
+ */
+static void Raster_projectTri(const RasterJob_t *const pJob, const unsigned int t)
+{
+    RasterTri_t *const pSlots = &(pJob->raster->tris[2 * t]);
+    double corners[3][3], clipped[4][3], screen[4][3], d[3];
+    const double *fan[3];
+    unsigned int count = 0, k, c;
+
+    //Each corner as (w, w*col, w*row), which is linear in its position, so it can be clipped
+    // as it is.
+    for(k=0; k<3; k++) {
+        const Point_t *const pt = Mesh_vertex(pJob->mesh, t, k);
+        d[0] = pt->x - pJob->eye[0];
+        d[1] = pt->y - pJob->eye[1];
+        d[2] = pt->z - pJob->eye[2];
+        for(c=0; c<3; c++) {
+            corners[k][c] = (pJob->inv[c][0] * d[0]) + (pJob->inv[c][1] * d[1]) + (pJob->inv[c][2] * d[2]);
+        }
+    }
+
+    //Rays start on the frame, where w is 1, so clip off everything closer.
+    for(k=0; k<3; k++) {
+        const double *const a = corners[k];
+        const double *const b = corners[(k + 1) % 3];
+        if(a[0] >= 1) {
+            for(c=0; c<3; c++) {
+                clipped[count][c] = a[c];
+            }
+            count++;
+        }
+        if((a[0] >= 1) != (b[0] >= 1)) {
+            const double f = (1 - a[0]) / (b[0] - a[0]);
+            for(c=1; c<3; c++) {
+                clipped[count][c] = a[c] + (f * (b[c] - a[c]));
+            }
+            clipped[count][0] = 1;
+            count++;
+        }
+    }
+
+    pSlots[0].id = TRIBLOCK_EMPTY;
+    pSlots[1].id = TRIBLOCK_EMPTY;
+    for(k=0; k<count; k++) {
+        screen[k][0] = clipped[k][1] / clipped[k][0];
+        screen[k][1] = clipped[k][2] / clipped[k][0];
+        screen[k][2] = 1 / clipped[k][0];
+    }
+    if(count >= 3) {
+        fan[0] = screen[0];
+        fan[1] = screen[1];
+        fan[2] = screen[2];
+        Raster_setup(pJob->raster, &(pSlots[0]), fan, t);
+    }
+    if(count == 4) {
+        fan[1] = screen[2];
+        fan[2] = screen[3];
+        Raster_setup(pJob->raster, &(pSlots[1]), fan, t);
+    }
+}
+
+static void Raster_projectBatch(void *const pCtx, const Tile_t *const pTile, const unsigned int worker)
+{
+    const RasterJob_t *const pJob = (const RasterJob_t *)pCtx;
+    int t;
+
+    for(t=pTile->x0; t<pTile->x1; t++) {
+        Raster_projectTri(pJob, (unsigned int)t);
+    }
+}
+
+/**
+ * Function: Raster_bin
+ * Sorts the projected triangles into the bins their pixels reach: counts each bin's, then
+ * makes room for them all, then files them, so each bin keeps them in order.
+ */
+static void Raster_bin(Raster_t *const pThis)
+{
+    const unsigned int bin_count = (unsigned int)(pThis->bins_x * pThis->bins_y);
+    unsigned int b, t, total;
+    int bx, by;
+
+    if(pThis->bin_capacity < bin_count + 1) {
+        free(pThis->bin_starts);
+        pThis->bin_capacity = bin_count + 1;
+        pThis->bin_starts = Util_allocOrDie(sizeof(unsigned int) * pThis->bin_capacity, "Allocating raster bins.");
+    }
+
+    //Count into the next bin's start, so the running total leaves each start where its
+    // triangles go.
+    memset(pThis->bin_starts, 0, sizeof(unsigned int) * (bin_count + 1));
+    for(t=0; t<pThis->tri_count; t++) {
+        const RasterTri_t *const pTri = &(pThis->tris[t]);
+        if(pTri->id == TRIBLOCK_EMPTY) {
+            continue;
+        }
+        for(by=pTri->y0 / RASTER_BIN_SIZE; by<=(pTri->y1 - 1) / RASTER_BIN_SIZE; by++) {
+            for(bx=pTri->x0 / RASTER_BIN_SIZE; bx<=(pTri->x1 - 1) / RASTER_BIN_SIZE; bx++) {
+                pThis->bin_starts[(by * pThis->bins_x) + bx + 1]++;
+            }
+        }
+    }
+    for(b=0; b<bin_count; b++) {
+        pThis->bin_starts[b + 1] += pThis->bin_starts[b];
+    }
+    total = pThis->bin_starts[bin_count];
+    if(pThis->binned_capacity < total) {
+        free(pThis->binned);
+        pThis->binned_capacity = total;
+        pThis->binned = Util_allocOrDie(sizeof(unsigned int) * total, "Allocating raster bins.");
+    }
+    pThis->binned_count = total;
+
+    //File them, moving each start on past its triangles, then put the starts back.
+    for(t=0; t<pThis->tri_count; t++) {
+        const RasterTri_t *const pTri = &(pThis->tris[t]);
+        if(pTri->id == TRIBLOCK_EMPTY) {
+            continue;
+        }
+        for(by=pTri->y0 / RASTER_BIN_SIZE; by<=(pTri->y1 - 1) / RASTER_BIN_SIZE; by++) {
+            for(bx=pTri->x0 / RASTER_BIN_SIZE; bx<=(pTri->x1 - 1) / RASTER_BIN_SIZE; bx++) {
+                pThis->binned[pThis->bin_starts[(by * pThis->bins_x) + bx]++] = t;
+            }
+        }
+    }
+    for(b=bin_count; b>0; b--) {
+        pThis->bin_starts[b] = pThis->bin_starts[b - 1];
+    }
+    pThis->bin_starts[0] = 0;
+}
+
+Raster_t * Raster_project(Raster_t *const pThis, const Mesh_t *const pMesh, const Frame_t *const pFrame, const Point_t *const pEye, const int width, const int height, const unsigned int threads)
+{
+    RasterJob_t job;
+    double a[3], r[3], s[3], det;
+    int c;
+
+    if(pThis->tri_capacity < 2 * pMesh->tri_count) {
+        free(pThis->tris);
+        pThis->tri_capacity = 2 * pMesh->tri_count;
+        pThis->tris = Util_allocOrDie(sizeof(RasterTri_t) * pThis->tri_capacity, "Allocating projected triangles.");
+    }
+    pThis->tri_count = 2 * pMesh->tri_count;
+    pThis->width = width;
+    pThis->height = height;
+    pThis->bins_x = (width + RASTER_BIN_SIZE - 1) / RASTER_BIN_SIZE;
+    pThis->bins_y = (height + RASTER_BIN_SIZE - 1) / RASTER_BIN_SIZE;
+
+    //The inverse of the matrix with columns a, r, and s is the rows r x s, s x a, and a x r,
+    // over its determinant.
+    a[0] = pFrame->top_left.x - pEye->x;
+    a[1] = pFrame->top_left.y - pEye->y;
+    a[2] = pFrame->top_left.z - pEye->z;
+    r[0] = pFrame->step_right.x;
+    r[1] = pFrame->step_right.y;
+    r[2] = pFrame->step_right.z;
+    s[0] = pFrame->step_down.x;
+    s[1] = pFrame->step_down.y;
+    s[2] = pFrame->step_down.z;
+    for(c=0; c<3; c++) {
+        const int c1 = (c + 1) % 3;
+        const int c2 = (c + 2) % 3;
+        job.inv[0][c] = (r[c1] * s[c2]) - (r[c2] * s[c1]);
+        job.inv[1][c] = (s[c1] * a[c2]) - (s[c2] * a[c1]);
+        job.inv[2][c] = (a[c1] * r[c2]) - (a[c2] * r[c1]);
+    }
+    det = (a[0] * job.inv[0][0]) + (a[1] * job.inv[0][1]) + (a[2] * job.inv[0][2]);
+    for(c=0; c<9; c++) {
+        job.inv[c / 3][c % 3] /= det;
+    }
+
+    job.raster = pThis;
+    job.mesh = pMesh;
+    job.eye[0] = pEye->x;
+    job.eye[1] = pEye->y;
+    job.eye[2] = pEye->z;
+    TilePool_run((int)(pMesh->tri_count), 1, RASTER_PROJECT_BATCH, threads, Raster_projectBatch, &job);
+    Raster_bin(pThis);
+    return pThis;
+}
+
+/**
+ * Struct: RasterDepths_t
+ * A tile's depth buffer, for <Raster_tile>. Reciprocal depths are all positive, so -1 is
+ * nothing there. <best> is the closest triangle each pixel is surely inside, <second> the next,
+ * and <maybe> the closest one it's too near the edge of to be sure about.
+ */
+typedef struct {
+    double best[RASTER_TILE_MAX * RASTER_TILE_MAX];
+    double second[RASTER_TILE_MAX * RASTER_TILE_MAX];
+    double maybe[RASTER_TILE_MAX * RASTER_TILE_MAX];
+} RasterDepths_t;
+
+/**
+ * Function: Raster_draw
+ * Scan converts one projected triangle into the part of the tile it reaches.
+ */
+static void Raster_draw(const RasterTri_t *const pTri, const Tile_t *const pTile, RasterDepths_t *const pDepths, uint32_t *const opIds)
+{
+    const int width = pTile->x1 - pTile->x0;
+    const int x0 = (pTri->x0 > pTile->x0) ? pTri->x0 : pTile->x0;
+    const int y0 = (pTri->y0 > pTile->y0) ? pTri->y0 : pTile->y0;
+    const int x1 = (pTri->x1 < pTile->x1) ? pTri->x1 : pTile->x1;
+    const int y1 = (pTri->y1 < pTile->y1) ? pTri->y1 : pTile->y1;
+    int i, j, k;
+
+    //Every pixel is worked out on its own, not stepped from its neighbours, so it comes out
+    // the same in any tile.
+    for(j=y0; j<y1; j++) {
+        for(i=x0; i<x1; i++) {
+            const double e0 = (pTri->edges[0][0] * i) + (pTri->edges[0][1] * j) + pTri->edges[0][2];
+            const double e1 = (pTri->edges[1][0] * i) + (pTri->edges[1][1] * j) + pTri->edges[1][2];
+            const double e2 = (pTri->edges[2][0] * i) + (pTri->edges[2][1] * j) + pTri->edges[2][2];
+            const double inside = fmin(fmin(e0, e1), e2);
+            double q;
+
+            if(inside < -RASTER_EDGE_MARGIN) {
+                continue;
+            }
+            q = (pTri->depth[0] * i) + (pTri->depth[1] * j) + pTri->depth[2];
+            q = fmin(fmax(q, pTri->depth_min), pTri->depth_max);
+            k = ((j - pTile->y0) * width) + (i - pTile->x0);
+            if(inside <= RASTER_EDGE_MARGIN) {
+                pDepths->maybe[k] = fmax(pDepths->maybe[k], q);
+            }
+            else if(q > pDepths->best[k]) {
+                pDepths->second[k] = pDepths->best[k];
+                pDepths->best[k] = q;
+                opIds[k] = pTri->id;
+            }
+            else {
+                pDepths->second[k] = fmax(pDepths->second[k], q);
+            }
+        }
+    }
+}
+
+void Raster_tile(const Raster_t *const pThis, const Tile_t *const pTile, uint32_t *const opIds)
+{
+    const int count = (pTile->x1 - pTile->x0) * (pTile->y1 - pTile->y0);
+    const int bx0 = pTile->x0 / RASTER_BIN_SIZE;
+    const int by0 = pTile->y0 / RASTER_BIN_SIZE;
+    const int bx1 = (pTile->x1 - 1) / RASTER_BIN_SIZE;
+    const int by1 = (pTile->y1 - 1) / RASTER_BIN_SIZE;
+    RasterDepths_t depths;
+    unsigned int n;
+    int k, bx, by;
+
+    for(k=0; k<count; k++) {
+        depths.best[k] = -1;
+        depths.second[k] = -1;
+        depths.maybe[k] = -1;
+        opIds[k] = TRIBLOCK_EMPTY;
+    }
+
+    for(by=by0; by<=by1; by++) {
+        for(bx=bx0; bx<=bx1; bx++) {
+            const unsigned int b = (unsigned int)((by * pThis->bins_x) + bx);
+            for(n=pThis->bin_starts[b]; n<pThis->bin_starts[b + 1]; n++) {
+                const RasterTri_t *const pTri = &(pThis->tris[pThis->binned[n]]);
+
+                //A triangle in more than one of the tile's bins is only drawn from the first.
+                const int first_x = (pTri->x0 / RASTER_BIN_SIZE > bx0) ? pTri->x0 / RASTER_BIN_SIZE : bx0;
+                const int first_y = (pTri->y0 / RASTER_BIN_SIZE > by0) ? pTri->y0 / RASTER_BIN_SIZE : by0;
+                if(bx == first_x && by == first_y) {
+                    Raster_draw(pTri, pTile, &depths, opIds);
+                }
+            }
+        }
+    }
+
+    //Anything that might be in front of the closest triangle, or level with it, might be what
+    // the ray hits instead.
+    for(k=0; k<count; k++) {
+        const double limit = depths.best[k] * (1 - RASTER_DEPTH_MARGIN);
+        if(opIds[k] == TRIBLOCK_EMPTY) {
+            if(depths.maybe[k] >= 0) {
+                opIds[k] = RASTER_UNSURE;
+            }
+        }
+        else if(depths.second[k] >= limit || depths.maybe[k] >= limit) {
+            opIds[k] = RASTER_UNSURE;
+        }
+    }
+}
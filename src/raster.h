@@ -0,0 +1,181 @@
+/**
+ * File: raster.h
+ *
+ * Primary visibility by rasterizing. Every triangle of a mesh is projected through the frame
+ * into pixel coordinates once per view, and binned by the squares of <RASTER_BIN_SIZE> pixels
+ * its bounding box reaches. Each tile of the image then scan converts just the triangles in
+ * the bins it covers into a depth buffer, with edge functions. This finds what each pixel sees
+ * in time that goes with the triangles plus the pixels, rather than a trip through the
+ * hierarchy for every pixel's ray.
+ *
+ * A pixel's ray is cast through its point on the frame, which is at whole pixel coordinates, so
+ * a pixel sees a triangle if that point is inside the projected triangle and the triangle is
+ * beyond the frame. Depths are compared in the reciprocal of the distance from the eye, in
+ * lengths of the ray to the frame, which is linear across the image.
+ *
+ * Rasterizing and the ray test round differently, so the rasterizer only answers for pixels it
+ * can be sure of. A pixel whose point is within <RASTER_EDGE_MARGIN> of the edge of a triangle
+ * that might be the closest, or whose closest triangle is within <RASTER_DEPTH_MARGIN> of
+ * another one, is left for a ray to decide. See <Render_visibility>.
+ */
+#ifndef RASTER_H
+#define RASTER_H
+
+#include <stdint.h>
+
+#include "mesh.h"
+#include "frame.h"
+#include "triblock.h"
+#include "tilepool.h"
+#include "point.h"
+
+/**
+ * Constants: Margins
+ *
+ * RASTER_EDGE_MARGIN - How close, in pixels, a pixel's point can be to a triangle's edge
+ *  before the rasterizer isn't sure whether the pixel's ray hits it.
+ * RASTER_DEPTH_MARGIN - How close, relative to their depths, two triangles in the same pixel
+ *  can be before the rasterizer isn't sure which one's in front.
+ *
+ * The float build's ray tests, and the rays they test, are far coarser, so its margins are
+ * wider.
+ */
+#ifdef RT_FLOAT
+#define RASTER_EDGE_MARGIN 1e-2
+#define RASTER_DEPTH_MARGIN 1e-3
+#else
+#define RASTER_EDGE_MARGIN 1e-5
+#define RASTER_DEPTH_MARGIN 1e-9
+#endif
+
+/**
+ * Constant: RASTER_UNSURE
+ * The id <Raster_tile> gives a pixel it isn't sure of, which needs its ray traced.
+ */
+#define RASTER_UNSURE 0xFFFFFFFEu
+
+/**
+ * Constant: RASTER_TILE_MAX
+ * Width and height, in pixels, of the biggest tile <Raster_tile> can fill.
+ */
+#define RASTER_TILE_MAX 32
+
+/**
+ * Constant: RASTER_BIN_SIZE
+ * Width and height, in pixels, of the squares the projected triangles are binned by. The same
+ * as <RENDER_TILE_SIZE>, so each of the renderer's tiles reads just the one bin.
+ */
+#define RASTER_BIN_SIZE 16
+
+/**
+ * Struct: RasterTri_t
+ * A triangle projected into pixel coordinates, ready for scan converting.
+ */
+typedef struct {
+    /**
+     * Field: edges
+     * For each edge, A, B, and C such that A*col + B*row + C is how far the point at (col, row)
+     * is inside that edge, in pixels: positive inside the triangle, negative outside it.
+     */
+    double edges[3][3];
+
+    /**
+     * Field: depth
+     * A, B, and C such that A*col + B*row + C is the reciprocal of the depth at (col, row), and
+     * the least and most it can be, from the corners.
+     */
+    double depth[3];
+    double depth_min;
+    double depth_max;
+
+    /**
+     * Fields: x0, y0, x1, y1
+     * The pixels the triangle could reach, within the image, as for <Tile_t>.
+     */
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+
+    /**
+     * Field: id
+     * Index of the triangle in the mesh, or <TRIBLOCK_EMPTY> if it can't be seen at all.
+     */
+    uint32_t id;
+} RasterTri_t;
+
+/**
+ * Struct: Raster_t
+ * The mesh as the current view sees it, kept from view to view so its memory is reused.
+ */
+typedef struct {
+    /**
+     * Fields: tris, tri_count, tri_capacity
+     * Two for every triangle of the mesh, in the mesh's order: clipping a triangle against the
+     * frame can leave a quadrilateral, which is drawn as two.
+     */
+    RasterTri_t *tris;
+    unsigned int tri_count;
+    unsigned int tri_capacity;
+
+    int width;
+    int height;
+
+    /**
+     * Fields: bins_x, bins_y, bin_starts, bin_capacity
+     * The image's bins, <bins_x> across and <bins_y> down, in rows from the top. Bin b's
+     * triangles are at <bin_starts>[b] up to <bin_starts>[b + 1] in <binned>.
+     */
+    int bins_x;
+    int bins_y;
+    unsigned int *bin_starts;
+    unsigned int bin_capacity;
+
+    /**
+     * Fields: binned, binned_count, binned_capacity
+     * Indices into <tris> of the triangles in each bin, in order, one bin after another. A
+     * triangle is in every bin its pixels reach.
+     */
+    unsigned int *binned;
+    unsigned int binned_count;
+    unsigned int binned_capacity;
+} Raster_t;
+
+/**
+ * Function: Raster_cfg
+ * Configures an empty rasterizer. Nothing is projected until <Raster_project>.
+ */
+Raster_t * Raster_cfg(Raster_t *pThis);
+
+/**
+ * Function: Raster_destroy
+ * Frees the projected triangles. The object itself is not freed.
+ */
+void Raster_destroy(Raster_t *pThis);
+
+/**
+ * Function: Raster_project
+ *
+ * Projects every triangle of the mesh for the view of a <width> by <height> image cast from
+ * <pEye> through <pFrame>, over <threads> threads (0 for one per CPU), and bins them. Whatever
+ * is on the eye's side of the frame is clipped off.
+ *
+ * Aborts the program if there is not enough memory.
+ */
+Raster_t * Raster_project(Raster_t *pThis, const Mesh_t *pMesh, const Frame_t *pFrame, const Point_t *pEye, int width, int height, unsigned int threads);
+
+/**
+ * Function: Raster_tile
+ *
+ * Scan converts the projected triangles in the bins a tile of the image covers into it, each
+ * one once however many of those bins it's in. The tile can be no bigger than
+ * <RASTER_TILE_MAX>, and needn't line up with the bins. Gets the index in the mesh of the
+ * closest triangle in each pixel, <TRIBLOCK_EMPTY> for pixels that certainly see nothing, or
+ * <RASTER_UNSURE>. <opIds> holds the tile's rows, from its top left pixel, with no gaps.
+ *
+ * Each pixel's result depends only on the pixel, however the image is split into tiles.
+ */
+void Raster_tile(const Raster_t *pThis, const Tile_t *pTile, uint32_t *opIds);
+
+#endif
+//end inclusion filter
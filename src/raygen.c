@@ -0,0 +1,132 @@
+/**
+ * File: raygen.c
+ *
+ */
+#include "raygen.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "scene.h"
+#include "frame.h"
+#include "camera.h"
+#include "axes.h"
+#include "xform.h"
+#include "point.h"
+#include "vect.h"
+#include "util.h"
+
+RayGen_t * RayGen_cfg(RayGen_t *const pThis)
+{
+    pThis->width = 0;
+    pThis->height = 0;
+    pThis->frame_width = 0;
+    pThis->frame_height = 0;
+    pThis->frame_dist = 0;
+    pThis->local = NULL;
+    pThis->reach = NULL;
+    pThis->dirs = NULL;
+    pThis->turned = false;
+    pThis->rebuilds = 0;
+    pThis->turns = 0;
+    return pThis;
+}
+
+void RayGen_destroy(RayGen_t *const pThis)
+{
+    free(pThis->local);
+    free(pThis->reach);
+    free(pThis->dirs);
+    RayGen_cfg(pThis);
+}
+
+/**
+ * Function: RayGen_rebuild
+ * Works out every pixel's local direction, for a new image or frame size.
+ */
+static void RayGen_rebuild(RayGen_t *const pThis, const Camera_t *const pCam, const double frame_width, const double frame_height, const int width, const int height)
+{
+    const size_t count = (size_t)width * height;
+    Camera_t local_cam;
+    Scene_t local_scene;
+    Frame_t frame;
+    Point_t pt;
+    Vect_t offset;
+    int i, j;
+
+    if(width != pThis->width || height != pThis->height) {
+        free(pThis->local);
+        free(pThis->reach);
+        free(pThis->dirs);
+        pThis->local = Util_allocOrDie(sizeof(Vect_t) * count + 1, "Allocating ray directions.");
+        pThis->reach = Util_allocOrDie(sizeof(Real_t) * count + 1, "Allocating ray directions.");
+        pThis->dirs = Util_allocOrDie(sizeof(Vect_t) * count + 1, "Allocating ray directions.");
+    }
+    pThis->width = width;
+    pThis->height = height;
+    pThis->frame_width = frame_width;
+    pThis->frame_height = frame_height;
+    pThis->frame_dist = pCam->frame_dist;
+
+    //The frame as an unturned camera at the origin sees it, which is the frame in the camera's
+    // own coordinates.
+    Camera_cfg(&local_cam, pCam->frame_dist);
+    memset(&local_scene, 0, sizeof(local_scene));
+    local_scene.cam = &local_cam;
+    local_scene.frame_width = frame_width;
+    local_scene.frame_height = frame_height;
+    local_scene.img_width = width;
+    local_scene.img_height = height;
+    Frame_cfg(&frame, &local_scene);
+
+    //Each direction straight from its pixel's point, so there's no error built up along a row.
+    for(j=0; j<height; j++) {
+        for(i=0; i<width; i++) {
+            const size_t k = ((size_t)j * width) + i;
+            Frame_point(&frame, &pt, i, j);
+            Point_position(&offset, &pt);
+            pThis->reach[k] = Vect_magnitude(&offset);
+            Vect_scale(&(pThis->local[k]), &offset, 1 / pThis->reach[k]);
+        }
+    }
+
+    pThis->turned = false;
+    pThis->rebuilds++;
+}
+
+RayGen_t * RayGen_update(RayGen_t *const pThis, const Camera_t *const pCam, const double frame_width, const double frame_height, const int width, const int height)
+{
+    const Axes_t *const pAxes = &(pCam->axes);
+    Xform_t turn;
+
+    if(pThis->local == NULL || width != pThis->width || height != pThis->height
+        || frame_width != pThis->frame_width || frame_height != pThis->frame_height || pCam->frame_dist != pThis->frame_dist)
+    {
+        RayGen_rebuild(pThis, pCam, frame_width, frame_height, width, height);
+    }
+
+    //Only the way the camera faces matters to the directions, not where it is.
+    if(!(pThis->turned)
+        || memcmp(&(pAxes->x), &(pThis->axes.x), sizeof(Vect_t)) != 0
+        || memcmp(&(pAxes->y), &(pThis->axes.y), sizeof(Vect_t)) != 0
+        || memcmp(&(pAxes->z), &(pThis->axes.z), sizeof(Vect_t)) != 0)
+    {
+        Xform_fromAxes(&turn, pAxes);
+        Xform_vects(&turn, pThis->dirs, pThis->local, (unsigned int)((size_t)width * height));
+        Axes_copy(&(pThis->axes), pAxes);
+        pThis->turned = true;
+        pThis->turns++;
+    }
+
+    Camera_getEye(pCam, &(pThis->eye));
+    return pThis;
+}
+
+void RayGen_ray(const RayGen_t *const pThis, const int col, const int row, Point_t *const opOrigin, Vect_t *const opDir)
+{
+    const size_t k = ((size_t)row * pThis->width) + col;
+    Vect_t offset;
+
+    Vect_copy(opDir, &(pThis->dirs[k]));
+    Point_translate(opOrigin, &(pThis->eye), Vect_scale(&offset, opDir, pThis->reach[k]));
+}
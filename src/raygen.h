@@ -0,0 +1,100 @@
+/**
+ * File: raygen.h
+ *
+ * Primary ray generation, cached between frames. The direction of the ray through each pixel
+ * is worked out once, in the camera's own coordinates, where it only depends on the image and
+ * frame sizes. Moving the camera without turning it reuses the cached directions as they are,
+ * and turning it takes one batched <Xform_vects> over them, rather than a <Frame_point> and
+ * <Point_displacement> per pixel per frame.
+ *
+ * The rays are the same rays a <Frame_t> gives, up to rounding, but with unit directions, so
+ * distances along them are true distances from the frame.
+ */
+#ifndef RAYGEN_H
+#define RAYGEN_H
+
+#include <stdbool.h>
+
+#include "camera.h"
+#include "axes.h"
+#include "point.h"
+#include "vect.h"
+
+/**
+ * Struct: RayGen_t
+ */
+typedef struct {
+    /**
+     * Fields: width, height, frame_width, frame_height, frame_dist
+     * The image and frame the local directions were made for.
+     */
+    int width;
+    int height;
+    double frame_width;
+    double frame_height;
+    Real_t frame_dist;
+
+    /**
+     * Fields: local, reach
+     * For each pixel, in rows from the top, the unit direction from the eye through its point
+     * on the frame, in the camera's coordinates, and how far away that point is.
+     */
+    Vect_t *local;
+    Real_t *reach;
+
+    /**
+     * Field: dirs
+     * The <local> directions turned to match the camera's axes, which are kept in <axes> to
+     * tell when the camera turns. <turned> is false until they've been turned at all.
+     */
+    Vect_t *dirs;
+    Axes_t axes;
+    bool turned;
+
+    Point_t eye;
+
+    /**
+     * Fields: rebuilds, turns
+     * How many times <RayGen_update> has had to work out the local directions, and turn them,
+     * since the generator was configured.
+     */
+    unsigned int rebuilds;
+    unsigned int turns;
+} RayGen_t;
+
+/**
+ * Function: RayGen_cfg
+ * Configures an empty generator. Nothing is cached until the first <RayGen_update>.
+ */
+RayGen_t * RayGen_cfg(RayGen_t *pThis);
+
+/**
+ * Function: RayGen_destroy
+ * Frees the cached directions. The object itself is not freed.
+ */
+void RayGen_destroy(RayGen_t *pThis);
+
+/**
+ * Function: RayGen_update
+ *
+ * Brings the rays up to date with a camera and an image of <width> by <height> pixels cast
+ * through a frame of the given size, as a <Scene_t> describes them, doing only as much work as
+ * has changed since the last update: nothing but copying the eye if the camera has only
+ * moved, one batched transform of the directions if it has turned, and working every
+ * direction out again only if the image or frame size has changed.
+ *
+ * The camera's axes must be at right angles and of unit length, as turning it keeps them.
+ *
+ * Aborts the program if there is not enough memory.
+ */
+RayGen_t * RayGen_update(RayGen_t *pThis, const Camera_t *pCam, double frame_width, double frame_height, int width, int height);
+
+/**
+ * Function: RayGen_ray
+ * Gets the ray through the given pixel: from its point on the frame, in a unit direction
+ * away from the eye.
+ */
+void RayGen_ray(const RayGen_t *pThis, int col, int row, Point_t *opOrigin, Vect_t *opDir);
+
+#endif
+//end inclusion filter
@@ -0,0 +1,182 @@
+/**
+ * File: raypacket.c
+ *
+ */
+#include "raypacket.h"
+
+#include <math.h>
+#include <stdbool.h>
+
+#include "frame.h"
+#include "point.h"
+#include "vect.h"
+
+/**
+ * Constant: RAYPACKET_SLACK
+ * How far outside the frustum, relative to the size of the terms in the plane test, something
+ * has to be before it's culled. This covers the rounding in the frustum itself, in the rays,
+ * and in the ray-triangle tests, which may count a hit just outside a triangle's edge.
+ */
+#ifdef RT_FLOAT
+#define RAYPACKET_SLACK 1e-4
+#else
+#define RAYPACKET_SLACK 1e-10
+#endif
+
+RayPacket_t * RayPacket_cfg(RayPacket_t *const pThis, const Frame_t *const pFrame, const Point_t *const pEye)
+{
+    pThis->frame = *pFrame;
+    Point_copy(&(pThis->eye), pEye);
+    pThis->count = 0;
+    return pThis;
+}
+
+unsigned int RayPacket_addPixel(RayPacket_t *const pThis, const int col, const int row)
+{
+    return RayPacket_addSample(pThis, col, row, 0, 0);
+}
+
+/**
+ * Function: RayPacket_add
+ * Adds a ray, from the given pixel or a point <x> and <y> within it, whose origin and direction
+ * have already been filled in, with nothing hit yet.
+ */
+static unsigned int RayPacket_add(RayPacket_t *const pThis, const unsigned int r, const int col, const int row, const double x, const double y)
+{
+    const Vect_t *const pDir = &(pThis->dirs[r]);
+
+    pThis->cols[r] = col;
+    pThis->rows[r] = row;
+    Vect_cfg(&(pThis->invs[r]), 1 / pDir->x, 1 / pDir->y, 1 / pDir->z);
+
+    //As for Bvh_rayHit with nothing hit yet.
+    pThis->hits[r].dist = Real_nextafter((Real_t)INFINITY, -INFINITY);
+    pThis->hits[r].id = TRIBLOCK_EMPTY;
+    pThis->hits[r].instance = 0;
+#ifdef RT_STATS
+    RayStats_clear(&(pThis->stats[r]));
+#endif
+
+    if(r == 0) {
+        pThis->min_col = pThis->max_col = x;
+        pThis->min_row = pThis->max_row = y;
+    }
+    else {
+        if(x < pThis->min_col) pThis->min_col = x;
+        if(x > pThis->max_col) pThis->max_col = x;
+        if(y < pThis->min_row) pThis->min_row = y;
+        if(y > pThis->max_row) pThis->max_row = y;
+    }
+    return r;
+}
+
+unsigned int RayPacket_addSample(RayPacket_t *const pThis, const int col, const int row, const double dx, const double dy)
+{
+    const unsigned int r = pThis->count++;
+    const double x = col + dx;
+    const double y = row + dy;
+
+    //Exactly the ray Render_traceRay casts through this point.
+    Frame_point(&(pThis->frame), &(pThis->origins[r]), x, y);
+    Point_displacement(&(pThis->dirs[r]), &(pThis->eye), &(pThis->origins[r]));
+    return RayPacket_add(pThis, r, col, row, x, y);
+}
+
+unsigned int RayPacket_addRay(RayPacket_t *const pThis, const int col, const int row, const Point_t *const pOrigin, const Vect_t *const pDir)
+{
+    const unsigned int r = pThis->count++;
+
+    Point_copy(&(pThis->origins[r]), pOrigin);
+    Vect_copy(&(pThis->dirs[r]), pDir);
+    return RayPacket_add(pThis, r, col, row, col, row);
+}
+
+RayPacket_t * RayPacket_cfgFrustum(RayPacket_t *const pThis)
+{
+    Point_t corner;
+    Vect_t dirs[4];
+    int k;
+
+    //Frame points are affine in the column and row, so every ray lies inside the cone from the
+    // eye through the four corners of the rectangle around them. Go round the corners in order.
+    Frame_point(&(pThis->frame), &corner, pThis->min_col, pThis->min_row);
+    Point_displacement(&(dirs[0]), &(pThis->eye), &corner);
+    Frame_point(&(pThis->frame), &corner, pThis->max_col, pThis->min_row);
+    Point_displacement(&(dirs[1]), &(pThis->eye), &corner);
+    Frame_point(&(pThis->frame), &corner, pThis->max_col, pThis->max_row);
+    Point_displacement(&(dirs[2]), &(pThis->eye), &corner);
+    Frame_point(&(pThis->frame), &corner, pThis->min_col, pThis->max_row);
+    Point_displacement(&(dirs[3]), &(pThis->eye), &corner);
+
+    Vect_add(&(pThis->center), &(dirs[0]), &(dirs[2]));
+
+    for(k=0; k<4; k++) {
+        //Each side is the plane through the eye and two neighbouring corners. Which way the
+        // cross product points depends on the handedness of the frame, so point it inward.
+        // When the packet is a single row or column, two corners are the same and the normal
+        // is zero, which never culls anything.
+        Vect_cross(&(pThis->planes[k]), &(dirs[k]), &(dirs[(k + 1) % 4]));
+        if(Vect_dot(&(pThis->planes[k]), &(pThis->center)) < 0) {
+            Vect_negate(&(pThis->planes[k]), &(pThis->planes[k]));
+        }
+    }
+    return pThis;
+}
+
+/**
+ * Function: RayPacket_side
+ * How far inside the given side of the frustum the point is (negative for outside), and in
+ * <opScale>, the size of the terms that went into it, which is what the rounding scales with.
+ */
+static double RayPacket_side(const RayPacket_t *const pThis, const Vect_t *const pPlane, const Point_t *const pPt, double *const opScale)
+{
+    const double tx = (double)(pPlane->x) * (pPt->x - pThis->eye.x);
+    const double ty = (double)(pPlane->y) * (pPt->y - pThis->eye.y);
+    const double tz = (double)(pPlane->z) * (pPt->z - pThis->eye.z);
+
+    *opScale = fabs(tx) + fabs(ty) + fabs(tz);
+    return tx + ty + tz;
+}
+
+bool RayPacket_cullsBox(const RayPacket_t *const pThis, const Aabb_t *const pBox)
+{
+    Point_t inner;
+    double scale;
+    int k;
+
+    for(k=0; k<4; k++) {
+        //The corner of the box furthest inside this side: if even that is outside, all of it is.
+        const Vect_t *const pPlane = &(pThis->planes[k]);
+        Point_cfg(&inner,
+            pPlane->x > 0 ? pBox->max.x : pBox->min.x,
+            pPlane->y > 0 ? pBox->max.y : pBox->min.y,
+            pPlane->z > 0 ? pBox->max.z : pBox->min.z);
+        if(RayPacket_side(pThis, pPlane, &inner, &scale) < -RAYPACKET_SLACK * scale) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RayPacket_cullsTriangle(const RayPacket_t *const pThis, const Point_t *const pA, const Point_t *const pB, const Point_t *const pC)
+{
+    double sa, sb, sc, scale;
+    int k;
+
+    for(k=0; k<4; k++) {
+        const Vect_t *const pPlane = &(pThis->planes[k]);
+        const double a = RayPacket_side(pThis, pPlane, pA, &sa);
+        const double b = RayPacket_side(pThis, pPlane, pB, &sb);
+        const double c = RayPacket_side(pThis, pPlane, pC, &sc);
+
+        //A hit can be rounded off the triangle by an amount that scales with its biggest
+        // vertex, so all three get the same slack.
+        scale = (sa > sb ? sa : sb);
+        scale = (sc > scale ? sc : scale);
+        if(a < -RAYPACKET_SLACK * scale && b < -RAYPACKET_SLACK * scale && c < -RAYPACKET_SLACK * scale) {
+            return true;
+        }
+    }
+    return false;
+}
+
@@ -0,0 +1,147 @@
+/**
+ * File: raypacket.h
+ *
+ * A packet of primary rays, all from the eye through nearby points of a <Frame_t>, traced
+ * together so that a box or triangle can be ruled out for every ray in the packet with a
+ * single test against the packet's bounding frustum.
+ */
+#ifndef RAYPACKET_H
+#define RAYPACKET_H
+
+#include <stdbool.h>
+
+#include "types.h"
+#include "frame.h"
+#include "triblock.h"
+#include "raystats.h"
+#include "aabb.h"
+#include "point.h"
+#include "vect.h"
+
+/**
+ * Constant: RAYPACKET_MAX
+ * The most rays a packet can hold: an 8 by 8 block of pixels.
+ */
+#define RAYPACKET_MAX 64
+
+/**
+ * Struct: RayPacket_t
+ *
+ * Each ray starts at its point on the frame and heads away from the eye, exactly as
+ * <Render_traceRay> casts it, so a packet finds exactly the same hits as its rays would one
+ * at a time. (Rays from <RayPacket_addRay> are whatever they're given.)
+ */
+typedef struct {
+    Frame_t frame;
+    Point_t eye;
+
+    /**
+     * Field: count
+     * The number of rays in the packet.
+     */
+    unsigned int count;
+
+    /**
+     * Fields: cols, rows
+     * The pixel each ray was cast through (or within, for a sample from <RayPacket_addSample>).
+     */
+    int cols[RAYPACKET_MAX];
+    int rows[RAYPACKET_MAX];
+
+    /**
+     * Fields: origins, dirs, invs
+     * Where each ray starts, its direction, and the component-wise reciprocal of its
+     * direction (for <Aabb_rayClip>).
+     */
+    Point_t origins[RAYPACKET_MAX];
+    Vect_t dirs[RAYPACKET_MAX];
+    Vect_t invs[RAYPACKET_MAX];
+
+    /**
+     * Field: hits
+     * The closest hit found so far for each ray. The id is <TRIBLOCK_EMPTY> until something is hit.
+     */
+    TriHit_t hits[RAYPACKET_MAX];
+
+#ifdef RT_STATS
+    /**
+     * Field: stats
+     * What tracing each ray has cost so far. Only there when built with RT_STATS.
+     */
+    RayStats_t stats[RAYPACKET_MAX];
+#endif
+
+    /**
+     * Fields: min_col, max_col, min_row, max_row
+     * The rectangle of the frame the rays were cast through, in (possibly fractional) pixels.
+     */
+    double min_col, max_col, min_row, max_row;
+
+    /**
+     * Field: planes
+     * Inward normals of the four sides of the frustum, which all pass through the eye.
+     */
+    Vect_t planes[4];
+
+    /**
+     * Field: center
+     * Direction of the middle of the frustum, for visiting boxes front to back.
+     */
+    Vect_t center;
+} RayPacket_t;
+
+/**
+ * Function: RayPacket_cfg
+ * Configures an empty packet of rays from <pEye> through points on <pFrame>.
+ */
+RayPacket_t * RayPacket_cfg(RayPacket_t *pThis, const Frame_t *pFrame, const Point_t *pEye);
+
+/**
+ * Function: RayPacket_addPixel
+ * Adds the ray through the given pixel of the frame, with nothing hit yet, and returns its
+ * index in the packet. The packet must have fewer than <RAYPACKET_MAX> rays already.
+ */
+unsigned int RayPacket_addPixel(RayPacket_t *pThis, int col, int row);
+
+/**
+ * Function: RayPacket_addSample
+ * Like <RayPacket_addPixel>, but the ray goes through the point <dx> and <dy> of the way (each
+ * in [0, 1)) from the given pixel's point on the frame to the next column's and row's.
+ */
+unsigned int RayPacket_addSample(RayPacket_t *pThis, int col, int row, double dx, double dy);
+
+/**
+ * Function: RayPacket_addRay
+ * Like <RayPacket_addPixel>, but with the ray's origin and direction given, from a <RayGen_t>.
+ * The ray must be the one through the pixel's point on the frame, up to rounding and the
+ * length of its direction, or the frustum won't hold it.
+ */
+unsigned int RayPacket_addRay(RayPacket_t *pThis, int col, int row, const Point_t *pOrigin, const Vect_t *pDir);
+
+/**
+ * Function: RayPacket_cfgFrustum
+ * Works out the frustum around the rectangle of pixels the rays were added through. Call
+ * this after adding the rays, and before any of the culling tests.
+ */
+RayPacket_t * RayPacket_cfgFrustum(RayPacket_t *pThis);
+
+/**
+ * Function: RayPacket_cullsBox
+ * Returns true if no ray in the packet can possibly pass through the box, because it's
+ * entirely outside one side of the frustum. This is conservative: a box it keeps may still
+ * be missed by every ray.
+ */
+bool RayPacket_cullsBox(const RayPacket_t *pThis, const Aabb_t *pBox);
+
+/**
+ * Function: RayPacket_cullsTriangle
+ * Returns true if no ray in the packet can possibly hit the triangle with the given vertices,
+ * because they are all outside the same side of the frustum. Like <RayPacket_cullsBox>, this
+ * is conservative, and it allows for the rounding in the ray-triangle tests, so it never
+ * rules out a triangle those tests would count as hit.
+ */
+bool RayPacket_cullsTriangle(const RayPacket_t *pThis, const Point_t *pA, const Point_t *pB, const Point_t *pC);
+
+#endif
+//end inclusion filter
+
@@ -0,0 +1,153 @@
+/**
+ * File: raystats.c
+ *
+ */
+#include "raystats.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "image.h"
+#include "util.h"
+
+const char *const RayStats_names[RAYSTATS_COUNT] = {"tests", "plane-hits", "bary-rejects", "hits", "nodes"};
+
+#ifdef RT_STATS
+__thread RayStats_t *RayStats_target = NULL;
+#endif
+
+/**
+ * Constants: Heatmap colors
+ *
+ * RAYSTATS_RAMP - The colors the heatmaps go through, from none to the most.
+ * RAYSTATS_RAMP_STOPS - How many there are.
+ */
+#define RAYSTATS_RAMP_STOPS 6
+static const uint8_t RAYSTATS_RAMP[RAYSTATS_RAMP_STOPS][3] = {
+    {0, 0, 0}, {0, 0, 255}, {0, 255, 255}, {0, 255, 0}, {255, 255, 0}, {255, 0, 0}
+};
+
+RayStats_t * RayStats_clear(RayStats_t *const pThis)
+{
+    memset(pThis->counts, 0, sizeof(pThis->counts));
+    return pThis;
+}
+
+RayStatsMap_t * RayStatsMap_cfg(RayStatsMap_t *const pThis, const int width, const int height)
+{
+    pThis->width = width;
+    pThis->height = height;
+    pThis->pixels = Util_allocOrDie(sizeof(RayStats_t) * width * height + 1, "Allocating pixel stats.");
+    RayStatsMap_clear(pThis);
+    return pThis;
+}
+
+void RayStatsMap_destroy(RayStatsMap_t *const pThis)
+{
+    free(pThis->pixels);
+    pThis->pixels = NULL;
+}
+
+void RayStatsMap_clear(RayStatsMap_t *const pThis)
+{
+    memset(pThis->pixels, 0, sizeof(RayStats_t) * pThis->width * pThis->height);
+}
+
+RayStats_t * RayStatsMap_at(RayStatsMap_t *const pThis, const int col, const int row)
+{
+    if(pThis == NULL) {
+        return NULL;
+    }
+    return &(pThis->pixels[((size_t)row * pThis->width) + col]);
+}
+
+void RayStatsMap_add(RayStatsMap_t *const pThis, const int col, const int row, const RayStats_t *const pStats)
+{
+    RayStats_t *const pPixel = RayStatsMap_at(pThis, col, row);
+    unsigned int c;
+
+    if(pPixel == NULL) {
+        return;
+    }
+    for(c=0; c<RAYSTATS_COUNT; c++) {
+        pPixel->counts[c] += pStats->counts[c];
+    }
+}
+
+RayStatsTotals_t * RayStatsMap_totals(const RayStatsMap_t *const pThis, RayStatsTotals_t *const opTotals)
+{
+    const size_t count = (size_t)pThis->width * pThis->height;
+    size_t k;
+    unsigned int c;
+
+    memset(opTotals, 0, sizeof(*opTotals));
+    opTotals->pixels = count;
+    for(k=0; k<count; k++) {
+        for(c=0; c<RAYSTATS_COUNT; c++) {
+            const uint32_t n = pThis->pixels[k].counts[c];
+            opTotals->totals[c] += n;
+            if(n > opTotals->max[c]) {
+                opTotals->max[c] = n;
+            }
+        }
+    }
+    return opTotals;
+}
+
+void RayStatsTotals_print(const RayStatsTotals_t *const pThis, FILE *const file, const char *const title)
+{
+    unsigned int c;
+
+    fprintf(file, "%s\n", title);
+    fprintf(file, "  %-14s %16s %12s %10s\n", "counter", "total", "per pixel", "most");
+    for(c=0; c<RAYSTATS_COUNT; c++) {
+        fprintf(file, "  %-14s %16" PRIu64 " %12.2f %10" PRIu32 "\n", RayStats_names[c], pThis->totals[c],
+            (pThis->pixels > 0) ? (double)(pThis->totals[c]) / pThis->pixels : 0.0, pThis->max[c]);
+    }
+}
+
+/**
+ * Function: RayStats_color
+ * Colors a count from 0 to <most> along the heatmap ramp.
+ */
+static void RayStats_color(uint8_t *const opRgb, const uint32_t count, const uint32_t most)
+{
+    const double x = (most > 0) ? (double)count / most * (RAYSTATS_RAMP_STOPS - 1) : 0;
+    const int stop = (x >= RAYSTATS_RAMP_STOPS - 1) ? RAYSTATS_RAMP_STOPS - 2 : (int)x;
+    const double f = x - stop;
+    int c;
+
+    for(c=0; c<3; c++) {
+        opRgb[c] = (uint8_t)(RAYSTATS_RAMP[stop][c] + f * (RAYSTATS_RAMP[stop + 1][c] - RAYSTATS_RAMP[stop][c]) + 0.5);
+    }
+}
+
+bool RayStatsMap_writeHeatmaps(const RayStatsMap_t *const pThis, const char *const prefix)
+{
+    RayStatsTotals_t totals;
+    Image_t image;
+    char path[4096];
+    unsigned int c;
+    int i, j;
+    bool ok = true;
+
+    RayStatsMap_totals(pThis, &totals);
+    Image_cfg(&image, pThis->width, pThis->height);
+    for(c=0; c<RAYSTATS_COUNT; c++) {
+        if(snprintf(path, sizeof(path), "%s-%s.ppm", prefix, RayStats_names[c]) >= (int)sizeof(path)) {
+            fprintf(stderr, "Heatmap file name for %s is too long.\n", prefix);
+            ok = false;
+            break;
+        }
+        for(j=0; j<pThis->height; j++) {
+            for(i=0; i<pThis->width; i++) {
+                RayStats_color(image.pixels + (j * image.rowstride) + (i * 3), pThis->pixels[((size_t)j * pThis->width) + i].counts[c], totals.max[c]);
+            }
+        }
+        ok = Image_writePpm(&image, path) && ok;
+    }
+    Image_destroy(&image);
+    return ok;
+}
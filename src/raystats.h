@@ -0,0 +1,164 @@
+/**
+ * File: raystats.h
+ *
+ * Counts what each pixel costs to render: how many triangles its rays were tested against and
+ * how those tests went, and how many hierarchy nodes they visited. The counts can be added up
+ * for the whole image, or drawn as false color heatmaps to show which parts of it are costly.
+ *
+ * Counting is only compiled in when RT_STATS is defined (e.g., `scons stats=1`). Otherwise
+ * <RAYSTATS_ADD> and <RAYSTATS_TARGET> expand to nothing, so the ray tests and traversals are
+ * exactly as fast as ever, and a <RayStatsMap_t> given to the renderer stays all zero.
+ *
+ * The tracing code doesn't know which pixel it's working for, so it counts into a per-thread
+ * <RayStats_target>, which the renderer points at the counts for the ray it's tracing.
+ */
+#ifndef RAYSTATS_H
+#define RAYSTATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Constants: Counters
+ *
+ * RAYSTATS_TESTS - Ray and triangle tests.
+ * RAYSTATS_PLANE_HITS - Tests where the ray wasn't parallel to the triangle, so it crosses its
+ *  plane somewhere.
+ * RAYSTATS_BARY_REJECTS - Tests where the ray crosses the plane outside the triangle, going by
+ *  the barycentric coordinates.
+ * RAYSTATS_HITS - Tests where the ray hit the triangle, closer than anything it had hit before.
+ * RAYSTATS_NODES - Hierarchy nodes the ray went into, in a <Bvh_t> or <InstanceBvh_t>.
+ * RAYSTATS_COUNT - How many counters there are.
+ */
+#define RAYSTATS_TESTS 0
+#define RAYSTATS_PLANE_HITS 1
+#define RAYSTATS_BARY_REJECTS 2
+#define RAYSTATS_HITS 3
+#define RAYSTATS_NODES 4
+#define RAYSTATS_COUNT 5
+
+/**
+ * Struct: RayStats_t
+ * Counts for one ray, or one pixel.
+ */
+typedef struct {
+    uint32_t counts[RAYSTATS_COUNT];
+} RayStats_t;
+
+/**
+ * Variable: RayStats_names
+ * A short name for each counter, which also goes in the heatmaps' file names.
+ */
+extern const char *const RayStats_names[RAYSTATS_COUNT];
+
+#ifdef RT_STATS
+
+/**
+ * Variable: RayStats_target
+ * Where the thread is counting, or NULL to not count.
+ */
+extern __thread RayStats_t *RayStats_target;
+
+/**
+ * Macros: Counting
+ *
+ * RAYSTATS_TARGET(pStats) - Counts the thread's rays into <pStats> from now on.
+ * RAYSTATS_ADD(counter, n) - Adds <n> to one of the <Counters> in the thread's target.
+ * RAYSTATS_ADD_TO(pStats, counter, n) - Adds <n> to one of the <Counters> in <pStats>.
+ */
+#define RAYSTATS_TARGET(pStats) (RayStats_target = (pStats))
+#define RAYSTATS_ADD(counter, n) do { if(RayStats_target != NULL) { RayStats_target->counts[counter] += (n); } } while(0)
+#define RAYSTATS_ADD_TO(pStats, counter, n) ((pStats)->counts[counter] += (n))
+
+#else
+
+#define RAYSTATS_TARGET(pStats) ((void)0)
+#define RAYSTATS_ADD(counter, n) ((void)0)
+#define RAYSTATS_ADD_TO(pStats, counter, n) ((void)0)
+
+#endif
+
+/**
+ * Function: RayStats_clear
+ * Zeroes every count.
+ */
+RayStats_t * RayStats_clear(RayStats_t *pThis);
+
+/**
+ * Struct: RayStatsMap_t
+ * Counts for every pixel of an image, rows from the top.
+ */
+typedef struct {
+    int width;
+    int height;
+    RayStats_t *pixels;
+} RayStatsMap_t;
+
+/**
+ * Struct: RayStatsTotals_t
+ * Counts added up over a whole <RayStatsMap_t>, and the most any one pixel had.
+ */
+typedef struct {
+    uint64_t totals[RAYSTATS_COUNT];
+    uint32_t max[RAYSTATS_COUNT];
+    uint64_t pixels;
+} RayStatsTotals_t;
+
+/**
+ * Function: RayStatsMap_cfg
+ * Configures a map for an image of the given size, with every count zero.
+ *
+ * Aborts the program if there is not enough memory.
+ */
+RayStatsMap_t * RayStatsMap_cfg(RayStatsMap_t *pThis, int width, int height);
+
+/**
+ * Function: RayStatsMap_destroy
+ * Frees the counts allocated by <RayStatsMap_cfg>. The object itself is not freed.
+ */
+void RayStatsMap_destroy(RayStatsMap_t *pThis);
+
+/**
+ * Function: RayStatsMap_clear
+ * Zeroes every pixel's counts.
+ */
+void RayStatsMap_clear(RayStatsMap_t *pThis);
+
+/**
+ * Function: RayStatsMap_at
+ * Gets the counts for a pixel, or NULL if <pThis> is NULL.
+ */
+RayStats_t * RayStatsMap_at(RayStatsMap_t *pThis, int col, int row);
+
+/**
+ * Function: RayStatsMap_add
+ * Adds one ray's counts to those of the pixel it was cast for. Does nothing if <pThis> is NULL.
+ */
+void RayStatsMap_add(RayStatsMap_t *pThis, int col, int row, const RayStats_t *pStats);
+
+/**
+ * Function: RayStatsMap_totals
+ * Adds up the counts over every pixel.
+ */
+RayStatsTotals_t * RayStatsMap_totals(const RayStatsMap_t *pThis, RayStatsTotals_t *opTotals);
+
+/**
+ * Function: RayStatsTotals_print
+ * Prints a table of the totals, with the average and most for a pixel, headed by <title>.
+ */
+void RayStatsTotals_print(const RayStatsTotals_t *pThis, FILE *file, const char *title);
+
+/**
+ * Function: RayStatsMap_writeHeatmaps
+ *
+ * Writes a false color PPM of each counter to <prefix> followed by "-" and its name from
+ * <RayStats_names>, like "stats-nodes.ppm". Each pixel's color goes from black for none,
+ * through blue, cyan, green, and yellow, to red for the most of any pixel in the image.
+ *
+ * Returns false, having printed a message to stderr, if any of them couldn't be written.
+ */
+bool RayStatsMap_writeHeatmaps(const RayStatsMap_t *pThis, const char *prefix);
+
+#endif
+//end inclusion filter
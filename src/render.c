@@ -0,0 +1,906 @@
+/**
+ * File: render.c
+ *
+ */
+#include "render.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "scene.h"
+#include "tilepool.h"
+#include "visbuffer.h"
+#include "triblock.h"
+#include "raypacket.h"
+#include "raygen.h"
+#include "raster.h"
+#include "raystats.h"
+#include "mesh.h"
+#include "bvh.h"
+#include "instance.h"
+#include "light.h"
+#include "camera.h"
+#include "color.h"
+#include "point.h"
+#include "vect.h"
+#include "util.h"
+
+/**
+ * Constant: RENDER_SHADOW_BIAS
+ * How far off the surface shadow rays start, relative to the size of the hit point's
+ * coordinates, so rounding in the hit point doesn't have them hit the triangle they start on.
+ */
+#ifdef RT_FLOAT
+#define RENDER_SHADOW_BIAS 1e-4
+#else
+#define RENDER_SHADOW_BIAS 1e-8
+#endif
+
+/**
+ * Struct: RenderJob_t
+ * Everything the tile workers need to render their tiles.
+ */
+typedef struct {
+    const Scene_t *scene;
+    Frame_t frame;
+    Point_t eye;
+
+    /**
+     * Field: rays
+     * The scene's primary rays, up to date, or NULL to cast them through the <frame>.
+     */
+    const RayGen_t *rays;
+
+    /**
+     * Field: raster
+     * The scene's rasterizer, with its mesh projected for this view, to find what the primary
+     * rays hit for <Render_visibility>; otherwise NULL.
+     */
+    const Raster_t *raster;
+
+    uint8_t *pixels;
+    int rowstride;
+
+    /**
+     * Field: area
+     * The part of the image that <pixels> and the visibility buffers hold: pixel (x, y) of the
+     * image is at (x - area.x0, y - area.y0) in them. The whole image, except for
+     * <Render_region>.
+     */
+    Tile_t area;
+
+    int block;
+    bool refine;
+
+    /**
+     * Field: buffer
+     * Where to record the hits, for <Render_visibility>.
+     */
+    VisBuffer_t *buffer;
+
+    /**
+     * Field: source
+     * The hits to shade, for <Render_shade>.
+     */
+    const VisBuffer_t *source;
+
+    /**
+     * Field: edges
+     * One byte per pixel, set for the pixels <Render_antialias> is to refine.
+     */
+    const uint8_t *edges;
+} RenderJob_t;
+
+/**
+ * Function: Render_cfgJob
+ * Sets up the parts of a job every pass needs: the scene, and its frame, eye, and rays, and the
+ * <area> it's rendering, which is the whole image if <pArea> is NULL.
+ */
+static RenderJob_t * Render_cfgJob(RenderJob_t *const pJob, const Scene_t *const scene, const Tile_t *const pArea)
+{
+    pJob->scene = scene;
+    if(pArea != NULL) {
+        pJob->area = *pArea;
+    }
+    else {
+        pJob->area.x0 = 0;
+        pJob->area.y0 = 0;
+        pJob->area.x1 = scene->img_width;
+        pJob->area.y1 = scene->img_height;
+    }
+    Frame_cfg(&(pJob->frame), scene);
+    Camera_getEye(scene->cam, &(pJob->eye));
+    pJob->rays = NULL;
+    if(scene->rays != NULL) {
+        pJob->rays = RayGen_update(scene->rays, scene->cam, scene->frame_width, scene->frame_height, scene->img_width, scene->img_height);
+    }
+    pJob->raster = NULL;
+    return pJob;
+}
+
+bool Render_rasterizes(const Scene_t *const scene)
+{
+    return (scene->raster != NULL && scene->instances == NULL);
+}
+
+/**
+ * Function: Render_countRay
+ * Adds what ray <r> of the packet has cost, tracing it and shading its hit, to the counts for
+ * its pixel in the scene's <Scene_t.stats>. Does nothing unless built with RT_STATS.
+ */
+static void Render_countRay(const Scene_t *const scene, const RayPacket_t *const pPacket, const unsigned int r)
+{
+#ifdef RT_STATS
+    RayStatsMap_add(scene->stats, pPacket->cols[r], pPacket->rows[r], &(pPacket->stats[r]));
+#endif
+}
+
+/**
+ * Function: Render_addPixel
+ * Adds the primary ray through a pixel to the packet, from the job's rays if it has them.
+ */
+static void Render_addPixel(const RenderJob_t *const pJob, RayPacket_t *const pPacket, const int col, const int row)
+{
+    Point_t origin;
+    Vect_t dir;
+
+    if(pJob->rays == NULL) {
+        RayPacket_addPixel(pPacket, col, row);
+        return;
+    }
+    RayGen_ray(pJob->rays, col, row, &origin, &dir);
+    RayPacket_addRay(pPacket, col, row, &origin, &dir);
+}
+
+/**
+ * Function: Render_primaryRay
+ * Gets the primary ray through a pixel, the same one <Render_addPixel> would add to a packet.
+ */
+static void Render_primaryRay(const RenderJob_t *const pJob, const int col, const int row, Point_t *const opOrigin, Vect_t *const opDir)
+{
+    if(pJob->rays != NULL) {
+        RayGen_ray(pJob->rays, col, row, opOrigin, opDir);
+        return;
+    }
+    Frame_point(&(pJob->frame), opOrigin, col, row);
+    Point_displacement(opDir, &(pJob->eye), opOrigin);
+}
+
+Color_t * Render_castRay(const Scene_t *const scene, Color_t *const opColor, const Point_t *const pEye, const Point_t *const pPt)
+{
+    TriHit_t hit;
+    Vect_t ray;
+
+    //Only the closest hit is colored.
+    Render_traceRay(scene, &hit, pEye, pPt);
+    Point_displacement(&ray, pEye, pPt);
+    return Render_shadeHit(scene, opColor, &hit, pPt, &ray);
+}
+
+bool Render_traceRay(const Scene_t *const scene, TriHit_t *const opHit, const Point_t *const pEye, const Point_t *const pPt)
+{
+    Vect_t ray;
+    Point_t bary;
+    double min_dist, dist;
+    unsigned int t;
+
+    //Get the vector from the eye to the point.
+    Point_displacement(&ray, pEye, pPt);
+
+    //Find which triangle it intersect withs closest.
+    min_dist = INFINITY;
+    opHit->id = TRIBLOCK_EMPTY;
+    opHit->instance = 0;
+    if(scene->instances != NULL) {
+        InstanceBvh_rayHit(scene->instances, opHit, min_dist, pPt, &ray);
+    }
+    else if(scene->bvh != NULL) {
+        Bvh_rayHit(scene->bvh, opHit, min_dist, pPt, &ray);
+    }
+    else {
+        for(t=0; t<scene->mesh->tri_count; t++)
+        {
+            dist = Mesh_intersect(scene->mesh, t, &bary, min_dist, pPt, &ray);
+            if(dist != min_dist) {
+                min_dist = dist;
+                opHit->id = t;
+                opHit->dist = (Real_t)dist;
+                Point_copy(&(opHit->bary), &bary);
+            }
+        }
+    }
+
+    return (opHit->id != TRIBLOCK_EMPTY);
+}
+
+void Render_tracePacket(const Scene_t *const scene, RayPacket_t *const pPacket)
+{
+    double min_dist[RAYPACKET_MAX];
+    Point_t bary;
+    double dist;
+    unsigned int r, t;
+
+    if(scene->instances != NULL) {
+        //Each instance sees the rays in its own space, where the packet's frustum doesn't apply,
+        // so they're traced one at a time.
+        for(r=0; r<pPacket->count; r++) {
+            RAYSTATS_TARGET(&(pPacket->stats[r]));
+            InstanceBvh_rayHit(scene->instances, &(pPacket->hits[r]), INFINITY, &(pPacket->origins[r]), &(pPacket->dirs[r]));
+        }
+        RAYSTATS_TARGET(NULL);
+        return;
+    }
+    if(scene->bvh != NULL) {
+        Bvh_packetHit(scene->bvh, pPacket);
+        return;
+    }
+
+    //Same as the loop in Render_traceRay, one ray at a time, but skipping the triangles outside
+    // the frustum for all of them at once.
+    for(r=0; r<pPacket->count; r++) {
+        min_dist[r] = INFINITY;
+    }
+    for(t=0; t<scene->mesh->tri_count; t++) {
+        if(RayPacket_cullsTriangle(pPacket, Mesh_vertex(scene->mesh, t, 0), Mesh_vertex(scene->mesh, t, 1), Mesh_vertex(scene->mesh, t, 2))) {
+            continue;
+        }
+        for(r=0; r<pPacket->count; r++) {
+            RAYSTATS_TARGET(&(pPacket->stats[r]));
+            dist = Mesh_intersect(scene->mesh, t, &bary, min_dist[r], &(pPacket->origins[r]), &(pPacket->dirs[r]));
+            if(dist != min_dist[r]) {
+                TriHit_t *const pHit = &(pPacket->hits[r]);
+                min_dist[r] = dist;
+                pHit->id = t;
+                pHit->dist = (Real_t)dist;
+                Point_copy(&(pHit->bary), &bary);
+            }
+        }
+    }
+    RAYSTATS_TARGET(NULL);
+}
+
+bool Render_occluded(const Scene_t *const scene, const Point_t *const pt, const Vect_t *const vect, const double max_dist)
+{
+    Point_t bary;
+    unsigned int t;
+
+    if(scene->instances != NULL) {
+        return InstanceBvh_occluded(scene->instances, pt, vect, max_dist);
+    }
+    if(scene->bvh != NULL) {
+        return Bvh_occluded(scene->bvh, pt, vect, max_dist);
+    }
+    for(t=0; t<scene->mesh->tri_count; t++) {
+        if(Mesh_intersect(scene->mesh, t, &bary, max_dist, pt, vect) != max_dist) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Function: Render_clamp
+ * Rounds a color channel to the nearest byte, saturating at 0 and 255.
+ */
+static uint8_t Render_clamp(const double value)
+{
+    if(!(value > 0)) {
+        return 0;
+    }
+    if(value >= 255) {
+        return 255;
+    }
+    return (uint8_t)(value + 0.5);
+}
+
+Color_t * Render_shadeHit(const Scene_t *const scene, Color_t *const opColor, const TriHit_t *const pHit, const Point_t *const pOrigin, const Vect_t *const pDir)
+{
+    Color_t base;
+    Point_t hit_pt, shadow_pt;
+    Vect_t normal, view, toward, unit, reflect;
+    double diffuse = 0, specular = 0;
+    double shade, highlight, ndotl, rdotv, max_dist, size;
+    unsigned int l;
+
+    const Instance_t *const pInst = (scene->instances != NULL) ? &(scene->instances->instances[pHit->instance]) : NULL;
+    const Mesh_t *const pMesh = (pInst != NULL) ? pInst->bvh->mesh : scene->mesh;
+
+    if(pHit->id == TRIBLOCK_EMPTY) {
+        return Color_cfg(opColor, 0, 0, 0);
+    }
+    Mesh_getBaryColor(pMesh, pHit->id, &base, &(pHit->bary));
+    if(scene->light_count == 0) {
+        return Color_copy(opColor, &base);
+    }
+
+    //Where the ray hit, and the triangle's normal turned to face back along the ray. Distances
+    // are the same in an instance's space as in the scene's, so the hit point is too.
+    Vect_scale(&toward, pDir, pHit->dist);
+    Point_translate(&hit_pt, pOrigin, &toward);
+    if(pInst != NULL) {
+        Instance_normal(pInst, &normal, &(pMesh->tris[pHit->id].normal));
+    }
+    else {
+        Vect_copy(&normal, &(pMesh->tris[pHit->id].normal));
+    }
+    if(Vect_dot(&normal, pDir) > 0) {
+        Vect_negate(&normal, &normal);
+    }
+    Vect_normalize(&view, pDir);
+    Vect_negate(&view, &view);
+
+    size = fabs(hit_pt.x);
+    if(fabs(hit_pt.y) > size) size = fabs(hit_pt.y);
+    if(fabs(hit_pt.z) > size) size = fabs(hit_pt.z);
+    Vect_scale(&toward, &normal, (Real_t)(RENDER_SHADOW_BIAS * (1 + size)));
+    Point_translate(&shadow_pt, &hit_pt, &toward);
+
+    for(l=0; l<scene->light_count; l++) {
+        const Light_t *const pLight = &(scene->lights[l]);
+
+        //Written so a light exactly at the hit point (giving NaN) is skipped too.
+        max_dist = Light_toward(pLight, &shadow_pt, &toward);
+        Vect_normalize(&unit, &toward);
+        ndotl = Vect_dot(&normal, &unit);
+        if(!(ndotl > 0) || Render_occluded(scene, &shadow_pt, &toward, max_dist)) {
+            continue;
+        }
+        diffuse += pLight->intensity * ndotl;
+
+        //Phong: the light reflected about the normal, against the direction back to the eye.
+        Vect_scale(&reflect, &normal, (Real_t)(2 * ndotl));
+        Vect_sub(&reflect, &reflect, &unit);
+        rdotv = Vect_dot(&reflect, &view);
+        if(rdotv > 0) {
+            specular += pLight->intensity * pow(rdotv, RENDER_SHININESS);
+        }
+    }
+
+    shade = scene->ambient + diffuse;
+    highlight = 255 * RENDER_SPECULAR * specular;
+    return Color_cfg(opColor,
+        Render_clamp((base.r * shade) + highlight),
+        Render_clamp((base.g * shade) + highlight),
+        Render_clamp((base.b * shade) + highlight));
+}
+
+/**
+ * Function: Render_fillBlock
+ * Colors the part of the block with its top left corner at (<x0>, <y0>) which is inside the tile.
+ */
+static void Render_fillBlock(const RenderJob_t *const pJob, const Tile_t *const pTile, const int x0, const int y0, const uint8_t *const rgb)
+{
+    const int x1 = (x0 + pJob->block < pTile->x1) ? x0 + pJob->block : pTile->x1;
+    const int y1 = (y0 + pJob->block < pTile->y1) ? y0 + pJob->block : pTile->y1;
+    int i, j;
+    uint8_t *pix;
+
+    for(j=y0; j<y1; j++) {
+        pix = pJob->pixels + ((j - pJob->area.y0) * pJob->rowstride) + ((x0 - pJob->area.x0) * 3);
+        for(i=x0; i<x1; i++) {
+            pix[0] = rgb[0];
+            pix[1] = rgb[1];
+            pix[2] = rgb[2];
+            pix += 3;
+        }
+    }
+}
+
+static void Render_tile(void *const pCtx, const Tile_t *const pTile, const unsigned int worker)
+{
+    const RenderJob_t *const pJob = (const RenderJob_t *)pCtx;
+    const int block = pJob->block;
+    const int span = RENDER_PACKET_SIZE * block;
+    int i, j, x0, y0, x1, y1;
+    unsigned int r;
+    const uint8_t *pix;
+    uint8_t rgb[3];
+    Color_t render_color;
+    RayPacket_t packet;
+
+    //Tiles start on multiples of the tile size, so blocks never straddle two tiles, and the
+    // previous pass's sample for a block is always in this tile.
+    for(y0=pTile->y0; y0<pTile->y1; y0+=span) {
+        for(x0=pTile->x0; x0<pTile->x1; x0+=span) {
+            x1 = (x0 + span < pTile->x1) ? x0 + span : pTile->x1;
+            y1 = (y0 + span < pTile->y1) ? y0 + span : pTile->y1;
+
+            //One ray per block, except those already cast in the previous pass, which just
+            // have their blocks shrunk.
+            RayPacket_cfg(&packet, &(pJob->frame), &(pJob->eye));
+            for(j=y0; j<y1; j+=block) {
+                for(i=x0; i<x1; i+=block) {
+                    if(pJob->refine && (i % (2 * block)) == 0 && (j % (2 * block)) == 0) {
+                        pix = pJob->pixels + ((j - pJob->area.y0) * pJob->rowstride) + ((i - pJob->area.x0) * 3);
+                        rgb[0] = pix[0];
+                        rgb[1] = pix[1];
+                        rgb[2] = pix[2];
+                        Render_fillBlock(pJob, pTile, i, j, rgb);
+                    }
+                    else {
+                        Render_addPixel(pJob, &packet, i, j);
+                    }
+                }
+            }
+            if(packet.count == 0) {
+                continue;
+            }
+
+            RayPacket_cfgFrustum(&packet);
+            Render_tracePacket(pJob->scene, &packet);
+
+            //Only the closest hit for each ray is colored.
+            for(r=0; r<packet.count; r++) {
+                RAYSTATS_TARGET(&(packet.stats[r]));
+                Render_shadeHit(pJob->scene, &render_color, &(packet.hits[r]), &(packet.origins[r]), &(packet.dirs[r]));
+                Render_countRay(pJob->scene, &packet, r);
+                rgb[0] = render_color.r;
+                rgb[1] = render_color.g;
+                rgb[2] = render_color.b;
+                Render_fillBlock(pJob, pTile, packet.cols[r], packet.rows[r], rgb);
+            }
+            RAYSTATS_TARGET(NULL);
+        }
+    }
+}
+
+/**
+ * Function: Render_record
+ * Records a primary ray's hit (or miss) in the job's visibility buffer.
+ */
+static void Render_record(const RenderJob_t *const pJob, const int col, const int row, const TriHit_t *const pHit)
+{
+    VisBuffer_t *const pBuffer = pJob->buffer;
+    const size_t k = ((size_t)(row - pJob->area.y0) * pBuffer->width) + (col - pJob->area.x0);
+
+    if(pHit->id != TRIBLOCK_EMPTY) {
+        pBuffer->ids[k] = pHit->id;
+        pBuffer->dists[k] = pHit->dist;
+        pBuffer->bary_u[k] = pHit->bary.y;
+        pBuffer->bary_v[k] = pHit->bary.z;
+        pBuffer->instances[k] = pHit->instance;
+    }
+    else {
+        pBuffer->ids[k] = TRIBLOCK_EMPTY;
+        pBuffer->dists[k] = INFINITY;
+        pBuffer->bary_u[k] = 0;
+        pBuffer->bary_v[k] = 0;
+        pBuffer->instances[k] = 0;
+    }
+}
+
+/**
+ * Function: Render_rasterTile
+ * <Render_visibilityTile> with the job's rasterizer. The ray through each pixel it's sure of is
+ * tested against just the triangle it found, which gives the hit exactly as tracing would. The
+ * rest, and any that miss that triangle after all, are traced in packets as usual.
+ */
+static void Render_rasterTile(const RenderJob_t *const pJob, const Tile_t *const pTile)
+{
+    const Mesh_t *const pMesh = pJob->scene->mesh;
+    const int width = pTile->x1 - pTile->x0;
+    uint32_t ids[RASTER_TILE_MAX * RASTER_TILE_MAX];
+    int i, j, x0, y0, x1, y1;
+    unsigned int r;
+    double dist;
+    TriHit_t hit;
+    Point_t origin;
+    Vect_t ray;
+    RayPacket_t packet;
+
+    Raster_tile(pJob->raster, pTile, ids);
+    for(y0=pTile->y0; y0<pTile->y1; y0+=RENDER_PACKET_SIZE) {
+        for(x0=pTile->x0; x0<pTile->x1; x0+=RENDER_PACKET_SIZE) {
+            x1 = (x0 + RENDER_PACKET_SIZE < pTile->x1) ? x0 + RENDER_PACKET_SIZE : pTile->x1;
+            y1 = (y0 + RENDER_PACKET_SIZE < pTile->y1) ? y0 + RENDER_PACKET_SIZE : pTile->y1;
+
+            RayPacket_cfg(&packet, &(pJob->frame), &(pJob->eye));
+            for(j=y0; j<y1; j++) {
+                for(i=x0; i<x1; i++) {
+                    hit.id = ids[((j - pTile->y0) * width) + (i - pTile->x0)];
+                    hit.instance = 0;
+                    if(hit.id == RASTER_UNSURE) {
+                        Render_addPixel(pJob, &packet, i, j);
+                        continue;
+                    }
+                    if(hit.id != TRIBLOCK_EMPTY) {
+                        Render_primaryRay(pJob, i, j, &origin, &ray);
+                        RAYSTATS_TARGET(RayStatsMap_at(pJob->scene->stats, i, j));
+                        dist = Mesh_intersect(pMesh, hit.id, &(hit.bary), INFINITY, &origin, &ray);
+                        if(dist == INFINITY) {
+                            Render_addPixel(pJob, &packet, i, j);
+                            continue;
+                        }
+                        hit.dist = (Real_t)dist;
+                    }
+                    Render_record(pJob, i, j, &hit);
+                }
+            }
+            RAYSTATS_TARGET(NULL);
+            if(packet.count == 0) {
+                continue;
+            }
+
+            RayPacket_cfgFrustum(&packet);
+            Render_tracePacket(pJob->scene, &packet);
+            for(r=0; r<packet.count; r++) {
+                Render_record(pJob, packet.cols[r], packet.rows[r], &(packet.hits[r]));
+                Render_countRay(pJob->scene, &packet, r);
+            }
+        }
+    }
+}
+
+static void Render_visibilityTile(void *const pCtx, const Tile_t *const pTile, const unsigned int worker)
+{
+    const RenderJob_t *const pJob = (const RenderJob_t *)pCtx;
+    int i, j, x0, y0, x1, y1;
+    unsigned int r;
+    RayPacket_t packet;
+
+    if(pJob->raster != NULL) {
+        Render_rasterTile(pJob, pTile);
+        return;
+    }
+
+    for(y0=pTile->y0; y0<pTile->y1; y0+=RENDER_PACKET_SIZE) {
+        for(x0=pTile->x0; x0<pTile->x1; x0+=RENDER_PACKET_SIZE) {
+            x1 = (x0 + RENDER_PACKET_SIZE < pTile->x1) ? x0 + RENDER_PACKET_SIZE : pTile->x1;
+            y1 = (y0 + RENDER_PACKET_SIZE < pTile->y1) ? y0 + RENDER_PACKET_SIZE : pTile->y1;
+
+            RayPacket_cfg(&packet, &(pJob->frame), &(pJob->eye));
+            for(j=y0; j<y1; j++) {
+                for(i=x0; i<x1; i++) {
+                    Render_addPixel(pJob, &packet, i, j);
+                }
+            }
+            RayPacket_cfgFrustum(&packet);
+            Render_tracePacket(pJob->scene, &packet);
+
+            for(r=0; r<packet.count; r++) {
+                Render_record(pJob, packet.cols[r], packet.rows[r], &(packet.hits[r]));
+                Render_countRay(pJob->scene, &packet, r);
+            }
+        }
+    }
+}
+
+/**
+ * Function: Render_visibilityArea
+ * <Render_visibility> for the given part of the image (or all of it, for NULL), which the buffer
+ * is the size of.
+ */
+static void Render_visibilityArea(const Scene_t *const scene, VisBuffer_t *const pBuffer, const Tile_t *const pArea)
+{
+    RenderJob_t job;
+
+    Render_cfgJob(&job, scene, pArea);
+    job.buffer = pBuffer;
+    if(Render_rasterizes(scene)) {
+        //Always the whole image's view, so a region's pixels come out as they would in it.
+        job.raster = Raster_project(scene->raster, scene->mesh, &(job.frame), &(job.eye), scene->img_width, scene->img_height, scene->threads);
+    }
+
+    TilePool_runRect(&(job.area), RENDER_TILE_SIZE, scene->threads, Render_visibilityTile, &job);
+}
+
+void Render_visibility(const Scene_t *const scene, VisBuffer_t *const pBuffer)
+{
+    Render_visibilityArea(scene, pBuffer, NULL);
+}
+
+static void Render_shadeTile(void *const pCtx, const Tile_t *const pTile, const unsigned int worker)
+{
+    const RenderJob_t *const pJob = (const RenderJob_t *)pCtx;
+    const VisBuffer_t *const pBuffer = pJob->source;
+    int i, j;
+    size_t k;
+    uint8_t *pix;
+    TriHit_t hit;
+    Point_t origin;
+    Vect_t ray;
+    Color_t color;
+
+    for(j=pTile->y0; j<pTile->y1; j++) {
+        pix = pJob->pixels + ((j - pJob->area.y0) * pJob->rowstride) + ((pTile->x0 - pJob->area.x0) * 3);
+        for(i=pTile->x0; i<pTile->x1; i++) {
+            //The same ray and hit the pixel was traced with.
+            k = ((size_t)(j - pJob->area.y0) * pBuffer->width) + (i - pJob->area.x0);
+            hit.id = pBuffer->ids[k];
+            hit.instance = pBuffer->instances[k];
+            hit.dist = pBuffer->dists[k];
+            Point_cfg(&(hit.bary), 1 - pBuffer->bary_u[k] - pBuffer->bary_v[k], pBuffer->bary_u[k], pBuffer->bary_v[k]);
+            Render_primaryRay(pJob, i, j, &origin, &ray);
+
+            //Shadow rays count toward the pixel straight away.
+            RAYSTATS_TARGET(RayStatsMap_at(pJob->scene->stats, i, j));
+            Render_shadeHit(pJob->scene, &color, &hit, &origin, &ray);
+            pix[0] = color.r;
+            pix[1] = color.g;
+            pix[2] = color.b;
+            pix += 3;
+        }
+    }
+    RAYSTATS_TARGET(NULL);
+}
+
+/**
+ * Function: Render_shadeArea
+ * <Render_shade> for the given part of the image (or all of it, for NULL), which the buffer and
+ * <pixels> are the size of.
+ */
+static void Render_shadeArea(const Scene_t *const scene, const VisBuffer_t *const pBuffer, uint8_t *const pixels, const int rowstride, const Tile_t *const pArea)
+{
+    RenderJob_t job;
+
+    if(scene->light_count == 0 && scene->instances == NULL) {
+        VisBuffer_shade(pBuffer, scene->mesh, pixels, rowstride);
+        return;
+    }
+
+    Render_cfgJob(&job, scene, pArea);
+    job.pixels = pixels;
+    job.rowstride = rowstride;
+    job.buffer = NULL;
+    job.source = pBuffer;
+
+    TilePool_runRect(&(job.area), RENDER_TILE_SIZE, scene->threads, Render_shadeTile, &job);
+}
+
+void Render_shade(const Scene_t *const scene, const VisBuffer_t *const pBuffer, uint8_t *const pixels, const int rowstride)
+{
+    Render_shadeArea(scene, pBuffer, pixels, rowstride, NULL);
+}
+
+void Render_scene(const Scene_t *const scene, uint8_t *const pixels, const int rowstride)
+{
+    VisBuffer_t buffer;
+
+    if(scene->aa_samples == 0 && !Render_rasterizes(scene)) {
+        Render_scenePass(scene, pixels, rowstride, 1, false);
+        return;
+    }
+
+    VisBuffer_cfg(&buffer, scene->img_width, scene->img_height);
+    Render_visibility(scene, &buffer);
+    Render_shade(scene, &buffer, pixels, rowstride);
+    Render_antialias(scene, &buffer, pixels, rowstride);
+    VisBuffer_destroy(&buffer);
+}
+
+/**
+ * Function: Render_isEdge
+ * Whether two neighbouring pixels, at <k1> and <k2> in the buffer, need antialiasing.
+ */
+static bool Render_isEdge(const VisBuffer_t *const pBuffer, const uint32_t k1, const uint32_t k2, const uint8_t *const pix1, const uint8_t *const pix2)
+{
+    int c;
+
+    if(pBuffer->ids[k1] == pBuffer->ids[k2] && pBuffer->instances[k1] == pBuffer->instances[k2]) {
+        return false;
+    }
+    for(c=0; c<3; c++) {
+        if(abs((int)(pix1[c]) - (int)(pix2[c])) > RENDER_AA_THRESHOLD) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Function: Render_random
+ * Next number from a xorshift generator, for the jitter.
+ */
+static uint32_t Render_random(uint32_t *const pState)
+{
+    uint32_t x = *pState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *pState = x;
+    return x;
+}
+
+/**
+ * Function: Render_randomUnit
+ * A random number in [0, 1).
+ */
+static double Render_randomUnit(uint32_t *const pState)
+{
+    return (Render_random(pState) >> 8) * (1.0 / 16777216.0);
+}
+
+static void Render_antialiasTile(void *const pCtx, const Tile_t *const pTile, const unsigned int worker)
+{
+    const RenderJob_t *const pJob = (const RenderJob_t *)pCtx;
+    const unsigned int samples = pJob->scene->aa_samples;
+    const int width = pJob->area.x1 - pJob->area.x0;
+    unsigned int perm[RAYPACKET_MAX];
+    unsigned int k, m, tmp, r, sum[3];
+    uint32_t state;
+    int i, j;
+    uint8_t *pix;
+    Color_t color;
+    RayPacket_t packet;
+
+    for(j=pTile->y0; j<pTile->y1; j++) {
+        for(i=pTile->x0; i<pTile->x1; i++) {
+            if(!pJob->edges[((j - pJob->area.y0) * width) + (i - pJob->area.x0)]) {
+                continue;
+            }
+
+            //Seed from the pixel, so it always gets the same jitter. Never zero, which xorshift
+            // would get stuck on.
+            state = ((uint32_t)i * 73856093u) ^ ((uint32_t)j * 19349663u) ^ 0x9E3779B9u;
+            if(state == 0) {
+                state = 1;
+            }
+
+            //Stratify both ways (like N rooks): each sample gets its own column and its own row of
+            // an N by N grid over the pixel, shuffled, and a random spot within that cell.
+            for(k=0; k<samples; k++) {
+                perm[k] = k;
+            }
+            for(k=samples-1; k>0; k--) {
+                m = Render_random(&state) % (k + 1);
+                tmp = perm[k];
+                perm[k] = perm[m];
+                perm[m] = tmp;
+            }
+            RayPacket_cfg(&packet, &(pJob->frame), &(pJob->eye));
+            for(k=0; k<samples; k++) {
+                const double dx = (k + Render_randomUnit(&state)) / samples;
+                const double dy = (perm[k] + Render_randomUnit(&state)) / samples;
+                RayPacket_addSample(&packet, i, j, dx, dy);
+            }
+            RayPacket_cfgFrustum(&packet);
+            Render_tracePacket(pJob->scene, &packet);
+
+            //Average with the one sample the pixel already has.
+            pix = pJob->pixels + ((j - pJob->area.y0) * pJob->rowstride) + ((i - pJob->area.x0) * 3);
+            sum[0] = pix[0];
+            sum[1] = pix[1];
+            sum[2] = pix[2];
+            for(r=0; r<packet.count; r++) {
+                RAYSTATS_TARGET(&(packet.stats[r]));
+                Render_shadeHit(pJob->scene, &color, &(packet.hits[r]), &(packet.origins[r]), &(packet.dirs[r]));
+                Render_countRay(pJob->scene, &packet, r);
+                sum[0] += color.r;
+                sum[1] += color.g;
+                sum[2] += color.b;
+            }
+            RAYSTATS_TARGET(NULL);
+            pix[0] = (uint8_t)((sum[0] + (samples + 1) / 2) / (samples + 1));
+            pix[1] = (uint8_t)((sum[1] + (samples + 1) / 2) / (samples + 1));
+            pix[2] = (uint8_t)((sum[2] + (samples + 1) / 2) / (samples + 1));
+        }
+    }
+}
+
+/**
+ * Function: Render_antialiasArea
+ * <Render_antialias> for the given part of the image (or all of it, for NULL), which the buffer
+ * and <pixels> are the size of, refining only the edges inside <pRefine> (or all of them).
+ */
+static unsigned int Render_antialiasArea(const Scene_t *const scene, const VisBuffer_t *const pBuffer, uint8_t *const pixels, const int rowstride, const Tile_t *const pArea, const Tile_t *const pRefine)
+{
+    const int width = pBuffer->width;
+    const int height = pBuffer->height;
+    RenderJob_t job;
+    const Tile_t *pRect;
+    uint8_t *edges;
+    unsigned int count = 0;
+    int i, j;
+
+    if(scene->aa_samples == 0) {
+        return 0;
+    }
+
+    //Find all the edges before touching any pixels, so every comparison is between original
+    // samples. Mark the pixels on both sides.
+    edges = Util_allocOrDie((size_t)width * height + 1, "Allocating antialiasing edges.");
+    memset(edges, 0, (size_t)width * height);
+    for(j=0; j<height; j++) {
+        for(i=0; i<width; i++) {
+            const uint32_t k = (j * width) + i;
+            const uint8_t *const pix = pixels + (j * rowstride) + (i * 3);
+            if(i+1 < width && Render_isEdge(pBuffer, k, k + 1, pix, pix + 3)) {
+                edges[k] = edges[k + 1] = 1;
+            }
+            if(j+1 < height && Render_isEdge(pBuffer, k, k + width, pix, pix + rowstride)) {
+                edges[k] = edges[k + width] = 1;
+            }
+        }
+    }
+
+    //Samples within pixels aren't cached, so these rays all come from the frame.
+    Render_cfgJob(&job, scene, pArea);
+    job.pixels = pixels;
+    job.rowstride = rowstride;
+    job.buffer = NULL;
+    job.edges = edges;
+    pRect = (pRefine != NULL) ? pRefine : &(job.area);
+    for(j=pRect->y0; j<pRect->y1; j++) {
+        for(i=pRect->x0; i<pRect->x1; i++) {
+            count += edges[((j - job.area.y0) * width) + (i - job.area.x0)];
+        }
+    }
+
+    TilePool_runRect(pRect, RENDER_TILE_SIZE, scene->threads, Render_antialiasTile, &job);
+
+    free(edges);
+    return count;
+}
+
+unsigned int Render_antialias(const Scene_t *const scene, const VisBuffer_t *const pBuffer, uint8_t *const pixels, const int rowstride)
+{
+    return Render_antialiasArea(scene, pBuffer, pixels, rowstride, NULL, NULL);
+}
+
+/**
+ * Function: Render_passArea
+ * <Render_scenePass> for the given part of the image (or all of it, for NULL), which <pixels>
+ * is the size of.
+ */
+static void Render_passArea(const Scene_t *const scene, uint8_t *const pixels, const int rowstride, const int block, const bool refine, const Tile_t *const pArea)
+{
+    RenderJob_t job;
+
+    Render_cfgJob(&job, scene, pArea);
+    job.pixels = pixels;
+    job.rowstride = rowstride;
+    job.block = block;
+    job.refine = refine;
+    job.buffer = NULL;
+
+    TilePool_runRect(&(job.area), RENDER_TILE_SIZE, scene->threads, Render_tile, &job);
+}
+
+void Render_scenePass(const Scene_t *const scene, uint8_t *const pixels, const int rowstride, const int block, const bool refine)
+{
+    Render_passArea(scene, pixels, rowstride, block, refine, NULL);
+}
+
+void Render_regionPass(const Scene_t *const scene, uint8_t *const pixels, const int rowstride, const int block, const bool refine, const Tile_t *const pRect)
+{
+    Render_passArea(scene, pixels, rowstride, block, refine, pRect);
+}
+
+void Render_region(const Scene_t *const scene, uint8_t *const pixels, const int rowstride, const Tile_t *const pRect)
+{
+    Tile_t apron;
+    VisBuffer_t buffer;
+    uint8_t *scratch;
+    int width, height, j;
+
+    if(scene->aa_samples == 0 && !Render_rasterizes(scene)) {
+        Render_passArea(scene, pixels, rowstride, 1, false, pRect);
+        return;
+    }
+
+    //Whether a pixel is an edge depends on its neighbours, so trace and shade a pixel more all
+    // the way round, and only refine the ones inside.
+    apron.x0 = (pRect->x0 > 0) ? pRect->x0 - 1 : 0;
+    apron.y0 = (pRect->y0 > 0) ? pRect->y0 - 1 : 0;
+    apron.x1 = (pRect->x1 < scene->img_width) ? pRect->x1 + 1 : scene->img_width;
+    apron.y1 = (pRect->y1 < scene->img_height) ? pRect->y1 + 1 : scene->img_height;
+    width = apron.x1 - apron.x0;
+    height = apron.y1 - apron.y0;
+
+    scratch = Util_allocOrDie((size_t)width * height * 3 + 1, "Allocating region pixels.");
+    VisBuffer_cfg(&buffer, width, height);
+    Render_visibilityArea(scene, &buffer, &apron);
+    Render_shadeArea(scene, &buffer, scratch, width * 3, &apron);
+    Render_antialiasArea(scene, &buffer, scratch, width * 3, &apron, pRect);
+    VisBuffer_destroy(&buffer);
+
+    for(j=pRect->y0; j<pRect->y1; j++) {
+        memcpy(pixels + ((j - pRect->y0) * rowstride),
+            scratch + ((size_t)(j - apron.y0) * width * 3) + ((pRect->x0 - apron.x0) * 3),
+            (size_t)(pRect->x1 - pRect->x0) * 3);
+    }
+    free(scratch);
+}
@@ -0,0 +1,213 @@
+/**
+ * File: render.h
+ *
+ * Renders a <Scene_t> into a plain buffer of 24-bit RGB pixels.
+ */
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "scene.h"
+#include "triblock.h"
+#include "visbuffer.h"
+#include "raypacket.h"
+#include "tilepool.h"
+#include "color.h"
+#include "point.h"
+#include "vect.h"
+
+/**
+ * Constant: RENDER_TILE_SIZE
+ * Width and height, in pixels, of the tiles the image is split into for the worker threads.
+ */
+#define RENDER_TILE_SIZE 16
+
+/**
+ * Constant: RENDER_PACKET_SIZE
+ * Width and height, in rays, of the packets rays are traced in (see <RayPacket_t>). Its
+ * square must be no more than <RAYPACKET_MAX>.
+ */
+#define RENDER_PACKET_SIZE 8
+
+/**
+ * Constant: RENDER_AA_THRESHOLD
+ * How much two neighbouring pixels that hit different triangles (or where one hit nothing)
+ * have to differ by, in any of red, green, or blue, for <Render_antialias> to refine them.
+ */
+#define RENDER_AA_THRESHOLD 16
+
+/**
+ * Constant: RENDER_COARSE_BLOCK
+ * Width and height, in pixels, of the blocks in the first (coarsest) pass of a progressive
+ * render; see <Render_scenePass>. Must be a power of two no bigger than <RENDER_TILE_SIZE>.
+ */
+#define RENDER_COARSE_BLOCK 8
+
+/**
+ * Constants: RENDER_SPECULAR, RENDER_SHININESS
+ * Strength and exponent of the Phong highlights in <Render_shadeHit>.
+ */
+#define RENDER_SPECULAR 0.3
+#define RENDER_SHININESS 32
+
+/**
+ * Function: Render_castRay
+ * Casts the ray from <pEye> through <pPt> into the scene, and gets the color of the closest
+ * triangle it hits, or black if it doesn't hit anything. This is <Render_traceRay>, and then
+ * coloring just the one hit it finds with <Render_shadeHit>.
+ */
+Color_t * Render_castRay(const Scene_t *scene, Color_t *opColor, const Point_t *pEye, const Point_t *pPt);
+
+/**
+ * Function: Render_traceRay
+ * Casts the ray from <pEye> through <pPt> into the scene like <Render_castRay>, but only finds
+ * the closest triangle it hits, without coloring it. Returns false if it doesn't hit anything,
+ * in which case the id in <opHit> is <TRIBLOCK_EMPTY>.
+ */
+bool Render_traceRay(const Scene_t *scene, TriHit_t *opHit, const Point_t *pEye, const Point_t *pPt);
+
+/**
+ * Function: Render_tracePacket
+ * Finds the closest hit for every ray in a packet, with exactly the same results as
+ * <Render_traceRay> on each of them. With a hierarchy this is <Bvh_packetHit>; without one,
+ * each triangle is checked against the packet's frustum before any of the rays are tested
+ * against it. With <Scene_t.instances>, each ray is traced on its own with
+ * <InstanceBvh_rayHit>.
+ */
+void Render_tracePacket(const Scene_t *scene, RayPacket_t *pPacket);
+
+/**
+ * Function: Render_occluded
+ * Whether anything in the scene is hit by the ray from <pt> along <vect> closer than <max_dist>
+ * (in lengths of <vect>). This stops at the first hit it finds, so it's cheaper than
+ * <Render_traceRay> for shadow rays. See <Bvh_occluded>.
+ */
+bool Render_occluded(const Scene_t *scene, const Point_t *pt, const Vect_t *vect, double max_dist);
+
+/**
+ * Function: Render_shadeHit
+ *
+ * Gets the color of a hit found along the ray from <pOrigin> along <pDir>, or black if
+ * <pHit> is empty.
+ *
+ * Without <Scene_t.lights> this is just the triangle's color at the hit, from
+ * <Mesh_getBaryColor>. With them, the color is lit by each light that isn't blocked by
+ * something else in the scene (<Render_occluded>), with Lambert diffuse shading plus white
+ * Phong highlights (<RENDER_SPECULAR>, <RENDER_SHININESS>), on top of <Scene_t.ambient>.
+ * Triangles are lit from whichever side the ray hits them.
+ */
+Color_t * Render_shadeHit(const Scene_t *scene, Color_t *opColor, const TriHit_t *pHit, const Point_t *pOrigin, const Vect_t *pDir);
+
+/**
+ * Function: Render_shade
+ *
+ * Shades every pixel of a visibility buffer from <Render_visibility> with <Render_shadeHit>,
+ * into <pixels> as for <Render_scene>. Without any <Scene_t.lights> this is just
+ * <VisBuffer_shade>. With them, or with <Scene_t.instances>, each pixel's ray is rebuilt from
+ * the scene's frame, and the shading is done over <Scene_t.threads> threads.
+ */
+void Render_shade(const Scene_t *scene, const VisBuffer_t *pBuffer, uint8_t *pixels, int rowstride);
+
+/**
+ * Function: Render_scene
+ *
+ * Renders the scene into <pixels>, which holds <Scene_t.img_height> rows of
+ * <Scene_t.img_width> RGB triplets, with rows starting <rowstride> bytes apart.
+ *
+ * The image is rendered in tiles over <Scene_t.threads> threads, and the rays in each tile are
+ * traced in packets of <RENDER_PACKET_SIZE> squared with <Render_tracePacket>. Every pixel is
+ * computed independently, so the result is exactly the same for any number of threads. Each pixel is
+ * colored once, for its closest hit, so this gives exactly the same image as
+ * <Render_visibility> followed by <Render_shade>, without the buffer in between; keep a
+ * <VisBuffer_t> instead when the same view is going to be shaded more than once.
+ *
+ * If <Scene_t.aa_samples> is set, the scene is rendered through a visibility buffer like that
+ * after all, and then <Render_antialias> refines the edges. So is a scene with a
+ * <Scene_t.raster>, to rasterize its primary visibility.
+ */
+void Render_scene(const Scene_t *scene, uint8_t *pixels, int rowstride);
+
+/**
+ * Function: Render_antialias
+ *
+ * Smooths the edges in an image rendered with one sample per pixel, given the visibility
+ * buffer it was shaded from. A pixel is an edge if a neighbour above, below, or to either side
+ * hit a different triangle (or hit something where it didn't, or the other way round) and
+ * differs from it by more than <RENDER_AA_THRESHOLD>. Where triangles meet without a visible
+ * change in color there's nothing to smooth, so smooth meshes aren't refined all over.
+ *
+ * Each edge pixel gets <Scene_t.aa_samples> more rays, traced together as a packet, through
+ * jittered points spread over the pixel's footprint (from its point on the frame, one
+ * <Frame_t.step_right> across and one <Frame_t.step_down> down), and becomes the average of
+ * those and its original sample. The jitter is fixed for each pixel, so the result is the same
+ * from run to run and for any number of threads.
+ *
+ * Returns the number of pixels refined.
+ */
+unsigned int Render_antialias(const Scene_t *scene, const VisBuffer_t *pBuffer, uint8_t *pixels, int rowstride);
+
+/**
+ * Function: Render_visibility
+ *
+ * Traces a ray for every pixel of the scene, and records what it hit in <pBuffer>, which must be
+ * <Scene_t.img_width> by <Scene_t.img_height> pixels.
+ *
+ * The image is traced in tiles and packets just as in <Render_scene>, so the result is exactly
+ * the same for any number of threads.
+ *
+ * With a <Scene_t.raster> (and no <Scene_t.instances>), the mesh is rasterized instead, tile by
+ * tile (see raster.h), and only the rays through pixels the rasterizer isn't sure of are traced.
+ * The rest are each tested against just the one triangle they see, so their hits come out
+ * exactly as tracing finds them, and the buffer is the same either way, only much quicker to
+ * fill for a big mesh. Shading, shadows, and antialiasing still cast rays as usual.
+ */
+void Render_visibility(const Scene_t *scene, VisBuffer_t *pBuffer);
+
+/**
+ * Function: Render_rasterizes
+ * Whether the scene's primary visibility is found with its <Scene_t.raster>: only when it has
+ * one, and no <Scene_t.instances>, which are always traced.
+ */
+bool Render_rasterizes(const Scene_t *scene);
+
+/**
+ * Function: Render_scenePass
+ *
+ * Renders one pass of a progressive render: the image is split into square blocks of
+ * <block> pixels, and one ray is cast for each block, through its top left pixel, to color
+ * the whole block. <block> must be a power of two no bigger than <RENDER_TILE_SIZE>.
+ *
+ * Starting at <RENDER_COARSE_BLOCK> and halving <block> each pass gives a rough image
+ * quickly, which sharpens until the pass with a <block> of 1. That pass traces every pixel's
+ * ray, and never antialiases or rasterizes, so it's the same as <Render_scene> only when the
+ * scene's <Scene_t.aa_samples> is 0 and it has no <Scene_t.raster>; otherwise finish with
+ * <Render_scene> instead. If <refine> is true, <pixels> must hold the previous pass, with a
+ * block twice the size, and the rays that pass already cast are not cast again; that way all
+ * the passes together cost no more than one full render.
+ */
+void Render_scenePass(const Scene_t *scene, uint8_t *pixels, int rowstride, int block, bool refine);
+
+/**
+ * Function: Render_regionPass
+ * <Render_scenePass> for just the given rectangle of the image, with <pixels> holding that
+ * rectangle's rows as for <Render_region>. The rectangle must start on a multiple of
+ * <RENDER_TILE_SIZE>, so its blocks are the same as the whole image's.
+ */
+void Render_regionPass(const Scene_t *scene, uint8_t *pixels, int rowstride, int block, bool refine, const Tile_t *pRect);
+
+/**
+ * Function: Render_region
+ *
+ * Renders just the given rectangle of the scene's image into <pixels>, which holds that
+ * rectangle's rows (from its top left pixel) with rows starting <rowstride> bytes apart. The
+ * pixels come out exactly as <Render_scene> would render them, antialiasing included, so an
+ * image can be put together from regions rendered separately, in any order, by different
+ * processes. Regions starting on multiples of <RENDER_TILE_SIZE> split up into the same tiles
+ * as the whole image.
+ */
+void Render_region(const Scene_t *scene, uint8_t *pixels, int rowstride, const Tile_t *pRect);
+
+#endif
+//end inclusion filter
@@ -0,0 +1,50 @@
+/**
+ * File: scene.c
+ *
+ */
+#include "scene.h"
+
+#include "camera.h"
+#include "point.h"
+#include "vect.h"
+
+Frame_t * Frame_cfg(Frame_t *const pThis, const Scene_t *const scene)
+{
+    Point_t eye;
+    Vect_t pov;
+    Vect_t up;
+    Vect_t right;
+
+    //Get the eye, pov, and up vector from the camera.
+    Camera_getEye(scene->cam, &eye);
+    Camera_getPov(scene->cam, &pov);
+    Camera_getUp(scene->cam, &up);
+
+    //Create the vector pointing right as the cross product of up and pov.
+    Vect_cross(&right, &pov, &up);
+
+    //Now make sure up is really up, i.e., perpendicular to both pov and right
+    // (because right is a cross product of pov, we know right is perpendicular to pov.
+    // The cross product of right and pov will be perp to both, so all three will be
+    // mutually perpendicular.
+    Vect_cross(&up, &right, &pov);
+
+    //Make up be half the height of the frame, and right be half the width.
+    Vect_setMag(&up, (scene->frame_height)*0.5);
+    Vect_setMag(&right, (scene->frame_width)*0.5);
+
+    //Get a point in the top-left corner of the frame by starting at the eye,
+    // translating to the center of the frame with pov, then translating to the top-center
+    // of the frame with up, and then translating back to the top-left corner with right.
+    Point_translate(&(pThis->top_left), &eye, &pov);
+    Point_translate(&(pThis->top_left), &(pThis->top_left), &up);
+    Point_translateBack(&(pThis->top_left), &(pThis->top_left), &right);
+
+    //Now get scaled vectors that represent a single step along the grid of the frame,
+    // in each direction.
+    Vect_scale(&(pThis->step_down), &up, -1.0 / (((double)(scene->img_height)) * 0.5));
+    Vect_scale(&(pThis->step_right), &right, 1.0 / (((double)(scene->img_width)) * 0.5));
+
+    return pThis;
+}
+
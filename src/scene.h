@@ -0,0 +1,112 @@
+/**
+ * File: scene.h
+ *
+ * Describes what to render (the triangles and the camera looking at them) and how
+ * big the rendered image is, and sets up the <Frame_t> grid that rays are cast through.
+ */
+#ifndef SCENE_H
+#define SCENE_H
+
+#include "mesh.h"
+#include "bvh.h"
+#include "instance.h"
+#include "camera.h"
+#include "frame.h"
+#include "light.h"
+#include "raygen.h"
+#include "raster.h"
+#include "raystats.h"
+#include "point.h"
+#include "vect.h"
+
+/**
+ * Struct: Scene_t
+ */
+typedef struct {
+    /**
+     * Field: mesh
+     * The triangles in the scene.
+     */
+    const Mesh_t *mesh;
+
+    /**
+     * Field: bvh
+     * Hierarchy built over <mesh>, or NULL to test every triangle for every ray.
+     */
+    const Bvh_t *bvh;
+
+    /**
+     * Field: instances
+     * Copies of meshes to render instead of <mesh> and <bvh>, which are then ignored, or NULL.
+     */
+    const InstanceBvh_t *instances;
+
+    const Camera_t *cam;
+    double frame_width;
+    double frame_height;
+    int img_width;
+    int img_height;
+
+    /**
+     * Field: threads
+     * Number of worker threads to render with, or 0 to use one per CPU.
+     */
+    unsigned int threads;
+
+    /**
+     * Field: aa_samples
+     * Extra jittered samples to take in each pixel along an edge, or 0 for just one sample per
+     * pixel. At most <RAYPACKET_MAX>. See <Render_antialias>.
+     */
+    unsigned int aa_samples;
+
+    /**
+     * Fields: lights, light_count
+     * The lights shining on the scene. With none, every triangle is shown in its own flat
+     * colors, as if lit evenly from everywhere; see <Render_shadeHit>.
+     */
+    const Light_t *lights;
+    unsigned int light_count;
+
+    /**
+     * Field: ambient
+     * How much of a triangle's color shows where no light reaches it, from 0 to 1. Only used if
+     * there are <lights>.
+     */
+    double ambient;
+
+    /**
+     * Field: rays
+     * Cache of the primary rays to render with, which rendering brings up to date with
+     * <RayGen_update>, or NULL to cast every ray through the <Frame_t> afresh. Rendering with
+     * one gives the same image up to rounding, and keeping it from frame to frame saves working
+     * the rays out again while the camera only moves, or the image only gets rendered again.
+     */
+    RayGen_t *rays;
+
+    /**
+     * Field: raster
+     * Rasterizer to find what the primary rays hit with (see <Render_visibility>), or NULL to
+     * trace them all. It's brought up to date with <Raster_project> for every image, and kept
+     * so its memory is reused. Ignored with <instances>.
+     */
+    Raster_t *raster;
+
+    /**
+     * Field: stats
+     * Counts of what each pixel costs to render, the size of the image, which rendering adds
+     * to (so it needs clearing between images to count them separately), or NULL. Only counted
+     * when built with RT_STATS; see <RayStats_t>.
+     */
+    RayStatsMap_t *stats;
+} Scene_t;
+
+/**
+ * Function: Frame_cfg
+ * Configures the frame for the scene's camera, frame size, and image size.
+ */
+Frame_t * Frame_cfg(Frame_t *pThis, const Scene_t *scene);
+
+#endif
+//end inclusion filter
+
@@ -0,0 +1,982 @@
+/**
+ * File: tilefarm.c
+ *
+ */
+#include "tilefarm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif
+
+#include "scene.h"
+#include "render.h"
+#include "tilepool.h"
+#include "camera.h"
+#include "types.h"
+#include "util.h"
+
+#ifndef _WIN32
+
+/**
+ * Constant: TILEFARM_MAGIC
+ * Starts every message: "RTF" and the size of a <Real_t>, so a float build and a double build
+ * won't talk to each other.
+ */
+#define TILEFARM_MAGIC (0x52544600u | (uint32_t)sizeof(Real_t))
+
+/**
+ * Constants: Message types
+ *
+ * TILEFARM_VIEW - To a worker: the view to render tiles of, a <TileFarmView_t>.
+ * TILEFARM_TILE - To a worker: render the tile in the header.
+ * TILEFARM_PIXELS - From a worker: the tile in the header, rendered, as packed RGB rows.
+ * TILEFARM_STOP - To a worker: exit.
+ * TILEFARM_HELLO - From a remote worker, first thing: its <TileFarm_fingerprint>, a uint64_t.
+ * TILEFARM_WELCOME - To a remote worker: its scene is the coordinator's, tiles will follow.
+ * TILEFARM_REFUSE - To a remote worker: its scene isn't the coordinator's, so it's hung up on.
+ */
+#define TILEFARM_VIEW 1
+#define TILEFARM_TILE 2
+#define TILEFARM_PIXELS 3
+#define TILEFARM_STOP 4
+#define TILEFARM_HELLO 5
+#define TILEFARM_WELCOME 6
+#define TILEFARM_REFUSE 7
+
+/**
+ * Struct: TileFarmMsg_t
+ * The header of every message, followed by <size> bytes of payload.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t type;
+
+    /**
+     * Fields: image, tile
+     * Which image (counting from 1 for each coordinator), and which tile of it, a tile or its
+     * pixels are for. Workers send them back as they got them.
+     */
+    uint32_t image;
+    uint32_t tile;
+
+    Tile_t rect;
+    uint32_t size;
+} TileFarmMsg_t;
+
+/**
+ * Struct: TileFarmView_t
+ * Everything about the scene that can change from one image to the next.
+ */
+typedef struct {
+    int img_width;
+    int img_height;
+    double frame_width;
+    double frame_height;
+    Camera_t cam;
+    unsigned int aa_samples;
+} TileFarmView_t;
+
+/**
+ * Function: TileFarm_send
+ * Sends all <size> bytes, without raising SIGPIPE if the other end has gone.
+ */
+static bool TileFarm_send(const int fd, const void *const pData, const size_t size)
+{
+    const uint8_t *p = (const uint8_t *)pData;
+    size_t left = size;
+    ssize_t sent;
+
+    while(left > 0) {
+        sent = send(fd, p, left, MSG_NOSIGNAL);
+        if(sent < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        p += sent;
+        left -= (size_t)sent;
+    }
+    return true;
+}
+
+/**
+ * Function: TileFarm_recv
+ * Receives exactly <size> bytes. Returns 1 if it got them, 0 if the other end hung up before
+ * sending any of them, and -1 on an error or if it hung up part way through.
+ */
+static int TileFarm_recv(const int fd, void *const opData, const size_t size)
+{
+    uint8_t *p = (uint8_t *)opData;
+    size_t left = size;
+    ssize_t got;
+
+    while(left > 0) {
+        got = recv(fd, p, left, 0);
+        if(got < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if(got == 0) {
+            return (left == size) ? 0 : -1;
+        }
+        p += got;
+        left -= (size_t)got;
+    }
+    return 1;
+}
+
+/**
+ * Function: TileFarm_sendMsg
+ * Sends a message with the given header fields and payload, which may be NULL if <size> is 0.
+ */
+static bool TileFarm_sendMsg(const int fd, const uint32_t type, const uint32_t image, const uint32_t tile, const Tile_t *const pRect, const void *const pPayload, const size_t size)
+{
+    TileFarmMsg_t msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.magic = TILEFARM_MAGIC;
+    msg.type = type;
+    msg.image = image;
+    msg.tile = tile;
+    if(pRect != NULL) {
+        msg.rect = *pRect;
+    }
+    msg.size = (uint32_t)size;
+    return TileFarm_send(fd, &msg, sizeof(msg)) && (size == 0 || TileFarm_send(fd, pPayload, size));
+}
+
+/**
+ * Function: TileFarm_hash
+ * Adds <size> bytes to an FNV-1a hash.
+ */
+static uint64_t TileFarm_hash(uint64_t hash, const void *const pData, const size_t size)
+{
+    const uint8_t *const bytes = (const uint8_t *)pData;
+    size_t i;
+
+    for(i=0; i<size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * Function: TileFarm_hashReals
+ * Adds a point or vector's coordinates to a hash, field by field, since the struct may have
+ * padding in it.
+ */
+static uint64_t TileFarm_hashReals(const uint64_t hash, const Real_t x, const Real_t y, const Real_t z)
+{
+    const Real_t coords[3] = {x, y, z};
+    return TileFarm_hash(hash, coords, sizeof(coords));
+}
+
+/**
+ * Function: TileFarm_fingerprint
+ *
+ * Hashes everything about the scene a remote worker loads from its own command line, rather
+ * than being sent: the mesh's vertices, colors, and triangles, the copies of it, the lights,
+ * and whether it's rasterized. A worker whose fingerprint isn't the coordinator's would render
+ * different tiles, so it's refused.
+ */
+static uint64_t TileFarm_fingerprint(const Scene_t *const scene)
+{
+    const Mesh_t *const pMesh = scene->mesh;
+    const uint8_t raster = (scene->raster != NULL);
+    uint64_t hash = 14695981039346656037ULL;
+    unsigned int k, count;
+
+    hash = TileFarm_hash(hash, &(pMesh->vert_count), sizeof(pMesh->vert_count));
+    hash = TileFarm_hash(hash, &(pMesh->tri_count), sizeof(pMesh->tri_count));
+    for(k=0; k<pMesh->vert_count; k++) {
+        const Point_t *const pPos = &(pMesh->positions[k]);
+        const Color_t *const pColor = &(pMesh->colors[k]);
+        const uint8_t rgb[3] = {pColor->r, pColor->g, pColor->b};
+        hash = TileFarm_hashReals(hash, pPos->x, pPos->y, pPos->z);
+        hash = TileFarm_hash(hash, rgb, sizeof(rgb));
+    }
+    hash = TileFarm_hash(hash, pMesh->indices, sizeof(uint32_t) * 3 * (size_t)pMesh->tri_count);
+
+    count = (scene->instances != NULL) ? scene->instances->instance_count : 0;
+    hash = TileFarm_hash(hash, &count, sizeof(count));
+    for(k=0; k<count; k++) {
+        const Axes_t *const pAxes = &(scene->instances->instances[k].axes);
+        hash = TileFarm_hashReals(hash, pAxes->x.x, pAxes->x.y, pAxes->x.z);
+        hash = TileFarm_hashReals(hash, pAxes->y.x, pAxes->y.y, pAxes->y.z);
+        hash = TileFarm_hashReals(hash, pAxes->z.x, pAxes->z.y, pAxes->z.z);
+        hash = TileFarm_hashReals(hash, pAxes->origin.x, pAxes->origin.y, pAxes->origin.z);
+    }
+
+    hash = TileFarm_hash(hash, &(scene->light_count), sizeof(scene->light_count));
+    for(k=0; k<scene->light_count; k++) {
+        const Light_t *const pLight = &(scene->lights[k]);
+        const uint32_t type = (uint32_t)pLight->type;
+        hash = TileFarm_hash(hash, &type, sizeof(type));
+        hash = TileFarm_hashReals(hash, pLight->position.x, pLight->position.y, pLight->position.z);
+        hash = TileFarm_hashReals(hash, pLight->direction.x, pLight->direction.y, pLight->direction.z);
+        hash = TileFarm_hash(hash, &(pLight->intensity), sizeof(pLight->intensity));
+    }
+    hash = TileFarm_hash(hash, &(scene->ambient), sizeof(scene->ambient));
+    return TileFarm_hash(hash, &raster, sizeof(raster));
+}
+
+/**
+ * Function: TileFarm_setNoDelay
+ * Turns off Nagle's algorithm on a TCP socket, so the small tile requests go straight out.
+ */
+static void TileFarm_setNoDelay(const int fd)
+{
+    const int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+}
+
+TileFarm_t * TileFarm_cfg(TileFarm_t *const pThis)
+{
+    pThis->worker_count = 0;
+    pThis->listen_fd = -1;
+    pThis->image = 0;
+    pThis->reissued = 0;
+    pThis->requeued = 0;
+    pThis->local = 0;
+    return pThis;
+}
+
+/**
+ * Function: TileFarm_addWorker
+ * Adds a worker on socket <fd>, and process <pid> if it was forked.
+ */
+static void TileFarm_addWorker(TileFarm_t *const pThis, const int fd, const pid_t pid)
+{
+    TileFarmWorker_t *const pWorker = &(pThis->workers[pThis->worker_count++]);
+
+    pWorker->fd = fd;
+    pWorker->pid = pid;
+    pWorker->tile = -1;
+    pWorker->started = 0;
+    pWorker->has_view = false;
+    pWorker->tiles_done = 0;
+}
+
+bool TileFarm_fork(TileFarm_t *const pThis, const Scene_t *const scene, const unsigned int count)
+{
+    const unsigned int threads = (scene->threads > 0) ? scene->threads : TilePool_threads(0) / count;
+    unsigned int k, w;
+    int fds[2];
+    pid_t pid;
+
+    if(pThis->worker_count + count > TILEFARM_MAX_WORKERS) {
+        fprintf(stderr, "Too many workers (at most %d).\n", TILEFARM_MAX_WORKERS);
+        return false;
+    }
+
+    for(k=0; k<count; k++) {
+        if(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            fprintf(stderr, "Can't make a socket for a worker: %s\n", strerror(errno));
+            return false;
+        }
+
+        //Don't let the child flush anything still buffered here a second time.
+        fflush(stdout);
+        fflush(stderr);
+        pid = fork();
+        if(pid < 0) {
+            fprintf(stderr, "Can't fork a worker: %s\n", strerror(errno));
+            close(fds[0]);
+            close(fds[1]);
+            return false;
+        }
+
+        if(pid == 0) {
+            //The worker gets its own copy of the scene, and its own camera to move.
+            Scene_t local = *scene;
+            Camera_t cam = *(scene->cam);
+            bool ok;
+
+            close(fds[0]);
+            for(w=0; w<pThis->worker_count; w++) {
+                if(pThis->workers[w].fd >= 0) {
+                    close(pThis->workers[w].fd);
+                }
+            }
+            if(pThis->listen_fd >= 0) {
+                close(pThis->listen_fd);
+            }
+            local.cam = &cam;
+            local.threads = (threads > 0) ? threads : 1;
+            ok = TileFarm_serve(&local, &cam, fds[1]);
+            _exit(ok ? 0 : 1);
+        }
+
+        close(fds[1]);
+        TileFarm_addWorker(pThis, fds[0], pid);
+    }
+    return true;
+}
+
+/**
+ * Function: TileFarm_greet
+ *
+ * Takes a newly connected remote worker's <TILEFARM_HELLO>, and welcomes it if its scene's
+ * fingerprint is <fingerprint>, or refuses it otherwise.
+ *
+ * Returns whether it was welcomed, having printed why not to stderr if it wasn't.
+ */
+static bool TileFarm_greet(const int fd, const uint64_t fingerprint, const char *const host)
+{
+    TileFarmMsg_t msg;
+    uint64_t theirs;
+
+    if(TileFarm_recv(fd, &msg, sizeof(msg)) != 1 || msg.magic != TILEFARM_MAGIC || msg.type != TILEFARM_HELLO
+        || msg.size != sizeof(theirs) || TileFarm_recv(fd, &theirs, sizeof(theirs)) != 1) {
+        fprintf(stderr, "Refused the worker from %s: it isn't the same build as this coordinator.\n", host);
+        TileFarm_sendMsg(fd, TILEFARM_REFUSE, 0, 0, NULL, NULL, 0);
+        return false;
+    }
+    if(theirs != fingerprint) {
+        fprintf(stderr, "Refused the worker from %s: its scene isn't the same as this one.\n", host);
+        TileFarm_sendMsg(fd, TILEFARM_REFUSE, 0, 0, NULL, NULL, 0);
+        return false;
+    }
+    return TileFarm_sendMsg(fd, TILEFARM_WELCOME, 0, 0, NULL, NULL, 0);
+}
+
+bool TileFarm_listen(TileFarm_t *const pThis, const Scene_t *const scene, const unsigned short port, const unsigned int count)
+{
+    const uint64_t fingerprint = TileFarm_fingerprint(scene);
+    struct sockaddr_in addr;
+    struct sockaddr_storage peer;
+    socklen_t peer_size;
+    char host[NI_MAXHOST];
+    const int on = 1;
+    unsigned int k;
+    int fd;
+
+    if(pThis->worker_count + count > TILEFARM_MAX_WORKERS) {
+        fprintf(stderr, "Too many workers (at most %d).\n", TILEFARM_MAX_WORKERS);
+        return false;
+    }
+
+    if(pThis->listen_fd < 0) {
+        pThis->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        if(pThis->listen_fd < 0) {
+            fprintf(stderr, "Can't make a socket to listen on: %s\n", strerror(errno));
+            return false;
+        }
+        setsockopt(pThis->listen_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(port);
+        if(bind(pThis->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(pThis->listen_fd, TILEFARM_MAX_WORKERS) != 0) {
+            fprintf(stderr, "Can't listen on port %u: %s\n", port, strerror(errno));
+            close(pThis->listen_fd);
+            pThis->listen_fd = -1;
+            return false;
+        }
+    }
+
+    fprintf(stderr, "Waiting for %u workers on port %u.\n", count, port);
+    for(k=0; k<count; k++) {
+        peer_size = sizeof(peer);
+        fd = accept(pThis->listen_fd, (struct sockaddr *)&peer, &peer_size);
+        if(fd < 0) {
+            if(errno == EINTR) {
+                k--;
+                continue;
+            }
+            fprintf(stderr, "Can't accept a worker: %s\n", strerror(errno));
+            return false;
+        }
+        TileFarm_setNoDelay(fd);
+        if(getnameinfo((struct sockaddr *)&peer, peer_size, host, sizeof(host), NULL, 0, NI_NUMERICHOST) != 0) {
+            strcpy(host, "?");
+        }
+
+        //Keep waiting for one that does have the same scene.
+        if(!TileFarm_greet(fd, fingerprint, host)) {
+            close(fd);
+            k--;
+            continue;
+        }
+        fprintf(stderr, "Worker %u connected from %s.\n", pThis->worker_count, host);
+        TileFarm_addWorker(pThis, fd, 0);
+    }
+    return true;
+}
+
+/**
+ * Struct: TileFarmJob_t
+ * The coordinator's state while rendering one image.
+ */
+typedef struct {
+    const Scene_t *scene;
+    uint8_t *pixels;
+    int rowstride;
+
+    /**
+     * Fields: cols, count
+     * Tiles across the image, and in all. Tile t is at column (t % cols), row (t / cols).
+     */
+    int cols;
+    int count;
+
+    /**
+     * Fields: done, copies
+     * For each tile, whether its pixels are in the image, and how many workers are rendering it.
+     */
+    uint8_t *done;
+    uint8_t *copies;
+    int finished;
+
+    /**
+     * Fields: fresh, queue, queued
+     * The next tile that's never been handed out, and tiles whose workers were lost, to hand
+     * out again before it.
+     */
+    int fresh;
+    int *queue;
+    int queued;
+
+    /**
+     * Fields: tile_time, timed
+     * Total seconds the finished tiles took, from being handed out to coming back, and how
+     * many of them there were.
+     */
+    double tile_time;
+    int timed;
+
+    /**
+     * Field: buffer
+     * Where a tile's pixels are received.
+     */
+    uint8_t *buffer;
+
+    TileFarmView_t view;
+} TileFarmJob_t;
+
+/**
+ * Function: TileFarm_rect
+ * Gets the rectangle of tile <t>, clipped to the image.
+ */
+static Tile_t * TileFarm_rect(const TileFarmJob_t *const pJob, Tile_t *const opRect, const int t)
+{
+    opRect->x0 = (t % pJob->cols) * TILEFARM_TILE_SIZE;
+    opRect->y0 = (t / pJob->cols) * TILEFARM_TILE_SIZE;
+    opRect->x1 = opRect->x0 + TILEFARM_TILE_SIZE;
+    opRect->y1 = opRect->y0 + TILEFARM_TILE_SIZE;
+    if(opRect->x1 > pJob->scene->img_width) {
+        opRect->x1 = pJob->scene->img_width;
+    }
+    if(opRect->y1 > pJob->scene->img_height) {
+        opRect->y1 = pJob->scene->img_height;
+    }
+    return opRect;
+}
+
+/**
+ * Function: TileFarm_lose
+ * Hangs up on a worker that's died or misbehaved, making sure it's gone, and queues its tile
+ * to be handed out again if no one else is rendering it.
+ */
+static void TileFarm_lose(TileFarm_t *const pThis, TileFarmJob_t *const pJob, TileFarmWorker_t *const pWorker)
+{
+    const int t = pWorker->tile;
+
+    fprintf(stderr, "Lost worker %u.\n", (unsigned int)(pWorker - pThis->workers));
+    close(pWorker->fd);
+    pWorker->fd = -1;
+    if(pWorker->pid > 0) {
+        kill(pWorker->pid, SIGKILL);
+        waitpid(pWorker->pid, NULL, 0);
+        pWorker->pid = 0;
+    }
+
+    pWorker->tile = -1;
+    if(pJob != NULL && t >= 0) {
+        pJob->copies[t]--;
+        if(!(pJob->done[t]) && pJob->copies[t] == 0) {
+            pJob->queue[pJob->queued++] = t;
+            pThis->requeued++;
+        }
+    }
+}
+
+/**
+ * Function: TileFarm_nextTile
+ *
+ * Picks a tile for an idle worker: one whose worker was lost, or else the next one not handed
+ * out yet, or else the one that's been out longest, if that's long enough to call slow and
+ * only one worker has it.
+ *
+ * Returns the tile's index, or -1 if there's nothing to hand out.
+ */
+static int TileFarm_nextTile(TileFarm_t *const pThis, TileFarmJob_t *const pJob, const double now)
+{
+    double slow = TILEFARM_SLOW_MIN, oldest = 0;
+    unsigned int w;
+    int t, found = -1;
+
+    while(pJob->queued > 0) {
+        t = pJob->queue[--(pJob->queued)];
+        if(!(pJob->done[t]) && pJob->copies[t] == 0) {
+            return t;
+        }
+    }
+    if(pJob->fresh < pJob->count) {
+        return pJob->fresh++;
+    }
+
+    if(pJob->timed > 0 && TILEFARM_SLOW_FACTOR * pJob->tile_time / pJob->timed > slow) {
+        slow = TILEFARM_SLOW_FACTOR * pJob->tile_time / pJob->timed;
+    }
+    for(w=0; w<pThis->worker_count; w++) {
+        const TileFarmWorker_t *const pWorker = &(pThis->workers[w]);
+        t = pWorker->tile;
+        if(pWorker->fd >= 0 && t >= 0 && pJob->copies[t] == 1 && now - pWorker->started > slow && now - pWorker->started > oldest) {
+            oldest = now - pWorker->started;
+            found = t;
+        }
+    }
+    if(found >= 0) {
+        pThis->reissued++;
+    }
+    return found;
+}
+
+/**
+ * Function: TileFarm_issue
+ * Hands tile <t> to an idle worker, sending it the view first if it hasn't had it yet.
+ */
+static bool TileFarm_issue(TileFarm_t *const pThis, TileFarmJob_t *const pJob, TileFarmWorker_t *const pWorker, const int t, const double now)
+{
+    Tile_t rect;
+
+    if(!(pWorker->has_view)) {
+        if(!TileFarm_sendMsg(pWorker->fd, TILEFARM_VIEW, pThis->image, 0, NULL, &(pJob->view), sizeof(pJob->view))) {
+            return false;
+        }
+        pWorker->has_view = true;
+    }
+    if(!TileFarm_sendMsg(pWorker->fd, TILEFARM_TILE, pThis->image, (uint32_t)t, TileFarm_rect(pJob, &rect, t), NULL, 0)) {
+        return false;
+    }
+    pWorker->tile = t;
+    pWorker->started = now;
+    pJob->copies[t]++;
+    return true;
+}
+
+/**
+ * Function: TileFarm_collect
+ *
+ * Receives the pixels a worker has sent back, and copies them into the image unless another
+ * worker got there first. Results for an earlier image are dropped.
+ *
+ * Returns false if the worker hung up or sent something that doesn't make sense.
+ */
+static bool TileFarm_collect(TileFarm_t *const pThis, TileFarmJob_t *const pJob, TileFarmWorker_t *const pWorker, const double now)
+{
+    TileFarmMsg_t msg;
+    Tile_t rect;
+    size_t row_size;
+    int t, j;
+
+    if(TileFarm_recv(pWorker->fd, &msg, sizeof(msg)) != 1) {
+        return false;
+    }
+    if(msg.magic != TILEFARM_MAGIC || msg.type != TILEFARM_PIXELS) {
+        fprintf(stderr, "Worker %u sent a bad message.\n", (unsigned int)(pWorker - pThis->workers));
+        return false;
+    }
+    if(msg.image != pThis->image) {
+        //Finishing a tile of an earlier image, which someone else must have finished first.
+        while(msg.size > 0) {
+            const uint32_t size = (msg.size < TILEFARM_TILE_SIZE * TILEFARM_TILE_SIZE * 3) ? msg.size : TILEFARM_TILE_SIZE * TILEFARM_TILE_SIZE * 3;
+            if(TileFarm_recv(pWorker->fd, pJob->buffer, size) != 1) {
+                return false;
+            }
+            msg.size -= size;
+        }
+        pWorker->tile = -1;
+        return true;
+    }
+
+    t = (int)msg.tile;
+    if(t != pWorker->tile) {
+        fprintf(stderr, "Worker %u sent back a tile it wasn't given.\n", (unsigned int)(pWorker - pThis->workers));
+        return false;
+    }
+    TileFarm_rect(pJob, &rect, t);
+    row_size = (size_t)(rect.x1 - rect.x0) * 3;
+    if(msg.size != row_size * (rect.y1 - rect.y0) || TileFarm_recv(pWorker->fd, pJob->buffer, msg.size) != 1) {
+        return false;
+    }
+
+    pWorker->tile = -1;
+    pWorker->tiles_done++;
+    pJob->copies[t]--;
+    if(pJob->done[t]) {
+        return true;
+    }
+    for(j=rect.y0; j<rect.y1; j++) {
+        memcpy(pJob->pixels + ((size_t)j * pJob->rowstride) + (rect.x0 * 3), pJob->buffer + ((j - rect.y0) * row_size), row_size);
+    }
+    pJob->done[t] = 1;
+    pJob->finished++;
+    pJob->tile_time += now - pWorker->started;
+    pJob->timed++;
+    return true;
+}
+
+void TileFarm_render(TileFarm_t *const pThis, const Scene_t *const scene, uint8_t *const pixels, const int rowstride)
+{
+    const int rows = (scene->img_height + TILEFARM_TILE_SIZE - 1) / TILEFARM_TILE_SIZE;
+    struct pollfd polls[TILEFARM_MAX_WORKERS];
+    TileFarmWorker_t *polled[TILEFARM_MAX_WORKERS];
+    TileFarmJob_t job;
+    unsigned int w, p, alive;
+    double now;
+    Tile_t rect;
+    int t, j;
+
+    job.scene = scene;
+    job.pixels = pixels;
+    job.rowstride = rowstride;
+    job.cols = (scene->img_width + TILEFARM_TILE_SIZE - 1) / TILEFARM_TILE_SIZE;
+    job.count = job.cols * rows;
+    job.done = Util_allocOrDie((size_t)job.count + 1, "Allocating tile states.");
+    job.copies = Util_allocOrDie((size_t)job.count + 1, "Allocating tile states.");
+    job.queue = Util_allocOrDie(sizeof(int) * (job.count + 1), "Allocating tile queue.");
+    job.buffer = Util_allocOrDie(TILEFARM_TILE_SIZE * TILEFARM_TILE_SIZE * 3, "Allocating tile buffer.");
+    memset(job.done, 0, job.count);
+    memset(job.copies, 0, job.count);
+    job.finished = 0;
+    job.fresh = 0;
+    job.queued = 0;
+    job.tile_time = 0;
+    job.timed = 0;
+
+    memset(&(job.view), 0, sizeof(job.view));
+    job.view.img_width = scene->img_width;
+    job.view.img_height = scene->img_height;
+    job.view.frame_width = scene->frame_width;
+    job.view.frame_height = scene->frame_height;
+    job.view.cam = *(scene->cam);
+    job.view.aa_samples = scene->aa_samples;
+
+    pThis->image++;
+    pThis->reissued = 0;
+    pThis->requeued = 0;
+    pThis->local = 0;
+    for(w=0; w<pThis->worker_count; w++) {
+        pThis->workers[w].has_view = false;
+        if(pThis->workers[w].tile >= 0) {
+            //Still rendering a tile of the last image, which will be dropped when it comes.
+            pThis->workers[w].tile = -2;
+        }
+    }
+
+    while(job.finished < job.count) {
+        //Keep every idle worker busy.
+        now = Util_now();
+        for(w=0; w<pThis->worker_count; w++) {
+            TileFarmWorker_t *const pWorker = &(pThis->workers[w]);
+            if(pWorker->fd < 0 || pWorker->tile != -1) {
+                continue;
+            }
+            t = TileFarm_nextTile(pThis, &job, now);
+            if(t < 0) {
+                break;
+            }
+            if(!TileFarm_issue(pThis, &job, pWorker, t, now)) {
+                //The tile never went out, so it's still the lost worker's to give back.
+                pWorker->tile = t;
+                job.copies[t]++;
+                TileFarm_lose(pThis, &job, pWorker);
+            }
+        }
+
+        //Wait for results, or for long enough that a tile might have become slow.
+        alive = 0;
+        for(w=0; w<pThis->worker_count; w++) {
+            if(pThis->workers[w].fd >= 0) {
+                polls[alive].fd = pThis->workers[w].fd;
+                polls[alive].events = POLLIN;
+                polls[alive].revents = 0;
+                polled[alive] = &(pThis->workers[w]);
+                alive++;
+            }
+        }
+        if(alive == 0) {
+            break;
+        }
+        if(poll(polls, alive, TILEFARM_POLL_MS) < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "Error waiting for workers: %s\n", strerror(errno));
+            break;
+        }
+
+        now = Util_now();
+        for(p=0; p<alive; p++) {
+            if(polls[p].revents != 0 && !TileFarm_collect(pThis, &job, polled[p], now)) {
+                TileFarm_lose(pThis, &job, polled[p]);
+            }
+        }
+    }
+
+    //Render anything left over here, if there's no one else to.
+    if(job.finished < job.count) {
+        fprintf(stderr, "No workers left, rendering the other %d tiles here.\n", job.count - job.finished);
+        for(t=0; t<job.count; t++) {
+            if(job.done[t]) {
+                continue;
+            }
+            TileFarm_rect(&job, &rect, t);
+            Render_region(scene, job.buffer, (rect.x1 - rect.x0) * 3, &rect);
+            for(j=rect.y0; j<rect.y1; j++) {
+                memcpy(pixels + ((size_t)j * rowstride) + (rect.x0 * 3), job.buffer + ((j - rect.y0) * (rect.x1 - rect.x0) * 3), (size_t)(rect.x1 - rect.x0) * 3);
+            }
+            pThis->local++;
+        }
+    }
+
+    free(job.done);
+    free(job.copies);
+    free(job.queue);
+    free(job.buffer);
+}
+
+void TileFarm_destroy(TileFarm_t *const pThis)
+{
+    const double deadline = Util_now() + TILEFARM_STOP_WAIT;
+    unsigned int w;
+
+    for(w=0; w<pThis->worker_count; w++) {
+        TileFarmWorker_t *const pWorker = &(pThis->workers[w]);
+        if(pWorker->fd >= 0) {
+            TileFarm_sendMsg(pWorker->fd, TILEFARM_STOP, pThis->image, 0, NULL, NULL, 0);
+            close(pWorker->fd);
+            pWorker->fd = -1;
+        }
+    }
+
+    //Give the forked workers a moment to finish whatever tile they're on, but don't wait on one
+    // that's hung.
+    for(w=0; w<pThis->worker_count; w++) {
+        TileFarmWorker_t *const pWorker = &(pThis->workers[w]);
+        while(pWorker->pid > 0 && waitpid(pWorker->pid, NULL, WNOHANG) == 0) {
+            if(Util_now() > deadline) {
+                kill(pWorker->pid, SIGKILL);
+                waitpid(pWorker->pid, NULL, 0);
+                break;
+            }
+            usleep(10000);
+        }
+        pWorker->pid = 0;
+    }
+    pThis->worker_count = 0;
+    if(pThis->listen_fd >= 0) {
+        close(pThis->listen_fd);
+        pThis->listen_fd = -1;
+    }
+}
+
+int TileFarm_connect(const Scene_t *const scene, const char *const address)
+{
+    const char *const colon = strrchr(address, ':');
+    struct addrinfo hints, *pFound, *pAddr;
+    char host[NI_MAXHOST];
+    TileFarmMsg_t msg;
+    uint64_t fingerprint;
+    int fd = -1, err;
+
+    if(colon == NULL || colon == address || colon[1] == '\0' || (size_t)(colon - address) >= sizeof(host)) {
+        fprintf(stderr, "Bad coordinator address: %s (expected HOST:PORT)\n", address);
+        return -1;
+    }
+    memcpy(host, address, colon - address);
+    host[colon - address] = '\0';
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    err = getaddrinfo(host, colon + 1, &hints, &pFound);
+    if(err != 0) {
+        fprintf(stderr, "Can't find %s: %s\n", address, gai_strerror(err));
+        return -1;
+    }
+    for(pAddr=pFound; pAddr!=NULL; pAddr=pAddr->ai_next) {
+        fd = socket(pAddr->ai_family, pAddr->ai_socktype, pAddr->ai_protocol);
+        if(fd < 0) {
+            continue;
+        }
+        if(connect(fd, pAddr->ai_addr, pAddr->ai_addrlen) == 0) {
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(pFound);
+
+    if(fd < 0) {
+        fprintf(stderr, "Can't connect to %s: %s\n", address, strerror(errno));
+        return -1;
+    }
+    TileFarm_setNoDelay(fd);
+
+    //Show the coordinator this has the same scene, and wait to be let in.
+    fingerprint = TileFarm_fingerprint(scene);
+    if(!TileFarm_sendMsg(fd, TILEFARM_HELLO, 0, 0, NULL, &fingerprint, sizeof(fingerprint))
+        || TileFarm_recv(fd, &msg, sizeof(msg)) != 1 || msg.magic != TILEFARM_MAGIC) {
+        fprintf(stderr, "Lost the connection to %s, which may not be the same build as this worker.\n", address);
+        close(fd);
+        return -1;
+    }
+    if(msg.type != TILEFARM_WELCOME) {
+        fprintf(stderr, "The coordinator at %s refused this worker: its scene isn't the same (check the mesh, --copies, the lights, and --raster).\n", address);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool TileFarm_serve(Scene_t *const scene, Camera_t *const pCam, const int fd)
+{
+    TileFarmMsg_t msg;
+    TileFarmView_t view;
+    uint8_t *buffer = NULL;
+    bool has_view = false, ok = false;
+    int got;
+
+    for(;;) {
+        got = TileFarm_recv(fd, &msg, sizeof(msg));
+        if(got == 0) {
+            ok = true;
+            break;
+        }
+        if(got < 0) {
+            fputs("Lost the connection to the coordinator.\n", stderr);
+            break;
+        }
+        if(msg.magic != TILEFARM_MAGIC) {
+            fputs("The coordinator isn't the same build as this worker.\n", stderr);
+            break;
+        }
+
+        if(msg.type == TILEFARM_STOP) {
+            ok = true;
+            break;
+        }
+        else if(msg.type == TILEFARM_VIEW) {
+            if(msg.size != sizeof(view) || TileFarm_recv(fd, &view, sizeof(view)) != 1) {
+                fputs("Bad view from the coordinator.\n", stderr);
+                break;
+            }
+            *pCam = view.cam;
+            scene->img_width = view.img_width;
+            scene->img_height = view.img_height;
+            scene->frame_width = view.frame_width;
+            scene->frame_height = view.frame_height;
+            scene->aa_samples = view.aa_samples;
+            has_view = true;
+        }
+        else if(msg.type == TILEFARM_TILE) {
+            const Tile_t *const pRect = &(msg.rect);
+            const size_t size = (size_t)(pRect->x1 - pRect->x0) * (pRect->y1 - pRect->y0) * 3;
+
+            if(!has_view || msg.size != 0 || pRect->x0 < 0 || pRect->y0 < 0 || pRect->x1 > scene->img_width || pRect->y1 > scene->img_height
+                || pRect->x1 <= pRect->x0 || pRect->y1 <= pRect->y0) {
+                fputs("Bad tile from the coordinator.\n", stderr);
+                break;
+            }
+            buffer = Util_reallocOrDie(buffer, size, "Allocating tile pixels.");
+            Render_region(scene, buffer, (pRect->x1 - pRect->x0) * 3, pRect);
+            if(!TileFarm_sendMsg(fd, TILEFARM_PIXELS, msg.image, msg.tile, pRect, buffer, size)) {
+                fputs("Lost the connection to the coordinator.\n", stderr);
+                break;
+            }
+        }
+        else {
+            fputs("Bad message from the coordinator.\n", stderr);
+            break;
+        }
+    }
+
+    free(buffer);
+    close(fd);
+    return ok;
+}
+
+#else
+
+//No fork or POSIX sockets, so there's never a worker: everything fails to start one, and the
+// coordinator renders every image itself.
+
+TileFarm_t * TileFarm_cfg(TileFarm_t *const pThis)
+{
+    pThis->worker_count = 0;
+    pThis->listen_fd = -1;
+    pThis->image = 0;
+    pThis->reissued = 0;
+    pThis->requeued = 0;
+    pThis->local = 0;
+    return pThis;
+}
+
+bool TileFarm_fork(TileFarm_t *const pThis, const Scene_t *const scene, const unsigned int count)
+{
+    fputs("Worker processes aren't available on Windows.\n", stderr);
+    return false;
+}
+
+bool TileFarm_listen(TileFarm_t *const pThis, const Scene_t *const scene, const unsigned short port, const unsigned int count)
+{
+    fputs("Remote workers aren't available on Windows.\n", stderr);
+    return false;
+}
+
+void TileFarm_render(TileFarm_t *const pThis, const Scene_t *const scene, uint8_t *const pixels, const int rowstride)
+{
+    pThis->image++;
+    pThis->reissued = 0;
+    pThis->requeued = 0;
+    pThis->local = 0;
+    Render_scene(scene, pixels, rowstride);
+}
+
+void TileFarm_destroy(TileFarm_t *const pThis)
+{
+    pThis->worker_count = 0;
+}
+
+int TileFarm_connect(const Scene_t *const scene, const char *const address)
+{
+    fputs("Remote workers aren't available on Windows.\n", stderr);
+    return -1;
+}
+
+bool TileFarm_serve(Scene_t *const scene, Camera_t *const pCam, const int fd)
+{
+    fputs("Remote workers aren't available on Windows.\n", stderr);
+    return false;
+}
+
+#endif
@@ -0,0 +1,206 @@
+/**
+ * File: tilefarm.h
+ *
+ * Spreads the rendering of an image across several worker processes, on this machine or others.
+ * A coordinator splits the image into tiles, hands them out one at a time to whichever worker is
+ * free, and copies each finished tile into the image as it comes back. Every tile is rendered
+ * with <Render_region>, so the image comes out exactly as <Render_scene> would render it in one
+ * process, whichever workers render which tiles.
+ *
+ * Workers talk to the coordinator over a socket: a Unix socket pair for workers it forks itself,
+ * or TCP for workers started elsewhere with <TileFarm_connect>. Workers already have the scene's
+ * geometry (forked ones inherit it, others load it from their own command line), so all that's
+ * sent is the view, once per worker for each image, and then just each tile's rectangle one way
+ * and its pixels the other.
+ *
+ * A tile taking much longer than tiles usually do is handed to an idle worker as well, once
+ * there's nothing else left to hand out, and whichever copy finishes first is used. A worker
+ * that dies or hangs up has its tile handed to another. If every worker is lost, the coordinator
+ * renders what's left itself.
+ *
+ * This needs POSIX processes and sockets, so it isn't available on Windows: there, starting or
+ * connecting a worker fails with a message, and <TileFarm_render> just renders the image itself.
+ *
+ * Messages are sent in the coordinator's own byte order and struct layout, so workers on other
+ * machines need to be the same build on the same kind of machine. The header's magic number
+ * catches most mismatches.
+ */
+#ifndef TILEFARM_H
+#define TILEFARM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+#include "scene.h"
+
+/**
+ * Constant: TILEFARM_TILE_SIZE
+ * Width and height of the tiles handed to workers. A multiple of <RENDER_TILE_SIZE>, so each
+ * one splits into the same tiles the whole image would.
+ */
+#define TILEFARM_TILE_SIZE 64
+
+/**
+ * Constant: TILEFARM_MAX_WORKERS
+ * Most workers a coordinator can have.
+ */
+#define TILEFARM_MAX_WORKERS 64
+
+/**
+ * Constants: Slow tiles
+ *
+ * TILEFARM_SLOW_FACTOR - How many times longer than the average tile a tile has to take before
+ *  it's handed out again.
+ * TILEFARM_SLOW_MIN - Seconds a tile has to take, at least, before it's handed out again, so
+ *  ordinary jitter in quick tiles doesn't count.
+ * TILEFARM_POLL_MS - How often, in milliseconds, the coordinator checks for slow tiles while it
+ *  waits for results.
+ * TILEFARM_STOP_WAIT - Seconds <TileFarm_destroy> gives forked workers to exit before killing
+ *  them.
+ */
+#define TILEFARM_SLOW_FACTOR 4.0
+#define TILEFARM_SLOW_MIN 0.5
+#define TILEFARM_POLL_MS 100
+#define TILEFARM_STOP_WAIT 2.0
+
+/**
+ * Struct: TileFarmWorker_t
+ * The coordinator's end of one worker.
+ */
+typedef struct {
+    /**
+     * Field: fd
+     * The socket to the worker, or -1 once it's been lost.
+     */
+    int fd;
+
+    /**
+     * Field: pid
+     * The process, for a worker the coordinator forked, otherwise 0.
+     */
+    pid_t pid;
+
+    /**
+     * Fields: tile, started
+     * Index of the tile the worker is rendering, or -1 if it's idle, and when it was handed out.
+     */
+    int tile;
+    double started;
+
+    /**
+     * Field: has_view
+     * Whether the worker has been sent the view of the image being rendered.
+     */
+    bool has_view;
+
+    /**
+     * Field: tiles_done
+     * Tiles the worker has rendered, in all, whether or not another copy finished first.
+     */
+    unsigned int tiles_done;
+} TileFarmWorker_t;
+
+/**
+ * Struct: TileFarm_t
+ */
+typedef struct {
+    TileFarmWorker_t workers[TILEFARM_MAX_WORKERS];
+    unsigned int worker_count;
+
+    /**
+     * Field: listen_fd
+     * The socket remote workers connect to, or -1.
+     */
+    int listen_fd;
+
+    /**
+     * Field: image
+     * Counts the images rendered, to tell a late tile from an earlier image from one of this.
+     */
+    uint32_t image;
+
+    /**
+     * Fields: reissued, requeued, local
+     * For the last image: tiles handed out again for being slow, tiles handed out again because
+     * their worker was lost, and tiles the coordinator had to render itself.
+     */
+    unsigned int reissued;
+    unsigned int requeued;
+    unsigned int local;
+} TileFarm_t;
+
+/**
+ * Function: TileFarm_cfg
+ * Configures a coordinator with no workers.
+ */
+TileFarm_t * TileFarm_cfg(TileFarm_t *pThis);
+
+/**
+ * Function: TileFarm_fork
+ *
+ * Forks <count> workers on this machine, each rendering with an even share of the CPUs (unless
+ * the scene sets its <Scene_t.threads>). The workers inherit <scene>, so it needs to be
+ * completely set up first; only its camera, sizes, and antialiasing can change between images.
+ *
+ * Returns false, having printed a message to stderr, if there would be too many workers, or
+ * the processes can't be started, in which case any that did start are kept.
+ */
+bool TileFarm_fork(TileFarm_t *pThis, const Scene_t *scene, unsigned int count);
+
+/**
+ * Function: TileFarm_listen
+ *
+ * Waits for <count> remote workers to connect on TCP <port>, on any address. Each one needs to
+ * have the same scene as the coordinator, see <TileFarm_connect>: a worker whose mesh, copies,
+ * lights, or rasterizing aren't the same as <scene>'s is refused, with a message, and another
+ * waited for in its place.
+ *
+ * Returns false, having printed a message to stderr, if the port can't be listened on, or
+ * there would be too many workers, in which case any that did connect are kept.
+ */
+bool TileFarm_listen(TileFarm_t *pThis, const Scene_t *scene, unsigned short port, unsigned int count);
+
+/**
+ * Function: TileFarm_render
+ *
+ * Renders the scene into <pixels> (with rows <rowstride> bytes apart) with the workers, handing
+ * out tiles as described above. The coordinator's own scene is only used to render tiles
+ * itself if it loses every worker.
+ */
+void TileFarm_render(TileFarm_t *pThis, const Scene_t *scene, uint8_t *pixels, int rowstride);
+
+/**
+ * Function: TileFarm_destroy
+ * Tells every worker to stop, hangs up on them, and waits for the forked ones to exit. The
+ * object itself is not freed.
+ */
+void TileFarm_destroy(TileFarm_t *pThis);
+
+/**
+ * Function: TileFarm_connect
+ *
+ * Connects to a coordinator waiting in <TileFarm_listen> at <address>, given as HOST:PORT, as
+ * a worker rendering <scene>. The coordinator only takes the worker if <scene> has the same
+ * mesh, copies, lights, and rasterizing as its own.
+ *
+ * Returns the socket, to hand to <TileFarm_serve>, or -1, having printed a message to stderr,
+ * if it can't connect, or the coordinator refused it.
+ */
+int TileFarm_connect(const Scene_t *scene, const char *address);
+
+/**
+ * Function: TileFarm_serve
+ *
+ * Runs a worker on socket <fd>: renders tiles of <scene> as the coordinator asks for them,
+ * with the camera, sizes, and antialiasing from the view it sends, until it says to stop or
+ * hangs up. The view's camera is copied into <pCam>, which should be the scene's own camera.
+ * Closes the socket.
+ *
+ * Returns false, having printed a message to stderr, if the coordinator sent something that
+ * doesn't make sense, or the connection failed part way through a message.
+ */
+bool TileFarm_serve(Scene_t *scene, Camera_t *pCam, int fd);
+
+#endif
+//end inclusion filter
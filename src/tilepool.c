@@ -0,0 +1,208 @@
+/**
+ * File: tilepool.c
+ *
+ */
+#include "tilepool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "util.h"
+
+/**
+ * Struct: TileQueue_t
+ * One worker's queue of tiles: indices into the tile list, from <head> inclusive to <tail>
+ * exclusive. The owner takes from the head, thieves take from the tail.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    int *tiles;
+    int head;
+    int tail;
+} TileQueue_t;
+
+typedef struct {
+    Tile_t *tiles;
+    TileQueue_t *queues;
+    unsigned int threads;
+    TileFunc_t func;
+    void *pCtx;
+} TilePool_t;
+
+typedef struct {
+    TilePool_t *pool;
+    unsigned int index;
+} TileWorker_t;
+
+unsigned int TilePool_threads(const unsigned int requested)
+{
+    long cpus;
+
+    if(requested > 0) {
+        return requested;
+    }
+
+#ifdef _WIN32
+    {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        cpus = (long)(info.dwNumberOfProcessors);
+    }
+#else
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+    return (cpus > 0) ? (unsigned int)cpus : 1;
+}
+
+static int TileQueue_take(TileQueue_t *const pThis, const int steal)
+{
+    int tile = -1;
+
+    pthread_mutex_lock(&(pThis->lock));
+    if(pThis->head < pThis->tail) {
+        if(steal) {
+            tile = pThis->tiles[--(pThis->tail)];
+        }
+        else {
+            tile = pThis->tiles[(pThis->head)++];
+        }
+    }
+    pthread_mutex_unlock(&(pThis->lock));
+
+    return tile;
+}
+
+static void * TilePool_work(void *const pArg)
+{
+    const TileWorker_t *const pWorker = (const TileWorker_t *)pArg;
+    TilePool_t *const pPool = pWorker->pool;
+    const unsigned int me = pWorker->index;
+    unsigned int k;
+    int tile;
+
+    for(;;) {
+        //Our own tiles first.
+        tile = TileQueue_take(&(pPool->queues[me]), 0);
+
+        //Then go looking for somebody else's, starting with our neighbour so that
+        // thieves spread out over the victims.
+        for(k=1; tile < 0 && k<pPool->threads; k++) {
+            tile = TileQueue_take(&(pPool->queues[(me + k) % pPool->threads]), 1);
+        }
+
+        //Tiles are never added once we start, so if every queue is empty we're done.
+        if(tile < 0) {
+            break;
+        }
+
+        pPool->func(pPool->pCtx, &(pPool->tiles[tile]), me);
+    }
+
+    return NULL;
+}
+
+void TilePool_run(const int width, const int height, const int tile_size, const unsigned int threads, const TileFunc_t func, void *const pCtx)
+{
+    Tile_t all;
+
+    all.x0 = 0;
+    all.y0 = 0;
+    all.x1 = width;
+    all.y1 = height;
+    TilePool_runRect(&all, tile_size, threads, func, pCtx);
+}
+
+void TilePool_runRect(const Tile_t *const pRect, const int tile_size, unsigned int threads, const TileFunc_t func, void *const pCtx)
+{
+    int i, j, n;
+    unsigned int t;
+    TilePool_t pool;
+    TileWorker_t *workers;
+    pthread_t *handles;
+
+    const int width = pRect->x1 - pRect->x0;
+    const int height = pRect->y1 - pRect->y0;
+    const int cols = (width > 0) ? (width + tile_size - 1) / tile_size : 0;
+    const int rows = (height > 0) ? (height + tile_size - 1) / tile_size : 0;
+    const int count = cols * rows;
+
+    if(count <= 0) {
+        return;
+    }
+
+    pool.tiles = Util_allocOrDie(sizeof(Tile_t) * count, "Allocating render tiles.");
+    n = 0;
+    for(j=0; j<rows; j++) {
+        for(i=0; i<cols; i++) {
+            pool.tiles[n].x0 = pRect->x0 + i * tile_size;
+            pool.tiles[n].y0 = pRect->y0 + j * tile_size;
+            pool.tiles[n].x1 = pRect->x0 + ((i+1) * tile_size < width ? (i+1) * tile_size : width);
+            pool.tiles[n].y1 = pRect->y0 + ((j+1) * tile_size < height ? (j+1) * tile_size : height);
+            n++;
+        }
+    }
+
+    threads = TilePool_threads(threads);
+    if(threads > (unsigned int)count) {
+        threads = (unsigned int)count;
+    }
+
+    //No point paying for threads and locks if there's only going to be one.
+    if(threads == 1) {
+        for(n=0; n<count; n++) {
+            func(pCtx, &(pool.tiles[n]), 0);
+        }
+        free(pool.tiles);
+        return;
+    }
+
+    pool.threads = threads;
+    pool.func = func;
+    pool.pCtx = pCtx;
+    pool.queues = Util_allocOrDie(sizeof(TileQueue_t) * threads, "Allocating tile queues.");
+    workers = Util_allocOrDie(sizeof(TileWorker_t) * threads, "Allocating tile workers.");
+    handles = Util_allocOrDie(sizeof(pthread_t) * threads, "Allocating tile worker threads.");
+
+    //Deal the tiles out round-robin, so expensive regions of the image (which tend to be
+    // contiguous) start out spread across all the workers.
+    for(t=0; t<threads; t++) {
+        pthread_mutex_init(&(pool.queues[t].lock), NULL);
+        pool.queues[t].tiles = Util_allocOrDie(sizeof(int) * ((count / threads) + 1), "Allocating tile queue.");
+        pool.queues[t].head = 0;
+        pool.queues[t].tail = 0;
+    }
+    for(n=0; n<count; n++) {
+        TileQueue_t *const pQueue = &(pool.queues[n % threads]);
+        pQueue->tiles[(pQueue->tail)++] = n;
+    }
+
+    for(t=0; t<threads; t++) {
+        workers[t].pool = &pool;
+        workers[t].index = t;
+        if(pthread_create(&(handles[t]), NULL, TilePool_work, &(workers[t])) != 0) {
+            fputs("Failed to start render thread.\n", stderr);
+            abort();
+        }
+    }
+    for(t=0; t<threads; t++) {
+        pthread_join(handles[t], NULL);
+    }
+
+    for(t=0; t<threads; t++) {
+        pthread_mutex_destroy(&(pool.queues[t].lock));
+        free(pool.queues[t].tiles);
+    }
+    free(pool.queues);
+    free(workers);
+    free(handles);
+    free(pool.tiles);
+}
+
@@ -0,0 +1,61 @@
+/**
+ * File: tilepool.h
+ *
+ * Splits an image into rectangular tiles and runs a function on each of them over a pool
+ * of worker threads.
+ *
+ * Every worker starts with its own queue of tiles and works through it from one end. A worker
+ * that runs out steals tiles from the other end of somebody else's queue, so the load stays
+ * balanced even when some parts of the image are far more expensive than others.
+ */
+#ifndef TILEPOOL_H
+#define TILEPOOL_H
+
+/**
+ * Struct: Tile_t
+ * A rectangle of pixels, from (<x0>, <y0>) inclusive to (<x1>, <y1>) exclusive.
+ */
+typedef struct {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+} Tile_t;
+
+/**
+ * Type: TileFunc_t
+ * The function run on each tile. <worker> is the index of the thread running it, in
+ * [0, threads), for callers that keep per-thread scratch space.
+ */
+typedef void (*TileFunc_t)(void *pCtx, const Tile_t *pTile, unsigned int worker);
+
+/**
+ * Function: TilePool_threads
+ * Resolves a requested thread count: 0 means one per CPU.
+ */
+unsigned int TilePool_threads(unsigned int requested);
+
+/**
+ * Function: TilePool_run
+ *
+ * Runs <func> once on every tile of a <width> by <height> image cut into <tile_size> squares
+ * (tiles on the right and bottom edges may be smaller), and returns when they're all done.
+ *
+ * With a single thread the tiles are run on the calling thread, in order, with no threads
+ * created at all.
+ *
+ * Aborts the program if there is not enough memory or threads can't be created.
+ */
+void TilePool_run(int width, int height, int tile_size, unsigned int threads, TileFunc_t func, void *pCtx);
+
+/**
+ * Function: TilePool_runRect
+ * Like <TilePool_run>, but only over the given rectangle of an image. The tiles start at its
+ * top left corner, so they line up with <TilePool_run>'s if that's on a multiple of
+ * <tile_size>.
+ */
+void TilePool_runRect(const Tile_t *pRect, int tile_size, unsigned int threads, TileFunc_t func, void *pCtx);
+
+#endif
+//end inclusion filter
+
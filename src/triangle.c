@@ -11,75 +11,80 @@
 #include <stdio.h>
 
 #include "point.h"
+#include "raystats.h"
 #include "util.h"
 
-/**
- * Function: Triangle_getBaryColor
- * Gets the color for a point on the triangle based on it's barycentric coordinates.
- *
- * Arguments:
- *  pThis   -   const <Triangle_t>* : Pointer to the triangle.
- *  opColor -   <Color_t>* : Pointer to the object that will hold the output color.
- *  pBary   -   const <Point_t>* : A point containing the barycentric coordinates of the point.
- */
-static Color_t * Triangle_getBaryColor(const Triangle_t *const pThis, Color_t *const opColor, const Point_t *const pBary)
+Color_t * Triangle_getBaryColor(const Triangle_t *const pThis, Color_t *const opColor, const Point_t *const pBary)
 {
-    const double r = (pBary->x*(pThis->vert[0].color.r)) + (pBary->y*(pThis->vert[1].color.r)) + (pBary->z*(pThis->vert[2].color.r));
-    const double g = (pBary->x*(pThis->vert[0].color.g)) + (pBary->y*(pThis->vert[1].color.g)) + (pBary->z*(pThis->vert[2].color.g));
-    const double b = (pBary->x*(pThis->vert[0].color.b)) + (pBary->y*(pThis->vert[1].color.b)) + (pBary->z*(pThis->vert[2].color.b));
+    const Real_t r = (pBary->x*(pThis->vert[0].color.r)) + (pBary->y*(pThis->vert[1].color.r)) + (pBary->z*(pThis->vert[2].color.r));
+    const Real_t g = (pBary->x*(pThis->vert[0].color.g)) + (pBary->y*(pThis->vert[1].color.g)) + (pBary->z*(pThis->vert[2].color.g));
+    const Real_t b = (pBary->x*(pThis->vert[0].color.b)) + (pBary->y*(pThis->vert[1].color.b)) + (pBary->z*(pThis->vert[2].color.b));
 
     return Color_cfg(opColor, r, g, b);
 }
 
-double Triangle_rayCast(const Triangle_t *pThis, Color_t *opColor, const double closest_dist, const Point_t *const pt, const Vect_t *const vect)
+double Triangle_intersect(const Triangle_t *const pThis, Point_t *const opBary, const double closest_dist, const Point_t *const pt, const Vect_t *const vect)
 {
-    Vect_t disp;
-    Vect_t pointer;
-    Point_t intersection;
-    Point_t bary;
+    return Triangle_intersectEdges(&(pThis->vert[0].loc), &(pThis->edge1), &(pThis->edge2), opBary, closest_dist, pt, vect);
+}
 
-    //A point on the plane of the triangle.
-    const Point_t *const pop = &(pThis->vert[0].loc);
-
-    //Convenient handle to the plane-normal.
-    const Vect_t *const pNorm = &(pThis->normal);
-
-    // What we're doing here is intersecting a ray with a plane. 
-    // The vector is a parametric equation like: pt + t*vect, so what we're going
-    // to find is the value of t for which the ray and the plane coincide.
-    // This is done as t = (disp . norm) / (vect . norm), where disp is a vector
-    // from the start of the ray to any point on the plane.
-    
-    //Get the denominator for the distance calc.
-    const double denom = Vect_dot(vect, pNorm);
-    if (denom == 0) {
-        //Line and plane are parallel, no intersection (or infinite intersection).
+double Triangle_intersectEdges(const Point_t *const v0, const Vect_t *const e1, const Vect_t *const e2, Point_t *const opBary, const double closest_dist, const Point_t *const pt, const Vect_t *const vect)
+{
+    //The operations are spelled out, in the same order as in TriBlock_intersect, so both round
+    // identically. The tests are written to fail on NaN as well.
+
+    //p = vect x e2. The determinant is zero when the ray is parallel to the plane,
+    // which is no intersection (or infinite intersection).
+    const Real_t px = (vect->y * e2->z) - (vect->z * e2->y);
+    const Real_t py = (vect->z * e2->x) - (vect->x * e2->z);
+    const Real_t pz = (vect->x * e2->y) - (vect->y * e2->x);
+    const Real_t det = ((e1->x * px) + (e1->y * py)) + (e1->z * pz);
+    RAYSTATS_ADD(RAYSTATS_TESTS, 1);
+    if(!(det != 0)) {
+        return closest_dist;
+    }
+    RAYSTATS_ADD(RAYSTATS_PLANE_HITS, 1);
+    const Real_t inv = 1 / det;
+
+    //Barycentric coordinate relative to the second vertex.
+    const Real_t sx = pt->x - v0->x;
+    const Real_t sy = pt->y - v0->y;
+    const Real_t sz = pt->z - v0->z;
+    const Real_t u = (((sx * px) + (sy * py)) + (sz * pz)) * inv;
+    if(!(u >= 0 && u <= 1)) {
+        RAYSTATS_ADD(RAYSTATS_BARY_REJECTS, 1);
         return closest_dist;
     }
 
-    // Finish the distance calc.
-    Point_displacement(&disp, pt, pop);
-    const double numer = Vect_dot(&disp, pNorm);
-    const double dist = numer / denom;
-
-    //If t is negative, then the intersection if "behind" the starting point of the ray, so there is no intersection.
-    // Or, if the intersection is further away than a point we've already hit with the ray, then we don't care about this
-    // one, we use the other one.
-    if(dist < 0 || dist >= closest_dist) {
+    //Barycentric coordinate relative to the third vertex.
+    const Real_t qx = (sy * e1->z) - (sz * e1->y);
+    const Real_t qy = (sz * e1->x) - (sx * e1->z);
+    const Real_t qz = (sx * e1->y) - (sy * e1->x);
+    const Real_t v = (((vect->x * qx) + (vect->y * qy)) + (vect->z * qz)) * inv;
+    if(!(v >= 0 && (u + v) <= 1)) {
+        RAYSTATS_ADD(RAYSTATS_BARY_REJECTS, 1);
         return closest_dist;
     }
 
-    //Pointer from pt to the intersection.
-    Vect_scale(&pointer, vect, dist);
+    //If the distance is negative, the intersection is "behind" the starting point of the ray.
+    // Or, if the intersection is further away than a point we've already hit with the ray, then
+    // we don't care about this one, we use the other one.
+    const Real_t dist = (((e2->x * qx) + (e2->y * qy)) + (e2->z * qz)) * inv;
+    if(!(dist >= 0 && dist < closest_dist)) {
+        return closest_dist;
+    }
+    RAYSTATS_ADD(RAYSTATS_HITS, 1);
 
-    //Point of intersection.
-    Point_translate(&intersection, pt, &pointer);
+    Point_cfg(opBary, 1 - u - v, u, v);
+    return dist;
+}
 
-    //Get the barycentric position of the intersection.
-    Triangle_barycentricPosition(pThis, &bary, &intersection);
+double Triangle_rayCast(const Triangle_t *pThis, Color_t *opColor, const double closest_dist, const Point_t *const pt, const Vect_t *const vect)
+{
+    Point_t bary;
 
-    //If any of it's components are negative, it is outside of the triangle, so no intersection.
-    if(bary.x < 0 || bary.y < 0 || bary.z < 0) {
+    const double dist = Triangle_intersect(pThis, &bary, closest_dist, pt, vect);
+    if(dist == closest_dist) {
         return closest_dist;
     }
 
@@ -101,7 +106,7 @@ double Triangle_rayCast(const Triangle_t *pThis, Color_t *opColor, const double
  * if the vertices A, B, and C are arranged clockwise (in that order) then the are is positive,
  * otherwise it is negative. I'm pretty sure I got that right, otherwise it's the reverse.
  */
-static double Triangle_signedArea(const Vect_t *const pNorm, const Point_t *const pA, const Point_t *const pB, const Point_t *const pC)
+static Real_t Triangle_signedArea(const Vect_t *const pNorm, const Point_t *const pA, const Point_t *const pB, const Point_t *const pC)
 {
     Vect_t ab, ac, xp;
 
@@ -111,7 +116,7 @@ static double Triangle_signedArea(const Vect_t *const pNorm, const Point_t *cons
 
     Vect_cross(&xp, &ab, &ac);
 
-    const double xpl = Vect_dot(&xp, pNorm);
+    const Real_t xpl = Vect_dot(&xp, pNorm);
 
     return 0.5 * xpl;
 }
@@ -132,11 +137,11 @@ Point_t * Triangle_barycentricPosition(const Triangle_t *const pThis, Point_t *c
     const Point_t *const b = &(pThis->vert[1].loc);
     const Point_t *const c = &(pThis->vert[2].loc);
 
-    const double pbc = Triangle_signedArea(&(pThis->normal), pPoint, b, c);
-    const double pca = Triangle_signedArea(&(pThis->normal), a, pPoint, c);
-    const double pab = Triangle_signedArea(&(pThis->normal), a, b, pPoint);
+    const Real_t pbc = Triangle_signedArea(&(pThis->normal), pPoint, b, c);
+    const Real_t pca = Triangle_signedArea(&(pThis->normal), a, pPoint, c);
+    const Real_t pab = Triangle_signedArea(&(pThis->normal), a, b, pPoint);
 
-    return Point_cfg(opBarry, pbc / pThis->area, pca / pThis->area, pab / pThis->area);
+    return Point_cfg(opBarry, pbc * pThis->inv_area, pca * pThis->inv_area, pab * pThis->inv_area);
 }
 
 Triangle_t* Triangle_cfg(Triangle_t *const pThis, Vertex_t *const pVertex1, Vertex_t *const pVertex2, Vertex_t *const pVertex3)
@@ -145,13 +150,22 @@ Triangle_t* Triangle_cfg(Triangle_t *const pThis, Vertex_t *const pVertex1, Vert
     Vertex_copy(&(pThis->vert[1]), pVertex2);
     Vertex_copy(&(pThis->vert[2]), pVertex3);
 
-    Vect_t u, v;
-    Point_displacement(&u, &(pVertex1->loc), &(pVertex2->loc));
-    Point_displacement(&v, &(pVertex1->loc), &(pVertex3->loc));
-    Vect_cross(&(pThis->normal), &u, &v);
+    return Triangle_recompute(pThis);
+}
+
+Triangle_t* Triangle_recompute(Triangle_t *const pThis)
+{
+    const Point_t *const a = &(pThis->vert[0].loc);
+    const Point_t *const b = &(pThis->vert[1].loc);
+    const Point_t *const c = &(pThis->vert[2].loc);
+
+    Point_displacement(&(pThis->edge1), a, b);
+    Point_displacement(&(pThis->edge2), a, c);
+    Vect_cross(&(pThis->normal), &(pThis->edge1), &(pThis->edge2));
     Vect_normalize(&(pThis->normal), &(pThis->normal));
 
-    pThis->area = Triangle_signedArea(&(pThis->normal), &(pVertex1->loc), &(pVertex2->loc), &(pVertex3->loc));
+    pThis->area = Triangle_signedArea(&(pThis->normal), a, b, c);
+    pThis->inv_area = 1 / pThis->area;
 
     return pThis;
 }
@@ -170,6 +184,17 @@ Triangle_t* Triangle_clone(const Triangle_t *const pRhs)
     return Util_cloneOrDie(pRhs, sizeof(Triangle_t), "Cloning Triangle_t object.");
 }
 
+Triangle_t* Triangle_inArena(Arena_t *const pArena, Vertex_t *const pVertex1, Vertex_t *const pVertex2, Vertex_t *const pVertex3)
+{
+    Triangle_t *const pThis = Arena_alloc(pArena, sizeof(Triangle_t), "Allocating a Triangle_t object in an arena.");
+    return Triangle_cfg(pThis, pVertex1, pVertex2, pVertex3);
+}
+
+Triangle_t* Triangle_cloneInArena(Arena_t *const pArena, const Triangle_t *const pRhs)
+{
+    return Arena_clone(pArena, pRhs, sizeof(Triangle_t), "Cloning a Triangle_t object into an arena.");
+}
+
 
 Color_t * Triangle_getColor(const Triangle_t *const pThis, Color_t *const opColor, const Point_t *const pPt)
 {
@@ -13,6 +13,7 @@
 #include "vect.h"
 #include "color.h"
 #include "plane.h"
+#include "util.h"
 
 typedef enum {VTX1=0, VTX2=1, VTX3=2} TriangleVertIndex_t;
 
@@ -31,7 +32,7 @@ typedef struct {
      * Field: area
      * The signed area of the triangle.
      */
-    double area;
+    Real_t area;
 
     /**
      * Field: normal
@@ -39,6 +40,19 @@ typedef struct {
      * and the vector from VTX1 to VTX3.
      */
     Vect_t normal;
+
+    /**
+     * Fields: edge1, edge2
+     * The vectors from VTX1 to VTX2 and from VTX1 to VTX3, for <Triangle_intersect>.
+     */
+    Vect_t edge1;
+    Vect_t edge2;
+
+    /**
+     * Field: inv_area
+     * The multiplicative inverse of <area>.
+     */
+    Real_t inv_area;
 } Triangle_t;
 
 /**
@@ -64,6 +78,13 @@ Point_t * Triangle_barycentricPosition(const Triangle_t *pThis, Point_t *opBarry
  */
 Triangle_t* Triangle_cfg(Triangle_t *pThis, Vertex_t *pVertex1, Vertex_t *pVertex2, Vertex_t *pVertex3);
 
+/**
+ * Function: Triangle_recompute
+ * Recomputes the <area>, <normal>, and the other precomputed fields from the vertices.
+ * Call this after moving the vertices of a triangle in place.
+ */
+Triangle_t* Triangle_recompute(Triangle_t *pThis);
+
 /**
  * Function: Triangle
  * Dynamically allocates a new <Triangle_t> object and configures it with <Triangle_cfg>.
@@ -81,6 +102,19 @@ Triangle_t* Triangle(Vertex_t *pVertex1, Vertex_t *pVertex2, Vertex_t *pVertex3)
  */
 Triangle_t* Triangle_clone(const Triangle_t *pRhs);
 
+/**
+ * Function: Triangle_inArena
+ * Like <Triangle>, but allocates the object from the arena, so it's freed along with everything
+ * else in it.
+ */
+Triangle_t* Triangle_inArena(Arena_t *pArena, Vertex_t *pVertex1, Vertex_t *pVertex2, Vertex_t *pVertex3);
+
+/**
+ * Function: Triangle_cloneInArena
+ * Like <Triangle_clone>, but allocates the copy from the arena.
+ */
+Triangle_t* Triangle_cloneInArena(Arena_t *pArena, const Triangle_t *pRhs);
+
 /**
  * Function: Triangle_getColor
  * Determines the color of the triangle at the specified point. The color is simply the average
@@ -97,10 +131,45 @@ Triangle_t* Triangle_clone(const Triangle_t *pRhs);
  */
 Color_t * Triangle_getColor(const Triangle_t *pThis, Color_t *opColor, const Point_t *pPt);
 
+/**
+ * Function: Triangle_getBaryColor
+ * Gets the color for a point on the triangle based on it's barycentric coordinates.
+ *
+ * Arguments:
+ *  pThis   -   const <Triangle_t>* : Pointer to the triangle.
+ *  opColor -   <Color_t>* : Pointer to the object that will hold the output color.
+ *  pBary   -   const <Point_t>* : A point containing the barycentric coordinates of the point.
+ */
+Color_t * Triangle_getBaryColor(const Triangle_t *pThis, Color_t *opColor, const Point_t *pBary);
+
+/**
+ * Function: Triangle_intersect
+ *
+ * Finds where a ray crosses this triangle, with the Möller–Trumbore test on the precomputed
+ * edge vectors. The test gives up as soon as either barycentric coordinate puts the ray outside
+ * the triangle, before it bothers working out the distance.
+ *
+ * The ray counts as hitting the triangle (edges included) if the distance is not negative
+ * and is less than <closest_dist>, in which case the distance is returned and <opBary> gets the
+ * barycentric coordinates of the hit (as with <Triangle_barycentricPosition>). Otherwise
+ * <closest_dist> is returned and <opBary> is left alone.
+ *
+ * This does exactly the same arithmetic as a lane of <TriBlock_intersect>, so the two always agree.
+ */
+double Triangle_intersect(const Triangle_t *pThis, Point_t *opBary, const double closest_dist, const Point_t *const pt, const Vect_t *const vect);
+
+/**
+ * Function: Triangle_intersectEdges
+ * The test behind <Triangle_intersect>, for a triangle given as its first vertex <v0> and the
+ * edge vectors <e1> and <e2> from it to the other two. This is for triangles that aren't
+ * stored as a <Triangle_t>, such as those in a <Mesh_t>.
+ */
+double Triangle_intersectEdges(const Point_t *v0, const Vect_t *e1, const Vect_t *e2, Point_t *opBary, double closest_dist, const Point_t *pt, const Vect_t *vect);
+
 /**
  * Function: Triangle_rayCast
  *
- * Performs simple ray casting of a single ray onto this triangle.
+ * Performs simple ray casting of a single ray onto this triangle, with <Triangle_intersect>.
  *
  * Finds the point at which a ray intersects with this triangle, and returns the distance from the start
  * of the ray to the point of intersection, as well as populating the <opColor> buffer object with 
@@ -0,0 +1,408 @@
+/**
+ * File: triblock.c
+ *
+ */
+#include "triblock.h"
+
+#include <stdbool.h>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "triangle.h"
+#include "raystats.h"
+#include "point.h"
+#include "vect.h"
+
+TriBlock_t * TriBlock_cfgEmpty(TriBlock_t *const pThis)
+{
+    unsigned int lane;
+
+    //Zero-length edges give a zero determinant, which never counts as a hit.
+    for(lane=0; lane<TRIBLOCK_WIDTH; lane++) {
+        pThis->v0x[lane] = pThis->v0y[lane] = pThis->v0z[lane] = 0;
+        pThis->e1x[lane] = pThis->e1y[lane] = pThis->e1z[lane] = 0;
+        pThis->e2x[lane] = pThis->e2y[lane] = pThis->e2z[lane] = 0;
+        pThis->id[lane] = TRIBLOCK_EMPTY;
+    }
+    return pThis;
+}
+
+TriBlock_t * TriBlock_setLane(TriBlock_t *const pThis, const unsigned int lane, const Triangle_t *const pTriangle, const unsigned int id)
+{
+    return TriBlock_setLaneEdges(pThis, lane, &(pTriangle->vert[0].loc), &(pTriangle->edge1), &(pTriangle->edge2), id);
+}
+
+TriBlock_t * TriBlock_setLaneEdges(TriBlock_t *const pThis, const unsigned int lane, const Point_t *const v0, const Vect_t *const e1, const Vect_t *const e2, const unsigned int id)
+{
+    pThis->v0x[lane] = v0->x;
+    pThis->v0y[lane] = v0->y;
+    pThis->v0z[lane] = v0->z;
+    pThis->e1x[lane] = e1->x;
+    pThis->e1y[lane] = e1->y;
+    pThis->e1z[lane] = e1->z;
+    pThis->e2x[lane] = e2->x;
+    pThis->e2y[lane] = e2->y;
+    pThis->e2z[lane] = e2->z;
+    pThis->id[lane] = id;
+
+    return pThis;
+}
+
+/*
+ * Each of the lane kernels below computes, for every lane, the distance and the second and
+ * third barycentric coordinates of the point where the ray crosses the triangle's plane, and
+ * returns a bitmask of the lanes where that point is a valid hit no further than <closest>.
+ *
+ * They all do exactly the same operations in exactly the same order as Triangle_intersect (the
+ * compiler must not be allowed to fuse multiplies and adds, see the Sconstruct), so they agree
+ * to the bit. Each <Real_t> has its own pair of SIMD kernels.
+ */
+
+#if defined(RT_FLOAT) && defined(__AVX__)
+
+static unsigned int TriBlock_lanes(const TriBlock_t *const pThis, const Point_t *const pt, const Vect_t *const vect, const Real_t closest, Real_t *const t, Real_t *const u, Real_t *const v)
+{
+    const __m256 dx = _mm256_set1_ps(vect->x);
+    const __m256 dy = _mm256_set1_ps(vect->y);
+    const __m256 dz = _mm256_set1_ps(vect->z);
+    const __m256 e1x = _mm256_loadu_ps(pThis->e1x);
+    const __m256 e1y = _mm256_loadu_ps(pThis->e1y);
+    const __m256 e1z = _mm256_loadu_ps(pThis->e1z);
+    const __m256 e2x = _mm256_loadu_ps(pThis->e2x);
+    const __m256 e2y = _mm256_loadu_ps(pThis->e2y);
+    const __m256 e2z = _mm256_loadu_ps(pThis->e2z);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0);
+
+    //p = d x e2, det = e1 . p
+    const __m256 px = _mm256_sub_ps(_mm256_mul_ps(dy, e2z), _mm256_mul_ps(dz, e2y));
+    const __m256 py = _mm256_sub_ps(_mm256_mul_ps(dz, e2x), _mm256_mul_ps(dx, e2z));
+    const __m256 pz = _mm256_sub_ps(_mm256_mul_ps(dx, e2y), _mm256_mul_ps(dy, e2x));
+    const __m256 det = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e1x, px), _mm256_mul_ps(e1y, py)), _mm256_mul_ps(e1z, pz));
+    const __m256 inv = _mm256_div_ps(one, det);
+
+    //s = o - v0, u = (s . p) / det
+    const __m256 sx = _mm256_sub_ps(_mm256_set1_ps(pt->x), _mm256_loadu_ps(pThis->v0x));
+    const __m256 sy = _mm256_sub_ps(_mm256_set1_ps(pt->y), _mm256_loadu_ps(pThis->v0y));
+    const __m256 sz = _mm256_sub_ps(_mm256_set1_ps(pt->z), _mm256_loadu_ps(pThis->v0z));
+    const __m256 uu = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sx, px), _mm256_mul_ps(sy, py)), _mm256_mul_ps(sz, pz)), inv);
+
+    //q = s x e1, v = (d . q) / det, t = (e2 . q) / det
+    const __m256 qx = _mm256_sub_ps(_mm256_mul_ps(sy, e1z), _mm256_mul_ps(sz, e1y));
+    const __m256 qy = _mm256_sub_ps(_mm256_mul_ps(sz, e1x), _mm256_mul_ps(sx, e1z));
+    const __m256 qz = _mm256_sub_ps(_mm256_mul_ps(sx, e1y), _mm256_mul_ps(sy, e1x));
+    const __m256 vv = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, qx), _mm256_mul_ps(dy, qy)), _mm256_mul_ps(dz, qz)), inv);
+    const __m256 tt = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e2x, qx), _mm256_mul_ps(e2y, qy)), _mm256_mul_ps(e2z, qz)), inv);
+
+    //Ordered comparisons, so a NaN anywhere (from a zero determinant) fails the lane.
+    __m256 ok = _mm256_cmp_ps(det, zero, _CMP_NEQ_OQ);
+    ok = _mm256_and_ps(ok, _mm256_cmp_ps(uu, zero, _CMP_GE_OQ));
+    ok = _mm256_and_ps(ok, _mm256_cmp_ps(vv, zero, _CMP_GE_OQ));
+    ok = _mm256_and_ps(ok, _mm256_cmp_ps(_mm256_add_ps(uu, vv), one, _CMP_LE_OQ));
+    ok = _mm256_and_ps(ok, _mm256_cmp_ps(tt, zero, _CMP_GE_OQ));
+    ok = _mm256_and_ps(ok, _mm256_cmp_ps(tt, _mm256_set1_ps(closest), _CMP_LE_OQ));
+
+    _mm256_storeu_ps(t, tt);
+    _mm256_storeu_ps(u, uu);
+    _mm256_storeu_ps(v, vv);
+    return (unsigned int)_mm256_movemask_ps(ok);
+}
+
+#elif defined(RT_FLOAT) && defined(__SSE2__)
+
+static unsigned int TriBlock_lanes(const TriBlock_t *const pThis, const Point_t *const pt, const Vect_t *const vect, const Real_t closest, Real_t *const t, Real_t *const u, Real_t *const v)
+{
+    unsigned int half;
+    unsigned int mask = 0;
+
+    const __m128 dx = _mm_set1_ps(vect->x);
+    const __m128 dy = _mm_set1_ps(vect->y);
+    const __m128 dz = _mm_set1_ps(vect->z);
+    const __m128 ox = _mm_set1_ps(pt->x);
+    const __m128 oy = _mm_set1_ps(pt->y);
+    const __m128 oz = _mm_set1_ps(pt->z);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0);
+    const __m128 lim = _mm_set1_ps(closest);
+
+    //Four lanes at a time.
+    for(half=0; half<TRIBLOCK_WIDTH; half+=4) {
+        const __m128 e1x = _mm_loadu_ps(pThis->e1x + half);
+        const __m128 e1y = _mm_loadu_ps(pThis->e1y + half);
+        const __m128 e1z = _mm_loadu_ps(pThis->e1z + half);
+        const __m128 e2x = _mm_loadu_ps(pThis->e2x + half);
+        const __m128 e2y = _mm_loadu_ps(pThis->e2y + half);
+        const __m128 e2z = _mm_loadu_ps(pThis->e2z + half);
+
+        //p = d x e2, det = e1 . p
+        const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+        const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+        const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+        const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+        const __m128 inv = _mm_div_ps(one, det);
+
+        //s = o - v0, u = (s . p) / det
+        const __m128 sx = _mm_sub_ps(ox, _mm_loadu_ps(pThis->v0x + half));
+        const __m128 sy = _mm_sub_ps(oy, _mm_loadu_ps(pThis->v0y + half));
+        const __m128 sz = _mm_sub_ps(oz, _mm_loadu_ps(pThis->v0z + half));
+        const __m128 uu = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inv);
+
+        //q = s x e1, v = (d . q) / det, t = (e2 . q) / det
+        const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+        const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+        const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+        const __m128 vv = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inv);
+        const __m128 tt = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inv);
+
+        //Ordered comparisons (except neq, which is why det is checked with ord as well),
+        // so a NaN anywhere fails the lane.
+        __m128 ok = _mm_and_ps(_mm_cmpneq_ps(det, zero), _mm_cmpord_ps(det, det));
+        ok = _mm_and_ps(ok, _mm_cmpge_ps(uu, zero));
+        ok = _mm_and_ps(ok, _mm_cmpge_ps(vv, zero));
+        ok = _mm_and_ps(ok, _mm_cmple_ps(_mm_add_ps(uu, vv), one));
+        ok = _mm_and_ps(ok, _mm_cmpge_ps(tt, zero));
+        ok = _mm_and_ps(ok, _mm_cmple_ps(tt, lim));
+
+        _mm_storeu_ps(t + half, tt);
+        _mm_storeu_ps(u + half, uu);
+        _mm_storeu_ps(v + half, vv);
+        mask |= ((unsigned int)_mm_movemask_ps(ok)) << half;
+    }
+
+    return mask;
+}
+
+#elif defined(__AVX__)
+
+static unsigned int TriBlock_lanes(const TriBlock_t *const pThis, const Point_t *const pt, const Vect_t *const vect, const Real_t closest, Real_t *const t, Real_t *const u, Real_t *const v)
+{
+    const __m256d dx = _mm256_set1_pd(vect->x);
+    const __m256d dy = _mm256_set1_pd(vect->y);
+    const __m256d dz = _mm256_set1_pd(vect->z);
+    const __m256d e1x = _mm256_loadu_pd(pThis->e1x);
+    const __m256d e1y = _mm256_loadu_pd(pThis->e1y);
+    const __m256d e1z = _mm256_loadu_pd(pThis->e1z);
+    const __m256d e2x = _mm256_loadu_pd(pThis->e2x);
+    const __m256d e2y = _mm256_loadu_pd(pThis->e2y);
+    const __m256d e2z = _mm256_loadu_pd(pThis->e2z);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+
+    //p = d x e2, det = e1 . p
+    const __m256d px = _mm256_sub_pd(_mm256_mul_pd(dy, e2z), _mm256_mul_pd(dz, e2y));
+    const __m256d py = _mm256_sub_pd(_mm256_mul_pd(dz, e2x), _mm256_mul_pd(dx, e2z));
+    const __m256d pz = _mm256_sub_pd(_mm256_mul_pd(dx, e2y), _mm256_mul_pd(dy, e2x));
+    const __m256d det = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(e1x, px), _mm256_mul_pd(e1y, py)), _mm256_mul_pd(e1z, pz));
+    const __m256d inv = _mm256_div_pd(one, det);
+
+    //s = o - v0, u = (s . p) / det
+    const __m256d sx = _mm256_sub_pd(_mm256_set1_pd(pt->x), _mm256_loadu_pd(pThis->v0x));
+    const __m256d sy = _mm256_sub_pd(_mm256_set1_pd(pt->y), _mm256_loadu_pd(pThis->v0y));
+    const __m256d sz = _mm256_sub_pd(_mm256_set1_pd(pt->z), _mm256_loadu_pd(pThis->v0z));
+    const __m256d uu = _mm256_mul_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(sx, px), _mm256_mul_pd(sy, py)), _mm256_mul_pd(sz, pz)), inv);
+
+    //q = s x e1, v = (d . q) / det, t = (e2 . q) / det
+    const __m256d qx = _mm256_sub_pd(_mm256_mul_pd(sy, e1z), _mm256_mul_pd(sz, e1y));
+    const __m256d qy = _mm256_sub_pd(_mm256_mul_pd(sz, e1x), _mm256_mul_pd(sx, e1z));
+    const __m256d qz = _mm256_sub_pd(_mm256_mul_pd(sx, e1y), _mm256_mul_pd(sy, e1x));
+    const __m256d vv = _mm256_mul_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, qx), _mm256_mul_pd(dy, qy)), _mm256_mul_pd(dz, qz)), inv);
+    const __m256d tt = _mm256_mul_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(e2x, qx), _mm256_mul_pd(e2y, qy)), _mm256_mul_pd(e2z, qz)), inv);
+
+    //Ordered comparisons, so a NaN anywhere (from a zero determinant) fails the lane.
+    __m256d ok = _mm256_cmp_pd(det, zero, _CMP_NEQ_OQ);
+    ok = _mm256_and_pd(ok, _mm256_cmp_pd(uu, zero, _CMP_GE_OQ));
+    ok = _mm256_and_pd(ok, _mm256_cmp_pd(vv, zero, _CMP_GE_OQ));
+    ok = _mm256_and_pd(ok, _mm256_cmp_pd(_mm256_add_pd(uu, vv), one, _CMP_LE_OQ));
+    ok = _mm256_and_pd(ok, _mm256_cmp_pd(tt, zero, _CMP_GE_OQ));
+    ok = _mm256_and_pd(ok, _mm256_cmp_pd(tt, _mm256_set1_pd(closest), _CMP_LE_OQ));
+
+    _mm256_storeu_pd(t, tt);
+    _mm256_storeu_pd(u, uu);
+    _mm256_storeu_pd(v, vv);
+    return (unsigned int)_mm256_movemask_pd(ok);
+}
+
+#elif defined(__SSE2__)
+
+static unsigned int TriBlock_lanes(const TriBlock_t *const pThis, const Point_t *const pt, const Vect_t *const vect, const Real_t closest, Real_t *const t, Real_t *const u, Real_t *const v)
+{
+    unsigned int half;
+    unsigned int mask = 0;
+
+    const __m128d dx = _mm_set1_pd(vect->x);
+    const __m128d dy = _mm_set1_pd(vect->y);
+    const __m128d dz = _mm_set1_pd(vect->z);
+    const __m128d ox = _mm_set1_pd(pt->x);
+    const __m128d oy = _mm_set1_pd(pt->y);
+    const __m128d oz = _mm_set1_pd(pt->z);
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d lim = _mm_set1_pd(closest);
+
+    //Two lanes at a time.
+    for(half=0; half<TRIBLOCK_WIDTH; half+=2) {
+        const __m128d e1x = _mm_loadu_pd(pThis->e1x + half);
+        const __m128d e1y = _mm_loadu_pd(pThis->e1y + half);
+        const __m128d e1z = _mm_loadu_pd(pThis->e1z + half);
+        const __m128d e2x = _mm_loadu_pd(pThis->e2x + half);
+        const __m128d e2y = _mm_loadu_pd(pThis->e2y + half);
+        const __m128d e2z = _mm_loadu_pd(pThis->e2z + half);
+
+        //p = d x e2, det = e1 . p
+        const __m128d px = _mm_sub_pd(_mm_mul_pd(dy, e2z), _mm_mul_pd(dz, e2y));
+        const __m128d py = _mm_sub_pd(_mm_mul_pd(dz, e2x), _mm_mul_pd(dx, e2z));
+        const __m128d pz = _mm_sub_pd(_mm_mul_pd(dx, e2y), _mm_mul_pd(dy, e2x));
+        const __m128d det = _mm_add_pd(_mm_add_pd(_mm_mul_pd(e1x, px), _mm_mul_pd(e1y, py)), _mm_mul_pd(e1z, pz));
+        const __m128d inv = _mm_div_pd(one, det);
+
+        //s = o - v0, u = (s . p) / det
+        const __m128d sx = _mm_sub_pd(ox, _mm_loadu_pd(pThis->v0x + half));
+        const __m128d sy = _mm_sub_pd(oy, _mm_loadu_pd(pThis->v0y + half));
+        const __m128d sz = _mm_sub_pd(oz, _mm_loadu_pd(pThis->v0z + half));
+        const __m128d uu = _mm_mul_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(sx, px), _mm_mul_pd(sy, py)), _mm_mul_pd(sz, pz)), inv);
+
+        //q = s x e1, v = (d . q) / det, t = (e2 . q) / det
+        const __m128d qx = _mm_sub_pd(_mm_mul_pd(sy, e1z), _mm_mul_pd(sz, e1y));
+        const __m128d qy = _mm_sub_pd(_mm_mul_pd(sz, e1x), _mm_mul_pd(sx, e1z));
+        const __m128d qz = _mm_sub_pd(_mm_mul_pd(sx, e1y), _mm_mul_pd(sy, e1x));
+        const __m128d vv = _mm_mul_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, qx), _mm_mul_pd(dy, qy)), _mm_mul_pd(dz, qz)), inv);
+        const __m128d tt = _mm_mul_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(e2x, qx), _mm_mul_pd(e2y, qy)), _mm_mul_pd(e2z, qz)), inv);
+
+        //Ordered comparisons (except neq, which is why det is checked with ord as well),
+        // so a NaN anywhere fails the lane.
+        __m128d ok = _mm_and_pd(_mm_cmpneq_pd(det, zero), _mm_cmpord_pd(det, det));
+        ok = _mm_and_pd(ok, _mm_cmpge_pd(uu, zero));
+        ok = _mm_and_pd(ok, _mm_cmpge_pd(vv, zero));
+        ok = _mm_and_pd(ok, _mm_cmple_pd(_mm_add_pd(uu, vv), one));
+        ok = _mm_and_pd(ok, _mm_cmpge_pd(tt, zero));
+        ok = _mm_and_pd(ok, _mm_cmple_pd(tt, lim));
+
+        _mm_storeu_pd(t + half, tt);
+        _mm_storeu_pd(u + half, uu);
+        _mm_storeu_pd(v + half, vv);
+        mask |= ((unsigned int)_mm_movemask_pd(ok)) << half;
+    }
+
+    return mask;
+}
+
+#else
+
+static unsigned int TriBlock_lanes(const TriBlock_t *const pThis, const Point_t *const pt, const Vect_t *const vect, const Real_t closest, Real_t *const t, Real_t *const u, Real_t *const v)
+{
+    unsigned int lane;
+    unsigned int mask = 0;
+
+    for(lane=0; lane<TRIBLOCK_WIDTH; lane++) {
+        const Real_t e1x = pThis->e1x[lane], e1y = pThis->e1y[lane], e1z = pThis->e1z[lane];
+        const Real_t e2x = pThis->e2x[lane], e2y = pThis->e2y[lane], e2z = pThis->e2z[lane];
+
+        const Real_t px = (vect->y * e2z) - (vect->z * e2y);
+        const Real_t py = (vect->z * e2x) - (vect->x * e2z);
+        const Real_t pz = (vect->x * e2y) - (vect->y * e2x);
+        const Real_t det = ((e1x * px) + (e1y * py)) + (e1z * pz);
+        const Real_t inv = 1 / det;
+
+        const Real_t sx = pt->x - pThis->v0x[lane];
+        const Real_t sy = pt->y - pThis->v0y[lane];
+        const Real_t sz = pt->z - pThis->v0z[lane];
+        u[lane] = (((sx * px) + (sy * py)) + (sz * pz)) * inv;
+
+        const Real_t qx = (sy * e1z) - (sz * e1y);
+        const Real_t qy = (sz * e1x) - (sx * e1z);
+        const Real_t qz = (sx * e1y) - (sy * e1x);
+        v[lane] = (((vect->x * qx) + (vect->y * qy)) + (vect->z * qz)) * inv;
+        t[lane] = (((e2x * qx) + (e2y * qy)) + (e2z * qz)) * inv;
+
+        if(det != 0 && u[lane] >= 0 && v[lane] >= 0 && (u[lane] + v[lane]) <= 1 && t[lane] >= 0 && t[lane] <= closest) {
+            mask |= (1u << lane);
+        }
+    }
+
+    return mask;
+}
+
+#endif
+
+#ifdef RT_STATS
+
+/**
+ * Function: TriBlock_count
+ * Counts the ray's tests against the block's triangles into the thread's <RayStats_target>,
+ * from what the lane kernel worked out. The determinants aren't kept, so they're worked out
+ * again here, the same way, to tell which lanes the ray crosses the plane of.
+ */
+static void TriBlock_count(const TriBlock_t *const pThis, const Vect_t *const vect, const Real_t *const u, const Real_t *const v, const unsigned int mask)
+{
+    RayStats_t *const pStats = RayStats_target;
+    unsigned int lane;
+
+    if(pStats == NULL) {
+        return;
+    }
+    for(lane=0; lane<TRIBLOCK_WIDTH; lane++) {
+        if(pThis->id[lane] == TRIBLOCK_EMPTY) {
+            continue;
+        }
+        const Real_t px = (vect->y * pThis->e2z[lane]) - (vect->z * pThis->e2y[lane]);
+        const Real_t py = (vect->z * pThis->e2x[lane]) - (vect->x * pThis->e2z[lane]);
+        const Real_t pz = (vect->x * pThis->e2y[lane]) - (vect->y * pThis->e2x[lane]);
+        const Real_t det = ((pThis->e1x[lane] * px) + (pThis->e1y[lane] * py)) + (pThis->e1z[lane] * pz);
+
+        pStats->counts[RAYSTATS_TESTS]++;
+        if(det != 0) {
+            pStats->counts[RAYSTATS_PLANE_HITS]++;
+            if(!(u[lane] >= 0 && v[lane] >= 0 && (u[lane] + v[lane]) <= 1)) {
+                pStats->counts[RAYSTATS_BARY_REJECTS]++;
+            }
+        }
+        if(mask & (1u << lane)) {
+            pStats->counts[RAYSTATS_HITS]++;
+        }
+    }
+}
+
+#endif
+
+bool TriBlock_intersect(const TriBlock_t *const pThis, const Point_t *const pt, const Vect_t *const vect, TriHit_t *const opHit)
+{
+    Real_t t[TRIBLOCK_WIDTH], u[TRIBLOCK_WIDTH], v[TRIBLOCK_WIDTH];
+    unsigned int lane;
+    int best = -1;
+    Real_t best_dist = opHit->dist;
+    unsigned int best_id = opHit->id;
+
+    const unsigned int mask = TriBlock_lanes(pThis, pt, vect, opHit->dist, t, u, v);
+#ifdef RT_STATS
+    TriBlock_count(pThis, vect, u, v, mask);
+#endif
+    if(mask == 0) {
+        return false;
+    }
+
+    //Only a handful of lanes, so pick the winner in plain C.
+    for(lane=0; lane<TRIBLOCK_WIDTH; lane++) {
+        if(!(mask & (1u << lane))) {
+            continue;
+        }
+        if(t[lane] < best_dist || (t[lane] == best_dist && pThis->id[lane] < best_id)) {
+            best = (int)lane;
+            best_dist = t[lane];
+            best_id = pThis->id[lane];
+        }
+    }
+
+    if(best < 0) {
+        return false;
+    }
+
+    opHit->dist = best_dist;
+    opHit->id = best_id;
+    Point_cfg(&(opHit->bary), 1 - u[best] - v[best], u[best], v[best]);
+    return true;
+}
+
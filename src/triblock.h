@@ -0,0 +1,123 @@
+/**
+ * File: triblock.h
+ *
+ * A block of triangles packed structure-of-arrays style, so one ray can be tested
+ * against all of them at once with SIMD instructions.
+ *
+ * Each lane holds a triangle as its first vertex plus the two edge vectors from it to the
+ * second and third vertices, which is all the Möller–Trumbore test needs.
+ */
+#ifndef TRIBLOCK_H
+#define TRIBLOCK_H
+
+#include <stdbool.h>
+
+#include "triangle.h"
+#include "point.h"
+#include "vect.h"
+
+/**
+ * Constant: TRIBLOCK_WIDTH
+ * Number of triangles in a block: one AVX register of <Real_t>, or two SSE2 registers.
+ * That's four doubles, or eight floats.
+ */
+#ifdef RT_FLOAT
+#define TRIBLOCK_WIDTH 8
+#else
+#define TRIBLOCK_WIDTH 4
+#endif
+
+/**
+ * Constant: TRIBLOCK_EMPTY
+ * The <TriBlock_t.id> of a lane with no triangle in it.
+ */
+#define TRIBLOCK_EMPTY 0xFFFFFFFFu
+
+/**
+ * Struct: TriBlock_t
+ */
+typedef struct {
+    Real_t v0x[TRIBLOCK_WIDTH], v0y[TRIBLOCK_WIDTH], v0z[TRIBLOCK_WIDTH];
+    Real_t e1x[TRIBLOCK_WIDTH], e1y[TRIBLOCK_WIDTH], e1z[TRIBLOCK_WIDTH];
+    Real_t e2x[TRIBLOCK_WIDTH], e2y[TRIBLOCK_WIDTH], e2z[TRIBLOCK_WIDTH];
+
+    /**
+     * Field: id
+     * Caller-assigned id of the triangle in each lane, or <TRIBLOCK_EMPTY>.
+     * When two triangles are hit at exactly the same distance, the lower id wins.
+     */
+    unsigned int id[TRIBLOCK_WIDTH];
+} TriBlock_t;
+
+/**
+ * Struct: TriHit_t
+ * Where a ray hit a triangle.
+ */
+typedef struct {
+    /**
+     * Field: dist
+     * Distance to the hit, in units of the ray's direction vector, as with <Triangle_rayCast>.
+     */
+    Real_t dist;
+
+    /**
+     * Field: bary
+     * Barycentric coordinates of the hit, co-opting a <Point_t> the same way
+     * as <Triangle_barycentricPosition>.
+     */
+    Point_t bary;
+
+    /**
+     * Field: id
+     * The <TriBlock_t.id> of the triangle that was hit.
+     */
+    unsigned int id;
+
+    /**
+     * Field: instance
+     * Which instance of the mesh was hit, as an index into <InstanceBvh_t.instances>, when
+     * tracing instances; otherwise 0. <TriBlock_intersect> leaves it alone.
+     */
+    unsigned int instance;
+} TriHit_t;
+
+/**
+ * Function: TriBlock_cfgEmpty
+ * Configures every lane of the block as empty.
+ */
+TriBlock_t * TriBlock_cfgEmpty(TriBlock_t *pThis);
+
+/**
+ * Function: TriBlock_setLane
+ * Packs a triangle into one lane of the block.
+ */
+TriBlock_t * TriBlock_setLane(TriBlock_t *pThis, unsigned int lane, const Triangle_t *pTriangle, unsigned int id);
+
+/**
+ * Function: TriBlock_setLaneEdges
+ * Packs a triangle, given as its first vertex and the edge vectors from it to the other two
+ * (as with <Triangle_intersectEdges>), into one lane of the block.
+ */
+TriBlock_t * TriBlock_setLaneEdges(TriBlock_t *pThis, unsigned int lane, const Point_t *v0, const Vect_t *e1, const Vect_t *e2, unsigned int id);
+
+/**
+ * Function: TriBlock_intersect
+ *
+ * Tests one ray against every triangle in the block.
+ *
+ * A triangle counts as hit if the ray crosses it (edges included) at a distance that is not
+ * negative and is closer than <opHit>'s current <TriHit_t.dist>, or exactly as close but with
+ * a lower id. So initialize <opHit> with a distance of <INFINITY> and an id of <TRIBLOCK_EMPTY>,
+ * then call this on each block in turn.
+ *
+ * Returns true, and updates <opHit> to the nearest such triangle, if there was one.
+ * Otherwise <opHit> is left alone.
+ *
+ * Uses AVX when built with it, SSE2 otherwise, or plain C if neither is available. All three
+ * give exactly the same results.
+ */
+bool TriBlock_intersect(const TriBlock_t *pThis, const Point_t *pt, const Vect_t *vect, TriHit_t *opHit);
+
+#endif
+//end inclusion filter
+
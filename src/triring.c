@@ -0,0 +1,71 @@
+/**
+ * File: triring.c
+ *
+ */
+#include "triring.h"
+
+#include "triangle.h"
+#include "vertex.h"
+#include "color.h"
+#include "point.h"
+#include "vect.h"
+#include "quat.h"
+#include "trig_helper.h"
+
+void TriRing12_cfg(TriRing12_t *const pThis, const Point_t * pCenter, const Vect_t *pFirst, const Vect_t *pUp, const double height_angle)
+{
+    unsigned int i;
+    Quat_t rot;
+    Vect_t tptr, bptr;
+    Vect_t hinge;
+    Point_t pt;
+    Color_t col;
+    Vertex_t verts[24];
+
+    Color_t colors[3];
+    Color_cfg(&colors[0], 255, 0, 0);
+    Color_cfg(&colors[1], 0, 255, 0);
+    Color_cfg(&colors[2], 0, 0, 255);
+
+    //Pointer to the first vertex in the top row.
+    Vect_copy(&tptr, pFirst);
+
+    //Axis to rotate the top pointer around to get the bottom pointer.
+    Vect_cross(&hinge, pFirst, pUp);
+
+    //Quat to rotate around the hinge.
+    Quat_rotation(&rot, &hinge, height_angle);
+
+    //Pointer to the first vertex in the bottom row.
+    Quat_rotateVect(&rot, &bptr, &tptr);
+    Quat_rotation(&rot, pUp, TWO_PI/24.0);
+    Quat_rotateVect(&rot, &bptr, &bptr);
+    
+    //Quat to rotate around the up axis.
+    Quat_rotation(&rot, pUp, TWO_PI/12.0);
+
+    for(i=0; i<12; i++)
+    {
+        //fill in the top row of vertices
+        Point_translate(&pt, pCenter, &tptr);
+        Color_copy(&col, &(colors[i%3]));
+        Vertex_cfg(&(verts[2*i]), &pt, &col);
+
+        //And the bottom row.
+        Point_translate(&pt, pCenter, &bptr);
+        Color_copy(&col, &(colors[(i+1)%3]));
+        Vertex_cfg(&(verts[2*i+1]), &pt, &col);
+
+        //Rotate around to the next triangle.
+        Quat_rotateVect(&rot, &tptr, &tptr);
+        Quat_rotateVect(&rot, &bptr, &bptr);
+    }
+
+    for(i=0; i<12; i++)
+    {
+        //And the triangle.
+        Triangle_cfg(&(pThis->triangles[2*i]), &(verts[2*i]), &(verts[2*((i+1)%12)]), &(verts[2*i+1]));
+        Triangle_cfg(&(pThis->triangles[2*i+1]), &(verts[2*i+1]), &(verts[2*((i+1)%12)]), &(verts[2*((i+1)%12)+1]));
+    }
+}
+
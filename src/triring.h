@@ -0,0 +1,38 @@
+/**
+ * File: triring.h
+ *
+ * A ring of triangles, used as a test model.
+ */
+#ifndef TRIRING_H
+#define TRIRING_H
+
+#include "triangle.h"
+#include "point.h"
+#include "vect.h"
+
+/**
+ * Struct: TriRing12_t
+ * A band of 24 triangles around an axis: two rows of 12 vertices each, zig-zagged
+ * together, with the vertices colored red, green, and blue in turn.
+ */
+typedef struct {
+    Triangle_t triangles[2*12];
+} TriRing12_t;
+
+/**
+ * Function: TriRing12_cfg
+ * Configures the ring around the axis <pUp> through <pCenter>.
+ *
+ * Arguments:
+ *  pThis   -   <TriRing12_t>* : The ring to configure.
+ *  pCenter -   const <Point_t>* : The center of the ring.
+ *  pFirst  -   const <Vect_t>* : Vector from the center to the first vertex of the top row.
+ *  pUp     -   const <Vect_t>* : The axis the ring goes around.
+ *  height_angle    -   double : Angle, in radians, from the top row of vertices down to the bottom row,
+ *                      as seen from the center.
+ */
+void TriRing12_cfg(TriRing12_t *pThis, const Point_t *pCenter, const Vect_t *pFirst, const Vect_t *pUp, double height_angle);
+
+#endif
+//end inclusion filter
+
@@ -5,6 +5,42 @@
 #ifndef TYPES_H
 #define TYPES_H
 
+#include <math.h>
+#include <float.h>
+
+/**
+ * Type: Real_t
+ *
+ * The scalar type all the geometry is done in: double by default, or float when built with
+ * RT_FLOAT defined (e.g., `scons float=1`). Floats halve the memory every point, vector, and
+ * triangle takes, and twice as many fit in a SIMD register. The double build is the reference
+ * to check the accuracy of the float build against.
+ *
+ * Functions: Real_sqrt, Real_sin, Real_cos, Real_acos, Real_fabs, Real_nextafter
+ * The math.h functions for <Real_t>, so float builds don't go through double.
+ *
+ * Constant: REAL_EPSILON
+ * DBL_EPSILON or FLT_EPSILON, to match <Real_t>.
+ */
+#ifdef RT_FLOAT
+typedef float Real_t;
+#define Real_sqrt sqrtf
+#define Real_sin sinf
+#define Real_cos cosf
+#define Real_acos acosf
+#define Real_fabs fabsf
+#define Real_nextafter nextafterf
+#define REAL_EPSILON FLT_EPSILON
+#else
+typedef double Real_t;
+#define Real_sqrt sqrt
+#define Real_sin sin
+#define Real_cos cos
+#define Real_acos acos
+#define Real_fabs fabs
+#define Real_nextafter nextafter
+#define REAL_EPSILON DBL_EPSILON
+#endif
 
 /**
  * Struct: Point_t
@@ -13,9 +49,9 @@
  * Can also represent a vector in three dimensions.
  */
 typedef struct {
-    double x;
-    double y;
-    double z;
+    Real_t x;
+    Real_t y;
+    Real_t z;
 } Point_t;
 
 /**
@@ -24,9 +60,9 @@ typedef struct {
  * Defines a vector in 3-D cartesian space by X, Y, and Z real components.
  */
 typedef struct {
-    double x;
-    double y;
-    double z;
+    Real_t x;
+    Real_t y;
+    Real_t z;
 } Vect_t;
 
 #endif
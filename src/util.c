@@ -7,6 +7,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 void Util_outOfMemory(const char *message)
 {
@@ -45,6 +46,156 @@ void* Util_cloneOrDie(const void *pRhs, size_t size, const char *message)
     return pLhs;
 }
 
+void* Util_reallocOrDie(void *ptr, size_t size, const char *message)
+{
+    void * res = realloc(ptr, size);
+    if(res == NULL) {
+        Util_outOfMemory(message);
+
+        //Just in case.
+        abort();
+        return NULL;
+    }
+    return res;
+}
+
+double Util_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + (ts.tv_nsec * 1e-9);
+}
+
+/**
+ * Function: Arena_roundUp
+ * Rounds a size up to a multiple of <ARENA_ALIGN>.
+ */
+static size_t Arena_roundUp(const size_t size)
+{
+    return (size + (ARENA_ALIGN - 1)) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+/**
+ * Function: Arena_data
+ * The first byte after a block's header, where its objects go.
+ */
+static unsigned char * Arena_data(ArenaBlock_t *const pBlock)
+{
+    return (unsigned char *)pBlock + Arena_roundUp(sizeof(ArenaBlock_t));
+}
+
+Arena_t * Arena_cfg(Arena_t *const pThis, const size_t block_size)
+{
+    pThis->head = NULL;
+    pThis->block_size = (block_size > 0) ? block_size : ARENA_BLOCK_SIZE;
+    return pThis;
+}
+
+void* Arena_alloc(Arena_t *const pThis, const size_t size, const char *const message)
+{
+    const size_t rounded = Arena_roundUp(size > 0 ? size : 1);
+    ArenaBlock_t *pBlock = pThis->head;
+
+    if(pBlock == NULL || pBlock->size - pBlock->used < rounded) {
+        const size_t block_size = (rounded > pThis->block_size) ? rounded : pThis->block_size;
+
+        //malloc's alignment is at least as strict as any of the scene's types need.
+        pBlock = Util_allocOrDie(Arena_roundUp(sizeof(ArenaBlock_t)) + block_size, message);
+        pBlock->size = block_size;
+        pBlock->used = 0;
+        if(pThis->head != NULL && rounded > pThis->block_size) {
+            //An oversized object fills a block of its own, so slip it in behind the current
+            // block rather than abandoning the space left in that.
+            pBlock->next = pThis->head->next;
+            pThis->head->next = pBlock;
+        }
+        else {
+            pBlock->next = pThis->head;
+            pThis->head = pBlock;
+        }
+    }
+
+    pBlock->used += rounded;
+    return Arena_data(pBlock) + (pBlock->used - rounded);
+}
 
+void* Arena_clone(Arena_t *const pThis, const void *const pRhs, const size_t size, const char *const message)
+{
+    void *const pLhs = Arena_alloc(pThis, size, message);
+    memcpy(pLhs, pRhs, size);
+    return pLhs;
+}
 
+size_t Arena_used(const Arena_t *const pThis)
+{
+    const ArenaBlock_t *pBlock;
+    size_t used = 0;
 
+    for(pBlock = pThis->head; pBlock != NULL; pBlock = pBlock->next) {
+        used += pBlock->used;
+    }
+    return used;
+}
+
+void Arena_reset(Arena_t *const pThis)
+{
+    ArenaBlock_t *pBlock = pThis->head;
+
+    if(pBlock == NULL) {
+        return;
+    }
+    while(pBlock->next != NULL) {
+        ArenaBlock_t *const pNext = pBlock->next;
+        free(pBlock);
+        pBlock = pNext;
+    }
+    pBlock->used = 0;
+    pThis->head = pBlock;
+}
+
+void Arena_destroy(Arena_t *const pThis)
+{
+    ArenaBlock_t *pBlock = pThis->head;
+
+    while(pBlock != NULL) {
+        ArenaBlock_t *const pNext = pBlock->next;
+        free(pBlock);
+        pBlock = pNext;
+    }
+    pThis->head = NULL;
+}
+
+Pool_t * Pool_cfg(Pool_t *const pThis, const size_t object_size, const size_t per_slab)
+{
+    //Big enough to hold the free list's link once it's freed.
+    pThis->object_size = Arena_roundUp(object_size > sizeof(void *) ? object_size : sizeof(void *));
+    pThis->free_list = NULL;
+    Arena_cfg(&(pThis->arena), pThis->object_size * (per_slab > 0 ? per_slab : 1));
+    return pThis;
+}
+
+void* Pool_alloc(Pool_t *const pThis, const char *const message)
+{
+    void *const pObject = pThis->free_list;
+
+    if(pObject != NULL) {
+        memcpy(&(pThis->free_list), pObject, sizeof(void *));
+        return pObject;
+    }
+    return Arena_alloc(&(pThis->arena), pThis->object_size, message);
+}
+
+void Pool_free(Pool_t *const pThis, void *const ptr)
+{
+    if(ptr == NULL) {
+        return;
+    }
+    memcpy(ptr, &(pThis->free_list), sizeof(void *));
+    pThis->free_list = ptr;
+}
+
+void Pool_destroy(Pool_t *const pThis)
+{
+    Arena_destroy(&(pThis->arena));
+    pThis->free_list = NULL;
+}
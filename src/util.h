@@ -6,6 +6,7 @@
 #define UTIL_H
 
 #include <stdlib.h>
+#include <stddef.h>
 
 void Util_outOfMemory(const char *message);
 
@@ -13,6 +14,163 @@ void* Util_allocOrDie(size_t size, const char *message);
 
 void* Util_cloneOrDie(const void *pRhs, size_t size, const char *message);
 
+/**
+ * Function: Util_reallocOrDie
+ * Like realloc, but aborts the program with the given message if there is not enough memory.
+ */
+void* Util_reallocOrDie(void *ptr, size_t size, const char *message);
+
+/**
+ * Function: Util_now
+ * Returns a monotonic time in seconds, for timing things. Only differences between
+ * two calls mean anything.
+ */
+double Util_now(void);
+
+/**
+ * Constant: ARENA_ALIGN
+ * Every allocation from an <Arena_t> starts at a multiple of this many bytes, which is enough
+ * for any of the scene's types.
+ */
+#define ARENA_ALIGN 16
+
+/**
+ * Constant: ARENA_BLOCK_SIZE
+ * Default size of the blocks an <Arena_t> allocates from the heap, in bytes.
+ */
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+/**
+ * Struct: ArenaBlock_t
+ * One block of an arena's memory, with its objects packed in after the header.
+ */
+typedef struct ArenaBlock_s {
+    struct ArenaBlock_s *next;
+    size_t size;
+    size_t used;
+} ArenaBlock_t;
+
+/**
+ * Struct: Arena_t
+ *
+ * Bump allocator for objects that all live and die together, like the pieces of a scene.
+ * Allocating is just moving a pointer along the current block, so it's far cheaper than
+ * malloc, and consecutive objects end up next to each other in memory. Objects can't be freed
+ * one at a time: everything goes at once with <Arena_reset> or <Arena_destroy>.
+ *
+ * An arena is not thread safe.
+ */
+typedef struct {
+    /**
+     * Field: head
+     * The block being allocated from, with the older, full ones chained behind it.
+     */
+    ArenaBlock_t *head;
+    size_t block_size;
+} Arena_t;
+
+/**
+ * Function: Arena_cfg
+ * Configures an empty arena, which will take memory from the heap <block_size> bytes at a time
+ * (or <ARENA_BLOCK_SIZE> if it's 0). Nothing is allocated until the first object is.
+ */
+Arena_t * Arena_cfg(Arena_t *pThis, size_t block_size);
+
+/**
+ * Function: Arena_alloc
+ * Allocates <size> bytes, aligned to <ARENA_ALIGN>, which stay valid until the arena is reset
+ * or destroyed. Objects bigger than a block get a block to themselves.
+ *
+ * Aborts the program with the given message if there is not enough memory.
+ */
+void* Arena_alloc(Arena_t *pThis, size_t size, const char *message);
+
+/**
+ * Function: Arena_clone
+ * Like <Util_cloneOrDie>, but allocating the copy from the arena.
+ */
+void* Arena_clone(Arena_t *pThis, const void *pRhs, size_t size, const char *message);
+
+/**
+ * Function: Arena_used
+ * Total bytes allocated from the arena so far, including the padding for alignment.
+ */
+size_t Arena_used(const Arena_t *pThis);
+
+/**
+ * Function: Arena_reset
+ * Frees every object allocated from the arena at once. The oldest block is kept to allocate
+ * from again, so an arena that's filled and reset over and over settles into reusing it.
+ */
+void Arena_reset(Arena_t *pThis);
+
+/**
+ * Function: Arena_destroy
+ * Frees all of the arena's memory. The object itself is not freed.
+ */
+void Arena_destroy(Arena_t *pThis);
+
+/**
+ * Struct: Pool_t
+ *
+ * Allocator for objects of a single type (or at least a single size) that come and go
+ * individually. Freed objects go on a list to be handed out again, and new ones are cut from
+ * slabs in an <Arena_t>, so like the arena, the pool gets all its memory back at once with
+ * <Pool_destroy>.
+ */
+typedef struct {
+    Arena_t arena;
+
+    /**
+     * Field: object_size
+     * Bytes per object, rounded up to keep every object aligned to <ARENA_ALIGN>.
+     */
+    size_t object_size;
+
+    /**
+     * Field: free_list
+     * Objects that have been freed, each holding a pointer to the next.
+     */
+    void *free_list;
+} Pool_t;
+
+/**
+ * Function: Pool_cfg
+ * Configures an empty pool of objects of <object_size> bytes, which takes memory <per_slab>
+ * objects at a time.
+ */
+Pool_t * Pool_cfg(Pool_t *pThis, size_t object_size, size_t per_slab);
+
+/**
+ * Function: Pool_alloc
+ * Allocates an object, reusing one that's been freed if there is one.
+ *
+ * Aborts the program with the given message if there is not enough memory.
+ */
+void* Pool_alloc(Pool_t *pThis, const char *message);
+
+/**
+ * Function: Pool_free
+ * Gives an object from <Pool_alloc> back to the pool.
+ */
+void Pool_free(Pool_t *pThis, void *ptr);
+
+/**
+ * Function: Pool_destroy
+ * Frees all of the pool's memory, including objects that are still allocated. The object
+ * itself is not freed.
+ */
+void Pool_destroy(Pool_t *pThis);
+
+/**
+ * Macros: Typed pools
+ *
+ * POOL_CFG(pPool, type, per_slab) - <Pool_cfg> for a pool of <type> objects.
+ * POOL_NEW(pPool, type) - <Pool_alloc> from a pool of <type> objects, as a pointer to one.
+ */
+#define POOL_CFG(pPool, type, per_slab) Pool_cfg((pPool), sizeof(type), (per_slab))
+#define POOL_NEW(pPool, type) ((type *)Pool_alloc((pPool), "Allocating a " #type " object from a pool."))
+
 #endif
 //end inclusion filter
 
@@ -9,7 +9,7 @@
 #include "point.h"
 #include "util.h"
 
-Vect_t * Vect_cfg(Vect_t * pThis,  double x,  double y,  double z)
+Vect_t * Vect_cfg(Vect_t * pThis,  Real_t x,  Real_t y,  Real_t z)
 {
     pThis->x = x;
     pThis->y = y;
@@ -22,7 +22,7 @@ Vect_t * Vect_copy(Vect_t * pThis,  const Vect_t *pRhs)
     return Vect_cfg(pThis, pRhs->x, pRhs->y, pRhs->z);
 }
 
-Vect_t * Vect(double x, double y, double z)
+Vect_t * Vect(Real_t x, Real_t y, Real_t z)
 {
     Vect_t *const pThis = Util_allocOrDie(sizeof(Vect_t), "Allocating a Vect_t object.");
     if(pThis != NULL) {
@@ -41,22 +41,33 @@ Vect_t * Vect_clone(const Vect_t* pRhs)
     return Util_cloneOrDie(pRhs, sizeof(Vect_t), "Cloning a Vect_t object.");
 }
 
-double Vect_magnitude(const Vect_t *pThis)
+Vect_t * Vect_inArena(Arena_t *const pArena, const Real_t x, const Real_t y, const Real_t z)
 {
-    const double x = pThis->x;
-    const double y = pThis->y;
-    const double z = pThis->z;
-    return sqrt(x*x + y*y + z*z);
+    Vect_t *const pThis = Arena_alloc(pArena, sizeof(Vect_t), "Allocating a Vect_t object in an arena.");
+    return Vect_cfg(pThis, x, y, z);
+}
+
+Vect_t * Vect_cloneInArena(Arena_t *const pArena, const Vect_t *const pRhs)
+{
+    return Arena_clone(pArena, pRhs, sizeof(Vect_t), "Cloning a Vect_t object into an arena.");
+}
+
+Real_t Vect_magnitude(const Vect_t *pThis)
+{
+    const Real_t x = pThis->x;
+    const Real_t y = pThis->y;
+    const Real_t z = pThis->z;
+    return Real_sqrt(x*x + y*y + z*z);
 }
 
 Vect_t * Vect_add(Vect_t *opVect, const Vect_t *pA, const Vect_t *pB)
 {
-    return Vect_cfg(opVect, pA->x + pB->z, pA->y + pB->y, pA->z + pB->z);
+    return Vect_cfg(opVect, pA->x + pB->x, pA->y + pB->y, pA->z + pB->z);
 }
 
 Vect_t * Vect_sub(Vect_t *opVect, const Vect_t *pA, const Vect_t *pB)
 {
-    return Vect_cfg(opVect, pA->x - pB->z, pA->y - pB->y, pA->z - pB->z);
+    return Vect_cfg(opVect, pA->x - pB->x, pA->y - pB->y, pA->z - pB->z);
 }
 
 Vect_t * Vect_negate(Vect_t *opVect, const Vect_t *pVect)
@@ -66,7 +77,7 @@ Vect_t * Vect_negate(Vect_t *opVect, const Vect_t *pVect)
 
 Vect_t * Vect_cross(Vect_t *opProd, const Vect_t *pA, const Vect_t *pB)
 {
-    double u1, u2, u3, v1, v2, v3;
+    Real_t u1, u2, u3, v1, v2, v3;
     u1 = pA->x;
     u2 = pA->y;
     u3 = pA->z;
@@ -77,32 +88,32 @@ Vect_t * Vect_cross(Vect_t *opProd, const Vect_t *pA, const Vect_t *pB)
     return Vect_cfg(opProd, (u2*v3) - (u3*v2), (u3*v1) - (u1*v3), (u1*v2) - (u2*v1));
 }
 
-double Vect_dot(const Vect_t *pA, const Vect_t *pB)
+Real_t Vect_dot(const Vect_t *pA, const Vect_t *pB)
 {
     return (pA->x * pB->x) + (pA->y * pB->y) + (pA->z * pB->z);
 }
 
 Vect_t * Vect_normalize(Vect_t *opNormal, const Vect_t *const pRhs)
 {
-    const double length = Vect_magnitude(pRhs);
+    const Real_t length = Vect_magnitude(pRhs);
     return Vect_cfg(opNormal, (pRhs->x)/length, (pRhs->y)/length, (pRhs->z)/length);
 }
 
-Vect_t * Vect_scale(Vect_t *pThis, const Vect_t *pRhs, double scale)
+Vect_t * Vect_scale(Vect_t *pThis, const Vect_t *pRhs, Real_t scale)
 {
     return Vect_cfg(pThis, pRhs->x * scale, pRhs->y * scale, pRhs->z * scale);
 }
 
-Vect_t * Vect_setMag(Vect_t *pThis, double magnitude)
+Vect_t * Vect_setMag(Vect_t *pThis, Real_t magnitude)
 {
-    const double length = Vect_magnitude(pThis);
-    const double scale = magnitude / length;
+    const Real_t length = Vect_magnitude(pThis);
+    const Real_t scale = magnitude / length;
     return Vect_cfg(pThis, (pThis->x)*scale, (pThis->y)*scale, (pThis->z)*scale);
 }
 
-double Vect_angle(const Vect_t *pA, const Vect_t *pB)
+Real_t Vect_angle(const Vect_t *pA, const Vect_t *pB)
 {
-    return acos(Vect_dot(pA, pB) / (Vect_magnitude(pA) * Vect_magnitude(pB)));
+    return Real_acos(Vect_dot(pA, pB) / (Vect_magnitude(pA) * Vect_magnitude(pB)));
 }
 
 Point_t * Vect_point(Point_t *opPoint, const Vect_t *pVect)
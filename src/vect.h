@@ -9,13 +9,14 @@
 #define VECT_H
 
 #include "types.h"
+#include "util.h"
 
 
 /**
  * Function: Vect_cfg
  * Configures the given <Vect_t> object and returns a pointer to the same object for convenience.
  */
-Vect_t * Vect_cfg(Vect_t * pThis,  double x,  double y,  double z);
+Vect_t * Vect_cfg(Vect_t * pThis,  Real_t x,  Real_t y,  Real_t z);
 
 Vect_t * Vect_copy(Vect_t * pThis,  const Vect_t *pRhs);
 
@@ -25,7 +26,7 @@ Vect_t * Vect_copy(Vect_t * pThis,  const Vect_t *pRhs);
  *
  * Aborts the program if there is not enough memory.
  */
-Vect_t * Vect(double x, double y, double z);
+Vect_t * Vect(Real_t x, Real_t y, Real_t z);
 
 /**
  * Function: Vect_zero
@@ -44,12 +45,25 @@ Vect_t * Vect_zero(void);
  */
 Vect_t * Vect_clone(const Vect_t* pRhs);
 
+/**
+ * Function: Vect_inArena
+ * Like <Vect>, but allocates the object from the arena, so it's freed along with everything
+ * else in it.
+ */
+Vect_t * Vect_inArena(Arena_t *pArena, Real_t x, Real_t y, Real_t z);
+
+/**
+ * Function: Vect_cloneInArena
+ * Like <Vect_clone>, but allocates the copy from the arena.
+ */
+Vect_t * Vect_cloneInArena(Arena_t *pArena, const Vect_t *pRhs);
+
 /**
  * Function: Vect_magnitude
  *
  * Returns the magnitude of the vector.
  */
-double Vect_magnitude(const Vect_t *pThis);
+Real_t Vect_magnitude(const Vect_t *pThis);
 
 /**
  * Function: Vect_add
@@ -87,7 +101,7 @@ Vect_t * Vect_cross(Vect_t *opProd, const Vect_t *pA, const Vect_t *pB);
  * Function: Vect_dot
  * Returns the dot product of two vectors.
  */
-double Vect_dot(const Vect_t *pA, const Vect_t *pB);
+Real_t Vect_dot(const Vect_t *pA, const Vect_t *pB);
 
 /**
  * Function: Vect_normalize
@@ -107,7 +121,7 @@ Vect_t * Vect_normalize(Vect_t *opNormal, const Vect_t *const pRhs);
  * Configures the given vector to be a scaled version of the right-hand vector.
  * It is acceptable for both pointers to point to the same object.
  */
-Vect_t * Vect_scale(Vect_t *pThis, const Vect_t *pRhs, double scale);
+Vect_t * Vect_scale(Vect_t *pThis, const Vect_t *pRhs, Real_t scale);
 
 /**
  * Function: Vect_setMag
@@ -118,7 +132,7 @@ Vect_t * Vect_scale(Vect_t *pThis, const Vect_t *pRhs, double scale);
  * and then scaling it by the desired magnitude with <Vect_scale>. But it's faster to
  * do it this way.
  */
-Vect_t * Vect_setMag(Vect_t *pThis, double magnitude);
+Vect_t * Vect_setMag(Vect_t *pThis, Real_t magnitude);
 
 /**
  * Function: Vect_angle
@@ -127,7 +141,7 @@ Vect_t * Vect_setMag(Vect_t *pThis, double magnitude);
  * This assumes the vectors are arranged tail to tail, and returns an angle no greater
  * than pi radians.
  */
-double Vect_angle(const Vect_t *pA, const Vect_t *pB);
+Real_t Vect_angle(const Vect_t *pA, const Vect_t *pB);
 
 /**
  * Function: Vect_point
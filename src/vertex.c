@@ -34,5 +34,16 @@ Vertex_t * Vertex_clone(const Vertex_t *pRhs)
     return Util_cloneOrDie(pRhs, sizeof(Vertex_t), "Cloning a Vertex_t object.");
 }
 
+Vertex_t * Vertex_inArena(Arena_t *const pArena, const Point_t *const loc, const Color_t *const color)
+{
+    Vertex_t *const pThis = Arena_alloc(pArena, sizeof(Vertex_t), "Allocating a Vertex_t object in an arena.");
+    return Vertex_cfg(pThis, loc, color);
+}
+
+Vertex_t * Vertex_cloneInArena(Arena_t *const pArena, const Vertex_t *const pRhs)
+{
+    return Arena_clone(pArena, pRhs, sizeof(Vertex_t), "Cloning a Vertex_t object into an arena.");
+}
+
 
 
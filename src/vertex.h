@@ -7,6 +7,7 @@
 
 #include "point.h"
 #include "color.h"
+#include "util.h"
 
 /**
  * Struct: Vertex_t
@@ -46,6 +47,19 @@ Vertex_t * Vertex(const Point_t *loc, const Color_t *color);
  */
 Vertex_t * Vertex_clone(const Vertex_t *pRhs);
 
+/**
+ * Function: Vertex_inArena
+ * Like <Vertex>, but allocates the object from the arena, so it's freed along with everything
+ * else in it.
+ */
+Vertex_t * Vertex_inArena(Arena_t *pArena, const Point_t *loc, const Color_t *color);
+
+/**
+ * Function: Vertex_cloneInArena
+ * Like <Vertex_clone>, but allocates the copy from the arena.
+ */
+Vertex_t * Vertex_cloneInArena(Arena_t *pArena, const Vertex_t *pRhs);
+
 #endif
 //end inclusion filter
 
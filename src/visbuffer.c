@@ -0,0 +1,88 @@
+/**
+ * File: visbuffer.c
+ *
+ */
+#include "visbuffer.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+
+VisBuffer_t * VisBuffer_cfg(VisBuffer_t *const pThis, const int width, const int height)
+{
+    const size_t count = (size_t)width * height;
+    size_t i;
+
+    pThis->width = width;
+    pThis->height = height;
+    pThis->ids = Util_allocOrDie(sizeof(uint32_t) * count + 1, "Allocating visibility buffer ids.");
+    pThis->dists = Util_allocOrDie(sizeof(Real_t) * count + 1, "Allocating visibility buffer distances.");
+    pThis->bary_u = Util_allocOrDie(sizeof(Real_t) * count + 1, "Allocating visibility buffer coordinates.");
+    pThis->bary_v = Util_allocOrDie(sizeof(Real_t) * count + 1, "Allocating visibility buffer coordinates.");
+    pThis->instances = Util_allocOrDie(sizeof(uint32_t) * count + 1, "Allocating visibility buffer instances.");
+
+    for(i=0; i<count; i++) {
+        pThis->ids[i] = TRIBLOCK_EMPTY;
+        pThis->dists[i] = INFINITY;
+        pThis->bary_u[i] = 0;
+        pThis->bary_v[i] = 0;
+        pThis->instances[i] = 0;
+    }
+    return pThis;
+}
+
+void VisBuffer_destroy(VisBuffer_t *const pThis)
+{
+    free(pThis->ids);
+    free(pThis->dists);
+    free(pThis->bary_u);
+    free(pThis->bary_v);
+    free(pThis->instances);
+    pThis->ids = NULL;
+    pThis->dists = NULL;
+    pThis->bary_u = NULL;
+    pThis->bary_v = NULL;
+    pThis->instances = NULL;
+}
+
+void VisBuffer_shade(const VisBuffer_t *const pThis, const Mesh_t *const pMesh, uint8_t *const pixels, const int rowstride)
+{
+    const uint32_t *const indices = pMesh->indices;
+    const Color_t *const colors = pMesh->colors;
+    int i, j;
+
+    if(pMesh->tri_count == 0) {
+        for(j=0; j<pThis->height; j++) {
+            memset(pixels + (j * rowstride), 0, (size_t)(pThis->width) * 3);
+        }
+        return;
+    }
+
+    //No branches and no calls: a miss is shaded as triangle 0 with all three weights zero,
+    // which comes out black. The weights and sums are exactly those of Mesh_getBaryColor.
+    for(j=0; j<pThis->height; j++) {
+        const uint32_t *const ids = pThis->ids + ((size_t)j * pThis->width);
+        const Real_t *const us = pThis->bary_u + ((size_t)j * pThis->width);
+        const Real_t *const vs = pThis->bary_v + ((size_t)j * pThis->width);
+        uint8_t *const pix = pixels + (j * rowstride);
+
+        for(i=0; i<pThis->width; i++) {
+            const bool hit = (ids[i] != TRIBLOCK_EMPTY);
+            const uint32_t *const idx = &(indices[3 * (hit ? ids[i] : 0)]);
+            const Color_t *const c0 = &(colors[idx[0]]);
+            const Color_t *const c1 = &(colors[idx[1]]);
+            const Color_t *const c2 = &(colors[idx[2]]);
+            const Real_t u = us[i];
+            const Real_t v = vs[i];
+            const Real_t w = hit ? (1 - u - v) : 0;
+
+            pix[3*i] = (uint8_t)((w*(c0->r)) + (u*(c1->r)) + (v*(c2->r)));
+            pix[3*i + 1] = (uint8_t)((w*(c0->g)) + (u*(c1->g)) + (v*(c2->g)));
+            pix[3*i + 2] = (uint8_t)((w*(c0->b)) + (u*(c1->b)) + (v*(c2->b)));
+        }
+    }
+}
+
@@ -0,0 +1,85 @@
+/**
+ * File: visbuffer.h
+ *
+ * A visibility buffer: for every pixel, just which triangle the pixel's ray hit and where,
+ * with no color. Tracing the rays (see <Render_visibility>) and shading the hits (see
+ * <VisBuffer_shade>) are then two separate passes, so each pixel is shaded exactly once, and
+ * an image can be shaded again without tracing any rays.
+ */
+#ifndef VISBUFFER_H
+#define VISBUFFER_H
+
+#include <stdint.h>
+
+#include "types.h"
+#include "mesh.h"
+#include "triblock.h"
+
+/**
+ * Struct: VisBuffer_t
+ * One entry per pixel, rows top first with no gaps, in separate arrays for each field so the
+ * shading pass reads each of them straight through.
+ */
+typedef struct {
+    int width;
+    int height;
+
+    /**
+     * Field: ids
+     * Index in the mesh of the triangle each pixel hit, or <TRIBLOCK_EMPTY> if it hit nothing.
+     */
+    uint32_t *ids;
+
+    /**
+     * Field: dists
+     * Distance to each hit, in units of the ray's direction vector (a unit vector, for rays from
+     * a <RayGen_t>), or infinity for a miss.
+     */
+    Real_t *dists;
+
+    /**
+     * Fields: bary_u, bary_v
+     * The second and third barycentric coordinates of each hit (the first is 1 - u - v),
+     * or 0 for a miss.
+     */
+    Real_t *bary_u;
+    Real_t *bary_v;
+
+    /**
+     * Field: instances
+     * Which instance each pixel hit, as <TriHit_t.instance>: 0 unless the scene has
+     * <Scene_t.instances>, in which case <ids> index into that instance's mesh.
+     */
+    uint32_t *instances;
+} VisBuffer_t;
+
+/**
+ * Function: VisBuffer_cfg
+ * Configures the buffer and allocates its arrays, with every pixel a miss.
+ *
+ * Aborts the program if there is not enough memory.
+ */
+VisBuffer_t * VisBuffer_cfg(VisBuffer_t *pThis, int width, int height);
+
+/**
+ * Function: VisBuffer_destroy
+ * Frees the arrays allocated by <VisBuffer_cfg>. The object itself is not freed.
+ */
+void VisBuffer_destroy(VisBuffer_t *pThis);
+
+/**
+ * Function: VisBuffer_shade
+ *
+ * Colors every pixel from the buffer, interpolating the vertex colors of the mesh the buffer
+ * was traced against, into <pixels>, laid out as for <Render_scene>. Pixels which hit nothing
+ * are black. The result is exactly what <Render_castRay> gives for each pixel. This only
+ * handles a single mesh, without <VisBuffer_t.instances>; see <Render_shade> for the rest.
+ *
+ * The vertex positions aren't used, so if only the colors in the mesh have changed, this is all
+ * that's needed to redraw the image.
+ */
+void VisBuffer_shade(const VisBuffer_t *pThis, const Mesh_t *pMesh, uint8_t *pixels, int rowstride);
+
+#endif
+//end inclusion filter
+
@@ -0,0 +1,252 @@
+/**
+ * File: xform.c
+ *
+ */
+#include "xform.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "quat.h"
+#include "axes.h"
+#include "mesh.h"
+#include "triangle.h"
+#include "point.h"
+#include "vect.h"
+
+/**
+ * Constant: XFORM_CHUNK
+ * Triangles whose vertices <Xform_triangles> gathers up to transform in one batch.
+ */
+#define XFORM_CHUNK 64
+
+Xform_t * Xform_cfg(Xform_t *const pThis)
+{
+    unsigned int r, c;
+
+    for(r=0; r<3; r++) {
+        for(c=0; c<4; c++) {
+            pThis->m[r][c] = (r == c) ? 1 : 0;
+        }
+    }
+    return pThis;
+}
+
+Xform_t * Xform_fromQuat(Xform_t *const opThis, const Quat_t *const pRot, const Vect_t *const pTrans)
+{
+    const Real_t w = pRot->w;
+    const Real_t x = pRot->x;
+    const Real_t y = pRot->y;
+    const Real_t z = pRot->z;
+
+    //The matrix of p -> q p q*, for a unit quat q.
+    opThis->m[0][0] = 1 - 2*(y*y + z*z);
+    opThis->m[0][1] = 2*(x*y - w*z);
+    opThis->m[0][2] = 2*(x*z + w*y);
+    opThis->m[1][0] = 2*(x*y + w*z);
+    opThis->m[1][1] = 1 - 2*(x*x + z*z);
+    opThis->m[1][2] = 2*(y*z - w*x);
+    opThis->m[2][0] = 2*(x*z - w*y);
+    opThis->m[2][1] = 2*(y*z + w*x);
+    opThis->m[2][2] = 1 - 2*(x*x + y*y);
+
+    opThis->m[0][3] = (pTrans != NULL) ? pTrans->x : 0;
+    opThis->m[1][3] = (pTrans != NULL) ? pTrans->y : 0;
+    opThis->m[2][3] = (pTrans != NULL) ? pTrans->z : 0;
+    return opThis;
+}
+
+Xform_t * Xform_fromAxes(Xform_t *const opThis, const Axes_t *const pAxes)
+{
+    opThis->m[0][0] = pAxes->x.x;
+    opThis->m[1][0] = pAxes->x.y;
+    opThis->m[2][0] = pAxes->x.z;
+    opThis->m[0][1] = pAxes->y.x;
+    opThis->m[1][1] = pAxes->y.y;
+    opThis->m[2][1] = pAxes->y.z;
+    opThis->m[0][2] = pAxes->z.x;
+    opThis->m[1][2] = pAxes->z.y;
+    opThis->m[2][2] = pAxes->z.z;
+    opThis->m[0][3] = pAxes->origin.x;
+    opThis->m[1][3] = pAxes->origin.y;
+    opThis->m[2][3] = pAxes->origin.z;
+    return opThis;
+}
+
+Point_t * Xform_point(const Xform_t *const pThis, Point_t *const opOut, const Point_t *const pIn)
+{
+    const Real_t x = pIn->x;
+    const Real_t y = pIn->y;
+    const Real_t z = pIn->z;
+    const Real_t (*const m)[4] = pThis->m;
+
+    //The same order of operations as the SIMD kernels, column by column.
+    return Point_cfg(opOut,
+        ((m[0][0]*x + m[0][1]*y) + m[0][2]*z) + m[0][3],
+        ((m[1][0]*x + m[1][1]*y) + m[1][2]*z) + m[1][3],
+        ((m[2][0]*x + m[2][1]*y) + m[2][2]*z) + m[2][3]);
+}
+
+Vect_t * Xform_vect(const Xform_t *const pThis, Vect_t *const opOut, const Vect_t *const pIn)
+{
+    const Real_t x = pIn->x;
+    const Real_t y = pIn->y;
+    const Real_t z = pIn->z;
+    const Real_t (*const m)[4] = pThis->m;
+
+    return Vect_cfg(opOut,
+        (m[0][0]*x + m[0][1]*y) + m[0][2]*z,
+        (m[1][0]*x + m[1][1]*y) + m[1][2]*z,
+        (m[2][0]*x + m[2][1]*y) + m[2][2]*z);
+}
+
+/*
+ * Function: Xform_apply
+ * Transforms <count> packed triples of coordinates.
+ *
+ * Each kernel holds the four columns of the matrix in registers, one coordinate per lane,
+ * and does a point at a time as a sum of the columns scaled by its coordinates. Each point's
+ * coordinates are read before anything is written back, so the input can be the output.
+ */
+#if defined(RT_FLOAT) && defined(__SSE2__)
+
+static void Xform_apply(const Xform_t *const pThis, Real_t *const opOut, const Real_t *const pIn, const unsigned int count)
+{
+    const Real_t (*const m)[4] = pThis->m;
+    const __m128 c0 = _mm_setr_ps(m[0][0], m[1][0], m[2][0], 0);
+    const __m128 c1 = _mm_setr_ps(m[0][1], m[1][1], m[2][1], 0);
+    const __m128 c2 = _mm_setr_ps(m[0][2], m[1][2], m[2][2], 0);
+    const __m128 c3 = _mm_setr_ps(m[0][3], m[1][3], m[2][3], 0);
+    unsigned int i;
+
+    for(i=0; i<count; i++) {
+        const __m128 x = _mm_set1_ps(pIn[3*i]);
+        const __m128 y = _mm_set1_ps(pIn[3*i + 1]);
+        const __m128 z = _mm_set1_ps(pIn[3*i + 2]);
+        const __m128 r = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, x), _mm_mul_ps(c1, y)), _mm_mul_ps(c2, z)), c3);
+
+        //A whole register would run over into the next point, so store three lanes.
+        _mm_storel_pi((__m64 *)&(opOut[3*i]), r);
+        _mm_store_ss(&(opOut[3*i + 2]), _mm_movehl_ps(r, r));
+    }
+}
+
+#elif !defined(RT_FLOAT) && defined(__AVX__)
+
+static void Xform_apply(const Xform_t *const pThis, Real_t *const opOut, const Real_t *const pIn, const unsigned int count)
+{
+    const Real_t (*const m)[4] = pThis->m;
+    const __m256d c0 = _mm256_setr_pd(m[0][0], m[1][0], m[2][0], 0);
+    const __m256d c1 = _mm256_setr_pd(m[0][1], m[1][1], m[2][1], 0);
+    const __m256d c2 = _mm256_setr_pd(m[0][2], m[1][2], m[2][2], 0);
+    const __m256d c3 = _mm256_setr_pd(m[0][3], m[1][3], m[2][3], 0);
+    const __m256i xyz = _mm256_setr_epi64x(-1, -1, -1, 0);
+    unsigned int i;
+
+    for(i=0; i<count; i++) {
+        const __m256d x = _mm256_set1_pd(pIn[3*i]);
+        const __m256d y = _mm256_set1_pd(pIn[3*i + 1]);
+        const __m256d z = _mm256_set1_pd(pIn[3*i + 2]);
+        const __m256d r = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(c0, x), _mm256_mul_pd(c1, y)), _mm256_mul_pd(c2, z)), c3);
+
+        _mm256_maskstore_pd(&(opOut[3*i]), xyz, r);
+    }
+}
+
+#elif !defined(RT_FLOAT) && defined(__SSE2__)
+
+static void Xform_apply(const Xform_t *const pThis, Real_t *const opOut, const Real_t *const pIn, const unsigned int count)
+{
+    const Real_t (*const m)[4] = pThis->m;
+    const __m128d c0 = _mm_setr_pd(m[0][0], m[1][0]);
+    const __m128d c1 = _mm_setr_pd(m[0][1], m[1][1]);
+    const __m128d c2 = _mm_setr_pd(m[0][2], m[1][2]);
+    const __m128d c3 = _mm_setr_pd(m[0][3], m[1][3]);
+    const __m128d c0z = _mm_set_sd(m[2][0]);
+    const __m128d c1z = _mm_set_sd(m[2][1]);
+    const __m128d c2z = _mm_set_sd(m[2][2]);
+    const __m128d c3z = _mm_set_sd(m[2][3]);
+    unsigned int i;
+
+    for(i=0; i<count; i++) {
+        const __m128d x = _mm_set1_pd(pIn[3*i]);
+        const __m128d y = _mm_set1_pd(pIn[3*i + 1]);
+        const __m128d z = _mm_set1_pd(pIn[3*i + 2]);
+
+        //X and Y in one register, Z in the bottom lane of another.
+        const __m128d r = _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(c0, x), _mm_mul_pd(c1, y)), _mm_mul_pd(c2, z)), c3);
+        const __m128d rz = _mm_add_sd(_mm_add_sd(_mm_add_sd(_mm_mul_sd(c0z, x), _mm_mul_sd(c1z, y)), _mm_mul_sd(c2z, z)), c3z);
+
+        _mm_storeu_pd(&(opOut[3*i]), r);
+        _mm_store_sd(&(opOut[3*i + 2]), rz);
+    }
+}
+
+#else
+
+static void Xform_apply(const Xform_t *const pThis, Real_t *const opOut, const Real_t *const pIn, const unsigned int count)
+{
+    unsigned int i;
+
+    Point_t pt;
+
+    for(i=0; i<count; i++) {
+        Xform_point(pThis, &pt, Point_cfg(&pt, pIn[3*i], pIn[3*i + 1], pIn[3*i + 2]));
+        opOut[3*i] = pt.x;
+        opOut[3*i + 1] = pt.y;
+        opOut[3*i + 2] = pt.z;
+    }
+}
+
+#endif
+
+void Xform_points(const Xform_t *const pThis, Point_t *const opOut, const Point_t *const pIn, const unsigned int count)
+{
+    //Points are three coordinates with nothing between them, so an array of them is packed.
+    if(count > 0) {
+        Xform_apply(pThis, &(opOut->x), &(pIn->x), count);
+    }
+}
+
+void Xform_vects(const Xform_t *const pThis, Vect_t *const opOut, const Vect_t *const pIn, const unsigned int count)
+{
+    Xform_t linear = *pThis;
+
+    linear.m[0][3] = linear.m[1][3] = linear.m[2][3] = 0;
+    if(count > 0) {
+        Xform_apply(&linear, &(opOut->x), &(pIn->x), count);
+    }
+}
+
+void Xform_triangles(const Xform_t *const pThis, Triangle_t *const pTriangles, const unsigned int count)
+{
+    Point_t locs[3 * XFORM_CHUNK];
+    unsigned int start, i, v;
+
+    //The vertices are strided through the triangles, so gather them up to transform in bulk.
+    for(start=0; start<count; start+=XFORM_CHUNK) {
+        const unsigned int n = (count - start < XFORM_CHUNK) ? (count - start) : XFORM_CHUNK;
+
+        for(i=0; i<n; i++) {
+            for(v=0; v<3; v++) {
+                Point_copy(&(locs[3*i + v]), &(pTriangles[start + i].vert[v].loc));
+            }
+        }
+        Xform_points(pThis, locs, locs, 3 * n);
+        for(i=0; i<n; i++) {
+            for(v=0; v<3; v++) {
+                Point_copy(&(pTriangles[start + i].vert[v].loc), &(locs[3*i + v]));
+            }
+            Triangle_recompute(&(pTriangles[start + i]));
+        }
+    }
+}
+
+Mesh_t * Xform_mesh(const Xform_t *const pThis, Mesh_t *const pMesh)
+{
+    Xform_points(pThis, pMesh->positions, pMesh->positions, pMesh->vert_count);
+    return Mesh_recompute(pMesh);
+}
@@ -0,0 +1,90 @@
+/**
+ * File: xform.h
+ *
+ * Affine transforms as 3x4 matrices: a rotation (or any linear map) in the left three columns,
+ * and a translation in the fourth. Rotating a point with a <Quat_t> takes two Hamilton products
+ * every time; turning the quat into a matrix once makes each point after that nine multiplies
+ * and nine adds, which the batch kernels here spread across SIMD lanes.
+ */
+#ifndef XFORM_H
+#define XFORM_H
+
+#include "quat.h"
+#include "axes.h"
+#include "mesh.h"
+#include "triangle.h"
+#include "point.h"
+#include "vect.h"
+
+/**
+ * Struct: Xform_t
+ * Rows of the matrix. A point (x, y, z) goes to m[r][0]*x + m[r][1]*y + m[r][2]*z + m[r][3]
+ * in each row r.
+ */
+typedef struct {
+    Real_t m[3][4];
+} Xform_t;
+
+/**
+ * Function: Xform_cfg
+ * Configures the identity transform.
+ */
+Xform_t * Xform_cfg(Xform_t *pThis);
+
+/**
+ * Function: Xform_fromQuat
+ * Configures the rotation represented by a unit quat, as <Quat_rotatePoint> does it, followed
+ * by a translation by <pTrans> (or none if it's NULL).
+ */
+Xform_t * Xform_fromQuat(Xform_t *opThis, const Quat_t *pRot, const Vect_t *pTrans);
+
+/**
+ * Function: Xform_fromAxes
+ * Configures the transform from the axes' local coordinates to global ones, as <Axes_point>
+ * does it: the axes are the columns of the matrix, and the origin the translation.
+ */
+Xform_t * Xform_fromAxes(Xform_t *opThis, const Axes_t *pAxes);
+
+/**
+ * Function: Xform_point
+ * Transforms a single point.
+ */
+Point_t * Xform_point(const Xform_t *pThis, Point_t *opOut, const Point_t *pIn);
+
+/**
+ * Function: Xform_vect
+ * Transforms a single vector, which only the left three columns apply to.
+ */
+Vect_t * Xform_vect(const Xform_t *pThis, Vect_t *opOut, const Vect_t *pIn);
+
+/**
+ * Function: Xform_points
+ * Transforms <count> points from <pIn> into <opOut>, with SIMD where it's built for it. The
+ * two arrays may be the same one, to transform it in place, but mustn't otherwise overlap.
+ * Every point comes out exactly as <Xform_point> would give it.
+ */
+void Xform_points(const Xform_t *pThis, Point_t *opOut, const Point_t *pIn, unsigned int count);
+
+/**
+ * Function: Xform_vects
+ * Transforms <count> vectors, as <Xform_points> does points: only the left three columns
+ * apply, as for <Xform_vect>.
+ */
+void Xform_vects(const Xform_t *pThis, Vect_t *opOut, const Vect_t *pIn, unsigned int count);
+
+/**
+ * Function: Xform_triangles
+ * Transforms the vertices of <count> triangles in place, and recomputes their normals, areas,
+ * and the rest of what <Triangle_recompute> does.
+ */
+void Xform_triangles(const Xform_t *pThis, Triangle_t *pTriangles, unsigned int count);
+
+/**
+ * Function: Xform_mesh
+ * Transforms every vertex of a mesh in place, and recomputes each triangle's <MeshTri_t>. Any
+ * <Bvh_t> over the mesh needs building again afterwards.
+ */
+Mesh_t * Xform_mesh(const Xform_t *pThis, Mesh_t *pMesh);
+
+#endif
+//end inclusion filter